@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""
+Read, print and compare the RadPro-Link command latency histograms.
+
+The firmware (CONFIG_RADPRO_LATENCY) times every command it sends to the
+detector in four stages and exposes the histograms through the Latency
+characteristic of the metrics service:
+
+  Service:  52504c4b-0100-4a8b-9c2e-6f5d3a1b0c00
+  Latency:  52504c4b-0102-4a8b-9c2e-6f5d3a1b0c00
+            read  — per stage (queue, device, reply, total): max_us, then
+                    24 log2 buckets, all little-endian uint32
+            write — any value clears the histograms
+
+Bucket 0 counts latencies below 2 us, bucket b [2^b, 2^(b+1)) us.
+
+Usage:
+  latency_hist.py read [--reset] [-o FILE.json]   read from the device
+  latency_hist.py show FILE.json                  print a saved capture
+  latency_hist.py diff BEFORE.json AFTER.json     compare two captures,
+                                                  e.g. two firmware builds
+"""
+
+import argparse
+import asyncio
+import json
+import struct
+import sys
+
+DEVICE_NAME  = "RadPro-Link"
+METRICS_SVC  = "52504c4b-0100-4a8b-9c2e-6f5d3a1b0c00"
+LATENCY_UUID = "52504c4b-0102-4a8b-9c2e-6f5d3a1b0c00"
+
+STAGES  = ["queue", "device", "reply", "total"]
+BUCKETS = 24
+
+
+def decode(raw: bytes) -> dict:
+    words = 1 + BUCKETS
+    if len(raw) != len(STAGES) * words * 4:
+        raise ValueError(f"unexpected latency record of {len(raw)} bytes")
+    values = struct.unpack(f"<{len(STAGES) * words}I", raw)
+    hist = {}
+    for i, stage in enumerate(STAGES):
+        chunk = values[i * words:(i + 1) * words]
+        hist[stage] = {"max_us": chunk[0], "buckets": list(chunk[1:])}
+    return hist
+
+
+def percentile(stage: dict, percent: int) -> int | None:
+    """Bound (us) on the given fraction of samples, as the firmware logs it."""
+    count = sum(stage["buckets"])
+    if count == 0:
+        return None
+    target = (count * percent + 99) // 100
+    seen = 0
+    for b, n in enumerate(stage["buckets"][:-1]):
+        seen += n
+        if seen >= target:
+            return min((1 << (b + 1)) - 1, stage["max_us"])
+    return stage["max_us"]
+
+
+def fmt_us(us: int | None) -> str:
+    if us is None:
+        return "-"
+    if us >= 1000000:
+        return f"{us / 1000000:.1f}s"
+    if us >= 1000:
+        return f"{us / 1000:.1f}ms"
+    return f"{us}us"
+
+
+def summary(stage: dict) -> dict:
+    return {
+        "n": sum(stage["buckets"]),
+        "p50": percentile(stage, 50),
+        "p90": percentile(stage, 90),
+        "p99": percentile(stage, 99),
+        "max": stage["max_us"] if sum(stage["buckets"]) else None,
+    }
+
+
+def show(hist: dict):
+    print(f"{'stage':<8}{'n':>8}{'p50<=':>10}{'p90<=':>10}{'p99<=':>10}{'max':>10}")
+    for stage in STAGES:
+        s = summary(hist[stage])
+        print(f"{stage:<8}{s['n']:>8}{fmt_us(s['p50']):>10}{fmt_us(s['p90']):>10}"
+              f"{fmt_us(s['p99']):>10}{fmt_us(s['max']):>10}")
+
+    for stage in STAGES:
+        buckets = hist[stage]["buckets"]
+        peak = max(buckets)
+        if peak == 0:
+            continue
+        print(f"\n{stage}")
+        first = next(b for b, n in enumerate(buckets) if n)
+        last = max(b for b, n in enumerate(buckets) if n)
+        for b in range(first, last + 1):
+            low = 0 if b == 0 else 1 << b
+            bar = "#" * round(40 * buckets[b] / peak)
+            print(f"  >={fmt_us(low):>8} {buckets[b]:>8} {bar}")
+
+
+def diff(before: dict, after: dict):
+    print(f"{'stage':<8}{'':>6}{'n':>8}{'p50<=':>10}{'p90<=':>10}{'p99<=':>10}{'max':>10}")
+    for stage in STAGES:
+        a = summary(before[stage])
+        b = summary(after[stage])
+        for label, s in (("before", a), ("after", b)):
+            print(f"{stage if label == 'before' else '':<8}{label:>6}{s['n']:>8}"
+                  f"{fmt_us(s['p50']):>10}{fmt_us(s['p90']):>10}"
+                  f"{fmt_us(s['p99']):>10}{fmt_us(s['max']):>10}")
+        deltas = []
+        for key in ("p50", "p90", "p99", "max"):
+            if a[key] and b[key]:
+                deltas.append(f"{key} x{b[key] / a[key]:.2f}")
+        if deltas:
+            print(f"{'':<14}{'  '.join(deltas)}")
+
+
+async def find_device(timeout: float = 10.0):
+    from bleak import BleakScanner
+
+    print(f"Scanning for '{DEVICE_NAME}' ({int(timeout)}s)...")
+    discovered = await BleakScanner.discover(timeout=timeout, return_adv=True)
+    for addr, (device, adv) in discovered.items():
+        if (device.name or "").lower() == DEVICE_NAME.lower():
+            rssi = adv.rssi if adv else "?"
+            print(f"Found: {addr}  RSSI={rssi}  name={device.name!r}")
+            return device
+    return None
+
+
+async def read_device(reset: bool) -> dict:
+    from bleak import BleakClient
+
+    device = await find_device()
+    if not device:
+        print(f"\nERROR: '{DEVICE_NAME}' not found.")
+        print("Run 'make ble-scan' to list all visible BLE devices.")
+        sys.exit(1)
+
+    async with BleakClient(device.address) as client:
+        # The characteristic needs an encrypted link
+        try:
+            await client.pair(protection_level=1)
+        except Exception as e:
+            print(f"Pairing: {e}")
+
+        raw = await client.read_gatt_char(LATENCY_UUID)
+        if reset:
+            await client.write_gatt_char(LATENCY_UUID, b"\x00", response=True)
+            print("Histograms cleared.")
+
+    return decode(bytes(raw))
+
+
+def load(path: str) -> dict:
+    with open(path) as f:
+        return json.load(f)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p_read = sub.add_parser("read", help="read the histograms from the device")
+    p_read.add_argument("--reset", action="store_true", help="clear them after reading")
+    p_read.add_argument("-o", "--output", help="save the capture as JSON")
+
+    p_show = sub.add_parser("show", help="print a saved capture")
+    p_show.add_argument("file")
+
+    p_diff = sub.add_parser("diff", help="compare two saved captures")
+    p_diff.add_argument("before")
+    p_diff.add_argument("after")
+
+    args = parser.parse_args()
+
+    if args.cmd == "read":
+        hist = asyncio.run(read_device(args.reset))
+        if args.output:
+            with open(args.output, "w") as f:
+                json.dump(hist, f, indent=1)
+            print(f"Saved to {args.output}")
+        print()
+        show(hist)
+    elif args.cmd == "show":
+        show(load(args.file))
+    else:
+        diff(load(args.before), load(args.after))
+
+
+if __name__ == "__main__":
+    main()
@@ -1,38 +1,93 @@
 #!/usr/bin/env python3
-"""Capture RTT output from nRF54L15 using pyocd Python API."""
+"""Capture RTT output from nRF54L15 using pyocd Python API.
+
+  rtt_capture.py [SECONDS]              print RTT console output
+  rtt_capture.py --trace [FILE]         pull the binary data path trace
+                                        (CONFIG_RADPRO_TRACE), decode it and
+                                        optionally save the raw ring to FILE
+  rtt_capture.py --decode FILE          decode a saved ring offline
+"""
+import struct
 import sys
 import time
 import signal
 
-from pyocd.core.helpers import ConnectHelper
-from pyocd.debug.rtt import RTTControlBlock
-
 PROBE_UID = "8ABD0345"
 RTT_ADDRESS = 0x20000000
-DURATION = float(sys.argv[1]) if len(sys.argv) > 1 else 15.0
-
-running = True
-def _stop(sig, frame):
-    global running
-    running = False
-signal.signal(signal.SIGINT, _stop)
-signal.signal(signal.SIGTERM, _stop)
-
-with ConnectHelper.session_with_chosen_probe(
-    unique_id=PROBE_UID,
-    target_override="nrf54l",
-    connect_mode="attach",
-    options={"logging.file_log_level": "warning"},
-) as session:
-    board = session.board
-    target = board.target
-    target.resume()
+RAM_SIZE = 256 * 1024
+DURATION = 15.0
+
+# Trace ring (src/trace/trace.c): magic, record size, record count,
+# cycles per second, events written, then the records
+TRACE_MAGIC = b"RPTRACE\0"
+TRACE_HEADER = struct.Struct("<8sIIII")
+TRACE_RECORD = struct.Struct("<IBxH8s")
+
+# enum trace_event_id (src/trace/trace.h): name, carries data bytes
+TRACE_EVENTS = {
+    1: ("uart_rx_rdy", True),
+    2: ("uart_rx_full", False),
+    3: ("uart_rx_stopped", False),
+    4: ("uart_tx", True),
+    5: ("uart_tx_done", False),
+    6: ("uart_to_ble", True),
+}
+
+
+def decode_trace(raw: bytes):
+    magic, rec_size, count, hz, head = TRACE_HEADER.unpack_from(raw)
+    if magic != TRACE_MAGIC or rec_size != TRACE_RECORD.size:
+        sys.exit("[TRACE] Not a trace ring")
+
+    first = max(0, head - count)
+    print(f"[TRACE] {head} events, showing {head - first} ({hz} cycles/s)")
+
+    prev = None
+    for seq in range(first, head):
+        off = TRACE_HEADER.size + (seq % count) * rec_size
+        cycles, event, length, data = TRACE_RECORD.unpack_from(raw, off)
+        name, has_data = TRACE_EVENTS.get(event, (f"event_{event}", False))
+        # Cycle counter deltas are exact across 32-bit wraps
+        delta = 0 if prev is None else ((cycles - prev) & 0xFFFFFFFF) * 1e6 / hz
+        prev = cycles
+
+        line = f"{seq:>8} +{delta:>10.1f}us  {name:<16} {length:>5}"
+        if has_data:
+            shown = data[:min(length, len(data))]
+            text = "".join(chr(b) if 32 <= b < 127 else "." for b in shown)
+            line += f"  {shown.hex(' '):<23}  {text}"
+        print(line)
+
+
+def find_trace(target) -> bytes:
+    ram = bytes(target.read_memory_block8(RTT_ADDRESS, RAM_SIZE))
+    pos = ram.find(TRACE_MAGIC)
+    if pos < 0:
+        sys.exit("[TRACE] Trace ring not found - is CONFIG_RADPRO_TRACE enabled?")
+
+    _, rec_size, count, _, _ = TRACE_HEADER.unpack_from(ram, pos)
+    addr = RTT_ADDRESS + pos
+    print(f"[TRACE] Ring at 0x{addr:08x}", flush=True)
+    # Re-read so the head and records are as close to consistent as possible
+    return bytes(target.read_memory_block8(addr, TRACE_HEADER.size + rec_size * count))
+
+
+def capture_rtt(target, duration: float):
+    from pyocd.debug.rtt import RTTControlBlock
+
+    running = True
+
+    def _stop(sig, frame):
+        nonlocal running
+        running = False
+    signal.signal(signal.SIGINT, _stop)
+    signal.signal(signal.SIGTERM, _stop)
 
     rtt = RTTControlBlock.from_target(target, address=RTT_ADDRESS, size=0)
     rtt.start()
 
-    deadline = time.monotonic() + DURATION
-    print(f"[RTT] Capturing for {DURATION:.0f}s... (Ctrl-C to stop early)", flush=True)
+    deadline = time.monotonic() + duration
+    print(f"[RTT] Capturing for {duration:.0f}s... (Ctrl-C to stop early)", flush=True)
     while running and time.monotonic() < deadline:
         data = rtt.up_channels[0].read()
         if data:
@@ -42,3 +97,40 @@ with ConnectHelper.session_with_chosen_probe(
             time.sleep(0.05)
 
     print("\n[RTT] Done.", flush=True)
+
+
+def main():
+    args = sys.argv[1:]
+
+    if args[:1] == ["--decode"] and len(args) == 2:
+        with open(args[1], "rb") as f:
+            decode_trace(f.read())
+        return
+
+    from pyocd.core.helpers import ConnectHelper
+
+    with ConnectHelper.session_with_chosen_probe(
+        unique_id=PROBE_UID,
+        target_override="nrf54l",
+        connect_mode="attach",
+        options={"logging.file_log_level": "warning"},
+    ) as session:
+        target = session.board.target
+
+        if args[:1] == ["--trace"]:
+            target.halt()
+            raw = find_trace(target)
+            target.resume()
+            if len(args) > 1:
+                with open(args[1], "wb") as f:
+                    f.write(raw)
+                print(f"[TRACE] Saved to {args[1]}")
+            decode_trace(raw)
+            return
+
+        target.resume()
+        capture_rtt(target, float(args[0]) if args else DURATION)
+
+
+if __name__ == "__main__":
+    main()
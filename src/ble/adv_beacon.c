@@ -0,0 +1,72 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Advertising Beacon Module - Implementation
+ */
+
+#include "adv_beacon.h"
+#include "ble_service.h"
+#include "radiation_service.h"
+#include "../radpro/radpro_sampler.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(adv_beacon, LOG_LEVEL_INF);
+
+BUILD_ASSERT(ADV_BEACON_LEN <= BLE_SERVICE_MFG_DATA_MAX,
+	     "Beacon record does not fit the advertising data");
+
+/* Only touched from the sampler listener */
+static uint8_t beacon_seq;
+
+void adv_beacon_encode(uint8_t *buf, uint8_t seq, uint32_t cpm_x100,
+		       uint32_t delta, uint16_t battery_mv)
+{
+	sys_put_le16(CONFIG_RADPRO_ADV_BEACON_COMPANY_ID, &buf[0]);
+	buf[2] = ADV_BEACON_VERSION;
+	buf[3] = seq;
+	sys_put_le32(cpm_x100, &buf[4]);
+	sys_put_le16(MIN(delta, UINT16_MAX), &buf[8]);
+	sys_put_le16(battery_mv, &buf[10]);
+}
+
+static uint16_t battery_mv(void)
+{
+	uint32_t value = 0;
+
+	/* Polled by the radiation service; unknown without it */
+	if (IS_ENABLED(CONFIG_RADPRO_RADIATION_SERVICE) &&
+	    radiation_service_get(RADIATION_BATTERY, &value) != 0) {
+		value = 0;
+	}
+
+	return MIN(value, UINT16_MAX);
+}
+
+static void on_sample(const struct radpro_sample *sample)
+{
+	uint8_t record[ADV_BEACON_LEN];
+	int err;
+
+	adv_beacon_encode(record, beacon_seq++, sample->cpm_short_x100, sample->delta,
+			  battery_mv());
+
+	err = ble_service_set_mfg_data(record, sizeof(record));
+	if (err) {
+		LOG_WRN("Failed to update beacon: %d", err);
+	}
+}
+
+int adv_beacon_init(void)
+{
+	int err = radpro_sampler_add_listener(on_sample);
+
+	if (err) {
+		LOG_ERR("Failed to subscribe to sampler: %d", err);
+		return err;
+	}
+
+	LOG_INF("Advertising beacon initialized");
+	return 0;
+}
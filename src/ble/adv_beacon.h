@@ -0,0 +1,46 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Advertising Beacon Module - Header
+ *
+ * Broadcasts the latest measurement in the advertising manufacturer
+ * data, refreshed on every sampler update, so any number of scanners can
+ * follow the detector without connecting. Little-endian layout:
+ *
+ *   0  uint16  company ID (CONFIG_RADPRO_ADV_BEACON_COMPANY_ID)
+ *   2  uint8   record version (ADV_BEACON_VERSION)
+ *   3  uint8   sequence number, incremented per record
+ *   4  uint32  counts per minute x 100 (10 s window)
+ *   8  uint16  pulses since the previous record (saturating)
+ *  10  uint16  battery voltage in mV, 0 if unknown
+ */
+
+#ifndef ADV_BEACON_H
+#define ADV_BEACON_H
+
+#include <stdint.h>
+
+#define ADV_BEACON_VERSION 1
+#define ADV_BEACON_LEN 12
+
+/**
+ * @brief Initialize the beacon
+ *
+ * Subscribes to the pulse sampler; the record is advertised from the
+ * first computed sample on.
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int adv_beacon_init(void);
+
+/**
+ * @brief Encode a beacon record
+ * @param buf Receives ADV_BEACON_LEN bytes
+ * @param seq Sequence number
+ * @param cpm_x100 Counts per minute x 100
+ * @param delta Pulses since the previous record
+ * @param battery_mv Battery voltage in mV, 0 if unknown
+ */
+void adv_beacon_encode(uint8_t *buf, uint8_t seq, uint32_t cpm_x100,
+		       uint32_t delta, uint16_t battery_mv);
+
+#endif /* ADV_BEACON_H */
@@ -4,10 +4,15 @@
  */
 
 #include "ble_service.h"
+#include "l2cap_coc.h"
 #include "../security/security_manager.h"
+#include "../metrics/metrics.h"
+#include "../status/app_status.h"
 
+#include <string.h>
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/hci.h>
 #include <zephyr/bluetooth/services/nus.h>
 #include <zephyr/logging/log.h>
 
@@ -16,16 +21,75 @@ LOG_MODULE_REGISTER(ble_service, LOG_LEVEL_DBG);
 #define DEVICE_NAME CONFIG_BT_DEVICE_NAME
 #define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
 
+/* Notifications allowed in flight per connection before senders block */
+#define NUS_TX_WINDOW CONFIG_RADPRO_NUS_TX_WINDOW
+
+/* Default BLE ATT MTU */
+#define ATT_DEFAULT_MTU 23
+
+/* Largest advertising payload that still fits a legacy PDU */
+#define ADV_LEGACY_MAX_LEN 31
+
+/* Per-connection state, indexed by bt_conn_index(). Written from the BT
+ * RX thread only; each peer has its own TX window so a central that
+ * stops reading cannot block notifications to the others. */
+struct ble_peer {
+	struct bt_conn *conn;
+	uint16_t mtu;
+	struct k_sem tx_credits;  /* One credit per notification not yet sent */
+};
+
 /* State */
-static struct bt_conn *current_conn;
+static struct ble_peer peers[BLE_SERVICE_MAX_CONN];
 static struct k_work adv_work;
-static uint16_t current_mtu = 23;  /* Default BLE ATT MTU */
+static struct k_work adv_update_work;
+static struct k_work adv_restart_work;
 static ble_data_received_cb_t data_received_callback;
+static ble_disconnected_cb_t disconnected_callback;
+
+/* Most recently used bonded peer, target of directed advertising */
+static bt_addr_le_t last_peer;
+static bool have_last_peer;
+static bool directed_pending;
+
+/* Advertising stages: fast after boot, a disconnect or a boost, then
+ * slower the longer nobody connects. The last stage lasts forever. */
+struct adv_stage {
+	uint16_t interval_min;  /* 0.625 ms units */
+	uint16_t interval_max;
+	uint32_t duration_s;
+};
+
+static const struct adv_stage adv_stages[] = {
+	{ BT_GAP_ADV_FAST_INT_MIN_1, BT_GAP_ADV_FAST_INT_MAX_1, CONFIG_RADPRO_ADV_FAST_S },
+	{ BT_GAP_ADV_FAST_INT_MIN_2, BT_GAP_ADV_FAST_INT_MAX_2, CONFIG_RADPRO_ADV_MEDIUM_S },
+	{ BT_GAP_ADV_SLOW_INT_MIN, BT_GAP_ADV_SLOW_INT_MAX, 0 },
+};
+
+/* Current stage - boosted from other threads, otherwise system workqueue */
+static atomic_t adv_stage;
+static struct k_work_delayable adv_stage_work;
+
+static const struct bt_gatt_attr *nus_tx_attr;
+static const struct bt_uuid_128 nus_tx_uuid = BT_UUID_INIT_128(BT_UUID_NUS_TX_CHAR_VAL);
+
+/* Manufacturer data: advertised from mfg_data, staged in mfg_pending by
+ * callers on other threads - protected by mfg_lock */
+static uint8_t mfg_data[BLE_SERVICE_MFG_DATA_MAX];
+static uint8_t mfg_pending[BLE_SERVICE_MFG_DATA_MAX];
+static uint8_t mfg_pending_len;
+static K_MUTEX_DEFINE(mfg_lock);
 
-/* Advertising data */
-static const struct bt_data ad[] = {
+/* Only the beacon sets manufacturer data; without it the name may use the room */
+BUILD_ASSERT(!IS_ENABLED(CONFIG_RADPRO_ADV_BEACON) ||
+	     3 + 2 + DEVICE_NAME_LEN + 2 + BLE_SERVICE_MFG_DATA_MAX <= ADV_LEGACY_MAX_LEN,
+	     "Device name too long to advertise manufacturer data");
+
+/* Advertising data - manufacturer data last, left out while empty */
+static struct bt_data ad[] = {
 	BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
 	BT_DATA(BT_DATA_NAME_COMPLETE, DEVICE_NAME, DEVICE_NAME_LEN),
+	BT_DATA(BT_DATA_MANUFACTURER_DATA, mfg_data, 0),
 };
 
 static const struct bt_data sd[] = {
@@ -35,10 +99,51 @@ static const struct bt_data sd[] = {
 /* Forward declarations */
 static void handle_mtu_update(struct bt_conn *conn);
 
+/* Peer slot of a connection, NULL if not one of ours */
+static struct ble_peer *peer_get(struct bt_conn *conn)
+{
+	struct ble_peer *peer;
+
+	if (!conn) {
+		return NULL;
+	}
+
+	peer = &peers[bt_conn_index(conn)];
+	return peer->conn == conn ? peer : NULL;
+}
+
+static int peer_count(void)
+{
+	int count = 0;
+
+	for (int i = 0; i < BLE_SERVICE_MAX_CONN; i++) {
+		if (peers[i].conn) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/* Publish the link flags after a connection event */
+static void publish_link_status(void)
+{
+	app_status_set(APP_STATUS_CONNECTED, peer_count() > 0);
+	app_status_set(APP_STATUS_AUTHENTICATED, ble_service_is_authenticated());
+}
+
 /* Connection callbacks */
 static void connected(struct bt_conn *conn, uint8_t err)
 {
 	char addr[BT_ADDR_LE_STR_LEN];
+	struct ble_peer *peer;
+
+	if (err == BT_HCI_ERR_ADV_TIMEOUT) {
+		/* Directed advertising ran out. recycled_cb restarts with the
+		 * accept list once its connection object is freed */
+		LOG_INF("Directed advertising timed out");
+		return;
+	}
 
 	if (err) {
 		LOG_ERR("Connection failed, err 0x%02x", err);
@@ -48,30 +153,71 @@ static void connected(struct bt_conn *conn, uint8_t err)
 	bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
 	LOG_INF("Connected to %s", addr);
 
-	current_conn = bt_conn_ref(conn);
+	peer = &peers[bt_conn_index(conn)];
+	peer->conn = bt_conn_ref(conn);
+	peer->mtu = ATT_DEFAULT_MTU;
+
+	metrics_inc(METRICS_CONNECTS);
+	metrics_set(METRICS_CONNECTIONS, peer_count());
+	publish_link_status();
+
+	/* Fresh link: open the full TX window (the semaphore limit caps it) */
+	for (int i = 0; i < NUS_TX_WINDOW; i++) {
+		k_sem_give(&peer->tx_credits);
+	}
 
 	/* Check current MTU */
 	handle_mtu_update(conn);
+
+	/* Advertising stopped with the connection; keep inviting centrals
+	 * while a slot is free */
+	if (peer_count() < BLE_SERVICE_MAX_CONN) {
+		k_work_submit(&adv_work);
+	} else {
+		k_work_cancel_delayable(&adv_stage_work);
+	}
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason)
 {
 	char addr[BT_ADDR_LE_STR_LEN];
+	struct ble_peer *peer = peer_get(conn);
 
 	bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
 	LOG_INF("Disconnected from %s, reason 0x%02x", addr, reason);
 
-	if (current_conn) {
-		bt_conn_unref(current_conn);
-		current_conn = NULL;
-		current_mtu = 23;
+	if (!peer) {
+		return;
+	}
+
+	bt_conn_unref(peer->conn);
+	peer->conn = NULL;
+	peer->mtu = ATT_DEFAULT_MTU;
+
+	metrics_inc(METRICS_DISCONNECTS);
+	metrics_set(METRICS_CONNECTIONS, peer_count());
+	publish_link_status();
+
+	/* Wake blocked senders; they will see the link is gone */
+	k_sem_reset(&peer->tx_credits);
+
+	if (disconnected_callback) {
+		disconnected_callback(conn);
+	}
+
+	/* Invite the peer back first when advertising restarts - only the
+	 * last bonded one, not whoever else was connected */
+	if (have_last_peer && bt_addr_le_eq(bt_conn_get_dst(conn), &last_peer)) {
+		directed_pending = true;
 	}
 }
 
 static void recycled_cb(void)
 {
+	/* Advertising may still run for the other slots: restart it fast */
 	LOG_INF("Connection recycled, restarting advertising");
-	ble_service_start_advertising();
+	atomic_set(&adv_stage, 0);
+	k_work_submit(&adv_restart_work);
 }
 
 static void security_changed(struct bt_conn *conn, bt_security_t level,
@@ -86,6 +232,12 @@ static void security_changed(struct bt_conn *conn, bt_security_t level,
 		if (level >= BT_SECURITY_L2) {
 			LOG_INF("Device %s is authenticated", addr);
 			handle_mtu_update(conn);
+			publish_link_status();
+
+			if (bt_le_bond_exists(BT_ID_DEFAULT, bt_conn_get_dst(conn))) {
+				last_peer = *bt_conn_get_dst(conn);
+				have_last_peer = true;
+			}
 		}
 	} else {
 		LOG_WRN("Security failed for %s level %u err %d %s", addr, level,
@@ -99,50 +251,36 @@ static bool le_param_req(struct bt_conn *conn, struct bt_le_conn_param *param)
 	return true;
 }
 
-static void le_param_updated(struct bt_conn *conn, uint16_t interval,
-			     uint16_t latency, uint16_t timeout)
-{
-	LOG_INF("Connection parameters updated: interval=%d, latency=%d, timeout=%d",
-		interval, latency, timeout);
-}
-
-#if defined(CONFIG_BT_USER_DATA_LEN_UPDATE)
-static void le_data_len_updated(struct bt_conn *conn, struct bt_conn_le_data_len_info *info)
-{
-	LOG_INF("Data length updated: TX max=%d, RX max=%d",
-		info->tx_max_len, info->rx_max_len);
-}
-#endif
-
 BT_CONN_CB_DEFINE(conn_callbacks) = {
 	.connected        = connected,
 	.disconnected     = disconnected,
 	.recycled         = recycled_cb,
 	.security_changed = security_changed,
 	.le_param_req     = le_param_req,
-	.le_param_updated = le_param_updated,
-#if defined(CONFIG_BT_USER_DATA_LEN_UPDATE)
-	.le_data_len_updated = le_data_len_updated,
-#endif
+	/* Parameter/PHY/data length updates are reported by link_profile */
 };
 
 /* MTU management */
 static void handle_mtu_update(struct bt_conn *conn)
 {
+	struct ble_peer *peer = peer_get(conn);
 	uint16_t mtu = bt_gatt_get_mtu(conn);
 
-	if (mtu != current_mtu) {
-		current_mtu = mtu;
+	if (peer && mtu != peer->mtu) {
+		peer->mtu = mtu;
+		metrics_set(METRICS_MTU, mtu);
 		LOG_INF("MTU updated to %d bytes (payload: %d bytes)", mtu, mtu - 3);
 	}
 }
 
 static void gatt_mtu_updated_cb(struct bt_conn *conn, uint16_t tx, uint16_t rx)
 {
+	struct ble_peer *peer = peer_get(conn);
 	uint16_t mtu = MIN(tx, rx);
 
-	if (mtu != current_mtu) {
-		current_mtu = mtu;
+	if (peer && mtu != peer->mtu) {
+		peer->mtu = mtu;
+		metrics_set(METRICS_MTU, mtu);
 		LOG_INF("MTU negotiated to %d bytes (payload: %d bytes)", mtu, mtu - 3);
 	}
 }
@@ -159,10 +297,13 @@ static void bt_receive_cb(struct bt_conn *conn, const void *data, uint16_t len,
 	/* Check if device is authenticated */
 	if (bt_conn_get_security(conn) < BT_SECURITY_L2) {
 		LOG_WRN("Rejecting %d bytes from non-authenticated device", len);
+		metrics_add(METRICS_DROP_UNAUTH_BYTES, len);
 		return;
 	}
 
 	LOG_DBG("Received %d bytes from authenticated device", len);
+	metrics_inc(METRICS_BLE_RX_FRAMES);
+	metrics_add(METRICS_BLE_RX_BYTES, len);
 
 	/* Forward to application callback */
 	if (data_received_callback) {
@@ -174,18 +315,148 @@ static struct bt_nus_cb nus_cb = {
 	.received = bt_receive_cb,
 };
 
-/* Advertising work handler */
+/* TX completion - the notification left the controller, free its slot */
+static void nus_tx_complete(struct bt_conn *conn, void *user_data)
+{
+	struct ble_peer *peer = user_data;
+
+	ARG_UNUSED(conn);
+
+	k_sem_give(&peer->tx_credits);
+}
+
+static k_timeout_t tx_credit_timeout(k_timeout_t timeout)
+{
+	/* Completions are delivered on the system workqueue; never block it */
+	if (k_current_get() == k_work_queue_thread_get(&k_sys_work_q)) {
+		return K_NO_WAIT;
+	}
+
+	return timeout;
+}
+
+static size_t ad_count(void)
+{
+	return ad[ARRAY_SIZE(ad) - 1].data_len ? ARRAY_SIZE(ad) : ARRAY_SIZE(ad) - 1;
+}
+
+static void add_bond_to_accept_list(const struct bt_bond_info *info, void *user_data)
+{
+	int *count = user_data;
+	int err = bt_le_filter_accept_list_add(&info->addr);
+
+	if (err) {
+		LOG_WRN("Failed to add bond to accept list: %d", err);
+		return;
+	}
+
+	(*count)++;
+}
+
+/* Once pairing is over only bonded peers are served: invite the last one
+ * with high duty directed advertising, otherwise filter on the bonds.
+ * Returns true if directed advertising was started. */
+static bool bonded_adv_start(void)
+{
+	int count = 0;
+	int err;
+
+	if (directed_pending) {
+		directed_pending = false;
+
+		err = bt_le_adv_start(BT_LE_ADV_CONN_DIR(&last_peer), NULL, 0, NULL, 0);
+		if (!err) {
+			LOG_INF("Directed advertising to last peer");
+			return true;
+		}
+
+		LOG_WRN("Directed advertising failed (err %d)", err);
+	}
+
+	err = bt_le_filter_accept_list_clear();
+	if (err) {
+		LOG_WRN("Failed to clear accept list: %d", err);
+	}
+
+	bt_foreach_bond(BT_ID_DEFAULT, add_bond_to_accept_list, &count);
+	LOG_INF("Accept list: %d bonded peers", count);
+
+	return false;
+}
+
+/* Advertising work handlers - both on the system workqueue, so ad[] is
+ * never rewritten while being handed to the stack */
 static void adv_work_handler(struct k_work *work)
 {
-	int err = bt_le_adv_start(BT_LE_ADV_CONN_FAST_2, ad, ARRAY_SIZE(ad),
-				  sd, ARRAY_SIZE(sd));
+	const struct adv_stage *stage = &adv_stages[atomic_get(&adv_stage)];
+	struct bt_le_adv_param param = BT_LE_ADV_PARAM_INIT(
+		BT_LE_ADV_OPT_CONN, stage->interval_min, stage->interval_max, NULL);
+	int err;
 
+	if (IS_ENABLED(CONFIG_RADPRO_ADV_BONDED_ONLY) &&
+	    !security_manager_is_pairing_allowed()) {
+		if (bonded_adv_start()) {
+			return;
+		}
+		param.options |= BT_LE_ADV_OPT_FILTER_CONN | BT_LE_ADV_OPT_FILTER_SCAN_REQ;
+	}
+
+	err = bt_le_adv_start(&param, ad, ad_count(), sd, ARRAY_SIZE(sd));
 	if (err) {
 		LOG_ERR("Advertising failed to start (err %d)", err);
 		return;
 	}
 
-	LOG_INF("Advertising started");
+	LOG_INF("Advertising started (stage %ld, %u ms)", atomic_get(&adv_stage),
+		stage->interval_min * 5 / 8);
+
+	if (stage->duration_s) {
+		k_work_reschedule(&adv_stage_work, K_SECONDS(stage->duration_s));
+	}
+}
+
+static void adv_restart_work_handler(struct k_work *work)
+{
+	int err;
+
+	/* No free slot: advertising resumes with the new mode on disconnect */
+	if (peer_count() >= BLE_SERVICE_MAX_CONN) {
+		return;
+	}
+
+	err = bt_le_adv_stop();
+	if (err) {
+		LOG_WRN("Failed to stop advertising (err %d)", err);
+		return;
+	}
+
+	adv_work_handler(work);
+}
+
+static void adv_stage_work_handler(struct k_work *work)
+{
+	/* Step down one stage; the last one is never left by the timer */
+	if (atomic_get(&adv_stage) < (atomic_val_t)ARRAY_SIZE(adv_stages) - 1) {
+		atomic_inc(&adv_stage);
+	}
+
+	adv_restart_work_handler(work);
+}
+
+static void adv_update_work_handler(struct k_work *work)
+{
+	int err;
+
+	k_mutex_lock(&mfg_lock, K_FOREVER);
+	memcpy(mfg_data, mfg_pending, mfg_pending_len);
+	ad[ARRAY_SIZE(ad) - 1].data_len = mfg_pending_len;
+	k_mutex_unlock(&mfg_lock);
+
+	/* -EAGAIN: not advertising (connected), picked up on the next start */
+	err = bt_le_adv_update_data(ad, ad_count(), sd, ARRAY_SIZE(sd));
+	if (err && err != -EAGAIN) {
+		LOG_WRN("Advertising data update failed (err %d)", err);
+	}
 }
 
 /* Public API */
@@ -195,8 +466,16 @@ int ble_service_init(ble_data_received_cb_t data_cb)
 
 	data_received_callback = data_cb;
 
+	for (int i = 0; i < BLE_SERVICE_MAX_CONN; i++) {
+		peers[i].mtu = ATT_DEFAULT_MTU;
+		k_sem_init(&peers[i].tx_credits, NUS_TX_WINDOW, NUS_TX_WINDOW);
+	}
+
 	/* Initialize work queue */
 	k_work_init(&adv_work, adv_work_handler);
+	k_work_init(&adv_update_work, adv_update_work_handler);
+	k_work_init(&adv_restart_work, adv_restart_work_handler);
+	k_work_init_delayable(&adv_stage_work, adv_stage_work_handler);
 
 	/* Register NUS callbacks - Zephyr API uses callback registration instead of init */
 	err = bt_nus_cb_register(&nus_cb, NULL);
@@ -205,39 +484,139 @@ int ble_service_init(ble_data_received_cb_t data_cb)
 		return err;
 	}
 
+	/* Bulk transport next to NUS, commands arrive through the same callback */
+	if (IS_ENABLED(CONFIG_RADPRO_L2CAP_COC)) {
+		err = l2cap_coc_init(data_cb);
+		if (err) {
+			return err;
+		}
+	}
+
 	/* Register GATT callbacks */
 	bt_gatt_cb_register(&gatt_callbacks);
 
+	/* NUS TX characteristic value, target of our notifications */
+	nus_tx_attr = bt_gatt_find_by_uuid(NULL, 0, &nus_tx_uuid.uuid);
+	if (!nus_tx_attr) {
+		LOG_ERR("NUS TX characteristic not found");
+		return -ENOENT;
+	}
+
 	LOG_INF("BLE service initialized");
 	return 0;
 }
 
 int ble_service_start_advertising(void)
 {
+	atomic_set(&adv_stage, 0);
 	k_work_submit(&adv_work);
 	return 0;
 }
 
-int ble_service_send(const uint8_t *data, uint16_t len)
+void ble_service_restart_advertising(void)
 {
-	if (!current_conn || bt_conn_get_security(current_conn) < BT_SECURITY_L2) {
+	k_work_submit(&adv_restart_work);
+}
+
+void ble_service_boost_advertising(void)
+{
+	/* Cheap when already fast, called on every trigger */
+	if (atomic_set(&adv_stage, 0) != 0) {
+		k_work_submit(&adv_restart_work);
+	}
+}
+
+int ble_service_set_mfg_data(const uint8_t *data, uint8_t len)
+{
+	if (len > BLE_SERVICE_MFG_DATA_MAX) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&mfg_lock, K_FOREVER);
+	memcpy(mfg_pending, data, len);
+	mfg_pending_len = len;
+	k_mutex_unlock(&mfg_lock);
+
+	k_work_submit(&adv_update_work);
+	return 0;
+}
+
+int ble_service_send(struct bt_conn *conn, const uint8_t *data, uint16_t len,
+		     k_timeout_t timeout)
+{
+	struct ble_peer *peer = peer_get(conn);
+	struct bt_gatt_notify_params params = {
+		.attr = nus_tx_attr,
+		.data = data,
+		.len = len,
+		.func = nus_tx_complete,
+		.user_data = peer,
+	};
+	int err;
+
+	if (!peer || bt_conn_get_security(conn) < BT_SECURITY_L2) {
+		return -ENOTCONN;
+	}
+
+	/* Backpressure: wait for a slot in this connection's TX window */
+	if (k_sem_take(&peer->tx_credits, tx_credit_timeout(timeout)) != 0) {
+		return peer->conn == conn ? -EAGAIN : -ENOTCONN;
+	}
+
+	if (peer->conn != conn) {
+		k_sem_give(&peer->tx_credits);
 		return -ENOTCONN;
 	}
 
-	return bt_nus_send(current_conn, data, len);
+	err = bt_gatt_notify_cb(conn, &params);
+	if (err) {
+		/* Not queued - the completion will never fire, return the slot */
+		k_sem_give(&peer->tx_credits);
+		if (err == -ENOMEM) {
+			err = -EAGAIN;
+		}
+		return err;
+	}
+
+	metrics_inc(METRICS_BLE_TX_FRAMES);
+	metrics_add(METRICS_BLE_TX_BYTES, len);
+	return 0;
+}
+
+uint16_t ble_service_get_mtu(struct bt_conn *conn)
+{
+	struct ble_peer *peer = peer_get(conn);
+
+	return peer ? peer->mtu : ATT_DEFAULT_MTU;
 }
 
-uint16_t ble_service_get_mtu(void)
+struct bt_conn *ble_service_get_connection(uint8_t index)
 {
-	return current_mtu;
+	return index < BLE_SERVICE_MAX_CONN ? peers[index].conn : NULL;
 }
 
-struct bt_conn *ble_service_get_connection(void)
+int ble_service_connection_count(void)
 {
-	return current_conn;
+	return peer_count();
+}
+
+void ble_service_set_disconnected_cb(ble_disconnected_cb_t cb)
+{
+	disconnected_callback = cb;
+}
+
+bool ble_service_is_conn_authenticated(struct bt_conn *conn)
+{
+	return peer_get(conn) && (bt_conn_get_security(conn) >= BT_SECURITY_L2);
 }
 
 bool ble_service_is_authenticated(void)
 {
-	return current_conn && (bt_conn_get_security(current_conn) >= BT_SECURITY_L2);
-}
\ No newline at end of file
+	for (int i = 0; i < BLE_SERVICE_MAX_CONN; i++) {
+		if (ble_service_is_conn_authenticated(peers[i].conn)) {
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -8,6 +8,13 @@
 
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/conn.h>
+#include <zephyr/kernel.h>
+
+/* Manufacturer data bytes that fit next to the flags and device name */
+#define BLE_SERVICE_MFG_DATA_MAX 12
+
+/* Simultaneous centrals served, slots indexed by bt_conn_index() */
+#define BLE_SERVICE_MAX_CONN CONFIG_BT_MAX_CONN
 
 /**
  * @brief Callback type for receiving data from BLE
@@ -17,6 +24,12 @@
  */
 typedef void (*ble_data_received_cb_t)(struct bt_conn *conn, const uint8_t *data, uint16_t len);
 
+/**
+ * @brief Callback type for a central disconnecting
+ * @param conn BLE connection, its slot is already free
+ */
+typedef void (*ble_disconnected_cb_t)(struct bt_conn *conn);
+
 /**
  * @brief Initialize BLE service
  * @param data_cb Callback for received data
@@ -26,34 +39,113 @@ int ble_service_init(ble_data_received_cb_t data_cb);
 
 /**
  * @brief Start BLE advertising
+ *
+ * Starts at the fastest interval and steps down to slower ones after
+ * CONFIG_RADPRO_ADV_FAST_S and CONFIG_RADPRO_ADV_MEDIUM_S without a
+ * connection. Advertising continues while fewer than
+ * BLE_SERVICE_MAX_CONN centrals are connected. Open to everyone while
+ * the pairing window is open. Afterwards, with
+ * CONFIG_RADPRO_ADV_BONDED_ONLY, the last bonded peer is invited back
+ * with directed advertising after a disconnect, then only bonded peers
+ * on the filter accept list may connect.
+ *
  * @return 0 on success, negative errno on failure
  */
 int ble_service_start_advertising(void);
 
 /**
- * @brief Send data over BLE NUS
+ * @brief Return advertising to its fastest interval
+ *
+ * For external triggers such as activity on the device. Cheap and safe
+ * from any thread; does nothing while all connection slots are in use
+ * or already fast.
+ */
+void ble_service_boost_advertising(void);
+
+/**
+ * @brief Restart advertising so a changed advertising mode takes effect
+ *
+ * Used when the pairing window closes. Does nothing while all connection
+ * slots are in use; advertising restarts in the new mode after a
+ * disconnect.
+ */
+void ble_service_restart_advertising(void);
+
+/**
+ * @brief Set the manufacturer data carried in the advertising data
+ *
+ * The advertising data is refreshed from the system workqueue, so this
+ * may be called from any thread. While all connection slots are in use
+ * nothing is advertised; the latest data goes out when advertising
+ * restarts.
+ *
+ * @param data Company ID (little-endian) followed by the payload
+ * @param len Length of data, 0 to stop advertising manufacturer data
+ * @return 0 on success, -EINVAL if longer than BLE_SERVICE_MFG_DATA_MAX
+ */
+int ble_service_set_mfg_data(const uint8_t *data, uint8_t len);
+
+/**
+ * @brief Set the callback for a central disconnecting
+ *
+ * Lets per-connection state elsewhere be dropped with the link. Called
+ * from the BT RX thread.
+ *
+ * @param cb Callback, NULL to disable
+ */
+void ble_service_set_disconnected_cb(ble_disconnected_cb_t cb);
+
+/**
+ * @brief Send data over BLE NUS to one central
+ *
+ * Queues one notification. Every connection has its own window of
+ * CONFIG_RADPRO_NUS_TX_WINDOW notifications in flight; beyond that the
+ * caller blocks for up to timeout until one completes (never on the
+ * system workqueue). A full window on one connection does not affect
+ * the others.
+ *
+ * @param conn Destination connection
  * @param data Data buffer to send
  * @param len Length of data
- * @return 0 on success, negative errno on failure
+ * @param timeout How long to wait for a free TX slot
+ * @return 0 on success, -EAGAIN if no TX slot became free (retry later),
+ *         -ENOTCONN if conn is not an authenticated connection, other
+ *         negative errno on failure
+ */
+int ble_service_send(struct bt_conn *conn, const uint8_t *data, uint16_t len,
+		     k_timeout_t timeout);
+
+/**
+ * @brief Get the MTU of a connection
+ * @param conn BLE connection
+ * @return Current MTU (includes 3-byte ATT header), 23 if not connected
  */
-int ble_service_send(const uint8_t *data, uint16_t len);
+uint16_t ble_service_get_mtu(struct bt_conn *conn);
 
 /**
- * @brief Get current MTU size
- * @return Current MTU (includes 3-byte ATT header)
+ * @brief Get the connection in a slot
+ * @param index Slot, as returned by bt_conn_index()
+ * @return Connection handle or NULL if the slot is free
  */
-uint16_t ble_service_get_mtu(void);
+struct bt_conn *ble_service_get_connection(uint8_t index);
 
 /**
- * @brief Get current connection handle
- * @return Connection handle or NULL if not connected
+ * @brief Get the number of connected centrals
+ * @return Number of connections, authenticated or not
  */
-struct bt_conn *ble_service_get_connection(void);
+int ble_service_connection_count(void);
 
 /**
- * @brief Check if connected and authenticated
+ * @brief Check if a connection is ours and authenticated
+ * @param conn BLE connection, may be NULL
  * @return true if connected with sufficient security level
  */
+bool ble_service_is_conn_authenticated(struct bt_conn *conn);
+
+/**
+ * @brief Check if any central is connected and authenticated
+ * @return true if at least one connection has sufficient security level
+ */
 bool ble_service_is_authenticated(void);
 
-#endif /* BLE_SERVICE_H */
\ No newline at end of file
+#endif /* BLE_SERVICE_H */
@@ -0,0 +1,339 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * L2CAP CoC Transport - Implementation
+ */
+
+#include "l2cap_coc.h"
+#include "../metrics/metrics.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/l2cap.h>
+#include <zephyr/net_buf.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(l2cap_coc, LOG_LEVEL_INF);
+
+#define L2CAP_SDU_LEN CONFIG_RADPRO_L2CAP_MTU
+#define L2CAP_TX_WINDOW CONFIG_RADPRO_L2CAP_TX_WINDOW
+
+/* How long a writer waits for the central to grant credits */
+#define L2CAP_TX_TIMEOUT K_SECONDS(1)
+
+/* Partial SDUs go out after the same delay as NUS fragments */
+#define L2CAP_FLUSH_DELAY K_MSEC(CONFIG_RADPRO_NUS_COALESCE_MS)
+
+/* Retry interval while the TX window is full */
+#define L2CAP_FLUSH_RETRY_DELAY K_MSEC(5)
+
+/* Every channel: a full window in flight plus the SDU being filled */
+NET_BUF_POOL_FIXED_DEFINE(tx_pool, BLE_SERVICE_MAX_CONN * (L2CAP_TX_WINDOW + 1),
+			  BT_L2CAP_SDU_BUF_SIZE(L2CAP_SDU_LEN),
+			  CONFIG_BT_CONN_TX_USER_DATA_SIZE, NULL);
+
+/* Commands are short; one SDU per channel being reassembled */
+NET_BUF_POOL_FIXED_DEFINE(rx_pool, BLE_SERVICE_MAX_CONN,
+			  BT_L2CAP_SDU_BUF_SIZE(L2CAP_SDU_LEN), 8, NULL);
+
+/* Channel per connection slot, indexed by bt_conn_index() */
+struct coc_chan {
+	struct bt_l2cap_le_chan le;
+	bool open;
+	bool stalled;              /* A send timed out waiting, don't wait again */
+	struct net_buf *pending;   /* SDU being filled */
+	struct k_sem tx_credits;   /* One credit per SDU not yet sent */
+	struct k_mutex lock;       /* Protects pending and stalled */
+	struct k_work_delayable flush_work;
+};
+
+static struct coc_chan chans[BLE_SERVICE_MAX_CONN];
+static ble_data_received_cb_t data_received_callback;
+
+static struct coc_chan *chan_get(struct bt_conn *conn)
+{
+	struct coc_chan *cc;
+
+	if (!conn) {
+		return NULL;
+	}
+
+	cc = &chans[bt_conn_index(conn)];
+	return (cc->open && cc->le.chan.conn == conn) ? cc : NULL;
+}
+
+static uint16_t sdu_size(struct coc_chan *cc)
+{
+	return MIN(cc->le.tx.mtu, L2CAP_SDU_LEN);
+}
+
+/* Caller must hold cc->lock */
+static void drop_pending_locked(struct coc_chan *cc)
+{
+	if (cc->pending) {
+		metrics_add(METRICS_DROP_BLE_TX_BYTES, cc->pending->len);
+		net_buf_unref(cc->pending);
+		cc->pending = NULL;
+	}
+}
+
+/* Caller must hold cc->lock */
+static int flush_locked(struct coc_chan *cc, bool may_block)
+{
+	k_timeout_t timeout = (may_block && !cc->stalled) ? L2CAP_TX_TIMEOUT : K_NO_WAIT;
+	uint16_t len;
+	int err;
+
+	if (!cc->pending || cc->pending->len == 0) {
+		return 0;
+	}
+
+	/* Credit-driven backpressure: wait for the central to take an SDU */
+	if (k_sem_take(&cc->tx_credits, timeout) != 0) {
+		if (!cc->open) {
+			drop_pending_locked(cc);
+			return -ENOTCONN;
+		}
+		/* Only a wait that expired means the central stopped granting
+		 * credits; a full window found without waiting is normal */
+		if (!K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+			cc->stalled = true;
+		}
+		return -EAGAIN;
+	}
+
+	if (!cc->open) {
+		k_sem_give(&cc->tx_credits);
+		drop_pending_locked(cc);
+		return -ENOTCONN;
+	}
+
+	len = cc->pending->len;
+	err = bt_l2cap_chan_send(&cc->le.chan, cc->pending);
+	if (err) {
+		/* Not queued - the sent callback will never fire */
+		LOG_WRN("Dropping %d byte SDU: %d", cc->pending->len, err);
+		k_sem_give(&cc->tx_credits);
+		drop_pending_locked(cc);
+		return err;
+	}
+
+	/* The stack owns the buffer now */
+	cc->pending = NULL;
+	cc->stalled = false;
+
+	metrics_inc(METRICS_BLE_TX_FRAMES);
+	metrics_add(METRICS_BLE_TX_BYTES, len);
+	return 0;
+}
+
+static void flush_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct coc_chan *cc = CONTAINER_OF(dwork, struct coc_chan, flush_work);
+	int err;
+
+	/* A writer holding the lock may be waiting for a credit, which
+	 * chan_sent() returns on this workqueue - retry rather than wait */
+	if (k_mutex_lock(&cc->lock, K_NO_WAIT)) {
+		k_work_reschedule(&cc->flush_work, L2CAP_FLUSH_RETRY_DELAY);
+		return;
+	}
+
+	err = flush_locked(cc, false);
+	k_mutex_unlock(&cc->lock);
+
+	if (err == -EAGAIN) {
+		k_work_reschedule(&cc->flush_work, L2CAP_FLUSH_RETRY_DELAY);
+	}
+}
+
+/* Channel callbacks - BT RX thread, except sent */
+static void chan_connected(struct bt_l2cap_chan *chan)
+{
+	struct coc_chan *cc = CONTAINER_OF(chan, struct coc_chan, le.chan);
+
+	LOG_INF("L2CAP channel open (TX MTU %d, MPS %d)", cc->le.tx.mtu, cc->le.tx.mps);
+
+	/* Fresh channel: open the full TX window (the semaphore limit caps it) */
+	for (int i = 0; i < L2CAP_TX_WINDOW; i++) {
+		k_sem_give(&cc->tx_credits);
+	}
+
+	cc->stalled = false;
+	cc->open = true;
+}
+
+static void chan_disconnected(struct bt_l2cap_chan *chan)
+{
+	struct coc_chan *cc = CONTAINER_OF(chan, struct coc_chan, le.chan);
+
+	LOG_INF("L2CAP channel closed");
+
+	cc->open = false;
+
+	/* Wake blocked writers; they will see the channel is gone */
+	k_sem_reset(&cc->tx_credits);
+	k_work_cancel_delayable(&cc->flush_work);
+
+	k_mutex_lock(&cc->lock, K_FOREVER);
+	drop_pending_locked(cc);
+	k_mutex_unlock(&cc->lock);
+}
+
+static struct net_buf *chan_alloc_buf(struct bt_l2cap_chan *chan)
+{
+	ARG_UNUSED(chan);
+
+	return net_buf_alloc(&rx_pool, K_FOREVER);
+}
+
+static int chan_recv(struct bt_l2cap_chan *chan, struct net_buf *buf)
+{
+	metrics_inc(METRICS_BLE_RX_FRAMES);
+	metrics_add(METRICS_BLE_RX_BYTES, buf->len);
+
+	/* Handed over synchronously, the credit goes back on return */
+	if (data_received_callback) {
+		data_received_callback(chan->conn, buf->data, buf->len);
+	}
+
+	return 0;
+}
+
+static void chan_sent(struct bt_l2cap_chan *chan)
+{
+	struct coc_chan *cc = CONTAINER_OF(chan, struct coc_chan, le.chan);
+
+	k_sem_give(&cc->tx_credits);
+}
+
+static const struct bt_l2cap_chan_ops chan_ops = {
+	.connected = chan_connected,
+	.disconnected = chan_disconnected,
+	.alloc_buf = chan_alloc_buf,
+	.recv = chan_recv,
+	.sent = chan_sent,
+};
+
+static int server_accept(struct bt_conn *conn, struct bt_l2cap_server *server,
+			 struct bt_l2cap_chan **chan)
+{
+	struct coc_chan *cc = &chans[bt_conn_index(conn)];
+
+	ARG_UNUSED(server);
+
+	/* One channel per central */
+	if (cc->le.chan.conn) {
+		LOG_WRN("L2CAP channel already open on this connection");
+		return -ENOMEM;
+	}
+
+	memset(&cc->le, 0, sizeof(cc->le));
+	cc->le.chan.ops = &chan_ops;
+	cc->le.rx.mtu = L2CAP_SDU_LEN;
+
+	*chan = &cc->le.chan;
+	return 0;
+}
+
+/* Encryption is enforced by the stack before accept is called */
+static struct bt_l2cap_server server = {
+	.psm = CONFIG_RADPRO_L2CAP_PSM,
+	.sec_level = BT_SECURITY_L2,
+	.accept = server_accept,
+};
+
+/* Public API */
+int l2cap_coc_init(ble_data_received_cb_t data_cb)
+{
+	int err;
+
+	data_received_callback = data_cb;
+
+	for (int i = 0; i < BLE_SERVICE_MAX_CONN; i++) {
+		chans[i].open = false;
+		chans[i].pending = NULL;
+		k_sem_init(&chans[i].tx_credits, 0, L2CAP_TX_WINDOW);
+		k_mutex_init(&chans[i].lock);
+		k_work_init_delayable(&chans[i].flush_work, flush_work_handler);
+	}
+
+	err = bt_l2cap_server_register(&server);
+	if (err) {
+		LOG_ERR("Failed to register L2CAP server: %d", err);
+		return err;
+	}
+
+	LOG_INF("L2CAP server on PSM 0x%04x (SDU %d bytes)", CONFIG_RADPRO_L2CAP_PSM,
+		L2CAP_SDU_LEN);
+	return 0;
+}
+
+bool l2cap_coc_is_open(struct bt_conn *conn)
+{
+	return chan_get(conn) != NULL;
+}
+
+int l2cap_coc_send(struct bt_conn *conn, const uint8_t *data, uint16_t len)
+{
+	struct coc_chan *cc = chan_get(conn);
+	bool restarted;
+	int err = 0;
+
+	if (!cc) {
+		return -ENOTCONN;
+	}
+
+	k_mutex_lock(&cc->lock, K_FOREVER);
+
+	/* Set when the buffered data no longer has a pending deadline */
+	restarted = !cc->pending || cc->pending->len == 0;
+
+	while (len > 0 && !err) {
+		uint16_t n;
+
+		if (!cc->pending) {
+			/* The pool holds one spare per channel beyond its window */
+			cc->pending = net_buf_alloc(&tx_pool, K_NO_WAIT);
+			if (!cc->pending) {
+				metrics_add(METRICS_DROP_BLE_TX_BYTES, len);
+				err = -ENOMEM;
+				break;
+			}
+			net_buf_reserve(cc->pending, BT_L2CAP_SDU_CHAN_SEND_RESERVE);
+		}
+
+		n = MIN(len, sdu_size(cc) - cc->pending->len);
+		net_buf_add_mem(cc->pending, data, n);
+		data += n;
+		len -= n;
+
+		if (cc->pending->len >= sdu_size(cc)) {
+			err = flush_locked(cc, true);
+			restarted = true;
+		}
+	}
+
+	/* End of a RadPro response line - don't hold it back */
+	if (!err && cc->pending && cc->pending->len > 0 &&
+	    (CONFIG_RADPRO_NUS_COALESCE_MS == 0 ||
+	     cc->pending->data[cc->pending->len - 1] == '\n')) {
+		err = flush_locked(cc, true);
+	}
+
+	if (err == -EAGAIN) {
+		/* Out of credits: the full SDU is retried, the rest is lost */
+		k_work_reschedule(&cc->flush_work, L2CAP_FLUSH_RETRY_DELAY);
+		if (len > 0) {
+			LOG_WRN("L2CAP TX stalled, dropping %d bytes", len);
+			metrics_add(METRICS_DROP_BLE_TX_BYTES, len);
+		} else {
+			err = 0;
+		}
+	} else if (!err && cc->pending && cc->pending->len > 0 && restarted) {
+		k_work_reschedule(&cc->flush_work, L2CAP_FLUSH_DELAY);
+	}
+
+	k_mutex_unlock(&cc->lock);
+	return err;
+}
@@ -0,0 +1,58 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * L2CAP CoC Transport - Header
+ *
+ * Optional LE credit-based L2CAP channel for bulk RadPro responses. An
+ * encrypted central opens it on CONFIG_RADPRO_L2CAP_PSM; from then on
+ * the replies to its commands are coalesced into SDUs of up to
+ * CONFIG_RADPRO_L2CAP_MTU bytes instead of (MTU - 3) byte NUS
+ * notifications. Commands may be written to either transport.
+ *
+ * Flow control follows the central's credits: at most
+ * CONFIG_RADPRO_L2CAP_TX_WINDOW SDUs are in flight per channel, beyond
+ * that the UART RX thread blocks, so a slow central backpressures the
+ * device instead of losing data.
+ */
+
+#ifndef L2CAP_COC_H
+#define L2CAP_COC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ble_service.h"
+
+/**
+ * @brief Register the L2CAP server
+ *
+ * Called from ble_service_init() next to the NUS registration.
+ *
+ * @param data_cb Callback for data written by the central
+ * @return 0 on success, negative errno on failure
+ */
+int l2cap_coc_init(ble_data_received_cb_t data_cb);
+
+/**
+ * @brief Check if a central has the channel open
+ * @param conn BLE connection, may be NULL
+ * @return true if responses to conn should use l2cap_coc_send()
+ */
+bool l2cap_coc_is_open(struct bt_conn *conn);
+
+/**
+ * @brief Queue data for the channel of a central
+ *
+ * Fills the current SDU and sends it when full, on a line end or after
+ * CONFIG_RADPRO_NUS_COALESCE_MS. Waits up to a second for a free slot in
+ * the channel's TX window; once that timed out, further writes don't
+ * wait until the window drains.
+ *
+ * @param conn Destination connection
+ * @param data Data buffer to send
+ * @param len Length of data
+ * @return 0 on success (data sent or buffered), -ENOTCONN if the channel
+ *         is not open, -EAGAIN if the central ran out of credits and part
+ *         of the data was dropped, other negative errno on failure
+ */
+int l2cap_coc_send(struct bt_conn *conn, const uint8_t *data, uint16_t len);
+
+#endif /* L2CAP_COC_H */
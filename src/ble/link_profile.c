@@ -0,0 +1,283 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * BLE Link Profile Module - Implementation
+ */
+
+#include "link_profile.h"
+#include "ble_service.h"
+
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(link_profile, LOG_LEVEL_INF);
+
+/* Automatic switching: >= BULK_THRESHOLD bytes within one traffic window
+ * selects bulk; no traffic for IDLE_TIMEOUT selects idle */
+#define LINK_TRAFFIC_WINDOW_MS 500
+#define LINK_BULK_THRESHOLD_BYTES 512
+#define LINK_IDLE_TIMEOUT K_SECONDS(5)
+
+struct link_profile_def {
+	const char *name;
+	struct bt_le_conn_param conn_param;
+	/* NULL leaves the current PHY / data length untouched */
+	const struct bt_conn_le_phy_param *phy;
+	const struct bt_conn_le_data_len_param *data_len;
+};
+
+static const struct bt_conn_le_phy_param phy_2m = {
+	.options = BT_CONN_LE_PHY_OPT_NONE,
+	.pref_tx_phy = BT_GAP_LE_PHY_2M,
+	.pref_rx_phy = BT_GAP_LE_PHY_2M,
+};
+
+static const struct bt_conn_le_data_len_param data_len_max = {
+	.tx_max_len = BT_GAP_DATA_LEN_MAX,
+	.tx_max_time = BT_GAP_DATA_TIME_MAX,
+};
+
+/* Intervals in 1.25 ms units, supervision timeout in 10 ms units */
+static const struct link_profile_def profiles[] = {
+	[LINK_PROFILE_IDLE] = {
+		.name = "idle",
+		.conn_param = BT_LE_CONN_PARAM_INIT(80, 100, 4, 600),
+	},
+	[LINK_PROFILE_BULK] = {
+		.name = "bulk",
+		.conn_param = BT_LE_CONN_PARAM_INIT(6, 12, 0, 400),
+		.phy = &phy_2m,
+		.data_len = &data_len_max,
+	},
+};
+
+/* State */
+static atomic_t active_profile = ATOMIC_INIT(LINK_PROFILE_NONE);
+static atomic_t requested_profile = ATOMIC_INIT(LINK_PROFILE_NONE);
+static atomic_t applied;     /* Slots (bt_conn_index) on the active profile */
+static atomic_t link_count;  /* Profiles and timers reset with the last link */
+static struct k_work apply_work;
+static struct k_work_delayable idle_work;
+static int64_t traffic_window_start;
+static size_t traffic_window_bytes;
+
+static void apply_profile(struct bt_conn *conn, const struct link_profile_def *def)
+{
+	int err;
+
+	if (def->phy) {
+		err = bt_conn_le_phy_update(conn, def->phy);
+		if (err && err != -EALREADY) {
+			LOG_WRN("PHY update request failed: %d", err);
+		}
+	}
+
+	if (def->data_len) {
+		err = bt_conn_le_data_len_update(conn, def->data_len);
+		if (err && err != -EALREADY) {
+			LOG_WRN("Data length update request failed: %d", err);
+		}
+	}
+
+	err = bt_conn_le_param_update(conn, &def->conn_param);
+	if (err && err != -EALREADY) {
+		LOG_WRN("Connection parameter update request failed: %d", err);
+	}
+}
+
+static void apply_work_handler(struct k_work *work)
+{
+	int profile = atomic_get(&requested_profile);
+
+	ARG_UNUSED(work);
+
+	if (ble_service_connection_count() == 0 || profile == LINK_PROFILE_NONE) {
+		return;
+	}
+
+	/* The bridge traffic is shared, so all links follow one profile */
+	if (atomic_set(&active_profile, profile) != profile) {
+		LOG_INF("Switching links to %s profile", profiles[profile].name);
+		atomic_clear(&applied);
+	}
+
+	/* Links that joined since the switch get it too */
+	for (uint8_t i = 0; i < BLE_SERVICE_MAX_CONN; i++) {
+		struct bt_conn *conn = ble_service_get_connection(i);
+
+		if (conn && !atomic_test_and_set_bit(&applied, i)) {
+			apply_profile(conn, &profiles[profile]);
+		}
+	}
+}
+
+static void idle_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	link_profile_set(LINK_PROFILE_IDLE);
+}
+
+/* Connection callbacks - report what the central actually granted */
+static void connected(struct bt_conn *conn, uint8_t err)
+{
+	if (err) {
+		return;
+	}
+
+	atomic_clear_bit(&applied, bt_conn_index(conn));
+
+	if (atomic_inc(&link_count) == 0) {
+		atomic_set(&active_profile, LINK_PROFILE_NONE);
+		atomic_set(&requested_profile, LINK_PROFILE_NONE);
+		traffic_window_bytes = 0;
+	} else if (atomic_get(&requested_profile) != LINK_PROFILE_NONE) {
+		/* Join the profile the other links are on */
+		k_work_submit(&apply_work);
+	}
+
+	if (IS_ENABLED(CONFIG_RADPRO_LINK_AUTO_PROFILE)) {
+		/* Quiet link after connecting/pairing drops to idle */
+		k_work_reschedule(&idle_work, LINK_IDLE_TIMEOUT);
+	}
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	atomic_clear_bit(&applied, bt_conn_index(conn));
+
+	/* The remaining links keep their profile and idle fallback */
+	if (atomic_dec(&link_count) != 1) {
+		return;
+	}
+
+	k_work_cancel_delayable(&idle_work);
+	atomic_set(&active_profile, LINK_PROFILE_NONE);
+	atomic_set(&requested_profile, LINK_PROFILE_NONE);
+}
+
+static void le_param_updated(struct bt_conn *conn, uint16_t interval,
+			     uint16_t latency, uint16_t timeout)
+{
+	LOG_INF("Link %s: interval %d.%02d ms, latency %d, timeout %d ms",
+		link_profile_name(atomic_get(&active_profile)),
+		interval * 5 / 4, (interval * 125) % 100, latency, timeout * 10);
+}
+
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+static const char *phy_name(uint8_t phy)
+{
+	switch (phy) {
+	case BT_GAP_LE_PHY_1M:
+		return "1M";
+	case BT_GAP_LE_PHY_2M:
+		return "2M";
+	case BT_GAP_LE_PHY_CODED:
+		return "Coded";
+	default:
+		return "?";
+	}
+}
+
+static void le_phy_updated(struct bt_conn *conn, struct bt_conn_le_phy_info *info)
+{
+	LOG_INF("Link %s: PHY TX %s, RX %s",
+		link_profile_name(atomic_get(&active_profile)),
+		phy_name(info->tx_phy), phy_name(info->rx_phy));
+}
+#endif
+
+#if defined(CONFIG_BT_USER_DATA_LEN_UPDATE)
+static void le_data_len_updated(struct bt_conn *conn, struct bt_conn_le_data_len_info *info)
+{
+	LOG_INF("Link %s: data length TX %d B/%d us, RX %d B/%d us",
+		link_profile_name(atomic_get(&active_profile)),
+		info->tx_max_len, info->tx_max_time,
+		info->rx_max_len, info->rx_max_time);
+}
+#endif
+
+BT_CONN_CB_DEFINE(link_profile_conn_callbacks) = {
+	.connected        = connected,
+	.disconnected     = disconnected,
+	.le_param_updated = le_param_updated,
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+	.le_phy_updated   = le_phy_updated,
+#endif
+#if defined(CONFIG_BT_USER_DATA_LEN_UPDATE)
+	.le_data_len_updated = le_data_len_updated,
+#endif
+};
+
+/* Public API */
+int link_profile_init(void)
+{
+	k_work_init(&apply_work, apply_work_handler);
+	k_work_init_delayable(&idle_work, idle_work_handler);
+
+	LOG_INF("Link profiles initialized (auto switching %s)",
+		IS_ENABLED(CONFIG_RADPRO_LINK_AUTO_PROFILE) ? "on" : "off");
+	return 0;
+}
+
+int link_profile_set(enum link_profile profile)
+{
+	if (profile != LINK_PROFILE_IDLE && profile != LINK_PROFILE_BULK) {
+		return -EINVAL;
+	}
+
+	if (ble_service_connection_count() == 0) {
+		return -ENOTCONN;
+	}
+
+	/* HCI requests are issued from the system workqueue */
+	atomic_set(&requested_profile, profile);
+	k_work_submit(&apply_work);
+	return 0;
+}
+
+enum link_profile link_profile_get(void)
+{
+	return (enum link_profile)atomic_get(&active_profile);
+}
+
+const char *link_profile_name(enum link_profile profile)
+{
+	switch (profile) {
+	case LINK_PROFILE_IDLE:
+	case LINK_PROFILE_BULK:
+		return profiles[profile].name;
+	default:
+		return "default";
+	}
+}
+
+void link_profile_note_traffic(size_t len)
+{
+	int64_t now;
+
+	if (!IS_ENABLED(CONFIG_RADPRO_LINK_AUTO_PROFILE)) {
+		return;
+	}
+
+	/* Any traffic postpones the fall back to idle */
+	k_work_reschedule(&idle_work, LINK_IDLE_TIMEOUT);
+
+	if (atomic_get(&requested_profile) == LINK_PROFILE_BULK) {
+		return;
+	}
+
+	now = k_uptime_get();
+	if (now - traffic_window_start > LINK_TRAFFIC_WINDOW_MS) {
+		traffic_window_start = now;
+		traffic_window_bytes = 0;
+	}
+
+	traffic_window_bytes += len;
+	if (traffic_window_bytes >= LINK_BULK_THRESHOLD_BYTES) {
+		LOG_INF("Sustained traffic (%d bytes in %d ms), requesting bulk profile",
+			(int)traffic_window_bytes, (int)(now - traffic_window_start));
+		link_profile_set(LINK_PROFILE_BULK);
+	}
+}
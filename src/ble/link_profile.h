@@ -0,0 +1,64 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * BLE Link Profile Module - Header
+ *
+ * Named sets of connection parameters for the bridge link: "bulk" for
+ * sustained transfers (2M PHY, 7.5-15 ms interval, maximum data length)
+ * and "idle" for low power (long interval with peripheral latency).
+ */
+
+#ifndef LINK_PROFILE_H
+#define LINK_PROFILE_H
+
+#include <stddef.h>
+
+enum link_profile {
+	LINK_PROFILE_NONE = -1,  /* Parameters chosen by the central */
+	LINK_PROFILE_IDLE,
+	LINK_PROFILE_BULK,
+};
+
+/**
+ * @brief Initialize link profile handling
+ * @return 0 on success, negative errno on failure
+ */
+int link_profile_init(void);
+
+/**
+ * @brief Request a link profile on every connection
+ *
+ * Parameters are negotiated asynchronously; the values the central
+ * accepts are logged when the updates complete.
+ *
+ * @param profile Profile to switch to
+ * @return 0 on success, -ENOTCONN if not connected, -EINVAL for an
+ *         unknown profile
+ */
+int link_profile_set(enum link_profile profile);
+
+/**
+ * @brief Get the most recently requested profile
+ * @return Active profile, LINK_PROFILE_NONE after the first connection
+ *         until a profile is requested
+ */
+enum link_profile link_profile_get(void);
+
+/**
+ * @brief Get printable profile name
+ * @param profile Profile
+ * @return Profile name
+ */
+const char *link_profile_name(enum link_profile profile);
+
+/**
+ * @brief Account bridged UART traffic for automatic profile switching
+ *
+ * Sustained traffic switches the link to the bulk profile; once it stops
+ * the link falls back to idle. No-op when
+ * CONFIG_RADPRO_LINK_AUTO_PROFILE is disabled.
+ *
+ * @param len Number of bytes bridged
+ */
+void link_profile_note_traffic(size_t len);
+
+#endif /* LINK_PROFILE_H */
@@ -0,0 +1,230 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * NUS Packetizer - Implementation
+ */
+
+#include "nus_packetizer.h"
+#include "ble_service.h"
+#include "../metrics/metrics.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(nus_packetizer, LOG_LEVEL_INF);
+
+/* ATT notification header: opcode (1) + attribute handle (2) */
+#define ATT_NTF_HDR_SIZE 3
+
+/* Largest notification payload, matching CONFIG_BT_L2CAP_TX_MTU=247 */
+#define NUS_PKT_MAX_PAYLOAD 244
+
+#define NUS_FLUSH_DELAY K_MSEC(CONFIG_RADPRO_NUS_COALESCE_MS)
+
+/* Retry interval while the BLE TX window is full */
+#define NUS_FLUSH_RETRY_DELAY K_MSEC(5)
+
+/* How long a routed write waits for the destination's TX window */
+#define NUS_TX_TIMEOUT K_SECONDS(1)
+
+/* Coalescing buffer per connection slot, shared by the writing threads
+ * and the slot's flush work */
+struct pkt_ctx {
+	uint8_t buf[NUS_PKT_MAX_PAYLOAD];
+	uint16_t len;
+	bool stalled;  /* A send timed out waiting, don't wait again until it drains */
+	struct k_mutex lock;
+	struct k_work_delayable flush_work;
+};
+
+static struct pkt_ctx ctxs[BLE_SERVICE_MAX_CONN];
+
+static uint16_t chunk_size(struct bt_conn *conn)
+{
+	uint16_t mtu = ble_service_get_mtu(conn);
+
+	if (mtu <= ATT_NTF_HDR_SIZE) {
+		return 1;
+	}
+
+	return MIN(mtu - ATT_NTF_HDR_SIZE, NUS_PKT_MAX_PAYLOAD);
+}
+
+/* Caller must hold ctx->lock */
+static int flush_locked(struct pkt_ctx *ctx, struct bt_conn *conn, bool may_block)
+{
+	/* A central that stopped reading costs one timeout, not one per chunk */
+	k_timeout_t timeout = (may_block && !ctx->stalled) ? NUS_TX_TIMEOUT : K_NO_WAIT;
+	int err;
+
+	if (ctx->len == 0) {
+		return 0;
+	}
+
+	err = ble_service_send(conn, ctx->buf, ctx->len, timeout);
+	if (err == -EAGAIN) {
+		/* TX window full - keep the data for a retry. Only a send that
+		 * waited out NUS_TX_TIMEOUT marks the central as not reading;
+		 * a full window found without waiting is normal streaming */
+		if (!K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+			ctx->stalled = true;
+		}
+		return err;
+	}
+
+	if (err) {
+		LOG_WRN("Dropping %d buffered bytes: %d", ctx->len, err);
+		metrics_add(METRICS_DROP_BLE_TX_BYTES, ctx->len);
+	}
+
+	ctx->stalled = false;
+	ctx->len = 0;
+	return err;
+}
+
+static void flush_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct pkt_ctx *ctx = CONTAINER_OF(dwork, struct pkt_ctx, flush_work);
+	struct bt_conn *conn = ble_service_get_connection(ctx - ctxs);
+	int err;
+
+	/* A writer holding the lock may be waiting for TX credits, which are
+	 * returned on this workqueue - retry later rather than wait for it */
+	if (k_mutex_lock(&ctx->lock, K_NO_WAIT)) {
+		k_work_reschedule(&ctx->flush_work, NUS_FLUSH_RETRY_DELAY);
+		return;
+	}
+
+	/* A gone connection fails the send and drops its leftovers */
+	err = flush_locked(ctx, conn, false);
+	k_mutex_unlock(&ctx->lock);
+
+	if (err == -EAGAIN) {
+		k_work_reschedule(&ctx->flush_work, NUS_FLUSH_RETRY_DELAY);
+	}
+}
+
+static int ctx_write(struct pkt_ctx *ctx, struct bt_conn *conn,
+		     const uint8_t *data, uint16_t len, bool may_block)
+{
+	uint16_t chunk = chunk_size(conn);
+	bool restarted;
+	int err = 0;
+
+	k_mutex_lock(&ctx->lock, K_FOREVER);
+
+	/* MTU may have shrunk (new connection) since data was buffered */
+	if (ctx->len >= chunk) {
+		err = flush_locked(ctx, conn, may_block);
+	}
+
+	/* Set when the buffered data no longer has a pending deadline */
+	restarted = (ctx->len == 0);
+
+	while (len > 0 && !err) {
+		uint16_t n = MIN(len, chunk - ctx->len);
+
+		memcpy(&ctx->buf[ctx->len], data, n);
+		ctx->len += n;
+		data += n;
+		len -= n;
+
+		if (ctx->len == chunk) {
+			err = flush_locked(ctx, conn, may_block);
+			restarted = true;
+		}
+	}
+
+	/* End of a RadPro response line - don't hold it back */
+	if (!err && ctx->len > 0 &&
+	    (CONFIG_RADPRO_NUS_COALESCE_MS == 0 || ctx->buf[ctx->len - 1] == '\n')) {
+		err = flush_locked(ctx, conn, may_block);
+	}
+
+	if (err == -EAGAIN) {
+		/* TX window still full: buffered data is retried, the rest is lost */
+		k_work_reschedule(&ctx->flush_work, NUS_FLUSH_RETRY_DELAY);
+		if (len > 0) {
+			LOG_WRN("BLE TX stalled, dropping %d bytes", len);
+			metrics_add(METRICS_DROP_BLE_TX_BYTES, len);
+		} else {
+			err = 0;
+		}
+	} else if (!err && ctx->len > 0 && restarted) {
+		k_work_reschedule(&ctx->flush_work, NUS_FLUSH_DELAY);
+	}
+
+	k_mutex_unlock(&ctx->lock);
+	return err;
+}
+
+/* Public API */
+int nus_packetizer_init(void)
+{
+	for (int i = 0; i < BLE_SERVICE_MAX_CONN; i++) {
+		ctxs[i].len = 0;
+		ctxs[i].stalled = false;
+		k_mutex_init(&ctxs[i].lock);
+		k_work_init_delayable(&ctxs[i].flush_work, flush_work_handler);
+	}
+
+	LOG_INF("NUS packetizer initialized (coalesce %d ms)",
+		CONFIG_RADPRO_NUS_COALESCE_MS);
+	return 0;
+}
+
+int nus_packetizer_write(struct bt_conn *conn, const uint8_t *data, uint16_t len)
+{
+	if (!ble_service_is_conn_authenticated(conn)) {
+		return -ENOTCONN;
+	}
+
+	return ctx_write(&ctxs[bt_conn_index(conn)], conn, data, len, true);
+}
+
+int nus_packetizer_broadcast(const uint8_t *data, uint16_t len)
+{
+	struct bt_conn *targets[BLE_SERVICE_MAX_CONN];
+	int count = 0;
+	int ret = 0;
+
+	for (uint8_t i = 0; i < BLE_SERVICE_MAX_CONN; i++) {
+		struct bt_conn *conn = ble_service_get_connection(i);
+
+		if (ble_service_is_conn_authenticated(conn)) {
+			targets[count++] = conn;
+		}
+	}
+
+	/* With several subscribers nobody waits for a slow one; a single
+	 * subscriber keeps the blocking backpressure */
+	for (int i = 0; i < count; i++) {
+		int err = ctx_write(&ctxs[bt_conn_index(targets[i])], targets[i],
+				    data, len, count == 1);
+
+		if (err) {
+			ret = err;
+		}
+	}
+
+	return ret;
+}
+
+int nus_packetizer_flush(struct bt_conn *conn)
+{
+	struct pkt_ctx *ctx;
+	int err;
+
+	if (!ble_service_is_conn_authenticated(conn)) {
+		return -ENOTCONN;
+	}
+
+	ctx = &ctxs[bt_conn_index(conn)];
+
+	k_mutex_lock(&ctx->lock, K_FOREVER);
+	err = flush_locked(ctx, conn, true);
+	k_mutex_unlock(&ctx->lock);
+
+	return err;
+}
@@ -0,0 +1,66 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * NUS Packetizer - Header
+ *
+ * Sizes UART→BLE traffic to the negotiated ATT MTU: oversized writes are
+ * split into (MTU - 3) byte notifications and small UART fragments are
+ * coalesced into full notifications, flushed on a full buffer, a line end
+ * or after CONFIG_RADPRO_NUS_COALESCE_MS.
+ *
+ * Every connection has its own buffer and TX window, so a central that
+ * stops reading only holds up its own data.
+ */
+
+#ifndef NUS_PACKETIZER_H
+#define NUS_PACKETIZER_H
+
+#include <stdint.h>
+#include <zephyr/bluetooth/conn.h>
+
+/**
+ * @brief Initialize the packetizer
+ * @return 0 on success, negative errno on failure
+ */
+int nus_packetizer_init(void);
+
+/**
+ * @brief Queue data for transmission to one central
+ *
+ * Full MTU-sized chunks are sent immediately; any remainder is buffered
+ * until the buffer fills, a line end is seen or the flush deadline expires.
+ * Waits up to a second for the connection's TX window; once a send timed
+ * out, further writes to that connection don't wait until it drains.
+ *
+ * @param conn Destination connection
+ * @param data Data buffer to send
+ * @param len Length of data
+ * @return 0 on success (data sent or buffered), -ENOTCONN if conn is not
+ *         authenticated, -EAGAIN if the BLE link stalled and part of the
+ *         data was dropped, other negative errno from the BLE send on
+ *         failure
+ */
+int nus_packetizer_write(struct bt_conn *conn, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Queue data for every authenticated central
+ *
+ * Like nus_packetizer_write(), but with more than one central connected
+ * it never waits: a central whose TX window is full loses data, the
+ * others are unaffected.
+ *
+ * @param data Data buffer to send
+ * @param len Length of data
+ * @return 0 on success or nobody connected, otherwise the last error of
+ *         a connection
+ */
+int nus_packetizer_broadcast(const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Send any data buffered for a central immediately
+ * @param conn Connection
+ * @return 0 on success or nothing buffered, -EAGAIN if the BLE TX window
+ *         is full (data stays buffered), other negative errno on failure
+ */
+int nus_packetizer_flush(struct bt_conn *conn);
+
+#endif /* NUS_PACKETIZER_H */
@@ -0,0 +1,521 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * BLE Radiation Service Module - Implementation
+ */
+
+#include "radiation_service.h"
+#include "../radpro/radpro_engine.h"
+#include "../radpro/radpro_sampler.h"
+#include "../radpro/radpro_history.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(radiation_service, LOG_LEVEL_INF);
+
+#define RAD_POLL_PERIOD K_SECONDS(CONFIG_RADPRO_RAD_POLL_PERIOD_S)
+#define RAD_POLL_TIMEOUT_MS 1000
+
+/* Attribute index of each characteristic value: primary service, then
+ * declaration + value + CCC per characteristic */
+#define RAD_VALUE_ATTR(id) (2 + 3 * (id))
+
+/* History follows the values */
+#define RAD_HISTORY_ATTR RAD_VALUE_ATTR(RADIATION_VALUE_COUNT)
+
+/* Largest history notification: ATT MTU 247 */
+#define RAD_HISTORY_NOTIFY_MAX 244
+
+/* Retry delay when the stack is out of notification buffers */
+#define RAD_HISTORY_RETRY_DELAY K_MSEC(20)
+
+struct rad_value {
+	uint32_t value;
+	uint32_t notified;   /* Last value sent to subscribers */
+	uint32_t threshold;  /* Minimum change worth a notification */
+	uint8_t size;        /* Bytes on the air */
+	bool valid;
+	bool notified_valid;
+	bool subscribed;
+};
+
+/* Values - protected by rad_lock */
+static struct rad_value values[RADIATION_VALUE_COUNT] = {
+	[RADIATION_CPM] = {
+		.threshold = CONFIG_RADPRO_RAD_CPM_THRESHOLD,
+		.size = sizeof(uint32_t),
+	},
+	[RADIATION_PULSES] = {
+		.threshold = CONFIG_RADPRO_RAD_PULSES_THRESHOLD,
+		.size = sizeof(uint32_t),
+	},
+	[RADIATION_BATTERY] = {
+		.threshold = CONFIG_RADPRO_RAD_BATTERY_THRESHOLD_MV,
+		.size = sizeof(uint16_t),
+	},
+	[RADIATION_TIME] = {
+		.threshold = CONFIG_RADPRO_RAD_TIME_THRESHOLD_S,
+		.size = sizeof(uint32_t),
+	},
+};
+static K_MUTEX_DEFINE(rad_lock);
+
+/* Device polling - the engine answers one command at a time, so a single
+ * response buffer serves both requests */
+static const char *const poll_cmds[RADIATION_VALUE_COUNT] = {
+	[RADIATION_BATTERY] = "GET deviceBatteryVoltage",
+	[RADIATION_TIME] = "GET deviceTime",
+};
+static char resp_buf[32];
+static size_t resp_len;
+static atomic_t poll_pending;  /* Bit per value with a request queued */
+static struct k_work_delayable poll_work;
+
+#if defined(CONFIG_RADPRO_HISTORY)
+/* History burst in progress for a connection, indexed by bt_conn_index().
+ * Started from the BT RX thread, sent from the system workqueue -
+ * protected by rad_lock */
+struct history_burst {
+	struct bt_conn *conn;  /* NULL when idle */
+	uint8_t gen;           /* Bumped by every (re)subscription */
+	uint8_t tier;
+	uint32_t seq;
+};
+
+static struct history_burst bursts[CONFIG_BT_MAX_CONN];
+static struct k_work_delayable history_work;
+#endif
+
+static void encode(const struct rad_value *v, uint32_t value, uint8_t *buf)
+{
+	if (v->size == sizeof(uint16_t)) {
+		sys_put_le16(MIN(value, UINT16_MAX), buf);
+	} else {
+		sys_put_le32(value, buf);
+	}
+}
+
+/* GATT callbacks */
+static ssize_t read_value(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			  void *buf, uint16_t len, uint16_t offset)
+{
+	enum radiation_value id = POINTER_TO_INT(attr->user_data);
+	struct rad_value *v = &values[id];
+	uint8_t data[sizeof(uint32_t)];
+	uint16_t size = 0;
+
+	k_mutex_lock(&rad_lock, K_FOREVER);
+	if (v->valid) {
+		encode(v, v->value, data);
+		size = v->size;
+	}
+	k_mutex_unlock(&rad_lock);
+
+	/* Empty until the first measurement arrives */
+	return bt_gatt_attr_read(conn, attr, buf, len, offset, data, size);
+}
+
+static void ccc_changed(enum radiation_value id, uint16_t value)
+{
+	k_mutex_lock(&rad_lock, K_FOREVER);
+	values[id].subscribed = (value == BT_GATT_CCC_NOTIFY);
+	/* New subscriber gets the current value on the next update */
+	values[id].notified_valid = false;
+	k_mutex_unlock(&rad_lock);
+}
+
+static void cpm_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+	ccc_changed(RADIATION_CPM, value);
+}
+
+static void pulses_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+	ccc_changed(RADIATION_PULSES, value);
+}
+
+static void battery_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+	ccc_changed(RADIATION_BATTERY, value);
+}
+
+static void time_ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+	ccc_changed(RADIATION_TIME, value);
+}
+
+#if defined(CONFIG_RADPRO_HISTORY)
+/* Start the burst for a connection over, or stop it */
+static void history_subscribe(struct bt_conn *conn, bool on)
+{
+	struct history_burst *burst = &bursts[bt_conn_index(conn)];
+	struct bt_conn *old;
+
+	k_mutex_lock(&rad_lock, K_FOREVER);
+	old = burst->conn;
+	burst->conn = on ? bt_conn_ref(conn) : NULL;
+	burst->gen++;
+	burst->tier = 0;
+	burst->seq = 0;
+	k_mutex_unlock(&rad_lock);
+
+	if (old) {
+		bt_conn_unref(old);
+	}
+
+	if (on) {
+		/* Sent from the workqueue, after the stack has stored the CCC */
+		k_work_reschedule(&history_work, K_NO_WAIT);
+	}
+}
+
+/* History is sent per connection, so the CCC write tells which one */
+static ssize_t history_ccc_write(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+				 uint16_t value)
+{
+	history_subscribe(conn, value & BT_GATT_CCC_NOTIFY);
+	return sizeof(value);
+}
+
+#define RAD_HISTORY_CHARACTERISTIC \
+	BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(RADIATION_HISTORY_UUID_VAL), \
+			       BT_GATT_CHRC_NOTIFY, BT_GATT_PERM_NONE, NULL, NULL, NULL), \
+	BT_GATT_CCC_WITH_WRITE_CB(NULL, history_ccc_write, \
+				  BT_GATT_PERM_READ | BT_GATT_PERM_WRITE_ENCRYPT),
+#else
+#define RAD_HISTORY_CHARACTERISTIC
+#endif
+
+#define RAD_CHARACTERISTIC(uuid_val, id, ccc_cb) \
+	BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(uuid_val), \
+			       BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY, \
+			       BT_GATT_PERM_READ_ENCRYPT, read_value, NULL, \
+			       INT_TO_POINTER(id)), \
+	BT_GATT_CCC(ccc_cb, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE_ENCRYPT)
+
+BT_GATT_SERVICE_DEFINE(rad_svc,
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_DECLARE_128(RADIATION_SVC_UUID_VAL)),
+	RAD_CHARACTERISTIC(RADIATION_CPM_UUID_VAL, RADIATION_CPM, cpm_ccc_changed),
+	RAD_CHARACTERISTIC(RADIATION_PULSES_UUID_VAL, RADIATION_PULSES, pulses_ccc_changed),
+	RAD_CHARACTERISTIC(RADIATION_BATTERY_UUID_VAL, RADIATION_BATTERY, battery_ccc_changed),
+	RAD_CHARACTERISTIC(RADIATION_TIME_UUID_VAL, RADIATION_TIME, time_ccc_changed),
+	RAD_HISTORY_CHARACTERISTIC
+);
+
+/* Sampler listener */
+static void on_sample(const struct radpro_sample *sample)
+{
+	radiation_service_update(RADIATION_CPM, sample->cpm_short_x100);
+	radiation_service_update(RADIATION_PULSES, sample->raw_count);
+}
+
+/* Parse a decimal such as "3.952" into thousandths */
+static int parse_milli(const char *str, uint32_t *out)
+{
+	char *end;
+	uint32_t value = strtoul(str, &end, 10) * 1000;
+	uint32_t scale = 100;
+
+	if (end == str) {
+		return -EINVAL;
+	}
+
+	if (*end == '.') {
+		for (end++; *end >= '0' && *end <= '9'; end++) {
+			value += (*end - '0') * scale;
+			scale /= 10;
+		}
+	}
+
+	*out = value;
+	return 0;
+}
+
+static void poll_data(const uint8_t *data, size_t len, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	len = MIN(len, sizeof(resp_buf) - 1 - resp_len);
+	memcpy(&resp_buf[resp_len], data, len);
+	resp_len += len;
+}
+
+static void poll_done(int status, void *user_data)
+{
+	enum radiation_value id = POINTER_TO_INT(user_data);
+	uint32_t value;
+	char *end;
+	int err;
+
+	resp_buf[resp_len] = '\0';
+	resp_len = 0;
+	atomic_clear_bit(&poll_pending, id);
+
+	if (status) {
+		LOG_DBG("%s failed: %d", poll_cmds[id], status);
+		return;
+	}
+
+	if (id == RADIATION_BATTERY) {
+		err = parse_milli(&resp_buf[3], &value);
+	} else {
+		value = strtoul(&resp_buf[3], &end, 10);
+		err = (end == &resp_buf[3]) ? -EINVAL : 0;
+	}
+
+	if (err) {
+		LOG_WRN("Unexpected response to %s", poll_cmds[id]);
+		return;
+	}
+
+	radiation_service_update(id, value);
+}
+
+static void poll_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	for (int id = 0; id < RADIATION_VALUE_COUNT; id++) {
+		int err;
+
+		if (!poll_cmds[id] || atomic_test_and_set_bit(&poll_pending, id)) {
+			continue;
+		}
+
+		err = radpro_engine_submit(poll_cmds[id], strlen(poll_cmds[id]),
+					   RAD_POLL_TIMEOUT_MS, poll_data, poll_done,
+					   INT_TO_POINTER(id));
+		if (err) {
+			LOG_WRN("Failed to queue %s: %d", poll_cmds[id], err);
+			atomic_clear_bit(&poll_pending, id);
+		}
+	}
+
+	k_work_reschedule(&poll_work, RAD_POLL_PERIOD);
+}
+
+#if defined(CONFIG_RADPRO_HISTORY)
+static void encode_point(uint8_t *buf, uint8_t tier, const struct radpro_history_point *point,
+			 uint32_t now_s)
+{
+	uint32_t period = radpro_history_period_s(tier);
+	uint32_t age = now_s / period - point->start_s / period;
+
+	buf[0] = tier;
+	sys_put_le16(MIN(age, UINT16_MAX), &buf[1]);
+	sys_put_le32(point->raw_count, &buf[3]);
+	sys_put_le32(point->cpm_min_x100, &buf[7]);
+	sys_put_le32(point->cpm_avg_x100, &buf[11]);
+	sys_put_le32(point->cpm_max_x100, &buf[15]);
+}
+
+/* Send notifications until the burst is done or the stack is out of
+ * buffers. Returns 0 when done, negative errno on failure. */
+static int send_history(struct bt_conn *conn, uint8_t *tier, uint32_t *seq)
+{
+	const struct bt_gatt_attr *attr = &rad_svc.attrs[RAD_HISTORY_ATTR];
+	uint16_t max = MIN(bt_gatt_get_mtu(conn) - 3, RAD_HISTORY_NOTIFY_MAX);
+	uint8_t buf[RAD_HISTORY_NOTIFY_MAX];
+
+	while (true) {
+		uint32_t now_s = (uint32_t)(k_uptime_get() / 1000);
+		struct radpro_history_point point;
+		uint8_t next_tier = *tier;
+		uint32_t next_seq = *seq;
+		uint16_t len = 0;
+		bool end = false;
+		int err;
+
+		while (len + RADIATION_HISTORY_POINT_SIZE <= max &&
+		       next_tier < RADPRO_HISTORY_TIERS) {
+			if (radpro_history_read(next_tier, &next_seq, &point)) {
+				next_tier++;
+				next_seq = 0;
+				continue;
+			}
+			encode_point(&buf[len], next_tier, &point, now_s);
+			len += RADIATION_HISTORY_POINT_SIZE;
+		}
+
+		if (len == 0) {
+			buf[len++] = RADIATION_HISTORY_END;
+			end = true;
+		}
+
+		err = bt_gatt_notify(conn, attr, buf, len);
+		if (err) {
+			return err;
+		}
+
+		*tier = next_tier;
+		*seq = next_seq;
+		if (end) {
+			return 0;
+		}
+	}
+}
+
+static void history_work_handler(struct k_work *work)
+{
+	bool retry = false;
+
+	ARG_UNUSED(work);
+
+	for (int i = 0; i < ARRAY_SIZE(bursts); i++) {
+		struct history_burst *burst = &bursts[i];
+		struct bt_conn *conn = NULL;
+		struct bt_conn *done = NULL;
+		uint8_t gen = 0;
+		uint8_t tier = 0;
+		uint32_t seq = 0;
+		int err;
+
+		k_mutex_lock(&rad_lock, K_FOREVER);
+		if (burst->conn) {
+			conn = bt_conn_ref(burst->conn);
+			gen = burst->gen;
+			tier = burst->tier;
+			seq = burst->seq;
+		}
+		k_mutex_unlock(&rad_lock);
+
+		if (!conn) {
+			continue;
+		}
+
+		err = send_history(conn, &tier, &seq);
+		if (err == -ENOMEM) {
+			retry = true;
+		} else if (err) {
+			LOG_DBG("History burst stopped: %d", err);
+		}
+
+		k_mutex_lock(&rad_lock, K_FOREVER);
+		if (burst->gen == gen) {
+			burst->tier = tier;
+			burst->seq = seq;
+			if (err != -ENOMEM) {
+				done = burst->conn;
+				burst->conn = NULL;
+			}
+		}
+		k_mutex_unlock(&rad_lock);
+
+		if (done) {
+			bt_conn_unref(done);
+		}
+		bt_conn_unref(conn);
+	}
+
+	if (retry) {
+		k_work_reschedule(&history_work, RAD_HISTORY_RETRY_DELAY);
+	}
+}
+
+/* A bonded central's subscription is restored on encryption without a
+ * CCC write, so a reconnect gets its burst here */
+static void security_changed(struct bt_conn *conn, bt_security_t level,
+			     enum bt_security_err err)
+{
+	bool active;
+
+	if (err || level < BT_SECURITY_L2 ||
+	    !bt_gatt_is_subscribed(conn, &rad_svc.attrs[RAD_HISTORY_ATTR], BT_GATT_CCC_NOTIFY)) {
+		return;
+	}
+
+	/* A level change while the link's burst runs does not restart it */
+	k_mutex_lock(&rad_lock, K_FOREVER);
+	active = bursts[bt_conn_index(conn)].conn == conn;
+	k_mutex_unlock(&rad_lock);
+
+	if (!active) {
+		history_subscribe(conn, true);
+	}
+}
+
+BT_CONN_CB_DEFINE(rad_conn_callbacks) = {
+	.security_changed = security_changed,
+};
+#endif /* CONFIG_RADPRO_HISTORY */
+
+/* Public API */
+int radiation_service_init(void)
+{
+	int err;
+
+	k_work_init_delayable(&poll_work, poll_work_handler);
+#if defined(CONFIG_RADPRO_HISTORY)
+	k_work_init_delayable(&history_work, history_work_handler);
+#endif
+
+	err = radpro_sampler_add_listener(on_sample);
+	if (err) {
+		LOG_ERR("Failed to subscribe to sampler: %d", err);
+		return err;
+	}
+
+	LOG_INF("Radiation service initialized");
+	return 0;
+}
+
+int radiation_service_start(void)
+{
+	k_work_reschedule(&poll_work, K_NO_WAIT);
+	return 0;
+}
+
+void radiation_service_update(enum radiation_value id, uint32_t value)
+{
+	struct rad_value *v = &values[id];
+	uint8_t data[sizeof(uint32_t)];
+	bool notify;
+	uint32_t change;
+	int err;
+
+	k_mutex_lock(&rad_lock, K_FOREVER);
+
+	v->value = value;
+	v->valid = true;
+
+	change = (value > v->notified) ? value - v->notified : v->notified - value;
+	notify = v->subscribed &&
+		 (!v->notified_valid || (change > 0 && change >= v->threshold));
+	if (notify) {
+		v->notified = value;
+		v->notified_valid = true;
+		encode(v, value, data);
+	}
+
+	k_mutex_unlock(&rad_lock);
+
+	if (!notify) {
+		return;
+	}
+
+	/* NULL connection: every subscribed central */
+	err = bt_gatt_notify(NULL, &rad_svc.attrs[RAD_VALUE_ATTR(id)], data, v->size);
+	if (err && err != -ENOTCONN) {
+		LOG_DBG("Notification %d failed: %d", id, err);
+	}
+}
+
+int radiation_service_get(enum radiation_value id, uint32_t *value)
+{
+	int ret = -ENODATA;
+
+	k_mutex_lock(&rad_lock, K_FOREVER);
+	if (values[id].valid) {
+		*value = values[id].value;
+		ret = 0;
+	}
+	k_mutex_unlock(&rad_lock);
+
+	return ret;
+}
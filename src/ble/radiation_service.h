@@ -0,0 +1,85 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * BLE Radiation Service Module - Header
+ *
+ * Custom GATT service exposing the latest measurements as compact
+ * little-endian fixed-point characteristics, readable and notifiable.
+ * Notifications are only sent when a value moves by at least its
+ * configured threshold.
+ *
+ * Service  52504c4b-0001-4a8b-9c2e-6f5d3a1b0c00
+ *   CPM             ...-0002-...  uint32  counts per minute x 100 (10 s window)
+ *   Pulse count     ...-0003-...  uint32  tubePulseCount
+ *   Battery voltage ...-0004-...  uint16  millivolts
+ *   Device time     ...-0005-...  uint32  Unix time (s)
+ *   History         ...-0006-...  notify only (CONFIG_RADPRO_HISTORY)
+ *
+ * Subscribing to History, or reconnecting encrypted with the subscription
+ * kept in the bond, sends that central the sample history
+ * (radpro_history.h) as a burst of notifications, each packing as many
+ * 19-byte points as the ATT MTU allows, oldest first, finest tier first:
+ *   uint8   tier (0: 1 s, 1: 1 min, 2: 10 min intervals)
+ *   uint16  age: intervals before the current one (saturating)
+ *   uint32  tubePulseCount at the end of the interval
+ *   uint32  CPM x 100 minimum, average and maximum over the interval
+ * A notification holding the single byte 0xff ends the burst.
+ */
+
+#ifndef RADIATION_SERVICE_H
+#define RADIATION_SERVICE_H
+
+#include <stdint.h>
+
+#define RADIATION_UUID_ENCODE(id) \
+	BT_UUID_128_ENCODE(0x52504c4b, (id), 0x4a8b, 0x9c2e, 0x6f5d3a1b0c00)
+
+#define RADIATION_SVC_UUID_VAL     RADIATION_UUID_ENCODE(0x0001)
+#define RADIATION_CPM_UUID_VAL     RADIATION_UUID_ENCODE(0x0002)
+#define RADIATION_PULSES_UUID_VAL  RADIATION_UUID_ENCODE(0x0003)
+#define RADIATION_BATTERY_UUID_VAL RADIATION_UUID_ENCODE(0x0004)
+#define RADIATION_TIME_UUID_VAL    RADIATION_UUID_ENCODE(0x0005)
+#define RADIATION_HISTORY_UUID_VAL RADIATION_UUID_ENCODE(0x0006)
+
+/* History notification layout */
+#define RADIATION_HISTORY_POINT_SIZE 19
+#define RADIATION_HISTORY_END 0xff
+
+enum radiation_value {
+	RADIATION_CPM,
+	RADIATION_PULSES,
+	RADIATION_BATTERY,
+	RADIATION_TIME,
+	RADIATION_VALUE_COUNT,
+};
+
+/**
+ * @brief Initialize the radiation service
+ *
+ * Subscribes to the pulse sampler for CPM and pulse count.
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int radiation_service_init(void);
+
+/**
+ * @brief Start polling battery voltage and device time from the device
+ * @return 0 on success, negative errno on failure
+ */
+int radiation_service_start(void);
+
+/**
+ * @brief Update a value, notifying subscribers if it moved past its threshold
+ * @param id Value to update
+ * @param value New value in the characteristic's unit
+ */
+void radiation_service_update(enum radiation_value id, uint32_t value);
+
+/**
+ * @brief Get the current value
+ * @param id Value to read
+ * @param value Receives the value
+ * @return 0 on success, -ENODATA if the value is not known yet
+ */
+int radiation_service_get(enum radiation_value id, uint32_t *value);
+
+#endif /* RADIATION_SERVICE_H */
@@ -0,0 +1,181 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Periodic Advertising Telemetry Module - Implementation
+ */
+
+#include "telemetry_adv.h"
+#include "ble_service.h"
+#include "radiation_service.h"
+#include "../radpro/radpro_sampler.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(telemetry_adv, LOG_LEVEL_INF);
+
+#define DEVICE_NAME CONFIG_BT_DEVICE_NAME
+#define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
+
+/* Periodic interval in 1.25 ms units */
+#define PER_ADV_INTERVAL (CONFIG_RADPRO_PER_ADV_INTERVAL_MS * 4 / 5)
+
+#define UUID_LEN 16
+
+static struct bt_le_ext_adv *adv_set;
+static struct k_work update_work;
+
+/* Frame: UUID, then the telemetry fields. Patched by the sampler
+ * listener, copied out by update_work - protected by frame_lock */
+static uint8_t frame[UUID_LEN + TELEMETRY_FRAME_LEN] = {
+	RADIATION_SVC_UUID_VAL,
+	[UUID_LEN] = TELEMETRY_VERSION,
+	[UUID_LEN + 3] = TELEMETRY_HISTORY - 1,
+};
+static K_MUTEX_DEFINE(frame_lock);
+
+/* Dose accumulator - pulses are summed from the deltas, as the
+ * sampler's pulse_count restarts at 0 when the device's counter resets */
+static uint32_t dose_pulses;
+static int64_t first_uptime_ms;
+static bool have_first;
+
+static const struct bt_data ext_ad[] = {
+	BT_DATA(BT_DATA_NAME_COMPLETE, DEVICE_NAME, DEVICE_NAME_LEN),
+};
+
+static uint8_t *field(size_t offset)
+{
+	return &frame[UUID_LEN + offset];
+}
+
+static void update_status(void)
+{
+	uint8_t status = 0;
+	uint32_t value;
+
+	if (ble_service_connection_count() > 0) {
+		status |= TELEMETRY_STATUS_CONNECTED;
+	}
+
+	/* Polled by the radiation service; unknown without it */
+	if (IS_ENABLED(CONFIG_RADPRO_RADIATION_SERVICE)) {
+		if (radiation_service_get(RADIATION_BATTERY, &value) == 0) {
+			sys_put_le16(MIN(value, UINT16_MAX), field(20));
+			status |= TELEMETRY_STATUS_BATTERY;
+		}
+		if (radiation_service_get(RADIATION_TIME, &value) == 0) {
+			sys_put_le32(value, field(22));
+			status |= TELEMETRY_STATUS_TIME;
+		}
+	}
+
+	*field(2) = status;
+}
+
+static void on_sample(const struct radpro_sample *sample)
+{
+	uint8_t head;
+
+	k_mutex_lock(&frame_lock, K_FOREVER);
+
+	if (!have_first) {
+		dose_pulses = 0;
+		first_uptime_ms = sample->uptime_ms;
+		have_first = true;
+	}
+	dose_pulses += sample->delta;
+
+	(*field(1))++;
+	update_status();
+
+	sys_put_le32(sample->cpm_short_x100, field(4));
+	sys_put_le32(sample->cpm_long_x100, field(8));
+	sys_put_le32(dose_pulses, field(12));
+	sys_put_le32((sample->uptime_ms - first_uptime_ms) / MSEC_PER_SEC, field(16));
+
+	/* Only the newest history slot changes */
+	head = (*field(3) + 1) % TELEMETRY_HISTORY;
+	sys_put_le16(MIN(sample->cpm_short_x100 / 100, UINT16_MAX),
+		     field(TELEMETRY_HEADER_LEN + 2 * head));
+	*field(3) = head;
+
+	k_mutex_unlock(&frame_lock);
+
+	k_work_submit(&update_work);
+}
+
+static void update_work_handler(struct k_work *work)
+{
+	uint8_t data[sizeof(frame)];
+	struct bt_data ad = BT_DATA(BT_DATA_SVC_DATA128, data, sizeof(data));
+	int err;
+
+	ARG_UNUSED(work);
+
+	k_mutex_lock(&frame_lock, K_FOREVER);
+	memcpy(data, frame, sizeof(frame));
+	k_mutex_unlock(&frame_lock);
+
+	err = bt_le_per_adv_set_data(adv_set, &ad, 1);
+	if (err) {
+		LOG_WRN("Periodic advertising data update failed (err %d)", err);
+	}
+}
+
+int telemetry_adv_init(void)
+{
+	const struct bt_le_per_adv_param per_param = {
+		.interval_min = PER_ADV_INTERVAL,
+		.interval_max = PER_ADV_INTERVAL,
+		.options = BT_LE_PER_ADV_OPT_NONE,
+	};
+	int err;
+
+	k_work_init(&update_work, update_work_handler);
+
+	err = bt_le_ext_adv_create(BT_LE_EXT_ADV_NCONN, NULL, &adv_set);
+	if (err) {
+		LOG_ERR("Failed to create advertising set: %d", err);
+		return err;
+	}
+
+	err = bt_le_ext_adv_set_data(adv_set, ext_ad, ARRAY_SIZE(ext_ad), NULL, 0);
+	if (err) {
+		LOG_ERR("Failed to set extended advertising data: %d", err);
+		return err;
+	}
+
+	err = bt_le_per_adv_set_param(adv_set, &per_param);
+	if (err) {
+		LOG_ERR("Failed to set periodic advertising parameters: %d", err);
+		return err;
+	}
+
+	/* Initial frame, empty until the first sample */
+	update_work_handler(&update_work);
+
+	err = bt_le_per_adv_start(adv_set);
+	if (err) {
+		LOG_ERR("Failed to start periodic advertising: %d", err);
+		return err;
+	}
+
+	err = bt_le_ext_adv_start(adv_set, BT_LE_EXT_ADV_START_DEFAULT);
+	if (err) {
+		LOG_ERR("Failed to start extended advertising: %d", err);
+		return err;
+	}
+
+	err = radpro_sampler_add_listener(on_sample);
+	if (err) {
+		LOG_ERR("Failed to subscribe to sampler: %d", err);
+		return err;
+	}
+
+	LOG_INF("Periodic telemetry started (%d ms)", CONFIG_RADPRO_PER_ADV_INTERVAL_MS);
+	return 0;
+}
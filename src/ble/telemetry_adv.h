@@ -0,0 +1,53 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Periodic Advertising Telemetry Module - Header
+ *
+ * Runs a non-connectable extended advertising set next to the
+ * connectable NUS advertising and attaches a periodic advertising train
+ * to it. The train carries one telemetry frame as service data for the
+ * radiation service UUID; stations that sync to it receive every update
+ * without connecting. The frame is patched in place on each sample.
+ *
+ * Frame layout after the UUID, little-endian:
+ *
+ *   0  uint8   frame version (TELEMETRY_VERSION)
+ *   1  uint8   sequence number, incremented per update
+ *   2  uint8   status flags (TELEMETRY_STATUS_*)
+ *   3  uint8   index of the newest history entry
+ *   4  uint32  counts per minute x 100, short window
+ *   8  uint32  counts per minute x 100, long window
+ *  12  uint32  dose accumulator: pulses since sampling started
+ *  16  uint32  dose accumulator: seconds since sampling started
+ *  20  uint16  battery voltage in mV, 0 if unknown
+ *  22  uint32  device Unix time, 0 if unknown
+ *  26  uint16  CPM history ring, TELEMETRY_HISTORY entries, one per
+ *              sample, saturating
+ */
+
+#ifndef TELEMETRY_ADV_H
+#define TELEMETRY_ADV_H
+
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_HISTORY 16
+
+#define TELEMETRY_HEADER_LEN 26
+#define TELEMETRY_FRAME_LEN (TELEMETRY_HEADER_LEN + 2 * TELEMETRY_HISTORY)
+
+/* Status flags */
+#define TELEMETRY_STATUS_CONNECTED BIT(0)  /* A central holds the link */
+#define TELEMETRY_STATUS_BATTERY   BIT(1)  /* Battery voltage is valid */
+#define TELEMETRY_STATUS_TIME      BIT(2)  /* Device time is valid */
+
+/**
+ * @brief Create the advertising set and start the periodic train
+ *
+ * Must be called after bt_enable(). Subscribes to the pulse sampler.
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int telemetry_adv_init(void);
+
+#endif /* TELEMETRY_ADV_H */
@@ -4,9 +4,11 @@
  */
 
 #include "led_status.h"
+#include "../status/app_status.h"
 
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_REGISTER(led_status, LOG_LEVEL_INF);
@@ -14,14 +16,56 @@ LOG_MODULE_REGISTER(led_status, LOG_LEVEL_INF);
 /* User LED GPIO definition - from device tree */
 static const struct gpio_dt_spec user_led = GPIO_DT_SPEC_GET(DT_ALIAS(led0), gpios);
 
-#define FAST_BLINK_INTERVAL_MS   250
-#define MEDIUM_BLINK_INTERVAL_MS 500
-#define SLOW_BLINK_INTERVAL_MS   1000
+/* One LED level held for a time */
+struct led_step {
+	bool on;
+	uint16_t ms;
+};
 
-/* State */
-static bool is_connected = false;
-static bool pairing_window_active = true;
-static bool error_mode = false;
+/* A pattern plays its steps in order, then repeats or ends */
+struct led_pattern {
+	const struct led_step *steps;
+	uint8_t count;
+	bool repeat;
+};
+
+#define LED_BLINK(ms) { { true, (ms) }, { false, (ms) } }
+
+static const struct led_step error_steps[] = LED_BLINK(100);
+static const struct led_step pairing_steps[] = LED_BLINK(250);
+static const struct led_step connected_steps[] = LED_BLINK(500);
+static const struct led_step activity_steps[] = {
+	{ true, 20 },
+	{ false, 80 },  /* Spaces out flashes under continuous traffic */
+};
+
+/* Indexed by enum led_pattern_id */
+static const struct led_pattern patterns[LED_PATTERN_COUNT] = {
+	[LED_PATTERN_ACTIVITY] = { activity_steps, ARRAY_SIZE(activity_steps), false },
+	[LED_PATTERN_CONNECTED] = { connected_steps, ARRAY_SIZE(connected_steps), true },
+	[LED_PATTERN_PAIRING] = { pairing_steps, ARRAY_SIZE(pairing_steps), true },
+	[LED_PATTERN_ERROR] = { error_steps, ARRAY_SIZE(error_steps), true },
+};
+
+#define LED_PATTERN_NONE LED_PATTERN_COUNT
+
+/* Link state, one bit each - set from any thread, turned into patterns
+ * by link_work so concurrent updates cannot apply a stale combination */
+#define LINK_CONNECTED 0
+#define LINK_PAIRING 1
+
+static atomic_t link_state = ATOMIC_INIT(BIT(LINK_PAIRING));
+static struct k_work link_work;
+static bool led_ready;
+
+/* Requested patterns, one bit each - set from any thread */
+static atomic_t requested;
+
+/* Pattern and step on the LED - system workqueue only, except that
+ * request() reads playing to decide whether to wake it */
+static atomic_t playing = ATOMIC_INIT(LED_PATTERN_NONE);
+static uint8_t step;
+static struct k_work_delayable led_work;
 
 /**
  * @brief Set LED state using device tree-aware API
@@ -32,6 +76,129 @@ static inline void led_set(bool state)
 	gpio_pin_set_dt(&user_led, state ? 1 : 0);
 }
 
+/* Highest-priority requested pattern */
+static int top_pattern(void)
+{
+	atomic_val_t bits = atomic_get(&requested);
+
+	for (int id = LED_PATTERN_COUNT - 1; id >= 0; id--) {
+		if (bits & BIT(id)) {
+			return id;
+		}
+	}
+
+	return LED_PATTERN_NONE;
+}
+
+static void play_step(int id)
+{
+	const struct led_step *s = &patterns[id].steps[step];
+
+	led_set(s->on);
+	k_work_reschedule(&led_work, K_MSEC(s->ms));
+}
+
+static void led_work_handler(struct k_work *work)
+{
+	int top = top_pattern();
+	int id = atomic_get(&playing);
+
+	if (top != id) {
+		/* Pattern stack changed: start the new top from its first step */
+		atomic_set(&playing, top);
+		step = 0;
+		if (top == LED_PATTERN_NONE) {
+			/* Nothing to show: LED off, no more wakeups */
+			led_set(false);
+			return;
+		}
+		play_step(top);
+		return;
+	}
+
+	if (id == LED_PATTERN_NONE) {
+		return;
+	}
+
+	if (++step < patterns[id].count) {
+		play_step(id);
+		return;
+	}
+
+	step = 0;
+	if (patterns[id].repeat) {
+		play_step(id);
+		return;
+	}
+
+	/* One-shot pattern done: fall back to whatever is below it */
+	atomic_clear_bit(&requested, id);
+	atomic_set(&playing, LED_PATTERN_NONE);
+	k_work_reschedule(&led_work, K_NO_WAIT);
+}
+
+/* Request or withdraw a pattern; wake the engine if the top changes */
+static void request(enum led_pattern_id id, bool on)
+{
+	if (on) {
+		atomic_set_bit(&requested, id);
+	} else {
+		atomic_clear_bit(&requested, id);
+	}
+
+	if (led_ready && top_pattern() != atomic_get(&playing)) {
+		k_work_reschedule(&led_work, K_NO_WAIT);
+	}
+}
+
+/* Pairing window and link state select one of the two blink patterns */
+static void update_link_patterns(void)
+{
+	atomic_val_t state = atomic_get(&link_state);
+	bool pairing = state & BIT(LINK_PAIRING);
+	bool connected = state & BIT(LINK_CONNECTED);
+
+	request(LED_PATTERN_PAIRING, pairing && !connected);
+	request(LED_PATTERN_CONNECTED, pairing && connected);
+}
+
+static void link_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	update_link_patterns();
+}
+
+static void set_link(int bit, bool on)
+{
+	if (on) {
+		atomic_set_bit(&link_state, bit);
+	} else {
+		atomic_clear_bit(&link_state, bit);
+	}
+
+	/* Until init, the state is picked up there */
+	if (led_ready) {
+		k_work_submit(&link_work);
+	}
+}
+
+/* Follows the pairing window and link state as they are published */
+static void status_changed(uint32_t status, uint32_t changed)
+{
+	if (changed & APP_STATUS_BIT(APP_STATUS_PAIRING_WINDOW)) {
+		led_status_set_pairing_window(status & APP_STATUS_BIT(APP_STATUS_PAIRING_WINDOW));
+	}
+
+	if (changed & APP_STATUS_BIT(APP_STATUS_AUTHENTICATED)) {
+		led_status_set_connected(status & APP_STATUS_BIT(APP_STATUS_AUTHENTICATED));
+	}
+
+	if (changed & status & APP_STATUS_BIT(APP_STATUS_ERROR)) {
+		led_status_error();
+	}
+}
+
 /* Public API */
 int led_status_init(void)
 {
@@ -39,6 +206,9 @@ int led_status_init(void)
 
 	LOG_INF("Initializing LED status module");
 
+	k_work_init_delayable(&led_work, led_work_handler);
+	k_work_init(&link_work, link_work_handler);
+
 	/* Verify LED GPIO is ready */
 	if (!gpio_is_ready_dt(&user_led)) {
 		LOG_ERR("User LED GPIO not ready");
@@ -52,76 +222,48 @@ int led_status_init(void)
 		return err;
 	}
 
-	/* Turn on LED and leave it on to test hardware */
-	led_set(true);
-	LOG_INF("User LED initialized (P2.0) - LED should be ON now");
+	led_ready = true;
+
+	/* Play whatever was requested before the LED was ready; nothing is
+	 * subscribed to the status yet, so link_work cannot run alongside */
+	update_link_patterns();
+	k_work_reschedule(&led_work, K_NO_WAIT);
+
+	err = app_status_subscribe(status_changed);
+	if (err) {
+		LOG_ERR("Failed to subscribe to status: %d", err);
+		return err;
+	}
+
+	LOG_INF("User LED initialized");
 	return 0;
 }
 
 void led_status_set_connected(bool connected)
 {
-	is_connected = connected;
+	set_link(LINK_CONNECTED, connected);
 }
 
 void led_status_set_pairing_window(bool pairing_active)
 {
-	pairing_window_active = pairing_active;
+	set_link(LINK_PAIRING, pairing_active);
 }
 
 void led_status_error(void)
 {
-	error_mode = true;
 	LOG_ERR("Entering LED error mode");
+	request(LED_PATTERN_ERROR, true);
 }
 
-/**
- * @brief LED status thread
- *
- * Status indication patterns (single LED):
- * - Rapid flash (100ms): Error state
- * - Fast blink (250ms): Pairing window active, not connected
- * - Medium blink (500ms): Pairing window active AND connected
- * - Off: Pairing window closed (regardless of connection state)
- */
-static void led_status_thread(void)
+#if defined(CONFIG_RADPRO_LED_ACTIVITY)
+void led_status_activity(void)
 {
-	bool blink_state = false;
-	uint32_t blink_interval_ms;
+	int top = top_pattern();
 
-	LOG_INF("LED status thread started");
-
-	for (;;) {
-		/* Error mode: Rapid flash */
-		if (error_mode) {
-			led_set(true);
-			k_msleep(100);
-			led_set(false);
-			k_msleep(100);
-			continue;
-		}
-
-		/* LED only active during pairing window */
-		if (!pairing_window_active) {
-			/* Pairing window closed: LED off */
-			led_set(false);
-			k_msleep(SLOW_BLINK_INTERVAL_MS);
-			continue;
-		}
-
-		/* Determine blink pattern based on state (pairing window active) */
-		if (is_connected) {
-			/* Pairing window active AND connected: medium blink */
-			blink_interval_ms = MEDIUM_BLINK_INTERVAL_MS;
-		} else {
-			/* Pairing window active, not connected: fast blink */
-			blink_interval_ms = FAST_BLINK_INTERVAL_MS;
-		}
-
-		/* Toggle LED */
-		blink_state = !blink_state;
-		led_set(blink_state);
-		k_msleep(blink_interval_ms);
+	/* Only visible on an otherwise dark LED; don't queue one up behind
+	 * a blink pattern */
+	if (top == LED_PATTERN_NONE || top == LED_PATTERN_ACTIVITY) {
+		request(LED_PATTERN_ACTIVITY, true);
 	}
 }
-
-K_THREAD_DEFINE(led_status_thread_id, 1024, led_status_thread, NULL, NULL, NULL, 7, 0, 0);
+#endif
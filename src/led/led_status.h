@@ -9,13 +9,27 @@
 #include <stdbool.h>
 
 /**
- * @brief LED status patterns (single user LED)
+ * @brief LED status patterns (single user LED), highest priority first
  * - Rapid flash (100ms): Error state
  * - Fast blink (250ms): Pairing window active, not connected
  * - Medium blink (500ms): Pairing window active AND connected
+ * - Brief flash: Data traffic (CONFIG_RADPRO_LED_ACTIVITY), LED otherwise off
  * - Off: Pairing window closed (regardless of connection state)
+ *
+ * Patterns are step tables played from a delayable work item on the
+ * system workqueue; with no pattern requested the LED is off and
+ * nothing is scheduled.
  */
 
+/* Patterns in increasing priority */
+enum led_pattern_id {
+	LED_PATTERN_ACTIVITY,
+	LED_PATTERN_CONNECTED,
+	LED_PATTERN_PAIRING,
+	LED_PATTERN_ERROR,
+	LED_PATTERN_COUNT,
+};
+
 /**
  * @brief Initialize LED status module
  * @return 0 on success, negative errno on failure
@@ -24,6 +38,9 @@ int led_status_init(void);
 
 /**
  * @brief Set connection status
+ *
+ * Callable from any thread; the LED follows from the system workqueue.
+ *
  * @param connected true if BLE connected
  */
 void led_status_set_connected(bool connected);
@@ -39,4 +56,15 @@ void led_status_set_pairing_window(bool pairing_active);
  */
 void led_status_error(void);
 
+#if defined(CONFIG_RADPRO_LED_ACTIVITY)
+/**
+ * @brief Flash the LED briefly for data traffic, when it is otherwise off
+ */
+void led_status_activity(void);
+#else
+static inline void led_status_activity(void)
+{
+}
+#endif
+
 #endif /* LED_STATUS_H */
\ No newline at end of file
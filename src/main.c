@@ -12,10 +12,26 @@
 
 #include "board/board_config.h"
 #include "ble/ble_service.h"
+#include "ble/nus_packetizer.h"
+#include "ble/l2cap_coc.h"
+#include "ble/link_profile.h"
+#include "ble/radiation_service.h"
+#include "ble/adv_beacon.h"
+#include "ble/telemetry_adv.h"
 #include "uart/uart_bridge.h"
 #include "security/security_manager.h"
 #include "led/led_status.h"
 #include "dfu/dfu_service.h"
+#include "metrics/metrics.h"
+#include "trace/trace.h"
+#include "status/app_status.h"
+#include "radpro/radpro_engine.h"
+#include "radpro/radpro_client.h"
+#include "radpro/radpro_cache.h"
+#include "radpro/radpro_sampler.h"
+#include "radpro/radpro_mirror.h"
+#include "radpro/radpro_history.h"
+#include "radpro/radpro_latency.h"
 
 LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 
@@ -24,17 +40,30 @@ LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 
 /* Forward declarations */
 static void uart_data_handler(const uint8_t *data, uint16_t len);
+static void forward_to_ble(const uint8_t *data, uint16_t len);
+static void reply_to_client(uint8_t client, const uint8_t *data, uint16_t len);
+static void ble_disconnected_handler(struct bt_conn *conn);
+static const bt_addr_le_t *client_peer(uint8_t client);
+static void unsolicited_handler(const uint8_t *data, size_t len, void *user_data);
 static void ble_data_handler(struct bt_conn *conn, const uint8_t *data, uint16_t len);
 
 /* Application initialization */
 static int app_init(void)
 {
+	bool uart_ready = false;
 	int err;
 
 	LOG_INF("=== RadPro-Link Starting ===");
 	LOG_INF("Pairing window: %d minutes", PAIRING_WINDOW_MS / 60000);
 	LOG_INF("Device: %s", CONFIG_BT_DEVICE_NAME);
 
+	/* First: registering the stats group zeroes the counters. Metrics
+	 * keep counting without it */
+	err = metrics_init();
+	if (err) {
+		LOG_WRN("Metrics stats group registration failed: %d", err);
+	}
+
 	/* Initialize board-specific hardware */
 	LOG_INF("Initializing board hardware");
 	err = board_init();
@@ -62,6 +91,33 @@ static int app_init(void)
 	}
 	LOG_INF("Security manager initialized");
 
+	/* Initialize RadPro protocol engine (before UART delivers data) */
+	if (IS_ENABLED(CONFIG_RADPRO_PROTOCOL_ENGINE)) {
+		radpro_engine_init(unsolicited_handler);
+		radpro_client_init(reply_to_client);
+		if (IS_ENABLED(CONFIG_RADPRO_DATALOG_SYNC)) {
+			radpro_client_set_peer_cb(client_peer);
+		}
+		radpro_cache_init();
+		radpro_sampler_init();
+
+		/* Non-fatal - charts then fill from live samples only */
+		if (IS_ENABLED(CONFIG_RADPRO_HISTORY)) {
+			err = radpro_history_init();
+			if (err) {
+				LOG_WRN("Sample history init failed: %d", err);
+			}
+		}
+
+		/* Non-fatal - downloads then go to the device as before */
+		if (IS_ENABLED(CONFIG_RADPRO_DATALOG_MIRROR)) {
+			err = radpro_mirror_init();
+			if (err) {
+				LOG_WRN("Datalog mirror init failed: %d", err);
+			}
+		}
+	}
+
 	/* Initialize UART bridge (non-fatal - BLE can work without it) */
 	LOG_INF("Initializing UART bridge");
 	err = uart_bridge_init(uart_data_handler);
@@ -70,6 +126,20 @@ static int app_init(void)
 		LOG_WRN("BLE will work but UART forwarding is disabled");
 	} else {
 		LOG_INF("UART bridge initialized");
+		uart_ready = true;
+
+		/* Fill static values while no client is connected yet */
+		if (IS_ENABLED(CONFIG_RADPRO_RESPONSE_CACHE)) {
+			radpro_cache_prefetch();
+		}
+
+		if (IS_ENABLED(CONFIG_RADPRO_SAMPLER)) {
+			radpro_sampler_start();
+		}
+
+		if (IS_ENABLED(CONFIG_RADPRO_DATALOG_MIRROR)) {
+			radpro_mirror_start();
+		}
 	}
 
 	/* Initialize Bluetooth */
@@ -91,7 +161,7 @@ static int app_init(void)
 
 	LOG_INF("Bluetooth initialized");
 
-	/* Load settings (bonding info) */
+	/* Load settings (bonding info, datalog sync cursors) */
 	if (IS_ENABLED(CONFIG_SETTINGS)) {
 		settings_load();
 		LOG_INF("Settings loaded");
@@ -104,6 +174,55 @@ static int app_init(void)
 		return err;
 	}
 
+	if (IS_ENABLED(CONFIG_RADPRO_PROTOCOL_ENGINE)) {
+		ble_service_set_disconnected_cb(ble_disconnected_handler);
+	}
+
+	if (IS_ENABLED(CONFIG_RADPRO_ADV_BONDED_ONLY)) {
+		/* Switch to bonded-only advertising when pairing ends */
+		security_manager_set_window_closed_cb(ble_service_restart_advertising);
+	}
+
+	err = nus_packetizer_init();
+	if (err) {
+		LOG_ERR("NUS packetizer init failed: %d", err);
+		return err;
+	}
+
+	err = link_profile_init();
+	if (err) {
+		LOG_ERR("Link profile init failed: %d", err);
+		return err;
+	}
+
+	if (IS_ENABLED(CONFIG_RADPRO_RADIATION_SERVICE)) {
+		err = radiation_service_init();
+		if (err) {
+			LOG_ERR("Radiation service init failed: %d", err);
+			return err;
+		}
+
+		if (uart_ready) {
+			radiation_service_start();
+		}
+	}
+
+	if (IS_ENABLED(CONFIG_RADPRO_ADV_BEACON)) {
+		err = adv_beacon_init();
+		if (err) {
+			LOG_ERR("Advertising beacon init failed: %d", err);
+			return err;
+		}
+	}
+
+	/* Non-fatal - the connectable advertising is unaffected */
+	if (IS_ENABLED(CONFIG_RADPRO_PER_ADV_TELEMETRY)) {
+		err = telemetry_adv_init();
+		if (err) {
+			LOG_WRN("Periodic telemetry init failed: %d", err);
+		}
+	}
+
 	/* Initialize DFU service (MCUmgr SMP) */
 	err = dfu_service_init();
 	if (err) {
@@ -123,46 +242,95 @@ static int app_init(void)
 }
 
 /* Data flow handlers */
-static void uart_data_handler(const uint8_t *data, uint16_t len)
+static void forward_to_ble(const uint8_t *data, uint16_t len)
 {
-	/* UART → BLE: Forward data from UART to BLE */
-	LOG_HEXDUMP_INF(data, len, "UART→BLE:");
+	/* Fanned out to every authenticated central */
 	if (ble_service_is_authenticated()) {
-		int err = ble_service_send(data, len);
+		link_profile_note_traffic(len);
+
+		int err = nus_packetizer_broadcast(data, len);
 		if (err) {
 			LOG_WRN("Failed to send to BLE: %d", err);
 		}
 	}
 }
 
-static void ble_data_handler(struct bt_conn *conn, const uint8_t *data, uint16_t len)
+static void reply_to_client(uint8_t client, const uint8_t *data, uint16_t len)
 {
-	/* BLE → UART: Forward data from BLE to UART */
-	int err = uart_bridge_send(data, len);
-	if (err) {
-		LOG_WRN("Failed to send to UART: %d", err);
+	/* Client numbers are connection slots */
+	struct bt_conn *conn = ble_service_get_connection(client);
+
+	if (ble_service_is_conn_authenticated(conn)) {
+		link_profile_note_traffic(len);
+
+		/* Bulk replies go over the L2CAP channel once the central opened it */
+		int err = (IS_ENABLED(CONFIG_RADPRO_L2CAP_COC) && l2cap_coc_is_open(conn)) ?
+			  l2cap_coc_send(conn, data, len) :
+			  nus_packetizer_write(conn, data, len);
+		if (err) {
+			LOG_WRN("Failed to send to BLE: %d", err);
+		}
 	}
 }
 
-/* Status monitoring thread */
-static void status_monitor_thread(void)
+static void ble_disconnected_handler(struct bt_conn *conn)
 {
-	LOG_INF("Status monitor started");
+	radpro_client_reset(bt_conn_index(conn));
+	/* RTT/console summary of the session's command latencies */
+	radpro_latency_log();
+}
+
+/* Sync cursors are kept per bond: only bonded centrals have one */
+static const bt_addr_le_t *client_peer(uint8_t client)
+{
+	struct bt_conn *conn = ble_service_get_connection(client);
+	const bt_addr_le_t *dst;
+
+	if (!ble_service_is_conn_authenticated(conn)) {
+		return NULL;
+	}
 
-	for (;;) {
-		/* Update LED status based on pairing window */
-		bool pairing_allowed = security_manager_is_pairing_allowed();
-		led_status_set_pairing_window(pairing_allowed);
+	dst = bt_conn_get_dst(conn);
+	return bt_le_bond_exists(BT_ID_DEFAULT, dst) ? dst : NULL;
+}
 
-		/* Update connection status */
-		bool connected = ble_service_is_authenticated();
-		led_status_set_connected(connected);
+static void unsolicited_handler(const uint8_t *data, size_t len, void *user_data)
+{
+	/* Someone is using the device - make the bridge quick to find */
+	ble_service_boost_advertising();
+
+	/* UART output nobody asked for is passed through as before */
+	forward_to_ble(data, len);
+}
 
-		k_sleep(K_SECONDS(1));
+static void uart_data_handler(const uint8_t *data, uint16_t len)
+{
+	/* UART → BLE: Forward data from UART to BLE */
+	trace_event(TRACE_UART_TO_BLE, data, len);
+	led_status_activity();
+	if (IS_ENABLED(CONFIG_RADPRO_PROTOCOL_ENGINE)) {
+		radpro_engine_uart_rx(data, len);
+	} else {
+		ble_service_boost_advertising();
+		forward_to_ble(data, len);
 	}
 }
 
-K_THREAD_DEFINE(status_monitor_id, 1024, status_monitor_thread, NULL, NULL, NULL, 7, 0, 0);
+static void ble_data_handler(struct bt_conn *conn, const uint8_t *data, uint16_t len)
+{
+	led_status_activity();
+
+	/* BLE → UART: Commands are queued so replies can't interleave */
+	if (IS_ENABLED(CONFIG_RADPRO_PROTOCOL_ENGINE)) {
+		radpro_client_rx(bt_conn_index(conn), data, len);
+		return;
+	}
+
+	int err = uart_bridge_send(data, len);
+	if (err) {
+		LOG_WRN("Failed to send to UART: %d", err);
+	}
+}
 
 /* Main entry point */
 int main(void)
@@ -171,7 +339,7 @@ int main(void)
 
 	if (err) {
 		LOG_ERR("Initialization failed: %d", err);
-		led_status_error();
+		app_status_set(APP_STATUS_ERROR, true);
 		return err;
 	}
 
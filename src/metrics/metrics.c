@@ -0,0 +1,137 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Bridge Metrics - Implementation
+ */
+
+#include "metrics.h"
+#if defined(CONFIG_RADPRO_LATENCY)
+#include "../radpro/radpro_latency.h"
+#endif
+
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+#if defined(CONFIG_STATS)
+#include <zephyr/stats/stats.h>
+#endif
+
+LOG_MODULE_REGISTER(metrics, LOG_LEVEL_INF);
+
+#if defined(CONFIG_STATS)
+/* MCUmgr reads the stats group in place, so the group is the storage:
+ * its entries are consecutive uint32_t fields in METRICS_LIST order */
+#define METRICS_STATS_ENTRY(id, name) STATS_SECT_ENTRY32(name)
+#define METRICS_STATS_NAME(id, name) STATS_NAME(radpro_bridge, name)
+
+STATS_SECT_START(radpro_bridge)
+METRICS_LIST(METRICS_STATS_ENTRY)
+STATS_SECT_END;
+
+STATS_NAME_START(radpro_bridge)
+METRICS_LIST(METRICS_STATS_NAME)
+STATS_NAME_END(radpro_bridge);
+
+static STATS_SECT_DECL(radpro_bridge) radpro_bridge;
+
+BUILD_ASSERT(sizeof(atomic_t) == sizeof(uint32_t), "stats entries are updated as atomics");
+
+static atomic_t *const values = (atomic_t *)&radpro_bridge.ble_rx_bytes;
+#else
+static atomic_t values[METRICS_COUNT];
+#endif
+
+/* GATT callbacks */
+static ssize_t read_metrics(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			    void *buf, uint16_t len, uint16_t offset)
+{
+	uint32_t snapshot[METRICS_COUNT];
+	uint8_t data[METRICS_COUNT * sizeof(uint32_t)];
+
+	metrics_snapshot(snapshot);
+	for (int i = 0; i < METRICS_COUNT; i++) {
+		sys_put_le32(snapshot[i], &data[i * sizeof(uint32_t)]);
+	}
+
+	/* Longer than a default MTU: centrals continue with Read Blob */
+	return bt_gatt_attr_read(conn, attr, buf, len, offset, data, sizeof(data));
+}
+
+#if defined(CONFIG_RADPRO_LATENCY)
+#define LATENCY_HIST_WORDS (1 + RADPRO_LATENCY_BUCKETS)
+
+static ssize_t read_latency(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			    void *buf, uint16_t len, uint16_t offset)
+{
+	uint8_t data[RADPRO_LATENCY_STAGES * LATENCY_HIST_WORDS * sizeof(uint32_t)];
+	struct radpro_latency_hist hist;
+	uint8_t *p = data;
+
+	for (int i = 0; i < RADPRO_LATENCY_STAGES; i++) {
+		radpro_latency_get(i, &hist);
+		sys_put_le32(hist.max_us, p);
+		p += sizeof(uint32_t);
+		for (int b = 0; b < RADPRO_LATENCY_BUCKETS; b++) {
+			sys_put_le32(hist.buckets[b], p);
+			p += sizeof(uint32_t);
+		}
+	}
+
+	return bt_gatt_attr_read(conn, attr, buf, len, offset, data, sizeof(data));
+}
+
+static ssize_t write_latency(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			     const void *buf, uint16_t len, uint16_t offset, uint8_t flags)
+{
+	/* Any write starts a new measurement */
+	radpro_latency_reset();
+	return len;
+}
+#endif
+
+BT_GATT_SERVICE_DEFINE(metrics_svc,
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_DECLARE_128(METRICS_SVC_UUID_VAL)),
+	BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(METRICS_VALUE_UUID_VAL),
+			       BT_GATT_CHRC_READ, BT_GATT_PERM_READ_ENCRYPT,
+			       read_metrics, NULL, NULL),
+#if defined(CONFIG_RADPRO_LATENCY)
+	BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(METRICS_LATENCY_UUID_VAL),
+			       BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE,
+			       BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT,
+			       read_latency, write_latency, NULL),
+#endif
+);
+
+/* Public API */
+int metrics_init(void)
+{
+#if defined(CONFIG_STATS)
+	int err = STATS_INIT_AND_REG(radpro_bridge, STATS_SIZE_32, "radpro_bridge");
+
+	if (err) {
+		LOG_ERR("Failed to register stats group: %d", err);
+		return err;
+	}
+#endif
+
+	LOG_INF("Metrics initialized (%d values)", METRICS_COUNT);
+	return 0;
+}
+
+void metrics_add(enum metrics_id id, uint32_t n)
+{
+	atomic_add(&values[id], n);
+}
+
+void metrics_set(enum metrics_id id, uint32_t value)
+{
+	atomic_set(&values[id], value);
+}
+
+void metrics_snapshot(uint32_t out[METRICS_COUNT])
+{
+	for (int i = 0; i < METRICS_COUNT; i++) {
+		out[i] = (uint32_t)atomic_get(&values[i]);
+	}
+}
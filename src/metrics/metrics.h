@@ -0,0 +1,115 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Bridge Metrics - Header
+ *
+ * Runtime counters and gauges of the bridge data paths, so throughput
+ * regressions and drops show up on deployed units without a debug probe.
+ * Every metric is a 32-bit atomic, cheap enough to update per frame from
+ * any context including ISRs; counters wrap.
+ *
+ * A snapshot is readable over GATT (encrypted link) as the metrics in
+ * enum order, each a little-endian uint32; new metrics are only ever
+ * appended. With CONFIG_STATS the same values form the MCUmgr stats
+ * group "radpro_bridge".
+ *
+ * Service  52504c4b-0100-4a8b-9c2e-6f5d3a1b0c00
+ *   Metrics ...-0101-...  read  uint32[METRICS_COUNT]
+ *   Latency ...-0102-...  read  per radpro_latency stage: max_us, buckets
+ *                         write anything to clear (CONFIG_RADPRO_LATENCY)
+ *
+ * Without CONFIG_RADPRO_METRICS the update calls compile to nothing.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+
+#define METRICS_UUID_ENCODE(id) \
+	BT_UUID_128_ENCODE(0x52504c4b, (id), 0x4a8b, 0x9c2e, 0x6f5d3a1b0c00)
+
+#define METRICS_SVC_UUID_VAL   METRICS_UUID_ENCODE(0x0100)
+#define METRICS_VALUE_UUID_VAL METRICS_UUID_ENCODE(0x0101)
+#define METRICS_LATENCY_UUID_VAL METRICS_UUID_ENCODE(0x0102)
+
+/* X(ID, name) for every metric, in snapshot order - append only */
+#define METRICS_LIST(X)                                                                 \
+	X(BLE_RX_BYTES, ble_rx_bytes)             /* From centrals (NUS writes, SDUs) */ \
+	X(BLE_RX_FRAMES, ble_rx_frames)                                                 \
+	X(BLE_TX_BYTES, ble_tx_bytes)             /* Queued to the stack */             \
+	X(BLE_TX_FRAMES, ble_tx_frames)           /* Notifications and SDUs */          \
+	X(UART_RX_BYTES, uart_rx_bytes)                                                 \
+	X(UART_TX_BYTES, uart_tx_bytes)                                                 \
+	X(DROP_UNAUTH_BYTES, drop_unauth_bytes)   /* Written without encryption */      \
+	X(DROP_BLE_TX_BYTES, drop_ble_tx_bytes)   /* Stalled or failed BLE sends */     \
+	X(DROP_UART_TX_BYTES, drop_uart_tx_bytes) /* No UART TX buffer */               \
+	X(UART_TX_POOL_EMPTY, uart_tx_pool_empty) /* TX buffer allocation failures */   \
+	X(UART_RX_RING_FULL, uart_rx_ring_full)   /* RX stopped, ring full */           \
+	X(UART_ERRORS, uart_errors)               /* Overrun, framing, parity, ... */   \
+	X(CONNECTS, connects)                                                           \
+	X(DISCONNECTS, disconnects)                                                     \
+	X(CONNECTIONS, connections)               /* Gauge: centrals connected */       \
+	X(MTU, mtu)                               /* Gauge: last negotiated ATT MTU */
+
+#define METRICS_ENUM(id, name) METRICS_##id,
+
+enum metrics_id {
+	METRICS_LIST(METRICS_ENUM)
+	METRICS_COUNT,
+};
+
+#if defined(CONFIG_RADPRO_METRICS)
+
+/**
+ * @brief Register the MCUmgr stats group (with CONFIG_STATS)
+ *
+ * Registration zeroes the counters, so call it before any other module
+ * starts counting.
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int metrics_init(void);
+
+/**
+ * @brief Add to a counter
+ * @param id Counter
+ * @param n Amount
+ */
+void metrics_add(enum metrics_id id, uint32_t n);
+
+/**
+ * @brief Set a gauge
+ * @param id Gauge
+ * @param value New value
+ */
+void metrics_set(enum metrics_id id, uint32_t value);
+
+/**
+ * @brief Copy every metric
+ * @param values Receives METRICS_COUNT values in enum order
+ */
+void metrics_snapshot(uint32_t values[METRICS_COUNT]);
+
+#else
+
+static inline int metrics_init(void)
+{
+	return 0;
+}
+
+static inline void metrics_add(enum metrics_id id, uint32_t n)
+{
+}
+
+static inline void metrics_set(enum metrics_id id, uint32_t value)
+{
+}
+
+#endif /* CONFIG_RADPRO_METRICS */
+
+static inline void metrics_inc(enum metrics_id id)
+{
+	metrics_add(id, 1);
+}
+
+#endif /* METRICS_H */
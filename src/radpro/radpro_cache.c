@@ -0,0 +1,253 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Response Cache - Implementation
+ */
+
+#include "radpro_cache.h"
+#include "radpro_engine.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+LOG_MODULE_REGISTER(radpro_cache, LOG_LEVEL_INF);
+
+/* Entries older than this are refetched; tubeDeadTime is measured by the
+ * device and tube settings can be changed from its menu */
+#define RADPRO_CACHE_TTL_MS ((int64_t)CONFIG_RADPRO_RESPONSE_CACHE_TTL_S * 1000)
+
+#define RADPRO_CACHE_PREFETCH_TIMEOUT_MS 1000
+
+/* A ticket identifies an entry and the generation it was tracked under */
+#define TICKET(index, generation) (((int)(generation) << 8) | (index))
+#define TICKET_INDEX(ticket) ((ticket) & 0xff)
+#define TICKET_GENERATION(ticket) (((ticket) >> 8) & 0xff)
+
+struct cache_entry {
+	const char *key;
+	uint8_t resp[RADPRO_CACHE_RESP_MAX];
+	uint8_t resp_len;    /* 0 = empty */
+	uint8_t generation;  /* Bumped on every invalidation */
+	int64_t stored_at;
+};
+
+static struct cache_entry entries[] = {
+	{ .key = "deviceId" },
+	{ .key = "tubeType" },
+	{ .key = "tubeSensitivity" },
+	{ .key = "tubeDeadTime" },
+	{ .key = "tubeDeadTimeCompensation" },
+};
+
+/* Response being received - the engine completes one command at a time */
+static uint8_t fill_buf[RADPRO_CACHE_RESP_MAX];
+static size_t fill_len;
+static bool fill_overflow;
+static int fill_ticket = -ENOENT;
+static K_MUTEX_DEFINE(cache_lock);
+
+/* Match "<verb> <key>" (GET) or "<verb> <key> <value>" (SET) */
+static int find_entry(const char *cmd, size_t len, const char *verb, bool has_value)
+{
+	size_t verb_len = strlen(verb);
+
+	while (len > 0 && (cmd[len - 1] == '\r' || cmd[len - 1] == '\n')) {
+		len--;
+	}
+
+	if (len <= verb_len || memcmp(cmd, verb, verb_len) != 0) {
+		return -ENOENT;
+	}
+
+	cmd += verb_len;
+	len -= verb_len;
+
+	for (size_t i = 0; i < ARRAY_SIZE(entries); i++) {
+		size_t key_len = strlen(entries[i].key);
+
+		if (len < key_len || memcmp(cmd, entries[i].key, key_len) != 0) {
+			continue;
+		}
+
+		if (has_value ? (len > key_len && cmd[key_len] == ' ') : (len == key_len)) {
+			return i;
+		}
+	}
+
+	return -ENOENT;
+}
+
+/* Caller must hold cache_lock */
+static bool entry_valid(const struct cache_entry *entry)
+{
+	if (entry->resp_len == 0) {
+		return false;
+	}
+
+	return RADPRO_CACHE_TTL_MS == 0 ||
+	       k_uptime_get() - entry->stored_at < RADPRO_CACHE_TTL_MS;
+}
+
+static void prefetch_data(const uint8_t *data, size_t len, void *user_data)
+{
+	radpro_cache_fill(POINTER_TO_INT(user_data), data, len);
+}
+
+static void prefetch_done(int status, void *user_data)
+{
+	radpro_cache_complete(POINTER_TO_INT(user_data), status);
+}
+
+/* Public API */
+int radpro_cache_init(void)
+{
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	for (size_t i = 0; i < ARRAY_SIZE(entries); i++) {
+		entries[i].resp_len = 0;
+		entries[i].generation = 0;
+	}
+	fill_len = 0;
+	fill_overflow = false;
+	fill_ticket = -ENOENT;
+
+	k_mutex_unlock(&cache_lock);
+	return 0;
+}
+
+int radpro_cache_prefetch(void)
+{
+	char cmd[RADPRO_CMD_MAX_LEN + 1];
+
+	for (size_t i = 0; i < ARRAY_SIZE(entries); i++) {
+		int len = snprintf(cmd, sizeof(cmd), "GET %s", entries[i].key);
+		int ticket = radpro_cache_track(cmd, len);
+		int err;
+
+		if (ticket < 0) {
+			continue;
+		}
+
+		k_mutex_lock(&cache_lock, K_FOREVER);
+		if (entry_valid(&entries[i])) {
+			k_mutex_unlock(&cache_lock);
+			continue;
+		}
+		k_mutex_unlock(&cache_lock);
+
+		err = radpro_engine_submit(cmd, len, RADPRO_CACHE_PREFETCH_TIMEOUT_MS,
+					   prefetch_data, prefetch_done,
+					   INT_TO_POINTER(ticket));
+		if (err) {
+			LOG_WRN("Prefetch of %s failed: %d", entries[i].key, err);
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+int radpro_cache_lookup(const char *cmd, size_t len, uint8_t *buf, size_t size)
+{
+	int index = find_entry(cmd, len, "GET ", false);
+	struct cache_entry *entry;
+	int ret;
+
+	if (index < 0) {
+		return -ENOENT;
+	}
+
+	entry = &entries[index];
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	if (!entry_valid(entry) || entry->resp_len > size) {
+		ret = -ENOENT;
+	} else {
+		memcpy(buf, entry->resp, entry->resp_len);
+		ret = entry->resp_len;
+	}
+
+	k_mutex_unlock(&cache_lock);
+
+	return ret;
+}
+
+int radpro_cache_track(const char *cmd, size_t len)
+{
+	int index = find_entry(cmd, len, "SET ", true);
+	int ticket;
+
+	if (index >= 0) {
+		k_mutex_lock(&cache_lock, K_FOREVER);
+		entries[index].resp_len = 0;
+		entries[index].generation++;
+		k_mutex_unlock(&cache_lock);
+
+		LOG_DBG("Invalidated %s", entries[index].key);
+		return -ENOENT;
+	}
+
+	index = find_entry(cmd, len, "GET ", false);
+	if (index < 0) {
+		return -ENOENT;
+	}
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+	ticket = TICKET(index, entries[index].generation);
+	k_mutex_unlock(&cache_lock);
+
+	return ticket;
+}
+
+void radpro_cache_fill(int ticket, const uint8_t *data, size_t len)
+{
+	if (ticket < 0) {
+		return;
+	}
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	if (ticket != fill_ticket) {
+		fill_ticket = ticket;
+		fill_len = 0;
+		fill_overflow = false;
+	}
+
+	if (fill_len + len <= sizeof(fill_buf)) {
+		memcpy(&fill_buf[fill_len], data, len);
+		fill_len += len;
+	} else {
+		fill_overflow = true;
+	}
+
+	k_mutex_unlock(&cache_lock);
+}
+
+void radpro_cache_complete(int ticket, int status)
+{
+	struct cache_entry *entry;
+
+	if (ticket < 0) {
+		return;
+	}
+
+	entry = &entries[TICKET_INDEX(ticket)];
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	if (status == 0 && ticket == fill_ticket && !fill_overflow && fill_len > 0 &&
+	    entry->generation == TICKET_GENERATION(ticket)) {
+		memcpy(entry->resp, fill_buf, fill_len);
+		entry->resp_len = fill_len;
+		entry->stored_at = k_uptime_get();
+		LOG_DBG("Cached %s", entry->key);
+	}
+
+	fill_ticket = -ENOENT;
+	fill_len = 0;
+
+	k_mutex_unlock(&cache_lock);
+}
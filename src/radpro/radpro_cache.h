@@ -0,0 +1,74 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Response Cache - Header
+ *
+ * Holds the responses to GET commands whose values practically never
+ * change (deviceId, tube parameters) so they can be answered without a
+ * UART round trip. Entries are filled by prefetching after UART init or
+ * from the first response that passes through, and dropped when the
+ * matching SET is sent.
+ */
+
+#ifndef RADPRO_CACHE_H
+#define RADPRO_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Longest cached response line, including "\r\n" */
+#define RADPRO_CACHE_RESP_MAX 64
+
+/**
+ * @brief Initialize the cache (all entries empty)
+ * @return 0 on success, negative errno on failure
+ */
+int radpro_cache_init(void);
+
+/**
+ * @brief Queue GET commands for every empty entry on the protocol engine
+ * @return 0 on success, negative errno if a command could not be queued
+ */
+int radpro_cache_prefetch(void);
+
+/**
+ * @brief Look up the cached response to a command
+ * @param cmd Command text, with or without the "\r\n" terminator
+ * @param len Length of cmd
+ * @param buf Receives the response line
+ * @param size Size of buf
+ * @return Response length on hit, -ENOENT if the command is not cached
+ */
+int radpro_cache_lookup(const char *cmd, size_t len, uint8_t *buf, size_t size);
+
+/**
+ * @brief Note a command about to be sent to the device
+ *
+ * A SET to a cached value invalidates its entry. A GET of a cached value
+ * returns a ticket used to store the response as it comes back.
+ *
+ * @param cmd Command text, with or without the "\r\n" terminator
+ * @param len Length of cmd
+ * @return Ticket (>= 0) for a cacheable GET, -ENOENT otherwise
+ */
+int radpro_cache_track(const char *cmd, size_t len);
+
+/**
+ * @brief Feed response bytes for a tracked command
+ * @param ticket Ticket from radpro_cache_track() (negative is ignored)
+ * @param data Response bytes
+ * @param len Number of bytes
+ */
+void radpro_cache_fill(int ticket, const uint8_t *data, size_t len);
+
+/**
+ * @brief Complete a tracked command; an OK response is stored
+ *
+ * The response is discarded if the entry was invalidated since the
+ * command was tracked, so a reply overtaken by a SET is never cached.
+ *
+ * @param ticket Ticket from radpro_cache_track() (negative is ignored)
+ * @param status Completion status from the protocol engine
+ */
+void radpro_cache_complete(int ticket, int status);
+
+#endif /* RADPRO_CACHE_H */
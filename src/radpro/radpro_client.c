@@ -0,0 +1,516 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Client Adapter - Implementation
+ */
+
+#include "radpro_client.h"
+#include "radpro_engine.h"
+#include "radpro_cache.h"
+#include "radpro_datalog.h"
+#include "radpro_sync.h"
+#include "radpro_mirror.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(radpro_client, LOG_LEVEL_INF);
+
+/* Silence allowed while a response is streaming in */
+#define RADPRO_CLIENT_TIMEOUT_MS 2000
+
+static const uint8_t error_reply[] = "ERROR\r\n";
+static const uint8_t line_end[] = "\r\n";
+
+/* Bridge command for the binary datalog, rewritten to its ASCII form */
+static const char datalog_bin_cmd[] = "GET datalogBin";
+static const char datalog_cmd[] = "GET datalog";
+
+/* Bridge commands for the per-bond datalog sync */
+static const char sync_datalog_cmd[] = "SYNC datalog";
+static const char sync_ack_cmd[] = "SYNC ack";
+static const char sync_reset_cmd[] = "SYNC reset";
+
+/* Device command that clears the datalog the mirror copies */
+static const char reset_datalog_cmd[] = "RESET datalog";
+
+/* Engine user_data, packed as unsigned: client in the low byte, its
+ * generation in the next, the 16-bit cache ticket above. Tickets are
+ * (generation << 8) | index with a small index, so TAG_NO_TICKET is
+ * never a real one and stands for any negative ticket */
+#define TAG_NO_TICKET 0xffffU
+#define CLIENT_TAG(client, gen, ticket)                                                \
+	UINT_TO_POINTER((((ticket) < 0 ? TAG_NO_TICKET : (uint32_t)(ticket)) << 16) |   \
+			((uint32_t)(gen) << 8) | (uint32_t)(client))
+#define TAG_CLIENT(tag) ((uint8_t)POINTER_TO_UINT(tag))
+#define TAG_GEN(tag) ((uint8_t)(POINTER_TO_UINT(tag) >> 8))
+#define TAG_TICKET(tag) \
+	((POINTER_TO_UINT(tag) >> 16) == TAG_NO_TICKET ? -ENOENT : (int)(POINTER_TO_UINT(tag) >> 16))
+
+/* Per-client state - only touched from the BLE RX path and engine
+ * callbacks, which are serialized by the engine (one command outstanding
+ * at a time across all clients) */
+struct client_state {
+	char line_buf[RADPRO_CMD_MAX_LEN];
+	uint16_t line_len;
+	bool line_overflow;
+	bool reply_started;
+	uint8_t gen;  /* Bumped on reset, replies to older commands are dropped */
+
+	/* Last record of a finished SYNC datalog, waiting for SYNC ack */
+	uint32_t sync_time;
+
+	/* Cache hit waiting for its turn on the engine */
+	uint8_t cached_reply[RADPRO_CACHE_RESP_MAX];
+	uint8_t cached_len;
+
+	/* Commands submitted and not yet answered - decremented from engine
+	 * callbacks, so atomic */
+	atomic_t outstanding;
+};
+
+static radpro_client_output_t output_callback;
+static radpro_client_peer_t peer_callback;
+static struct client_state clients[RADPRO_CLIENT_MAX];
+
+/* The engine runs one command at a time, so one encoder serves everyone */
+static struct radpro_datalog_enc datalog_enc;
+
+static void reply(uint8_t client, const uint8_t *data, uint16_t len)
+{
+	if (output_callback) {
+		output_callback(client, data, len);
+	}
+}
+
+/* The client that sent the command, NULL if it has gone since */
+static struct client_state *tag_client(void *tag)
+{
+	struct client_state *cs = &clients[TAG_CLIENT(tag)];
+
+	return cs->gen == TAG_GEN(tag) ? cs : NULL;
+}
+
+static void client_data(const uint8_t *data, size_t len, void *user_data)
+{
+	uint8_t client = TAG_CLIENT(user_data);
+
+	radpro_cache_fill(TAG_TICKET(user_data), data, len);
+
+	if (!tag_client(user_data)) {
+		return;
+	}
+
+	clients[client].reply_started = true;
+	reply(client, data, len);
+}
+
+static void client_done(int status, void *user_data)
+{
+	uint8_t client = TAG_CLIENT(user_data);
+	struct client_state *cs = tag_client(user_data);
+
+	radpro_cache_complete(TAG_TICKET(user_data), status);
+
+	if (!cs) {
+		return;
+	}
+
+	/* OK/ERROR/other lines were already forwarded verbatim; anything else
+	 * still owes the client exactly one line */
+	if (status != 0 && status != -EIO && status != -EBADMSG) {
+		if (cs->reply_started) {
+			reply(client, line_end, sizeof(line_end) - 1);
+		} else {
+			reply(client, error_reply, sizeof(error_reply) - 1);
+		}
+	}
+
+	cs->reply_started = false;
+	atomic_dec(&cs->outstanding);
+}
+
+static void datalog_out(const uint8_t *data, size_t len, void *user_data)
+{
+	if (tag_client(user_data)) {
+		reply(TAG_CLIENT(user_data), data, len);
+	}
+}
+
+static void datalog_data(const uint8_t *data, size_t len, void *user_data)
+{
+	struct client_state *cs = tag_client(user_data);
+
+	if (cs) {
+		cs->reply_started = true;
+	}
+
+	radpro_datalog_enc_feed(&datalog_enc, data, len, datalog_out, user_data);
+}
+
+static void datalog_done(int status, void *user_data)
+{
+	struct client_state *cs = tag_client(user_data);
+	bool ended = radpro_datalog_enc_finish(&datalog_enc, status, datalog_out, user_data);
+
+	radpro_datalog_enc_init(&datalog_enc);
+
+	/* The binary stream carries its own end marker and line end */
+	if (ended && cs) {
+		cs->reply_started = false;
+		atomic_dec(&cs->outstanding);
+		return;
+	}
+
+	client_done(status, user_data);
+}
+
+/* The device's datalog is gone, so is the mirror's copy of it. Cleared
+ * whether or not the client is still there. */
+static void reset_datalog_done(int status, void *user_data)
+{
+	if (status == 0) {
+		radpro_mirror_clear();
+	}
+
+	client_done(status, user_data);
+}
+
+/* Datalog downloads the mirror holds are answered from bridge flash */
+static int submit_cmd(const char *cmd, size_t len, radpro_data_cb_t data_cb,
+		      radpro_done_cb_t done_cb, void *tag)
+{
+	if (IS_ENABLED(CONFIG_RADPRO_DATALOG_MIRROR) && radpro_mirror_covers(cmd, len)) {
+		/* Catch up first; the engine runs the fetch before the reply */
+		radpro_mirror_refresh();
+		return radpro_engine_submit_local(cmd, len, radpro_mirror_serve, data_cb,
+						  done_cb, tag);
+	}
+
+	return radpro_engine_submit_timed(cmd, len, RADPRO_CLIENT_TIMEOUT_MS, data_cb, done_cb,
+					  tag);
+}
+
+/* Queue the client's line to be answered on the bridge by local_cb. It
+ * runs on the engine's work queue, in turn with the device's replies,
+ * where sending the reply may block. */
+static int submit_local(uint8_t client, radpro_local_cb_t local_cb)
+{
+	struct client_state *cs = &clients[client];
+	int err;
+
+	atomic_inc(&cs->outstanding);
+
+	err = radpro_engine_submit_local(cs->line_buf, cs->line_len, local_cb, client_data,
+					 client_done, CLIENT_TAG(client, cs->gen, -ENOENT));
+	if (err) {
+		atomic_dec(&cs->outstanding);
+	}
+
+	return err;
+}
+
+static int cache_serve(const char *cmd, size_t len, radpro_data_cb_t data_cb,
+		       void *user_data)
+{
+	struct client_state *cs = &clients[TAG_CLIENT(user_data)];
+
+	ARG_UNUSED(cmd);
+	ARG_UNUSED(len);
+
+	/* Dropped by data_cb if the client has gone since */
+	data_cb(cs->cached_reply, cs->cached_len, user_data);
+	return 0;
+}
+
+/* Line is the command word(s) cmd, alone or followed by arguments */
+static bool line_is(const struct client_state *cs, const char *cmd)
+{
+	size_t n = strlen(cmd);
+
+	return cs->line_len >= n && memcmp(cs->line_buf, cmd, n) == 0 &&
+	       (cs->line_len == n || cs->line_buf[n] == ' ');
+}
+
+static void submit_datalog_bin(uint8_t client)
+{
+	struct client_state *cs = &clients[client];
+	size_t n = sizeof(datalog_bin_cmd) - 1;
+	char cmd[RADPRO_CMD_MAX_LEN];
+	size_t len = sizeof(datalog_cmd) - 1;
+	int err;
+
+	/* "GET datalogBin [args]" is sent as "GET datalog [args]" */
+	memcpy(cmd, datalog_cmd, len);
+	memcpy(&cmd[len], &cs->line_buf[n], cs->line_len - n);
+	len += cs->line_len - n;
+
+	atomic_inc(&cs->outstanding);
+
+	/* Records are re-encoded as they stream in, nothing is cached */
+	err = submit_cmd(cmd, len, datalog_data, datalog_done,
+			 CLIENT_TAG(client, cs->gen, -ENOENT));
+	if (err) {
+		atomic_dec(&cs->outstanding);
+		LOG_WRN("Command rejected: %d", err);
+		reply(client, error_reply, sizeof(error_reply) - 1);
+	}
+}
+
+static void sync_done(int status, void *user_data)
+{
+	struct client_state *cs = tag_client(user_data);
+	uint32_t last = radpro_datalog_enc_last_time(&datalog_enc);
+
+	/* Acked later, once the client has stored the records */
+	if (cs && status == 0 && last > 0) {
+		cs->sync_time = last;
+	}
+
+	datalog_done(status, user_data);
+}
+
+static int sync_datalog(uint8_t client, const bt_addr_le_t *peer)
+{
+	struct client_state *cs = &clients[client];
+	uint32_t cursor = radpro_sync_get(peer);
+	char cmd[RADPRO_CMD_MAX_LEN];
+	int len;
+	int err;
+
+	if (cursor == UINT32_MAX) {
+		return -ERANGE;
+	}
+
+	/* Only records after the last one the client acknowledged */
+	len = snprintf(cmd, sizeof(cmd), "%s %u", datalog_cmd, cursor + 1);
+	cs->sync_time = 0;
+
+	atomic_inc(&cs->outstanding);
+
+	err = submit_cmd(cmd, len, datalog_data, sync_done, CLIENT_TAG(client, cs->gen, -ENOENT));
+	if (err) {
+		atomic_dec(&cs->outstanding);
+	}
+
+	return err;
+}
+
+/* Identity of the client a local SYNC command came from, NULL if gone */
+static const bt_addr_le_t *tag_peer(void *tag)
+{
+	return tag_client(tag) ? peer_callback(TAG_CLIENT(tag)) : NULL;
+}
+
+/* A failed local SYNC command answers like a device ERROR */
+static int sync_failed(int err, radpro_data_cb_t data_cb, void *user_data)
+{
+	LOG_WRN("SYNC command failed: %d", err);
+	data_cb(error_reply, sizeof(error_reply) - 1, user_data);
+	return -EIO;
+}
+
+/* Local callbacks: the cursor is written to settings on the engine's
+ * work queue, not on the BLE RX thread */
+static int sync_ack(const char *cmd, size_t len, radpro_data_cb_t data_cb, void *user_data)
+{
+	struct client_state *cs = tag_client(user_data);
+	const bt_addr_le_t *peer = tag_peer(user_data);
+	uint8_t buf[24];
+	int err;
+
+	ARG_UNUSED(cmd);
+	ARG_UNUSED(len);
+
+	if (!peer) {
+		return sync_failed(-ENOTCONN, data_cb, user_data);
+	}
+
+	if (cs->sync_time > 0) {
+		err = radpro_sync_set(peer, cs->sync_time);
+		if (err) {
+			return sync_failed(err, data_cb, user_data);
+		}
+		cs->sync_time = 0;
+	}
+
+	data_cb(buf, snprintf((char *)buf, sizeof(buf), "OK %u\r\n", radpro_sync_get(peer)),
+		user_data);
+	return 0;
+}
+
+static int sync_reset(const char *cmd, size_t len, radpro_data_cb_t data_cb, void *user_data)
+{
+	struct client_state *cs = tag_client(user_data);
+	const bt_addr_le_t *peer = tag_peer(user_data);
+	int err;
+
+	ARG_UNUSED(cmd);
+	ARG_UNUSED(len);
+
+	if (!peer) {
+		return sync_failed(-ENOTCONN, data_cb, user_data);
+	}
+
+	cs->sync_time = 0;
+	err = radpro_sync_set(peer, 0);
+	if (err) {
+		return sync_failed(err, data_cb, user_data);
+	}
+
+	data_cb((const uint8_t *)"OK\r\n", 4, user_data);
+	return 0;
+}
+
+static bool line_equals(const struct client_state *cs, const char *cmd)
+{
+	return cs->line_len == strlen(cmd) && memcmp(cs->line_buf, cmd, cs->line_len) == 0;
+}
+
+static void submit_sync(uint8_t client)
+{
+	struct client_state *cs = &clients[client];
+	const bt_addr_le_t *peer = peer_callback ? peer_callback(client) : NULL;
+	int err = -EINVAL;
+
+	/* ack and reset are answered in turn, after the client's earlier
+	 * commands, so an ack follows the download it confirms */
+	if (!peer) {
+		err = -EACCES;
+	} else if (line_equals(cs, sync_datalog_cmd)) {
+		err = sync_datalog(client, peer);
+	} else if (line_equals(cs, sync_ack_cmd)) {
+		err = submit_local(client, sync_ack);
+	} else if (line_equals(cs, sync_reset_cmd)) {
+		err = submit_local(client, sync_reset);
+	}
+
+	if (err) {
+		LOG_WRN("SYNC command failed: %d", err);
+		reply(client, error_reply, sizeof(error_reply) - 1);
+	}
+}
+
+static void submit_line(uint8_t client)
+{
+	struct client_state *cs = &clients[client];
+	radpro_done_cb_t done_cb = client_done;
+	int ticket = -ENOENT;
+	int err;
+
+	if (IS_ENABLED(CONFIG_RADPRO_DATALOG_MIRROR) && line_equals(cs, reset_datalog_cmd)) {
+		done_cb = reset_datalog_done;
+	}
+
+	if (IS_ENABLED(CONFIG_RADPRO_DATALOG_BINARY) && line_is(cs, datalog_bin_cmd)) {
+		submit_datalog_bin(client);
+		return;
+	}
+
+	if (IS_ENABLED(CONFIG_RADPRO_DATALOG_SYNC) && line_is(cs, "SYNC")) {
+		submit_sync(client);
+		return;
+	}
+
+	if (IS_ENABLED(CONFIG_RADPRO_RESPONSE_CACHE)) {
+		/* One cache hit in flight per client: its reply is held in cs */
+		if (atomic_get(&cs->outstanding) == 0) {
+			int n = radpro_cache_lookup(cs->line_buf, cs->line_len, cs->cached_reply,
+						    sizeof(cs->cached_reply));
+
+			if (n > 0) {
+				cs->cached_len = n;
+				err = submit_local(client, cache_serve);
+				if (err) {
+					LOG_WRN("Command rejected: %d", err);
+					reply(client, error_reply, sizeof(error_reply) - 1);
+				}
+				return;
+			}
+		}
+
+		ticket = radpro_cache_track(cs->line_buf, cs->line_len);
+	}
+
+	atomic_inc(&cs->outstanding);
+
+	err = submit_cmd(cs->line_buf, cs->line_len, client_data, done_cb,
+			 CLIENT_TAG(client, cs->gen, ticket));
+	if (err) {
+		atomic_dec(&cs->outstanding);
+		LOG_WRN("Command rejected: %d", err);
+		reply(client, error_reply, sizeof(error_reply) - 1);
+	}
+}
+
+/* Public API */
+int radpro_client_init(radpro_client_output_t output)
+{
+	output_callback = output;
+	radpro_datalog_enc_init(&datalog_enc);
+
+	for (uint8_t i = 0; i < RADPRO_CLIENT_MAX; i++) {
+		radpro_client_reset(i);
+	}
+
+	return 0;
+}
+
+void radpro_client_set_peer_cb(radpro_client_peer_t cb)
+{
+	peer_callback = cb;
+}
+
+void radpro_client_reset(uint8_t client)
+{
+	struct client_state *cs;
+
+	if (client >= RADPRO_CLIENT_MAX) {
+		return;
+	}
+
+	/* Commands still queued run, but their replies are dropped */
+	cs = &clients[client];
+	cs->gen++;
+	cs->line_len = 0;
+	cs->line_overflow = false;
+	cs->reply_started = false;
+	cs->sync_time = 0;
+	atomic_set(&cs->outstanding, 0);
+}
+
+void radpro_client_rx(uint8_t client, const uint8_t *data, uint16_t len)
+{
+	struct client_state *cs;
+
+	if (client >= RADPRO_CLIENT_MAX) {
+		return;
+	}
+
+	cs = &clients[client];
+
+	for (uint16_t i = 0; i < len; i++) {
+		char c = data[i];
+
+		if (c == '\r' || c == '\n') {
+			if (cs->line_overflow) {
+				LOG_WRN("Command longer than %d bytes dropped", RADPRO_CMD_MAX_LEN);
+				reply(client, error_reply, sizeof(error_reply) - 1);
+			} else if (cs->line_len > 0) {
+				submit_line(client);
+			}
+
+			/* "\r\n" yields one command: the empty line is skipped */
+			cs->line_len = 0;
+			cs->line_overflow = false;
+			continue;
+		}
+
+		if (cs->line_len < sizeof(cs->line_buf)) {
+			cs->line_buf[cs->line_len++] = c;
+		} else {
+			cs->line_overflow = true;
+		}
+	}
+}
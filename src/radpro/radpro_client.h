@@ -0,0 +1,82 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Client Adapter - Header
+ *
+ * Turns the byte stream written by a BLE client into RadPro command lines
+ * for the protocol engine and returns exactly one response line per
+ * command, in order, so clients can pipeline requests. Static values are
+ * answered from the response cache when enabled.
+ *
+ * Every BLE connection is a separate client with its own line buffer;
+ * responses go back to the client that sent the command.
+ *
+ * Bridge commands, answered without being sent as-is:
+ *   GET datalogBin [args]  datalog in binary (radpro_datalog.h)
+ *   SYNC datalog           binary datalog after the client's sync cursor
+ *   SYNC ack               store the last record of that download as the
+ *                          cursor, reply "OK <cursor>"
+ *   SYNC reset             start over with the next SYNC datalog
+ * The SYNC commands need a bonded client. Like every command they are
+ * answered in order, so SYNC ack confirms the SYNC datalog sent before it.
+ */
+
+#ifndef RADPRO_CLIENT_H
+#define RADPRO_CLIENT_H
+
+#include <stdint.h>
+#include <zephyr/bluetooth/addr.h>
+
+/* One client per BLE connection, numbered like bt_conn_index() */
+#define RADPRO_CLIENT_MAX CONFIG_BT_MAX_CONN
+
+/**
+ * @brief Callback type for response bytes going back to the client
+ * @param client Client that sent the command
+ * @param data Response bytes
+ * @param len Number of bytes
+ */
+typedef void (*radpro_client_output_t)(uint8_t client, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Callback type for the identity of a client
+ * @param client Client number
+ * @return Identity address if the client is a bonded central, else NULL
+ */
+typedef const bt_addr_le_t *(*radpro_client_peer_t)(uint8_t client);
+
+/**
+ * @brief Initialize the client adapter
+ * @param output Sink for response bytes
+ * @return 0 on success, negative errno on failure
+ */
+int radpro_client_init(radpro_client_output_t output);
+
+/**
+ * @brief Set the lookup of client identities for the SYNC commands
+ * @param cb Callback, NULL to reject SYNC commands
+ */
+void radpro_client_set_peer_cb(radpro_client_peer_t cb);
+
+/**
+ * @brief Feed bytes received from the client
+ *
+ * Lines may be terminated by "\r", "\n" or "\r\n" and may be split
+ * across calls.
+ *
+ * @param client Client the bytes came from, below RADPRO_CLIENT_MAX
+ * @param data Received bytes
+ * @param len Number of bytes
+ */
+void radpro_client_rx(uint8_t client, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Forget a client that went away
+ *
+ * Drops its partial line. Its commands already queued still run, but
+ * their responses are not passed to the output callback.
+ *
+ * @param client Client to reset
+ */
+void radpro_client_reset(uint8_t client);
+
+#endif /* RADPRO_CLIENT_H */
@@ -0,0 +1,224 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Datalog Encoder - Implementation
+ */
+
+#include "radpro_datalog.h"
+
+#include <string.h>
+#include <zephyr/sys/util.h>
+
+enum enc_state {
+	ENC_PREFIX,       /* Waiting for "OK " */
+	ENC_RECORDS,      /* Encoding records */
+	ENC_DONE,         /* Line end seen, waiting for completion */
+	ENC_PASSTHROUGH,  /* Not an OK response, forwarded verbatim */
+};
+
+static const uint8_t ok_prefix[] = "OK ";
+static const uint8_t line_end[] = "\r\n";
+
+/* Largest item: 5-byte head plus 5-byte pulse delta */
+#define ITEM_MAX 10
+
+static void flush(struct radpro_datalog_enc *enc, radpro_data_cb_t out, void *user_data)
+{
+	if (enc->out_len > 0) {
+		if (out) {
+			out(enc->out, enc->out_len, user_data);
+		}
+		enc->out_len = 0;
+	}
+}
+
+static void put(struct radpro_datalog_enc *enc, const uint8_t *data, size_t len,
+		radpro_data_cb_t out, void *user_data)
+{
+	while (len > 0) {
+		size_t n = MIN(len, sizeof(enc->out) - enc->out_len);
+
+		memcpy(&enc->out[enc->out_len], data, n);
+		enc->out_len += n;
+		data += n;
+		len -= n;
+
+		if (enc->out_len == sizeof(enc->out)) {
+			flush(enc, out, user_data);
+		}
+	}
+}
+
+static void put_varint(struct radpro_datalog_enc *enc, uint64_t value)
+{
+	do {
+		uint8_t b = value & 0x7f;
+
+		value >>= 7;
+		enc->out[enc->out_len++] = value ? (b | 0x80) : b;
+	} while (value);
+}
+
+static uint64_t zigzag(int64_t value)
+{
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static void put_item(struct radpro_datalog_enc *enc, uint64_t head, const int64_t *pulses,
+		     radpro_data_cb_t out, void *user_data)
+{
+	if (enc->out_len > sizeof(enc->out) - ITEM_MAX) {
+		flush(enc, out, user_data);
+	}
+
+	put_varint(enc, head);
+	if (pulses) {
+		put_varint(enc, zigzag(*pulses));
+	}
+}
+
+static void record_reset(struct radpro_datalog_enc *enc)
+{
+	enc->field = 0;
+	enc->field_digits = 0;
+	enc->bad = false;
+	enc->value[0] = 0;
+	enc->value[1] = 0;
+}
+
+static void record_end(struct radpro_datalog_enc *enc, bool line_end_seen,
+		       radpro_data_cb_t out, void *user_data)
+{
+	if (enc->field == 0 && enc->field_digits == 0 && !enc->bad) {
+		/* Empty record: a new session, unless it is the line end after a ';' */
+		if (!line_end_seen) {
+			if (enc->record_cb) {
+				enc->record_cb(RADPRO_DATALOG_SESSION, 0, 0, enc->record_user_data);
+			}
+			put_item(enc, RADPRO_DATALOG_SESSION, NULL, out, user_data);
+		}
+	} else if (!enc->bad && enc->field == 1 && enc->field_digits == 0x3) {
+		int64_t dt = (int64_t)enc->value[0] - enc->prev_time;
+		int64_t dp = (int64_t)enc->value[1] - enc->prev_pulses;
+
+		if (enc->record_cb) {
+			enc->record_cb(RADPRO_DATALOG_RECORD, enc->value[0], enc->value[1],
+				       enc->record_user_data);
+		}
+		put_item(enc, RADPRO_DATALOG_RECORD + zigzag(dt), &dp, out, user_data);
+		enc->prev_time = enc->value[0];
+		enc->prev_pulses = enc->value[1];
+	}
+
+	/* Anything else - the field name record - is dropped */
+	record_reset(enc);
+}
+
+static void record_char(struct radpro_datalog_enc *enc, uint8_t c,
+			radpro_data_cb_t out, void *user_data)
+{
+	if (c >= '0' && c <= '9') {
+		uint32_t *v = &enc->value[MIN(enc->field, 1)];
+
+		if (*v > (UINT32_MAX - (c - '0')) / 10) {
+			enc->bad = true;
+		} else {
+			*v = *v * 10 + (c - '0');
+		}
+		enc->field_digits |= BIT(MIN(enc->field, 1));
+	} else if (c == ',') {
+		if (enc->field >= 1) {
+			enc->bad = true;
+		}
+		enc->field++;
+	} else if (c == ';') {
+		record_end(enc, false, out, user_data);
+	} else if (c == '\r' || c == '\n') {
+		record_end(enc, true, out, user_data);
+		enc->state = ENC_DONE;
+	} else {
+		enc->bad = true;
+	}
+}
+
+/* Public API */
+void radpro_datalog_enc_init(struct radpro_datalog_enc *enc)
+{
+	memset(enc, 0, sizeof(*enc));
+	enc->state = ENC_PREFIX;
+}
+
+void radpro_datalog_enc_set_record_cb(struct radpro_datalog_enc *enc,
+				      radpro_datalog_record_cb_t cb, void *user_data)
+{
+	enc->record_cb = cb;
+	enc->record_user_data = user_data;
+}
+
+void radpro_datalog_enc_feed(struct radpro_datalog_enc *enc, const uint8_t *data,
+			     size_t len, radpro_data_cb_t out, void *user_data)
+{
+	for (size_t i = 0; i < len; i++) {
+		uint8_t c = data[i];
+
+		switch (enc->state) {
+		case ENC_PREFIX:
+			if (c == ok_prefix[enc->prefix_len]) {
+				if (++enc->prefix_len == sizeof(ok_prefix) - 1) {
+					put(enc, ok_prefix, sizeof(ok_prefix) - 1, out, user_data);
+					enc->state = ENC_RECORDS;
+				}
+			} else if (enc->prefix_len == 2 && (c == '\r' || c == '\n')) {
+				/* "OK" without records: an empty log */
+				put(enc, ok_prefix, sizeof(ok_prefix) - 1, out, user_data);
+				enc->state = ENC_DONE;
+			} else {
+				put(enc, ok_prefix, enc->prefix_len, out, user_data);
+				put(enc, &c, 1, out, user_data);
+				enc->state = ENC_PASSTHROUGH;
+			}
+			break;
+
+		case ENC_RECORDS:
+			record_char(enc, c, out, user_data);
+			break;
+
+		case ENC_DONE:
+			break;
+
+		case ENC_PASSTHROUGH:
+			put(enc, &c, 1, out, user_data);
+			break;
+		}
+	}
+
+	flush(enc, out, user_data);
+}
+
+bool radpro_datalog_enc_finish(struct radpro_datalog_enc *enc, int status,
+			       radpro_data_cb_t out, void *user_data)
+{
+	switch (enc->state) {
+	case ENC_RECORDS:
+	case ENC_DONE:
+		/* A record cut off mid-way is dropped */
+		put_item(enc, (status == 0 && enc->state == ENC_DONE) ? RADPRO_DATALOG_END :
+			 RADPRO_DATALOG_ABORT, NULL, out, user_data);
+		put(enc, line_end, sizeof(line_end) - 1, out, user_data);
+		flush(enc, out, user_data);
+		return true;
+
+	case ENC_PREFIX:
+		/* Partial "OK" before a timeout, the caller ends the line */
+		put(enc, ok_prefix, enc->prefix_len, out, user_data);
+		flush(enc, out, user_data);
+		return false;
+
+	default:
+		return false;
+	}
+}
+
+uint32_t radpro_datalog_enc_last_time(const struct radpro_datalog_enc *enc)
+{
+	return enc->prev_time;
+}
@@ -0,0 +1,121 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Datalog Encoder - Header
+ *
+ * Re-encodes the ASCII `GET datalog` response (docs/comm.md) on the fly
+ * into a compact binary stream, record by record as it comes off the
+ * UART. Clients ask for it with `GET datalogBin [start] [end] [max]`,
+ * which takes the same arguments as `GET datalog`.
+ *
+ * Reply: "OK " followed by items, each starting with an unsigned LEB128
+ * varint head:
+ *   0           end of log, "\r\n" follows
+ *   1           start of a new logging session (`;;` in the ASCII log)
+ *   2           log truncated (device timed out), "\r\n" follows
+ *   3 + zz(dt)  record: time delta to the previous record, followed by
+ *               a varint zz(dp) with the tubePulseCount delta
+ * zz() is zigzag encoding; deltas of the first record are relative to 0.
+ * The field name record is dropped. An `ERROR` reply is passed through
+ * unchanged. A typical record takes 2 bytes instead of ~17.
+ */
+
+#ifndef RADPRO_DATALOG_H
+#define RADPRO_DATALOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "radpro_engine.h"
+
+/* Item heads */
+#define RADPRO_DATALOG_END 0
+#define RADPRO_DATALOG_SESSION 1
+#define RADPRO_DATALOG_ABORT 2
+#define RADPRO_DATALOG_RECORD 3
+
+/**
+ * @brief Callback for the items of the log as they are parsed
+ * @param head RADPRO_DATALOG_SESSION or RADPRO_DATALOG_RECORD
+ * @param time UNIX time of the record (0 for a session start)
+ * @param pulses tubePulseCount of the record (0 for a session start)
+ * @param user_data User data passed to radpro_datalog_enc_set_record_cb()
+ */
+typedef void (*radpro_datalog_record_cb_t)(uint8_t head, uint32_t time, uint32_t pulses,
+					   void *user_data);
+
+/* Encoder state, one per response being encoded */
+struct radpro_datalog_enc {
+	uint8_t state;
+	uint8_t prefix_len;    /* Bytes of "OK " matched */
+	uint8_t field;         /* Field of the current record */
+	uint8_t field_digits;  /* Bit per field that has digits */
+	bool bad;              /* Current record is not two numbers */
+	uint32_t value[2];
+	uint32_t prev_time;
+	uint32_t prev_pulses;
+	uint8_t out[32];       /* Encoded bytes not yet passed on */
+	uint8_t out_len;
+	radpro_datalog_record_cb_t record_cb;
+	void *record_user_data;
+};
+
+/**
+ * @brief Prepare an encoder for a new response
+ * @param enc Encoder
+ */
+void radpro_datalog_enc_init(struct radpro_datalog_enc *enc);
+
+/**
+ * @brief Also report every parsed item to a callback
+ *
+ * Call after radpro_datalog_enc_init(). Items are reported in log order,
+ * before their encoded form is passed to the output.
+ *
+ * @param enc Encoder
+ * @param cb Callback, NULL to stop reporting
+ * @param user_data Passed to cb
+ */
+void radpro_datalog_enc_set_record_cb(struct radpro_datalog_enc *enc,
+				      radpro_datalog_record_cb_t cb, void *user_data);
+
+/**
+ * @brief Encode response bytes
+ *
+ * Output is passed to out before returning; a record split across calls
+ * is emitted once complete.
+ *
+ * @param enc Encoder
+ * @param data Response bytes, as passed to the engine's data callback
+ * @param len Number of bytes
+ * @param out Receives encoded bytes, NULL if only the records are wanted
+ * @param user_data Passed to out
+ */
+void radpro_datalog_enc_feed(struct radpro_datalog_enc *enc, const uint8_t *data,
+			     size_t len, radpro_data_cb_t out, void *user_data);
+
+/**
+ * @brief Finish the response
+ *
+ * Ends a binary stream with RADPRO_DATALOG_END (status 0) or
+ * RADPRO_DATALOG_ABORT and "\r\n".
+ *
+ * @param enc Encoder
+ * @param status Command status from the engine's done callback
+ * @param out Receives encoded bytes
+ * @param user_data Passed to out
+ * @return true if a binary stream was ended, false if the response was
+ *         passed through (or nothing arrived) and still needs the usual
+ *         completion handling
+ */
+bool radpro_datalog_enc_finish(struct radpro_datalog_enc *enc, int status,
+			       radpro_data_cb_t out, void *user_data);
+
+/**
+ * @brief Get the time of the last record encoded
+ * @param enc Encoder
+ * @return UNIX time of the most recent record, 0 if none was encoded
+ */
+uint32_t radpro_datalog_enc_last_time(const struct radpro_datalog_enc *enc);
+
+#endif /* RADPRO_DATALOG_H */
@@ -0,0 +1,393 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Protocol Engine - Implementation
+ */
+
+#include "radpro_engine.h"
+#include "radpro_latency.h"
+#include "../uart/uart_bridge.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(radpro_engine, LOG_LEVEL_INF);
+
+#define RADPRO_CMD_QUEUE_DEPTH 8
+
+/* Quiet period after a timeout; a late reply arriving in it is dropped
+ * instead of being taken for the next command's response */
+#define RADPRO_RESYNC_MS 100
+
+/* Work queue running the local callbacks, which block on BLE sends */
+#define RADPRO_LOCAL_STACK_SIZE 2048
+#define RADPRO_LOCAL_PRIORITY 7
+
+struct radpro_cmd {
+	char line[RADPRO_CMD_MAX_LEN + 2];  /* + "\r\n" */
+	uint8_t len;
+	uint32_t timeout_ms;
+	radpro_local_cb_t local_cb;  /* NULL for commands sent to the device */
+	radpro_data_cb_t data_cb;
+	radpro_done_cb_t done_cb;
+	void *user_data;
+	bool timed;          /* Stages recorded in the latency histograms */
+	uint32_t queued_at;  /* radpro_latency_stamp() when queued */
+	uint32_t seq;        /* Numbered when written to the UART */
+};
+
+enum engine_state {
+	ENGINE_IDLE,    /* Nothing outstanding on the UART */
+	ENGINE_BUSY,    /* Head of the queue sent, waiting for its line */
+	ENGINE_RESYNC,  /* Previous command timed out, draining late replies */
+	ENGINE_LOCAL,   /* Head of the queue being answered by its local_cb */
+};
+
+/* State - protected by engine_lock; callbacks are invoked without it */
+static struct radpro_cmd cmd_queue[RADPRO_CMD_QUEUE_DEPTH];
+static uint8_t queue_head;
+static uint8_t queue_count;
+static enum engine_state state;
+static char line_prefix[5];  /* Enough to tell "OK" from "ERROR" */
+static uint8_t prefix_len;
+static uint32_t stage_at;  /* Start of the outstanding command's current stage */
+static uint32_t send_seq;
+static uint32_t timeout_seq;  /* Command the timeout is armed for */
+static int64_t timeout_at;    /* Uptime (ms) it expires at */
+static radpro_data_cb_t unsolicited_callback;
+static K_MUTEX_DEFINE(engine_lock);
+static struct k_work_delayable timeout_work;
+static struct k_work local_work;
+static struct k_work_q local_q;
+static K_THREAD_STACK_DEFINE(local_stack, RADPRO_LOCAL_STACK_SIZE);
+
+/* Caller must hold engine_lock */
+static void timeout_arm(uint32_t seq, uint32_t ms)
+{
+	timeout_seq = seq;
+	timeout_at = k_uptime_get() + ms;
+	k_work_reschedule(&timeout_work, K_MSEC(ms));
+}
+
+/* Caller must hold engine_lock */
+static void queue_pop(void)
+{
+	queue_head = (queue_head + 1) % RADPRO_CMD_QUEUE_DEPTH;
+	queue_count--;
+}
+
+static int classify_response(void)
+{
+	if (prefix_len >= 2 && memcmp(line_prefix, "OK", 2) == 0) {
+		return 0;
+	}
+
+	if (prefix_len == sizeof(line_prefix) &&
+	    memcmp(line_prefix, "ERROR", sizeof(line_prefix)) == 0) {
+		return -EIO;
+	}
+
+	return -EBADMSG;
+}
+
+/* Send the next queued command if the UART is free */
+static void engine_kick(void)
+{
+	for (;;) {
+		struct radpro_cmd *cmd;
+		radpro_done_cb_t done_cb;
+		void *user_data;
+		int err;
+
+		k_mutex_lock(&engine_lock, K_FOREVER);
+
+		if (state != ENGINE_IDLE || queue_count == 0) {
+			k_mutex_unlock(&engine_lock);
+			return;
+		}
+
+		cmd = &cmd_queue[queue_head];
+		if (cmd->local_cb) {
+			state = ENGINE_LOCAL;
+			k_work_submit_to_queue(&local_q, &local_work);
+			k_mutex_unlock(&engine_lock);
+			return;
+		}
+
+		err = uart_bridge_send((const uint8_t *)cmd->line, cmd->len);
+		if (!err) {
+			uint32_t now = radpro_latency_stamp();
+
+			if (cmd->timed) {
+				radpro_latency_record(RADPRO_LATENCY_QUEUE, cmd->queued_at, now);
+			}
+			stage_at = now;
+			state = ENGINE_BUSY;
+			prefix_len = 0;
+			cmd->seq = ++send_seq;
+			timeout_arm(cmd->seq, cmd->timeout_ms);
+			k_mutex_unlock(&engine_lock);
+			return;
+		}
+
+		LOG_WRN("Failed to send %.*s: %d", cmd->len - 2, cmd->line, err);
+		done_cb = cmd->done_cb;
+		user_data = cmd->user_data;
+		queue_pop();
+		k_mutex_unlock(&engine_lock);
+
+		if (done_cb) {
+			done_cb(err, user_data);
+		}
+	}
+}
+
+static void timeout_work_handler(struct k_work *work)
+{
+	radpro_done_cb_t done_cb;
+	void *user_data;
+
+	ARG_UNUSED(work);
+
+	k_mutex_lock(&engine_lock, K_FOREVER);
+
+	/* A run already under way cannot be cancelled: when its command was
+	 * answered (or more of the reply re-armed it) while it waited for the
+	 * lock, the timeout now belongs to a later arming - leave it to that */
+	if (k_uptime_get() < timeout_at) {
+		k_mutex_unlock(&engine_lock);
+		return;
+	}
+
+	if (state == ENGINE_BUSY) {
+		struct radpro_cmd *cmd = &cmd_queue[queue_head];
+
+		if (cmd->seq != timeout_seq) {
+			/* Armed for a command that has completed since */
+			k_mutex_unlock(&engine_lock);
+			return;
+		}
+
+		LOG_WRN("No response to %.*s", cmd->len - 2, cmd->line);
+		done_cb = cmd->done_cb;
+		user_data = cmd->user_data;
+		queue_pop();
+		state = ENGINE_RESYNC;
+		timeout_arm(timeout_seq, RADPRO_RESYNC_MS);
+		k_mutex_unlock(&engine_lock);
+
+		if (done_cb) {
+			done_cb(-ETIMEDOUT, user_data);
+		}
+		return;
+	}
+
+	if (state == ENGINE_RESYNC) {
+		state = ENGINE_IDLE;
+	}
+
+	k_mutex_unlock(&engine_lock);
+	engine_kick();
+}
+
+static void local_work_handler(struct k_work *work)
+{
+	struct radpro_cmd *cmd;
+	radpro_done_cb_t done_cb;
+	void *user_data;
+	int status;
+
+	ARG_UNUSED(work);
+
+	/* The head slot is not reused until it is popped below */
+	k_mutex_lock(&engine_lock, K_FOREVER);
+	cmd = &cmd_queue[queue_head];
+	k_mutex_unlock(&engine_lock);
+
+	status = cmd->local_cb(cmd->line, cmd->len - 2, cmd->data_cb, cmd->user_data);
+
+	k_mutex_lock(&engine_lock, K_FOREVER);
+	done_cb = cmd->done_cb;
+	user_data = cmd->user_data;
+	queue_pop();
+	state = ENGINE_IDLE;
+	k_mutex_unlock(&engine_lock);
+
+	if (done_cb) {
+		done_cb(status, user_data);
+	}
+
+	engine_kick();
+}
+
+static int queue_push(const char *cmd, size_t len, uint32_t timeout_ms, bool timed,
+		      radpro_local_cb_t local_cb, radpro_data_cb_t data_cb,
+		      radpro_done_cb_t done_cb, void *user_data)
+{
+	struct radpro_cmd *slot;
+
+	/* The terminator is normalized to "\r\n" below */
+	while (len > 0 && (cmd[len - 1] == '\r' || cmd[len - 1] == '\n')) {
+		len--;
+	}
+
+	if (len == 0 || len > RADPRO_CMD_MAX_LEN) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&engine_lock, K_FOREVER);
+
+	if (queue_count == RADPRO_CMD_QUEUE_DEPTH) {
+		k_mutex_unlock(&engine_lock);
+		return -ENOSPC;
+	}
+
+	slot = &cmd_queue[(queue_head + queue_count) % RADPRO_CMD_QUEUE_DEPTH];
+	memcpy(slot->line, cmd, len);
+	slot->line[len] = '\r';
+	slot->line[len + 1] = '\n';
+	slot->len = len + 2;
+	slot->timeout_ms = timeout_ms;
+	slot->local_cb = local_cb;
+	slot->data_cb = data_cb;
+	slot->done_cb = done_cb;
+	slot->user_data = user_data;
+	slot->timed = timed;
+	slot->queued_at = radpro_latency_stamp();
+	queue_count++;
+
+	k_mutex_unlock(&engine_lock);
+
+	engine_kick();
+	return 0;
+}
+
+/* Public API */
+int radpro_engine_init(radpro_data_cb_t unsolicited_cb)
+{
+	unsolicited_callback = unsolicited_cb;
+	queue_head = 0;
+	queue_count = 0;
+	state = ENGINE_IDLE;
+	k_work_init_delayable(&timeout_work, timeout_work_handler);
+	k_work_init(&local_work, local_work_handler);
+	k_work_queue_start(&local_q, local_stack, K_THREAD_STACK_SIZEOF(local_stack),
+			   RADPRO_LOCAL_PRIORITY, NULL);
+
+	LOG_INF("RadPro protocol engine initialized");
+	return 0;
+}
+
+int radpro_engine_submit(const char *cmd, size_t len, uint32_t timeout_ms,
+			 radpro_data_cb_t data_cb, radpro_done_cb_t done_cb,
+			 void *user_data)
+{
+	return queue_push(cmd, len, timeout_ms, false, NULL, data_cb, done_cb, user_data);
+}
+
+int radpro_engine_submit_timed(const char *cmd, size_t len, uint32_t timeout_ms,
+			       radpro_data_cb_t data_cb, radpro_done_cb_t done_cb,
+			       void *user_data)
+{
+	return queue_push(cmd, len, timeout_ms, true, NULL, data_cb, done_cb, user_data);
+}
+
+int radpro_engine_submit_local(const char *cmd, size_t len, radpro_local_cb_t local_cb,
+			       radpro_data_cb_t data_cb, radpro_done_cb_t done_cb,
+			       void *user_data)
+{
+	return queue_push(cmd, len, 0, false, local_cb, data_cb, done_cb, user_data);
+}
+
+void radpro_engine_uart_rx(const uint8_t *data, size_t len)
+{
+	while (len > 0) {
+		const uint8_t *eol = memchr(data, '\n', len);
+		size_t n = eol ? (size_t)(eol - data) + 1 : len;
+		radpro_data_cb_t data_cb = NULL;
+		radpro_done_cb_t done_cb = NULL;
+		void *user_data = NULL;
+		bool completed = false;
+		bool timed = false;
+		uint32_t queued_at = 0;
+		uint32_t first_at = 0;
+		int status = 0;
+
+		k_mutex_lock(&engine_lock, K_FOREVER);
+
+		switch (state) {
+		case ENGINE_IDLE:
+		case ENGINE_LOCAL:
+			data_cb = unsolicited_callback;
+			break;
+
+		case ENGINE_RESYNC:
+			/* Late reply to a timed-out command - drop it */
+			timeout_arm(timeout_seq, RADPRO_RESYNC_MS);
+			break;
+
+		case ENGINE_BUSY: {
+			struct radpro_cmd *cmd = &cmd_queue[queue_head];
+			size_t copy = MIN(n, sizeof(line_prefix) - prefix_len);
+
+			if (prefix_len == 0 && cmd->timed) {
+				uint32_t now = radpro_latency_stamp();
+
+				radpro_latency_record(RADPRO_LATENCY_DEVICE, stage_at, now);
+				stage_at = now;
+			}
+
+			memcpy(&line_prefix[prefix_len], data, copy);
+			prefix_len += copy;
+
+			data_cb = cmd->data_cb;
+			user_data = cmd->user_data;
+
+			if (eol) {
+				status = classify_response();
+				done_cb = cmd->done_cb;
+				timed = cmd->timed;
+				queued_at = cmd->queued_at;
+				first_at = stage_at;
+				completed = true;
+				queue_pop();
+				state = ENGINE_IDLE;
+				k_work_cancel_delayable(&timeout_work);
+			} else {
+				/* Long responses (datalog) stream in; timeout is on silence */
+				timeout_arm(cmd->seq, cmd->timeout_ms);
+			}
+			break;
+		}
+		}
+
+		k_mutex_unlock(&engine_lock);
+
+		if (data_cb) {
+			data_cb(data, n, user_data);
+		}
+
+		if (completed) {
+			if (timed) {
+				/* The line end flushed the reply to the BLE stack in data_cb */
+				uint32_t now = radpro_latency_stamp();
+
+				radpro_latency_record(RADPRO_LATENCY_REPLY, first_at, now);
+				radpro_latency_record(RADPRO_LATENCY_TOTAL, queued_at, now);
+			}
+
+			if (done_cb) {
+				done_cb(status, user_data);
+			}
+			engine_kick();
+		}
+
+		data += n;
+		len -= n;
+	}
+}
+
+int radpro_engine_pending(void)
+{
+	return queue_count;
+}
@@ -0,0 +1,131 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Protocol Engine - Header
+ *
+ * Serializes commands to the RadPro line protocol (docs/comm.md): commands
+ * are queued, exactly one is outstanding on the UART, and the `OK ...` /
+ * `ERROR` line that follows is routed back to the command that caused it.
+ */
+
+#ifndef RADPRO_ENGINE_H
+#define RADPRO_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Longest command line accepted, excluding the "\r\n" terminator */
+#define RADPRO_CMD_MAX_LEN 78
+
+/**
+ * @brief Callback for response bytes of a command
+ *
+ * Called as response bytes arrive, possibly several times per line; the
+ * final call ends with the line's "\r\n".
+ *
+ * @param data Response bytes
+ * @param len Number of bytes
+ * @param user_data User data passed to radpro_engine_submit()
+ */
+typedef void (*radpro_data_cb_t)(const uint8_t *data, size_t len, void *user_data);
+
+/**
+ * @brief Callback for command completion
+ * @param status 0 for an `OK` response, -EIO for `ERROR`, -EBADMSG for any
+ *        other line, -ETIMEDOUT if the response did not complete in time,
+ *        other negative errno if the command could not be sent
+ * @param user_data User data passed to radpro_engine_submit()
+ */
+typedef void (*radpro_done_cb_t)(int status, void *user_data);
+
+/**
+ * @brief Callback answering a command on the bridge instead of the device
+ *
+ * Runs on the engine's own work queue when the command reaches the head
+ * of the queue, so its response is ordered with the device's; it may
+ * block. It passes the response line, "\r\n" included, to data_cb.
+ *
+ * @param cmd Command text, without terminator
+ * @param len Length of cmd
+ * @param data_cb Data callback of the command
+ * @param user_data User data of the command
+ * @return Completion status, as passed to the done callback
+ */
+typedef int (*radpro_local_cb_t)(const char *cmd, size_t len, radpro_data_cb_t data_cb,
+				 void *user_data);
+
+/**
+ * @brief Initialize the protocol engine
+ * @param unsolicited_cb Receives UART bytes while no command is outstanding
+ *        (may be NULL)
+ * @return 0 on success, negative errno on failure
+ */
+int radpro_engine_init(radpro_data_cb_t unsolicited_cb);
+
+/**
+ * @brief Queue a command for the RadPro device
+ * @param cmd Command text, with or without the "\r\n" terminator
+ * @param len Length of cmd
+ * @param timeout_ms Maximum silence while waiting for the response
+ * @param data_cb Receives the response bytes (may be NULL)
+ * @param done_cb Called once when the command completes (may be NULL)
+ * @param user_data Passed to both callbacks
+ * @return 0 on success, -EINVAL for an empty or oversized command,
+ *         -ENOSPC if the queue is full
+ */
+int radpro_engine_submit(const char *cmd, size_t len, uint32_t timeout_ms,
+			 radpro_data_cb_t data_cb, radpro_done_cb_t done_cb,
+			 void *user_data);
+
+/**
+ * @brief Queue a command for the RadPro device and time it
+ *
+ * Like radpro_engine_submit(), but the command's stages are recorded in
+ * the latency histograms (radpro_latency.h). For the commands clients
+ * send; the bridge's own polls would skew what clients see.
+ *
+ * @param cmd Command text, with or without the "\r\n" terminator
+ * @param len Length of cmd
+ * @param timeout_ms Maximum silence while waiting for the response
+ * @param data_cb Receives the response bytes (may be NULL)
+ * @param done_cb Called once when the command completes (may be NULL)
+ * @param user_data Passed to both callbacks
+ * @return 0 on success, -EINVAL for an empty or oversized command,
+ *         -ENOSPC if the queue is full
+ */
+int radpro_engine_submit_timed(const char *cmd, size_t len, uint32_t timeout_ms,
+			       radpro_data_cb_t data_cb, radpro_done_cb_t done_cb,
+			       void *user_data);
+
+/**
+ * @brief Queue a command answered by the bridge itself
+ *
+ * Takes its turn in the queue like radpro_engine_submit(), but local_cb
+ * produces the response and the UART stays idle meanwhile.
+ *
+ * @param cmd Command text, with or without the "\r\n" terminator
+ * @param len Length of cmd
+ * @param local_cb Produces the response
+ * @param data_cb Receives the response bytes (may be NULL)
+ * @param done_cb Called once when the command completes (may be NULL)
+ * @param user_data Passed to all callbacks
+ * @return 0 on success, -EINVAL for an empty or oversized command,
+ *         -ENOSPC if the queue is full
+ */
+int radpro_engine_submit_local(const char *cmd, size_t len, radpro_local_cb_t local_cb,
+			       radpro_data_cb_t data_cb, radpro_done_cb_t done_cb,
+			       void *user_data);
+
+/**
+ * @brief Feed bytes received from the RadPro UART
+ * @param data Received bytes
+ * @param len Number of bytes
+ */
+void radpro_engine_uart_rx(const uint8_t *data, size_t len);
+
+/**
+ * @brief Get number of commands waiting or in progress
+ * @return Queued commands, including the outstanding one
+ */
+int radpro_engine_pending(void);
+
+#endif /* RADPRO_ENGINE_H */
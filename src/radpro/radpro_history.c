@@ -0,0 +1,160 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Sample History - Implementation
+ */
+
+#include "radpro_history.h"
+#include "radpro_sampler.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(radpro_history, LOG_LEVEL_INF);
+
+/* Interval being accumulated */
+struct history_acc {
+	uint32_t interval;  /* Interval number: uptime / period */
+	uint32_t samples;   /* 0 while no interval is open */
+	uint64_t cpm_sum;
+	uint32_t cpm_min;
+	uint32_t cpm_max;
+	uint32_t raw_count;
+};
+
+struct history_tier {
+	struct radpro_history_point *ring;
+	uint16_t len;
+	uint16_t period_s;
+	uint32_t total;  /* Intervals stored since init */
+	struct history_acc acc;
+};
+
+static struct radpro_history_point second_ring[RADPRO_HISTORY_SECOND_LEN];
+static struct radpro_history_point minute_ring[RADPRO_HISTORY_MINUTE_LEN];
+static struct radpro_history_point ten_min_ring[RADPRO_HISTORY_10MIN_LEN];
+
+/* Tiers - protected by history_lock */
+static struct history_tier tiers[RADPRO_HISTORY_TIERS] = {
+	[RADPRO_HISTORY_SECOND] = {
+		.ring = second_ring,
+		.len = RADPRO_HISTORY_SECOND_LEN,
+		.period_s = 1,
+	},
+	[RADPRO_HISTORY_MINUTE] = {
+		.ring = minute_ring,
+		.len = RADPRO_HISTORY_MINUTE_LEN,
+		.period_s = 60,
+	},
+	[RADPRO_HISTORY_10MIN] = {
+		.ring = ten_min_ring,
+		.len = RADPRO_HISTORY_10MIN_LEN,
+		.period_s = 600,
+	},
+};
+static K_MUTEX_DEFINE(history_lock);
+
+/* Caller must hold history_lock */
+static void store_interval(struct history_tier *tier)
+{
+	struct history_acc *acc = &tier->acc;
+	struct radpro_history_point *point = &tier->ring[tier->total % tier->len];
+
+	point->start_s = acc->interval * tier->period_s;
+	point->raw_count = acc->raw_count;
+	point->cpm_min_x100 = acc->cpm_min;
+	point->cpm_avg_x100 = (uint32_t)(acc->cpm_sum / acc->samples);
+	point->cpm_max_x100 = acc->cpm_max;
+	tier->total++;
+}
+
+/* Caller must hold history_lock */
+static void add_sample(struct history_tier *tier, uint32_t now_s,
+		       const struct radpro_sample *sample)
+{
+	struct history_acc *acc = &tier->acc;
+	uint32_t interval = now_s / tier->period_s;
+	uint32_t cpm = sample->cpm_short_x100;
+
+	if (acc->samples > 0 && interval != acc->interval) {
+		store_interval(tier);
+		acc->samples = 0;
+	}
+
+	if (acc->samples == 0) {
+		acc->interval = interval;
+		acc->cpm_sum = 0;
+		acc->cpm_min = cpm;
+		acc->cpm_max = cpm;
+	}
+
+	acc->samples++;
+	acc->cpm_sum += cpm;
+	acc->cpm_min = MIN(acc->cpm_min, cpm);
+	acc->cpm_max = MAX(acc->cpm_max, cpm);
+	acc->raw_count = sample->raw_count;
+}
+
+/* Sampler listener */
+static void on_sample(const struct radpro_sample *sample)
+{
+	uint32_t now_s = (uint32_t)(sample->uptime_ms / 1000);
+
+	k_mutex_lock(&history_lock, K_FOREVER);
+	for (int i = 0; i < RADPRO_HISTORY_TIERS; i++) {
+		add_sample(&tiers[i], now_s, sample);
+	}
+	k_mutex_unlock(&history_lock);
+}
+
+/* Public API */
+int radpro_history_init(void)
+{
+	int err;
+
+	k_mutex_lock(&history_lock, K_FOREVER);
+	for (int i = 0; i < RADPRO_HISTORY_TIERS; i++) {
+		tiers[i].total = 0;
+		memset(&tiers[i].acc, 0, sizeof(tiers[i].acc));
+	}
+	k_mutex_unlock(&history_lock);
+
+	err = radpro_sampler_add_listener(on_sample);
+	if (err) {
+		LOG_ERR("Failed to subscribe to sampler: %d", err);
+		return err;
+	}
+
+	return 0;
+}
+
+uint32_t radpro_history_period_s(uint8_t tier)
+{
+	return tier < RADPRO_HISTORY_TIERS ? tiers[tier].period_s : 0;
+}
+
+int radpro_history_read(uint8_t tier, uint32_t *seq, struct radpro_history_point *point)
+{
+	struct history_tier *t;
+	int ret = -ENODATA;
+
+	if (tier >= RADPRO_HISTORY_TIERS) {
+		return -EINVAL;
+	}
+
+	t = &tiers[tier];
+
+	k_mutex_lock(&history_lock, K_FOREVER);
+	if (t->total > t->len && *seq < t->total - t->len) {
+		/* Overwritten - continue with the oldest one left */
+		*seq = t->total - t->len;
+	}
+	if (*seq < t->total) {
+		*point = t->ring[*seq % t->len];
+		(*seq)++;
+		ret = 0;
+	}
+	k_mutex_unlock(&history_lock);
+
+	return ret;
+}
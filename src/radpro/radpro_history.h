@@ -0,0 +1,68 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Sample History - Header
+ *
+ * Keeps recent pulse sampler readings in RAM so a central that connects
+ * can draw a chart at once instead of downloading the datalog. Samples
+ * are downsampled into tiers of fixed-length intervals; each tier is a
+ * ring holding the CPM minimum, average and maximum of its most recent
+ * intervals:
+ *   second   1 s intervals, last 5 minutes
+ *   minute   1 min intervals, last hour
+ *   10 min   10 min intervals, last day
+ * An interval is stored once the first sample of the next one arrives.
+ */
+
+#ifndef RADPRO_HISTORY_H
+#define RADPRO_HISTORY_H
+
+#include <stdint.h>
+
+/* Tiers, finest first */
+#define RADPRO_HISTORY_SECOND 0
+#define RADPRO_HISTORY_MINUTE 1
+#define RADPRO_HISTORY_10MIN 2
+#define RADPRO_HISTORY_TIERS 3
+
+/* Intervals kept per tier */
+#define RADPRO_HISTORY_SECOND_LEN 300
+#define RADPRO_HISTORY_MINUTE_LEN 60
+#define RADPRO_HISTORY_10MIN_LEN 144
+
+/** One interval of a tier */
+struct radpro_history_point {
+	uint32_t start_s;       /* Uptime at the start of the interval (s) */
+	uint32_t raw_count;     /* tubePulseCount at the last sample */
+	uint32_t cpm_min_x100;  /* Short-window CPM over the interval, in 1/100 */
+	uint32_t cpm_avg_x100;
+	uint32_t cpm_max_x100;
+};
+
+/**
+ * @brief Initialize the history and subscribe to the pulse sampler
+ * @return 0 on success, negative errno on failure
+ */
+int radpro_history_init(void);
+
+/**
+ * @brief Get the interval length of a tier
+ * @param tier RADPRO_HISTORY_SECOND, _MINUTE or _10MIN
+ * @return Interval length in seconds
+ */
+uint32_t radpro_history_period_s(uint8_t tier);
+
+/**
+ * @brief Read the next stored interval of a tier, oldest first
+ *
+ * Start with *seq = 0. Intervals overwritten since the previous call are
+ * skipped, so a slow reader never sees a mix of old and new data.
+ *
+ * @param tier Tier to read
+ * @param seq Position in the tier, advanced past the interval read
+ * @param point Receives the interval
+ * @return 0 on success, -ENODATA if there is no newer interval,
+ *         -EINVAL for an unknown tier
+ */
+int radpro_history_read(uint8_t tier, uint32_t *seq, struct radpro_history_point *point);
+
+#endif /* RADPRO_HISTORY_H */
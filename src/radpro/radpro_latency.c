@@ -0,0 +1,113 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Command Latency - Implementation
+ */
+
+#include "radpro_latency.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(radpro_latency, LOG_LEVEL_INF);
+
+/* Updated with atomics from the BLE RX, UART RX and workqueue threads */
+struct latency_stage {
+	atomic_t max_us;
+	atomic_t buckets[RADPRO_LATENCY_BUCKETS];
+};
+
+static struct latency_stage stages[RADPRO_LATENCY_STAGES];
+
+static const char *const stage_names[RADPRO_LATENCY_STAGES] = {
+	[RADPRO_LATENCY_QUEUE] = "queue",
+	[RADPRO_LATENCY_DEVICE] = "device",
+	[RADPRO_LATENCY_REPLY] = "reply",
+	[RADPRO_LATENCY_TOTAL] = "total",
+};
+
+static unsigned int bucket_of(uint32_t us)
+{
+	if (us < 2) {
+		return 0;
+	}
+
+	return MIN(31 - __builtin_clz(us), RADPRO_LATENCY_BUCKETS - 1);
+}
+
+/* Bound (us) on the given fraction of samples: the top of the bucket
+ * reaching it, or the maximum if that is lower */
+static uint32_t percentile_us(const struct radpro_latency_hist *hist, uint32_t count,
+			      uint32_t percent)
+{
+	uint32_t target = (uint32_t)(((uint64_t)count * percent + 99) / 100);
+	uint32_t seen = 0;
+
+	for (int b = 0; b < RADPRO_LATENCY_BUCKETS - 1; b++) {
+		seen += hist->buckets[b];
+		if (seen >= target) {
+			return MIN(BIT(b + 1) - 1, hist->max_us);
+		}
+	}
+
+	return hist->max_us;
+}
+
+/* Public API */
+void radpro_latency_record(enum radpro_latency_stage stage, uint32_t start, uint32_t end)
+{
+	struct latency_stage *s = &stages[stage];
+	uint32_t us = k_cyc_to_us_floor32(end - start);
+	atomic_val_t max;
+
+	atomic_inc(&s->buckets[bucket_of(us)]);
+
+	do {
+		max = atomic_get(&s->max_us);
+		if (us <= (uint32_t)max) {
+			break;
+		}
+	} while (!atomic_cas(&s->max_us, max, us));
+}
+
+void radpro_latency_get(enum radpro_latency_stage stage, struct radpro_latency_hist *hist)
+{
+	struct latency_stage *s = &stages[stage];
+
+	hist->max_us = atomic_get(&s->max_us);
+	for (int b = 0; b < RADPRO_LATENCY_BUCKETS; b++) {
+		hist->buckets[b] = atomic_get(&s->buckets[b]);
+	}
+}
+
+void radpro_latency_reset(void)
+{
+	for (int i = 0; i < RADPRO_LATENCY_STAGES; i++) {
+		atomic_clear(&stages[i].max_us);
+		for (int b = 0; b < RADPRO_LATENCY_BUCKETS; b++) {
+			atomic_clear(&stages[i].buckets[b]);
+		}
+	}
+}
+
+void radpro_latency_log(void)
+{
+	struct radpro_latency_hist hist;
+
+	for (int i = 0; i < RADPRO_LATENCY_STAGES; i++) {
+		uint32_t count = 0;
+
+		radpro_latency_get(i, &hist);
+		for (int b = 0; b < RADPRO_LATENCY_BUCKETS; b++) {
+			count += hist.buckets[b];
+		}
+
+		if (count == 0) {
+			continue;
+		}
+
+		LOG_INF("%-6s n=%u p50<=%u p90<=%u p99<=%u max=%u us", stage_names[i], count,
+			percentile_us(&hist, count, 50), percentile_us(&hist, count, 90),
+			percentile_us(&hist, count, 99), hist.max_us);
+	}
+}
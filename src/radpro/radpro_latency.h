@@ -0,0 +1,95 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Command Latency - Header
+ *
+ * Per-stage latency histograms of the client commands the protocol engine
+ * sends to the device, timed with the kernel's hardware cycle counter:
+ *   queue   queued (the BLE write that carried it) -> written to the UART
+ *   device  written to the UART -> first reply byte
+ *   reply   first reply byte -> last chunk handed to the BLE stack
+ *   total   queued -> last chunk handed to the BLE stack
+ * so slow responses can be pinned on the bridge's queue, the device or
+ * the BLE link. Only commands queued with radpro_engine_submit_timed()
+ * are timed: neither those answered on the bridge nor the bridge's own
+ * polls and fetches, which would skew what clients see.
+ *
+ * Bucket 0 counts latencies below 2 us, bucket b [2^b, 2^(b+1)) us and
+ * the last bucket everything from 2^(RADPRO_LATENCY_BUCKETS - 1) us up.
+ */
+
+#ifndef RADPRO_LATENCY_H
+#define RADPRO_LATENCY_H
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+#define RADPRO_LATENCY_BUCKETS 24
+
+enum radpro_latency_stage {
+	RADPRO_LATENCY_QUEUE,
+	RADPRO_LATENCY_DEVICE,
+	RADPRO_LATENCY_REPLY,
+	RADPRO_LATENCY_TOTAL,
+	RADPRO_LATENCY_STAGES,
+};
+
+struct radpro_latency_hist {
+	uint32_t max_us;
+	uint32_t buckets[RADPRO_LATENCY_BUCKETS];
+};
+
+#if defined(CONFIG_RADPRO_LATENCY)
+
+/**
+ * @brief Take a timestamp for radpro_latency_record()
+ * @return Hardware cycle count
+ */
+static inline uint32_t radpro_latency_stamp(void)
+{
+	return k_cycle_get_32();
+}
+
+/**
+ * @brief Add the time since a timestamp to a stage's histogram
+ * @param stage Stage measured
+ * @param start Timestamp from radpro_latency_stamp() at its start
+ * @param end Timestamp at its end
+ */
+void radpro_latency_record(enum radpro_latency_stage stage, uint32_t start, uint32_t end);
+
+/**
+ * @brief Copy a stage's histogram
+ * @param stage Stage
+ * @param hist Receives the histogram
+ */
+void radpro_latency_get(enum radpro_latency_stage stage, struct radpro_latency_hist *hist);
+
+/**
+ * @brief Clear all histograms
+ */
+void radpro_latency_reset(void);
+
+/**
+ * @brief Log a summary of every stage
+ */
+void radpro_latency_log(void);
+
+#else
+
+static inline uint32_t radpro_latency_stamp(void)
+{
+	return 0;
+}
+
+static inline void radpro_latency_record(enum radpro_latency_stage stage, uint32_t start,
+					 uint32_t end)
+{
+}
+
+static inline void radpro_latency_log(void)
+{
+}
+
+#endif /* CONFIG_RADPRO_LATENCY */
+
+#endif /* RADPRO_LATENCY_H */
@@ -0,0 +1,528 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Datalog Mirror - Implementation
+ */
+
+#include "radpro_mirror.h"
+#include "radpro_datalog.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(radpro_mirror, LOG_LEVEL_INF);
+
+#define MIRROR_PARTITION_ID FIXED_PARTITION_ID(datalog_partition)
+#define MIRROR_MAX_SECTORS 32
+#define MIRROR_MAGIC 0x4d4c5052  /* "RPLM" */
+#define MIRROR_VERSION 1
+
+#define MIRROR_PERIOD K_SECONDS(CONFIG_RADPRO_MIRROR_PERIOD_S)
+#define MIRROR_TIMEOUT_MS 2000
+
+/* Records per FCB entry - the per-entry overhead is padded to the
+ * write block size, so records are written in batches */
+#define MIRROR_BATCH 32
+
+/* Markers are stored as records with time 0, which the device never logs */
+#define MARK_SESSION 0  /* The next record starts a logging session */
+#define MARK_ORIGIN 1   /* First entry of a fresh mirror */
+
+static const char datalog_cmd[] = "GET datalog";
+static const char reply_head[] = "OK time,tubePulseCount";
+static const char line_end[] = "\r\n";
+
+/* Longest reply item: ";;4294967295,4294967295" */
+#define ITEM_MAX 24
+
+struct mirror_record {
+	uint32_t time;
+	uint32_t pulses;
+};
+
+/* Reply being built by radpro_mirror_serve() */
+struct serve_ctx {
+	uint32_t start;
+	uint32_t end;
+	bool session;  /* A session marker precedes the next record */
+	radpro_data_cb_t data_cb;
+	void *user_data;
+	char buf[128];
+	size_t len;
+};
+
+/* The FCB and read_buf are only used from engine commands (fetch
+ * callbacks and radpro_mirror_serve()), which never overlap */
+static struct fcb fcb;
+static struct flash_sector sectors[MIRROR_MAX_SECTORS];
+static struct mirror_record read_buf[MIRROR_BATCH];
+static bool ready;
+
+/* Extent of the mirror - protected by mirror_lock */
+static uint32_t newest_time;  /* Last record, 0 if empty */
+static uint32_t floor_time;   /* Records up to this time were dropped, 0 if none */
+static bool synced;           /* A fetch completed since boot */
+static K_MUTEX_DEFINE(mirror_lock);
+
+/* Fetch in progress */
+static struct radpro_datalog_enc fetch_enc;
+static struct mirror_record batch[MIRROR_BATCH];
+static uint8_t batch_len;
+static uint32_t fetch_after;
+static atomic_t fetch_pending;
+static struct k_work_delayable fetch_work;
+
+static bool is_marker(const struct mirror_record *rec, uint32_t mark)
+{
+	return rec->time == 0 && rec->pulses == mark;
+}
+
+/* Records of an FCB entry, read into read_buf; 0 for a malformed entry */
+static size_t read_entry(struct fcb_entry_ctx *ctx)
+{
+	size_t len = ctx->loc.fe_data_len;
+
+	if (len == 0 || len > sizeof(read_buf) || len % sizeof(read_buf[0])) {
+		return 0;
+	}
+
+	if (flash_area_read(ctx->fap, FCB_ENTRY_FA_DATA_OFF(ctx->loc), read_buf, len)) {
+		return 0;
+	}
+
+	return len / sizeof(read_buf[0]);
+}
+
+struct scan_ctx {
+	bool first_entry;
+	bool origin;  /* First entry is the origin marker: nothing dropped */
+	uint32_t oldest;
+	uint32_t newest;
+};
+
+static int scan_entry(struct fcb_entry_ctx *loc_ctx, void *arg)
+{
+	struct scan_ctx *ctx = arg;
+	size_t n = read_entry(loc_ctx);
+
+	if (ctx->first_entry && n > 0 && is_marker(&read_buf[0], MARK_ORIGIN)) {
+		ctx->origin = true;
+	}
+	ctx->first_entry = false;
+
+	for (size_t i = 0; i < n; i++) {
+		if (read_buf[i].time == 0) {
+			continue;
+		}
+		if (ctx->oldest == 0) {
+			ctx->oldest = read_buf[i].time;
+		}
+		ctx->newest = read_buf[i].time;
+	}
+
+	return 0;
+}
+
+/* Find the extent of the mirror after boot or a dropped sector */
+static int scan(void)
+{
+	struct scan_ctx ctx = { .first_entry = true };
+	int err = fcb_walk(&fcb, NULL, scan_entry, &ctx);
+
+	if (err) {
+		return err;
+	}
+
+	k_mutex_lock(&mirror_lock, K_FOREVER);
+	newest_time = ctx.newest;
+	floor_time = (ctx.origin || ctx.oldest == 0) ? 0 : ctx.oldest - 1;
+	k_mutex_unlock(&mirror_lock);
+
+	return 0;
+}
+
+static int append(const struct mirror_record *recs, size_t count)
+{
+	struct fcb_entry loc;
+	size_t len = count * sizeof(recs[0]);
+	bool rotated = false;
+	int err;
+
+	err = fcb_append(&fcb, len, &loc);
+	if (err == -ENOSPC) {
+		/* Full - drop the oldest sector */
+		err = fcb_rotate(&fcb);
+		if (!err) {
+			rotated = true;
+			err = fcb_append(&fcb, len, &loc);
+		}
+	}
+
+	if (!err) {
+		err = flash_area_write(fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), recs, len);
+	}
+
+	if (!err) {
+		err = fcb_append_finish(&fcb, &loc);
+	}
+
+	if (err) {
+		LOG_ERR("Failed to append %zu records: %d", count, err);
+		return err;
+	}
+
+	return rotated ? scan() : 0;
+}
+
+static void flush_batch(void)
+{
+	uint32_t newest = 0;
+
+	if (batch_len == 0) {
+		return;
+	}
+
+	for (uint8_t i = 0; i < batch_len; i++) {
+		if (batch[i].time != 0) {
+			newest = batch[i].time;
+		}
+	}
+
+	if (!append(batch, batch_len) && newest) {
+		k_mutex_lock(&mirror_lock, K_FOREVER);
+		newest_time = newest;
+		k_mutex_unlock(&mirror_lock);
+	}
+
+	batch_len = 0;
+}
+
+static void fetch_record(uint8_t head, uint32_t time, uint32_t pulses, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	if (head == RADPRO_DATALOG_SESSION) {
+		batch[batch_len].time = 0;
+		batch[batch_len].pulses = MARK_SESSION;
+	} else if (time > fetch_after) {
+		batch[batch_len].time = time;
+		batch[batch_len].pulses = pulses;
+		fetch_after = time;
+	} else {
+		/* Already mirrored, or the device clock went back */
+		return;
+	}
+
+	if (++batch_len == MIRROR_BATCH) {
+		flush_batch();
+	}
+}
+
+static void fetch_data(const uint8_t *data, size_t len, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	radpro_datalog_enc_feed(&fetch_enc, data, len, NULL, NULL);
+}
+
+static void fetch_done(int status, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	/* Complete records of a cut-off download are kept, the next fetch
+	 * continues after them */
+	flush_batch();
+
+	if (status == 0) {
+		k_mutex_lock(&mirror_lock, K_FOREVER);
+		synced = true;
+		k_mutex_unlock(&mirror_lock);
+	} else {
+		LOG_WRN("Datalog fetch failed: %d", status);
+	}
+
+	atomic_clear(&fetch_pending);
+}
+
+static void fetch_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	radpro_mirror_refresh();
+	k_work_reschedule(&fetch_work, MIRROR_PERIOD);
+}
+
+/* Arguments of "GET datalog [args]"; number of them, -EINVAL if it is
+ * another command or they are not numbers */
+static int parse_args(const char *cmd, size_t len, uint32_t *args, int max)
+{
+	char line[RADPRO_CMD_MAX_LEN + 1];
+	size_t n = sizeof(datalog_cmd) - 1;
+	char *p, *end;
+	int count = 0;
+
+	if (len < n || len > RADPRO_CMD_MAX_LEN || memcmp(cmd, datalog_cmd, n) ||
+	    (len > n && cmd[n] != ' ')) {
+		return -EINVAL;
+	}
+
+	memcpy(line, cmd, len);
+	line[len] = '\0';
+
+	for (p = &line[n]; *p != '\0'; p = end) {
+		unsigned long long value;
+
+		while (*p == ' ') {
+			p++;
+		}
+		if (*p == '\0') {
+			break;
+		}
+		if (count == max || *p < '0' || *p > '9') {
+			return -EINVAL;
+		}
+
+		value = strtoull(p, &end, 10);
+		if (value > UINT32_MAX || (*end != ' ' && *end != '\0')) {
+			return -EINVAL;
+		}
+		args[count++] = value;
+	}
+
+	return count;
+}
+
+static void serve_flush(struct serve_ctx *ctx)
+{
+	if (ctx->len > 0) {
+		ctx->data_cb((const uint8_t *)ctx->buf, ctx->len, ctx->user_data);
+		ctx->len = 0;
+	}
+}
+
+static void serve_put(struct serve_ctx *ctx, const char *text)
+{
+	size_t len = strlen(text);
+
+	if (ctx->len + len > sizeof(ctx->buf)) {
+		serve_flush(ctx);
+	}
+
+	memcpy(&ctx->buf[ctx->len], text, len);
+	ctx->len += len;
+}
+
+static int serve_entry(struct fcb_entry_ctx *loc_ctx, void *arg)
+{
+	struct serve_ctx *ctx = arg;
+	size_t n = read_entry(loc_ctx);
+	char item[ITEM_MAX];
+
+	for (size_t i = 0; i < n; i++) {
+		const struct mirror_record *rec = &read_buf[i];
+
+		if (is_marker(rec, MARK_SESSION)) {
+			ctx->session = true;
+		} else if (rec->time == 0) {
+			continue;
+		} else if (rec->time < ctx->start || rec->time > ctx->end) {
+			/* A session that started before the range is not marked */
+			ctx->session = false;
+		} else {
+			snprintf(item, sizeof(item), "%s;%u,%u", ctx->session ? ";" : "",
+				 rec->time, rec->pulses);
+			serve_put(ctx, item);
+			ctx->session = false;
+		}
+	}
+
+	return 0;
+}
+
+static const struct mirror_record origin = { .time = 0, .pulses = MARK_ORIGIN };
+
+/* Public API */
+int radpro_mirror_init(void)
+{
+	const struct flash_area *fa;
+	uint32_t count = ARRAY_SIZE(sectors);
+	int err;
+
+	k_work_init_delayable(&fetch_work, fetch_work_handler);
+	atomic_clear(&fetch_pending);
+	batch_len = 0;
+	synced = false;
+	ready = false;
+
+	err = flash_area_get_sectors(MIRROR_PARTITION_ID, &count, sectors);
+	if (err) {
+		LOG_ERR("Datalog partition unavailable: %d", err);
+		return err;
+	}
+
+	memset(&fcb, 0, sizeof(fcb));
+	fcb.f_magic = MIRROR_MAGIC;
+	fcb.f_version = MIRROR_VERSION;
+	fcb.f_sector_cnt = count;
+	fcb.f_sectors = sectors;
+
+	err = fcb_init(MIRROR_PARTITION_ID, &fcb);
+	if (err) {
+		/* Another format or corrupted - start over */
+		LOG_WRN("Erasing datalog partition (%d)", err);
+		err = flash_area_open(MIRROR_PARTITION_ID, &fa);
+		if (!err) {
+			err = flash_area_erase(fa, 0, fa->fa_size);
+			flash_area_close(fa);
+		}
+		if (!err) {
+			err = fcb_init(MIRROR_PARTITION_ID, &fcb);
+		}
+		if (err) {
+			LOG_ERR("Datalog partition init failed: %d", err);
+			return err;
+		}
+	}
+
+	if (fcb_is_empty(&fcb)) {
+		err = append(&origin, 1);
+	}
+
+	if (!err) {
+		err = scan();
+	}
+
+	if (err) {
+		LOG_ERR("Datalog mirror scan failed: %d", err);
+		return err;
+	}
+
+	ready = true;
+	LOG_INF("Datalog mirror: %u sectors, newest record %u", count, newest_time);
+	return 0;
+}
+
+int radpro_mirror_start(void)
+{
+	if (!ready) {
+		return -ENODEV;
+	}
+
+	LOG_INF("Mirroring the datalog every %d s", CONFIG_RADPRO_MIRROR_PERIOD_S);
+	k_work_reschedule(&fetch_work, K_NO_WAIT);
+	return 0;
+}
+
+void radpro_mirror_refresh(void)
+{
+	char cmd[RADPRO_CMD_MAX_LEN];
+	int len;
+	int err;
+
+	if (!ready || !atomic_cas(&fetch_pending, 0, 1)) {
+		return;
+	}
+
+	k_mutex_lock(&mirror_lock, K_FOREVER);
+	fetch_after = newest_time;
+	k_mutex_unlock(&mirror_lock);
+
+	/* The whole log the first time, then what was logged since */
+	if (fetch_after > 0 && fetch_after < UINT32_MAX) {
+		len = snprintf(cmd, sizeof(cmd), "%s %u", datalog_cmd, fetch_after + 1);
+	} else {
+		len = snprintf(cmd, sizeof(cmd), "%s", datalog_cmd);
+	}
+
+	radpro_datalog_enc_init(&fetch_enc);
+	radpro_datalog_enc_set_record_cb(&fetch_enc, fetch_record, NULL);
+
+	err = radpro_engine_submit(cmd, len, MIRROR_TIMEOUT_MS, fetch_data, fetch_done, NULL);
+	if (err) {
+		LOG_WRN("Failed to queue datalog fetch: %d", err);
+		atomic_clear(&fetch_pending);
+	}
+}
+
+int radpro_mirror_clear(void)
+{
+	int err;
+
+	if (!ready) {
+		return -ENODEV;
+	}
+
+	/* Stop serving before the old records go */
+	k_mutex_lock(&mirror_lock, K_FOREVER);
+	synced = false;
+	k_mutex_unlock(&mirror_lock);
+
+	/* Runs in the reset's done callback, so no fetch or serve overlaps */
+	err = fcb_clear(&fcb);
+	if (!err) {
+		err = append(&origin, 1);
+	}
+	if (!err) {
+		err = scan();
+	}
+
+	if (err) {
+		LOG_ERR("Datalog mirror clear failed: %d", err);
+		ready = false;
+		return err;
+	}
+
+	LOG_INF("Datalog mirror cleared");
+	radpro_mirror_refresh();
+	return 0;
+}
+
+bool radpro_mirror_covers(const char *cmd, size_t len)
+{
+	uint32_t args[2] = { 0 };
+	bool covered;
+
+	if (!ready || parse_args(cmd, len, args, ARRAY_SIZE(args)) < 0) {
+		return false;
+	}
+
+	k_mutex_lock(&mirror_lock, K_FOREVER);
+	covered = synced && (floor_time == 0 || args[0] > floor_time);
+	k_mutex_unlock(&mirror_lock);
+
+	return covered;
+}
+
+int radpro_mirror_serve(const char *cmd, size_t len, radpro_data_cb_t data_cb,
+			void *user_data)
+{
+	static struct serve_ctx ctx;
+	uint32_t args[2] = { 0, UINT32_MAX };
+	int err;
+
+	if (parse_args(cmd, len, args, ARRAY_SIZE(args)) < 0) {
+		return -EINVAL;
+	}
+
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.start = args[0];
+	ctx.end = args[1];
+	ctx.data_cb = data_cb;
+	ctx.user_data = user_data;
+
+	serve_put(&ctx, reply_head);
+	err = fcb_walk(&fcb, NULL, serve_entry, &ctx);
+	serve_put(&ctx, line_end);
+	serve_flush(&ctx);
+
+	if (err) {
+		LOG_ERR("Datalog mirror read failed: %d", err);
+		return -EIO;
+	}
+
+	return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Datalog Mirror - Header
+ *
+ * Copies the device's datalog into a flash partition of the bridge
+ * (`datalog_partition`), fetching only new records (GET datalog <last+1>)
+ * over the UART in the background. The device pauses logging while a
+ * download runs (docs/comm.md); with the mirror that is only the short
+ * UART transfer of a few new records, however slowly the BLE client
+ * reads. BLE downloads of a time range the mirror covers are answered
+ * from flash, in the device's ASCII format, after a catch-up fetch.
+ *
+ * The partition is a flash circular buffer (FCB): records are appended
+ * in batches and the oldest sector is dropped when it fills up.
+ */
+
+#ifndef RADPRO_MIRROR_H
+#define RADPRO_MIRROR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "radpro_engine.h"
+
+/**
+ * @brief Open the mirror partition and find the newest record
+ * @return 0 on success, negative errno on failure
+ */
+int radpro_mirror_init(void);
+
+/**
+ * @brief Start fetching new records periodically
+ * @return 0 on success, negative errno if the mirror is not initialized
+ */
+int radpro_mirror_start(void);
+
+/**
+ * @brief Fetch new records now
+ *
+ * Queued on the protocol engine, so a command queued after it sees the
+ * records it fetched. Does nothing if a fetch is already queued.
+ */
+void radpro_mirror_refresh(void);
+
+/**
+ * @brief Drop the mirrored records after the device's datalog was reset
+ *
+ * Call from the done callback of a `RESET datalog` that completed OK.
+ * Requests are left to the device until a fetch of the new log
+ * completes; one is queued right away.
+ *
+ * @return 0 on success, negative errno if the partition could not be
+ *         erased (the mirror then serves nothing until reboot)
+ */
+int radpro_mirror_clear(void);
+
+/**
+ * @brief Check whether a datalog request can be answered by the mirror
+ *
+ * True for `GET datalog [start] [end]` once a fetch has completed since
+ * boot, unless records from start onwards were dropped from the mirror
+ * but may still be on the device. Requests with a record limit are left
+ * to the device.
+ *
+ * @param cmd Command text, without terminator
+ * @param len Length of cmd
+ * @return true if radpro_mirror_serve() can answer it
+ */
+bool radpro_mirror_covers(const char *cmd, size_t len);
+
+/**
+ * @brief Answer a datalog request from the mirror
+ *
+ * Local callback for radpro_engine_submit_local(). Produces the same
+ * `OK time,tubePulseCount;...` line the device would.
+ *
+ * @return 0 on success, -EIO if the partition could not be read
+ */
+int radpro_mirror_serve(const char *cmd, size_t len, radpro_data_cb_t data_cb,
+			void *user_data);
+
+#endif /* RADPRO_MIRROR_H */
@@ -0,0 +1,247 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Pulse Sampler - Implementation
+ */
+
+#include "radpro_sampler.h"
+#include "radpro_engine.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(radpro_sampler, LOG_LEVEL_INF);
+
+#define SAMPLER_PERIOD K_MSEC(CONFIG_RADPRO_SAMPLER_PERIOD_MS)
+#define SAMPLER_TIMEOUT_MS 1000
+#define SAMPLER_MAX_LISTENERS 4
+
+/* A larger delta than this rate allows is a counter reset (device restart
+ * or SET tubePulseCount), not a wraparound - GM tubes saturate far below */
+#define SAMPLER_MAX_CPS 100000
+
+static const char sample_cmd[] = "GET tubePulseCount";
+
+struct history_entry {
+	int64_t uptime_ms;
+	uint64_t pulse_count;
+};
+
+/* History and latest sample - protected by sampler_lock */
+static struct history_entry history[RADPRO_SAMPLER_HISTORY];
+static uint8_t history_head;   /* Index of the newest entry */
+static uint8_t history_count;
+static struct radpro_sample latest;
+static bool latest_valid;
+static K_MUTEX_DEFINE(sampler_lock);
+
+/* Response line of the outstanding request */
+static char resp_buf[24];
+static size_t resp_len;
+static atomic_t request_pending;
+
+static radpro_sample_cb_t listeners[SAMPLER_MAX_LISTENERS];
+static struct k_work_delayable sample_work;
+
+/* Caller must hold sampler_lock */
+static uint32_t window_cpm_x100(int64_t now, uint64_t count, uint32_t window_s)
+{
+	const struct history_entry *oldest = NULL;
+	int64_t span;
+
+	/* Walk back from the newest entry to the oldest one inside the window */
+	for (uint8_t i = 1; i < history_count; i++) {
+		uint8_t idx = (history_head + RADPRO_SAMPLER_HISTORY - i) % RADPRO_SAMPLER_HISTORY;
+
+		if (now - history[idx].uptime_ms > (int64_t)window_s * 1000) {
+			break;
+		}
+		oldest = &history[idx];
+	}
+
+	if (!oldest) {
+		return 0;
+	}
+
+	span = now - oldest->uptime_ms;
+	if (span <= 0) {
+		return 0;
+	}
+
+	return (uint32_t)((count - oldest->pulse_count) * 60U * 1000U * 100U / span);
+}
+
+/* Caller must hold sampler_lock */
+static void history_reset(int64_t now, uint32_t raw_count)
+{
+	history_head = 0;
+	history_count = 1;
+	history[0].uptime_ms = now;
+	history[0].pulse_count = 0;
+	latest.raw_count = raw_count;
+	latest.pulse_count = 0;
+	latest_valid = false;
+}
+
+static void process_count(uint32_t raw_count)
+{
+	int64_t now = k_uptime_get();
+	struct radpro_sample sample;
+	uint32_t delta;
+	int64_t span;
+
+	k_mutex_lock(&sampler_lock, K_FOREVER);
+
+	if (history_count == 0) {
+		history_reset(now, raw_count);
+		k_mutex_unlock(&sampler_lock);
+		return;
+	}
+
+	/* Unsigned subtraction handles the 2^32 wraparound */
+	delta = raw_count - latest.raw_count;
+	span = now - history[history_head].uptime_ms;
+
+	if ((uint64_t)delta * 1000U > (uint64_t)SAMPLER_MAX_CPS * MAX(span, 1)) {
+		LOG_INF("Pulse counter reset (%u -> %u)", latest.raw_count, raw_count);
+		history_reset(now, raw_count);
+		k_mutex_unlock(&sampler_lock);
+		return;
+	}
+
+	history_head = (history_head + 1) % RADPRO_SAMPLER_HISTORY;
+	if (history_count < RADPRO_SAMPLER_HISTORY) {
+		history_count++;
+	}
+	history[history_head].uptime_ms = now;
+	history[history_head].pulse_count = latest.pulse_count + delta;
+
+	latest.uptime_ms = now;
+	latest.pulse_count += delta;
+	latest.raw_count = raw_count;
+	latest.delta = delta;
+	latest.cpm_short_x100 = window_cpm_x100(now, latest.pulse_count,
+						RADPRO_SAMPLER_SHORT_WINDOW_S);
+	latest.cpm_long_x100 = window_cpm_x100(now, latest.pulse_count,
+					       RADPRO_SAMPLER_LONG_WINDOW_S);
+	latest_valid = true;
+	sample = latest;
+
+	k_mutex_unlock(&sampler_lock);
+
+	LOG_DBG("Pulses %u (+%u), CPM %u.%02u", raw_count, delta,
+		sample.cpm_short_x100 / 100, sample.cpm_short_x100 % 100);
+
+	for (int i = 0; i < SAMPLER_MAX_LISTENERS; i++) {
+		if (listeners[i]) {
+			listeners[i](&sample);
+		}
+	}
+}
+
+static void sampler_data(const uint8_t *data, size_t len, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	len = MIN(len, sizeof(resp_buf) - 1 - resp_len);
+	memcpy(&resp_buf[resp_len], data, len);
+	resp_len += len;
+}
+
+static void sampler_done(int status, void *user_data)
+{
+	char *end;
+	unsigned long count;
+
+	ARG_UNUSED(user_data);
+
+	resp_buf[resp_len] = '\0';
+	resp_len = 0;
+	atomic_clear(&request_pending);
+
+	if (status) {
+		LOG_WRN("tubePulseCount request failed: %d", status);
+		return;
+	}
+
+	count = strtoul(&resp_buf[3], &end, 10);
+	if (end == &resp_buf[3] || (*end != '\r' && *end != '\n')) {
+		LOG_WRN("Unexpected tubePulseCount response");
+		return;
+	}
+
+	process_count((uint32_t)count);
+}
+
+static void sample_work_handler(struct k_work *work)
+{
+	int err;
+
+	ARG_UNUSED(work);
+
+	/* Skip this period if the previous request is still queued */
+	if (atomic_cas(&request_pending, 0, 1)) {
+		err = radpro_engine_submit(sample_cmd, sizeof(sample_cmd) - 1,
+					   SAMPLER_TIMEOUT_MS, sampler_data,
+					   sampler_done, NULL);
+		if (err) {
+			LOG_WRN("Failed to queue tubePulseCount: %d", err);
+			atomic_clear(&request_pending);
+		}
+	}
+
+	k_work_reschedule(&sample_work, SAMPLER_PERIOD);
+}
+
+/* Public API */
+int radpro_sampler_init(void)
+{
+	k_work_init_delayable(&sample_work, sample_work_handler);
+
+	k_mutex_lock(&sampler_lock, K_FOREVER);
+	history_head = 0;
+	history_count = 0;
+	memset(&latest, 0, sizeof(latest));
+	latest_valid = false;
+	k_mutex_unlock(&sampler_lock);
+
+	resp_len = 0;
+	atomic_clear(&request_pending);
+	memset(listeners, 0, sizeof(listeners));
+
+	return 0;
+}
+
+int radpro_sampler_start(void)
+{
+	LOG_INF("Sampling tubePulseCount every %d ms", CONFIG_RADPRO_SAMPLER_PERIOD_MS);
+	k_work_reschedule(&sample_work, K_NO_WAIT);
+	return 0;
+}
+
+int radpro_sampler_add_listener(radpro_sample_cb_t cb)
+{
+	for (int i = 0; i < SAMPLER_MAX_LISTENERS; i++) {
+		if (!listeners[i]) {
+			listeners[i] = cb;
+			return 0;
+		}
+	}
+
+	return -ENOMEM;
+}
+
+int radpro_sampler_get_latest(struct radpro_sample *sample)
+{
+	int ret = -ENODATA;
+
+	k_mutex_lock(&sampler_lock, K_FOREVER);
+	if (latest_valid) {
+		*sample = latest;
+		ret = 0;
+	}
+	k_mutex_unlock(&sampler_lock);
+
+	return ret;
+}
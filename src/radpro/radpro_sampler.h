@@ -0,0 +1,69 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Pulse Sampler - Header
+ *
+ * Polls `GET tubePulseCount` on the UART at a fixed period and computes
+ * the count rate from pulse-count deltas (docs/comm.md recommends this
+ * over `GET tubeRate`), handling the 32-bit counter wraparound. Listeners
+ * receive each new sample so only computed values need to go over BLE.
+ */
+
+#ifndef RADPRO_SAMPLER_H
+#define RADPRO_SAMPLER_H
+
+#include <stdint.h>
+
+/* Sliding windows the count rate is computed over */
+#define RADPRO_SAMPLER_SHORT_WINDOW_S 10
+#define RADPRO_SAMPLER_LONG_WINDOW_S 60
+
+/* Samples kept for the sliding windows */
+#define RADPRO_SAMPLER_HISTORY 64
+
+/** One pulse-count reading and the rates derived from it */
+struct radpro_sample {
+	int64_t uptime_ms;        /* When the count was read */
+	uint64_t pulse_count;     /* Pulses since sampling started, wrap-free */
+	uint32_t raw_count;       /* tubePulseCount as reported by the device */
+	uint32_t delta;           /* Pulses since the previous sample */
+	uint32_t cpm_short_x100;  /* CPM over the short window, in 1/100 */
+	uint32_t cpm_long_x100;   /* CPM over the long window, in 1/100 */
+};
+
+/**
+ * @brief Callback type for new samples
+ * @param sample The new sample
+ */
+typedef void (*radpro_sample_cb_t)(const struct radpro_sample *sample);
+
+/**
+ * @brief Initialize the sampler
+ * @return 0 on success, negative errno on failure
+ */
+int radpro_sampler_init(void);
+
+/**
+ * @brief Start polling the device
+ * @return 0 on success, negative errno on failure
+ */
+int radpro_sampler_start(void);
+
+/**
+ * @brief Register a listener for new samples
+ *
+ * Listeners are called from the protocol engine's callback context and
+ * must not block.
+ *
+ * @param cb Callback to add
+ * @return 0 on success, -ENOMEM if all listener slots are taken
+ */
+int radpro_sampler_add_listener(radpro_sample_cb_t cb);
+
+/**
+ * @brief Get the most recent sample
+ * @param sample Receives the sample
+ * @return 0 on success, -ENODATA if no rate has been computed yet
+ */
+int radpro_sampler_get_latest(struct radpro_sample *sample);
+
+#endif /* RADPRO_SAMPLER_H */
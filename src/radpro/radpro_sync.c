@@ -0,0 +1,161 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Datalog Sync Cursors - Implementation
+ */
+
+#include "radpro_sync.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(radpro_sync, LOG_LEVEL_INF);
+
+#define SYNC_SETTINGS_ROOT "radpro/sync"
+
+/* Address type and value as hex: "01c0ffee123456" */
+#define SYNC_KEY_LEN (2 * (1 + sizeof(bt_addr_t)))
+
+/* "radpro/sync/<key>" with terminator */
+#define SYNC_NAME_SIZE (sizeof(SYNC_SETTINGS_ROOT "/") + SYNC_KEY_LEN)
+
+struct sync_entry {
+	bool used;
+	bt_addr_le_t peer;
+	uint32_t cursor;
+};
+
+static struct sync_entry entries[RADPRO_SYNC_MAX];
+
+static void peer_to_name(const bt_addr_le_t *peer, char *name)
+{
+	uint8_t raw[1 + sizeof(bt_addr_t)];
+
+	raw[0] = peer->type;
+	memcpy(&raw[1], peer->a.val, sizeof(peer->a.val));
+
+	strcpy(name, SYNC_SETTINGS_ROOT "/");
+	bin2hex(raw, sizeof(raw), &name[sizeof(SYNC_SETTINGS_ROOT)], SYNC_KEY_LEN + 1);
+}
+
+static int key_to_peer(const char *key, size_t len, bt_addr_le_t *peer)
+{
+	uint8_t raw[1 + sizeof(bt_addr_t)];
+
+	if (len != SYNC_KEY_LEN || hex2bin(key, len, raw, sizeof(raw)) != sizeof(raw)) {
+		return -EINVAL;
+	}
+
+	peer->type = raw[0];
+	memcpy(peer->a.val, &raw[1], sizeof(peer->a.val));
+	return 0;
+}
+
+static struct sync_entry *entry_find(const bt_addr_le_t *peer)
+{
+	for (int i = 0; i < RADPRO_SYNC_MAX; i++) {
+		if (entries[i].used && bt_addr_le_eq(&entries[i].peer, peer)) {
+			return &entries[i];
+		}
+	}
+	return NULL;
+}
+
+/* A free slot, or one whose bond was deleted or overwritten since */
+static struct sync_entry *entry_alloc(void)
+{
+	char name[SYNC_NAME_SIZE];
+
+	for (int i = 0; i < RADPRO_SYNC_MAX; i++) {
+		if (!entries[i].used) {
+			return &entries[i];
+		}
+	}
+
+	for (int i = 0; i < RADPRO_SYNC_MAX; i++) {
+		if (!bt_le_bond_exists(BT_ID_DEFAULT, &entries[i].peer)) {
+			peer_to_name(&entries[i].peer, name);
+			settings_delete(name);
+			entries[i].used = false;
+			return &entries[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Settings handler - called from settings_load() */
+static int sync_settings_set(const char *name, size_t len, settings_read_cb read_cb,
+			     void *cb_arg)
+{
+	const char *next;
+	bt_addr_le_t peer;
+	struct sync_entry *entry;
+	uint32_t cursor;
+	int rc;
+
+	if (key_to_peer(name, settings_name_next(name, &next), &peer) || next ||
+	    len != sizeof(cursor)) {
+		LOG_WRN("Ignoring sync setting %s", name);
+		return 0;
+	}
+
+	rc = read_cb(cb_arg, &cursor, sizeof(cursor));
+	if (rc < 0) {
+		return rc;
+	}
+
+	entry = entry_find(&peer);
+	if (!entry) {
+		entry = entry_alloc();
+		if (!entry) {
+			return -ENOMEM;
+		}
+	}
+
+	entry->used = true;
+	entry->peer = peer;
+	entry->cursor = cursor;
+	return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(radpro_sync, SYNC_SETTINGS_ROOT, NULL, sync_settings_set,
+			       NULL, NULL);
+
+/* Public API */
+uint32_t radpro_sync_get(const bt_addr_le_t *peer)
+{
+	struct sync_entry *entry = entry_find(peer);
+
+	return entry ? entry->cursor : 0;
+}
+
+int radpro_sync_set(const bt_addr_le_t *peer, uint32_t cursor)
+{
+	char name[SYNC_NAME_SIZE];
+	struct sync_entry *entry = entry_find(peer);
+	int err;
+
+	if (!entry) {
+		entry = entry_alloc();
+		if (!entry) {
+			return -ENOMEM;
+		}
+		entry->used = true;
+		entry->peer = *peer;
+	}
+
+	entry->cursor = cursor;
+
+	peer_to_name(peer, name);
+	err = settings_save_one(name, &cursor, sizeof(cursor));
+	if (err) {
+		LOG_ERR("Failed to save sync cursor: %d", err);
+		return err;
+	}
+
+	LOG_INF("Sync cursor %s = %u", name, cursor);
+	return 0;
+}
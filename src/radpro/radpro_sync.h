@@ -0,0 +1,38 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RadPro Datalog Sync Cursors - Header
+ *
+ * Remembers, per bonded central, the time of the last datalog record it
+ * acknowledged, so a reconnecting app only downloads newer records. The
+ * cursors live in the settings subsystem under "radpro/sync/<addr>" and
+ * are restored by the settings_load() that also restores the bonds.
+ */
+
+#ifndef RADPRO_SYNC_H
+#define RADPRO_SYNC_H
+
+#include <stdint.h>
+#include <zephyr/bluetooth/addr.h>
+
+/* One cursor per possible bond */
+#define RADPRO_SYNC_MAX CONFIG_BT_MAX_PAIRED
+
+/**
+ * @brief Get the cursor of a bonded central
+ * @param peer Identity address of the central
+ * @return Time of the last acknowledged record, 0 if it never synced
+ */
+uint32_t radpro_sync_get(const bt_addr_le_t *peer);
+
+/**
+ * @brief Store the cursor of a bonded central
+ *
+ * Takes the slot of a bond that no longer exists when all are in use.
+ *
+ * @param peer Identity address of the central
+ * @param cursor Time of the last acknowledged record, 0 to sync from scratch
+ * @return 0 on success, negative errno if it could not be persisted
+ */
+int radpro_sync_set(const bt_addr_le_t *peer, uint32_t cursor);
+
+#endif /* RADPRO_SYNC_H */
@@ -4,6 +4,7 @@
  */
 
 #include "security_manager.h"
+#include "../status/app_status.h"
 
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/kernel.h>
@@ -16,13 +17,19 @@ static bool pairing_allowed = true;
 static struct k_work_delayable pairing_timeout_work;
 static uint32_t pairing_window_ms;
 static int64_t pairing_window_end_time;
+static security_window_closed_cb_t window_closed_cb;
 
 /* Pairing timeout handler */
 static void pairing_timeout_handler(struct k_work *work)
 {
 	pairing_allowed = false;
+	app_status_set(APP_STATUS_PAIRING_WINDOW, false);
 	LOG_WRN("Pairing window closed - no new pairings allowed");
 	LOG_INF("Device will continue with existing paired devices only");
+
+	if (window_closed_cb) {
+		window_closed_cb();
+	}
 }
 
 /* Authentication callbacks */
@@ -153,6 +160,7 @@ int security_manager_init(uint32_t window_ms)
 	/* Start pairing timeout timer */
 	k_work_init_delayable(&pairing_timeout_work, pairing_timeout_handler);
 	k_work_schedule(&pairing_timeout_work, K_MSEC(window_ms));
+	app_status_set(APP_STATUS_PAIRING_WINDOW, pairing_allowed);
 
 	LOG_INF("Security manager initialized (pairing window: %u minutes)",
 		window_ms / 60000);
@@ -160,6 +168,11 @@ int security_manager_init(uint32_t window_ms)
 	return 0;
 }
 
+void security_manager_set_window_closed_cb(security_window_closed_cb_t cb)
+{
+	window_closed_cb = cb;
+}
+
 bool security_manager_is_pairing_allowed(void)
 {
 	return pairing_allowed;
@@ -8,6 +8,11 @@
 
 #include <zephyr/bluetooth/conn.h>
 
+/**
+ * @brief Callback type for the end of the pairing window
+ */
+typedef void (*security_window_closed_cb_t)(void);
+
 /**
  * @brief Initialize security manager
  * @param pairing_window_ms Time window for automatic pairing (milliseconds)
@@ -15,6 +20,15 @@
  */
 int security_manager_init(uint32_t pairing_window_ms);
 
+/**
+ * @brief Set a callback for when the pairing window closes
+ *
+ * Called from the system workqueue.
+ *
+ * @param cb Callback, or NULL to remove
+ */
+void security_manager_set_window_closed_cb(security_window_closed_cb_t cb);
+
 /**
  * @brief Check if pairing is currently allowed
  * @return true if within pairing window
@@ -0,0 +1,71 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Application Status - Implementation
+ */
+
+#include "app_status.h"
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(app_status, LOG_LEVEL_INF);
+
+#define APP_STATUS_ALL (APP_STATUS_BIT(APP_STATUS_FLAGS) - 1)
+
+static atomic_t status;
+
+/* Slots are claimed once at init and never released; a claimed slot
+ * stays NULL until its callback is stored */
+static app_status_cb_t subscribers[APP_STATUS_MAX_SUBSCRIBERS];
+static atomic_t subscriber_count;
+
+/* Public API */
+void app_status_set(enum app_status_flag flag, bool on)
+{
+	uint32_t bit = APP_STATUS_BIT(flag);
+	uint32_t old;
+	int count;
+
+	if (on) {
+		old = atomic_or(&status, bit);
+	} else {
+		old = atomic_and(&status, ~bit);
+	}
+
+	if (((old & bit) != 0) == on) {
+		return;
+	}
+
+	LOG_DBG("Status 0x%02x -> 0x%02x", old, old ^ bit);
+
+	count = MIN(atomic_get(&subscriber_count), APP_STATUS_MAX_SUBSCRIBERS);
+	for (int i = 0; i < count; i++) {
+		app_status_cb_t cb = subscribers[i];
+
+		/* Current word, so a racing publisher is never reported stale */
+		if (cb) {
+			cb(atomic_get(&status), bit);
+		}
+	}
+}
+
+uint32_t app_status_get(void)
+{
+	return atomic_get(&status);
+}
+
+int app_status_subscribe(app_status_cb_t cb)
+{
+	int slot = atomic_inc(&subscriber_count);
+
+	if (slot >= APP_STATUS_MAX_SUBSCRIBERS) {
+		atomic_dec(&subscriber_count);
+		return -ENOMEM;
+	}
+
+	subscribers[slot] = cb;
+	cb(atomic_get(&status), APP_STATUS_ALL);
+	return 0;
+}
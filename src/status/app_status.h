@@ -0,0 +1,65 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Application Status - Header
+ *
+ * Publish/subscribe channel for the bridge's state: modules publish a
+ * flag when it changes and every subscriber is called right away, so
+ * consumers such as the status LED follow transitions without polling.
+ *
+ * Subscribers run synchronously in the publisher's context (BT RX
+ * thread, system workqueue, main), so they must not block. Publishing a
+ * flag that did not change calls nobody.
+ */
+
+#ifndef APP_STATUS_H
+#define APP_STATUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Maximum number of subscribers */
+#define APP_STATUS_MAX_SUBSCRIBERS 4
+
+enum app_status_flag {
+	APP_STATUS_PAIRING_WINDOW,  /* security_manager: new pairings allowed */
+	APP_STATUS_CONNECTED,       /* ble_service: at least one central */
+	APP_STATUS_AUTHENTICATED,   /* ble_service: at least one encrypted central */
+	APP_STATUS_UART_READY,      /* uart_bridge: device UART up */
+	APP_STATUS_ERROR,           /* main: initialization failed */
+	APP_STATUS_FLAGS,
+};
+
+/* Bit of a flag in a status word */
+#define APP_STATUS_BIT(flag) (1U << (flag))
+
+/**
+ * @brief Status subscriber callback
+ * @param status Every flag after the change, as APP_STATUS_BIT()s
+ * @param changed Flags that changed (all flags on subscription)
+ */
+typedef void (*app_status_cb_t)(uint32_t status, uint32_t changed);
+
+/**
+ * @brief Publish a flag
+ * @param flag Flag
+ * @param on New value
+ */
+void app_status_set(enum app_status_flag flag, bool on);
+
+/**
+ * @brief Get the current status
+ * @return Every flag as APP_STATUS_BIT()s
+ */
+uint32_t app_status_get(void);
+
+/**
+ * @brief Subscribe to status changes
+ *
+ * The callback is called once immediately with the current status.
+ *
+ * @param cb Callback
+ * @return 0 on success, -ENOMEM if all subscriber slots are taken
+ */
+int app_status_subscribe(app_status_cb_t cb);
+
+#endif /* APP_STATUS_H */
@@ -0,0 +1,50 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Data Path Trace - Implementation
+ */
+
+#include "trace.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_RADPRO_TRACE_RECORDS), "trace ring must be a power of two");
+BUILD_ASSERT(sizeof(struct trace_record) == 16, "host decoder expects 16-byte records");
+
+/* Located by the host through its magic, so the layout is fixed:
+ * magic, record size, record count, cycles per second, events written */
+struct trace_ring {
+	char magic[8];
+	uint32_t record_size;
+	uint32_t record_count;
+	uint32_t cycles_per_sec;
+	atomic_t head;
+	struct trace_record records[CONFIG_RADPRO_TRACE_RECORDS];
+};
+
+struct trace_ring radpro_trace = {
+	.magic = "RPTRACE",
+	.record_size = sizeof(struct trace_record),
+	.record_count = CONFIG_RADPRO_TRACE_RECORDS,
+	.cycles_per_sec = CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC,
+};
+
+/* Public API */
+void trace_event(enum trace_event_id event, const void *data, size_t len)
+{
+	/* Concurrent writers claim distinct slots; a reader may see one torn
+	 * record where the ring wraps under it */
+	uint32_t slot = (uint32_t)atomic_inc(&radpro_trace.head);
+	struct trace_record *rec =
+		&radpro_trace.records[slot & (CONFIG_RADPRO_TRACE_RECORDS - 1)];
+
+	rec->cycles = k_cycle_get_32();
+	rec->event = event;
+	rec->reserved = 0;
+	rec->len = MIN(len, UINT16_MAX);
+	if (data) {
+		memcpy(rec->data, data, MIN(len, TRACE_DATA_LEN));
+	}
+}
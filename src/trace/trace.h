@@ -0,0 +1,66 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Data Path Trace - Header
+ *
+ * Binary event trace for the UART/BLE data path, replacing per-event
+ * log lines and hexdumps that flood the deferred log buffer. Each event
+ * is a fixed 16-byte record in a RAM ring: no formatting, no locking,
+ * callable from ISRs. The ring is found in RAM by its magic and pulled
+ * over SWD with `scripts/rtt_capture.py --trace`, which decodes it
+ * offline.
+ *
+ * Record layout (little-endian):
+ *   0  uint32  cycles   k_cycle_get_32() at the event
+ *   4  uint8   event    enum trace_event_id
+ *   5  uint8   -        reserved, 0
+ *   6  uint16  len      event length (bytes, or event argument)
+ *   8  uint8[8]         first min(len, 8) data bytes
+ *
+ * Without CONFIG_RADPRO_TRACE every call compiles to nothing.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TRACE_DATA_LEN 8
+
+/* Event ids - append only, scripts/rtt_capture.py decodes them */
+enum trace_event_id {
+	TRACE_UART_RX_RDY = 1,    /* Bytes received by the UART driver */
+	TRACE_UART_RX_FULL,       /* RX ring out of space, len = 0 */
+	TRACE_UART_RX_STOPPED,    /* Line error, len = reason */
+	TRACE_UART_TX,            /* Chunk handed to uart_tx() */
+	TRACE_UART_TX_DONE,       /* Chunk sent */
+	TRACE_UART_TO_BLE,        /* UART data handed to the application */
+};
+
+struct trace_record {
+	uint32_t cycles;
+	uint8_t event;
+	uint8_t reserved;
+	uint16_t len;
+	uint8_t data[TRACE_DATA_LEN];
+};
+
+#if defined(CONFIG_RADPRO_TRACE)
+
+/**
+ * @brief Record an event
+ * @param event Event id
+ * @param data Leading bytes are copied into the record (may be NULL)
+ * @param len Length of data, or an argument when data is NULL
+ */
+void trace_event(enum trace_event_id event, const void *data, size_t len);
+
+#else
+
+static inline void trace_event(enum trace_event_id event, const void *data, size_t len)
+{
+}
+
+#endif /* CONFIG_RADPRO_TRACE */
+
+#endif /* TRACE_H */
@@ -0,0 +1,86 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RX Byte Ring - Implementation
+ */
+
+#include "rx_ring.h"
+
+#include <string.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/sys/__assert.h>
+
+void rx_ring_init(struct rx_ring *ring, uint8_t *buf, uint32_t size)
+{
+	__ASSERT_NO_MSG(IS_POWER_OF_TWO(size));
+
+	ring->buf = buf;
+	ring->size = size;
+	atomic_set(&ring->head, 0);
+	atomic_set(&ring->tail, 0);
+}
+
+uint32_t rx_ring_used(struct rx_ring *ring)
+{
+	return (uint32_t)atomic_get(&ring->head) - (uint32_t)atomic_get(&ring->tail);
+}
+
+uint32_t rx_ring_head(struct rx_ring *ring)
+{
+	return (uint32_t)atomic_get(&ring->head);
+}
+
+uint8_t *rx_ring_reserve(struct rx_ring *ring, uint32_t pos, uint32_t max_len, uint32_t *len)
+{
+	uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+	uint32_t offset = pos & (ring->size - 1);
+	uint32_t free = ring->size - (pos - tail);
+
+	*len = MIN(MIN(free, ring->size - offset), max_len);
+	if (*len == 0) {
+		return NULL;
+	}
+
+	return &ring->buf[offset];
+}
+
+void rx_ring_commit(struct rx_ring *ring, uint32_t len)
+{
+	/* Single producer - a plain store of the new index is sufficient */
+	atomic_set(&ring->head, (atomic_val_t)((uint32_t)atomic_get(&ring->head) + len));
+}
+
+uint32_t rx_ring_put(struct rx_ring *ring, const uint8_t *data, uint32_t len)
+{
+	uint32_t written = 0;
+
+	while (written < len) {
+		uint32_t n;
+		uint8_t *dst = rx_ring_reserve(ring, rx_ring_head(ring), len - written, &n);
+
+		if (!dst) {
+			break;
+		}
+
+		memcpy(dst, &data[written], n);
+		rx_ring_commit(ring, n);
+		written += n;
+	}
+
+	return written;
+}
+
+uint32_t rx_ring_peek(struct rx_ring *ring, const uint8_t **data)
+{
+	uint32_t head = (uint32_t)atomic_get(&ring->head);
+	uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+	uint32_t offset = tail & (ring->size - 1);
+
+	*data = &ring->buf[offset];
+	return MIN(head - tail, ring->size - offset);
+}
+
+void rx_ring_consume(struct rx_ring *ring, uint32_t len)
+{
+	/* Single consumer - a plain store of the new index is sufficient */
+	atomic_set(&ring->tail, (atomic_val_t)((uint32_t)atomic_get(&ring->tail) + len));
+}
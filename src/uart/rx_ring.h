@@ -0,0 +1,92 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * RX Byte Ring - Header
+ *
+ * Lock-free single-producer/single-consumer byte ring. The producer (UART
+ * ISR) only advances the write index; the consumer (RX thread) only
+ * advances the read index. Indices are free-running and masked on access,
+ * so the ring size must be a power of two.
+ */
+
+#ifndef RX_RING_H
+#define RX_RING_H
+
+#include <zephyr/types.h>
+#include <zephyr/sys/atomic.h>
+
+struct rx_ring {
+	uint8_t *buf;
+	uint32_t size;
+	atomic_t head;  /* write index - producer only */
+	atomic_t tail;  /* read index - consumer only */
+};
+
+/**
+ * @brief Initialize an empty ring
+ * @param ring Ring to initialize
+ * @param buf Backing storage
+ * @param size Size of backing storage, must be a power of two
+ */
+void rx_ring_init(struct rx_ring *ring, uint8_t *buf, uint32_t size);
+
+/**
+ * @brief Get number of bytes waiting to be consumed
+ * @param ring Ring
+ * @return Bytes between read and write index
+ */
+uint32_t rx_ring_used(struct rx_ring *ring);
+
+/**
+ * @brief Get the current write index
+ * @param ring Ring
+ * @return Free-running write index
+ */
+uint32_t rx_ring_head(struct rx_ring *ring);
+
+/**
+ * @brief Reserve a contiguous free region for the producer
+ *
+ * The region starts at @p pos, which may lie ahead of the write index when
+ * several regions are outstanding (e.g. DMA double buffering). It never
+ * crosses the end of the backing storage.
+ *
+ * @param ring Ring
+ * @param pos Free-running index where the region starts
+ * @param max_len Upper bound on the region length
+ * @param len Set to the region length
+ * @return Pointer to the region, NULL if no space at @p pos
+ */
+uint8_t *rx_ring_reserve(struct rx_ring *ring, uint32_t pos, uint32_t max_len, uint32_t *len);
+
+/**
+ * @brief Publish bytes written at the write index (producer)
+ * @param ring Ring
+ * @param len Number of bytes to publish
+ */
+void rx_ring_commit(struct rx_ring *ring, uint32_t len);
+
+/**
+ * @brief Copy data into the ring (producer)
+ * @param ring Ring
+ * @param data Data to copy
+ * @param len Length of data
+ * @return Number of bytes written, less than @p len if the ring is full
+ */
+uint32_t rx_ring_put(struct rx_ring *ring, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Get the next contiguous readable span (consumer)
+ * @param ring Ring
+ * @param data Set to the start of the span
+ * @return Span length, 0 if the ring is empty
+ */
+uint32_t rx_ring_peek(struct rx_ring *ring, const uint8_t **data);
+
+/**
+ * @brief Release bytes returned by rx_ring_peek() (consumer)
+ * @param ring Ring
+ * @param len Number of bytes to release
+ */
+void rx_ring_consume(struct rx_ring *ring, uint32_t len);
+
+#endif /* RX_RING_H */
@@ -4,6 +4,10 @@
  */
 
 #include "uart_bridge.h"
+#include "rx_ring.h"
+#include "../metrics/metrics.h"
+#include "../trace/trace.h"
+#include "../status/app_status.h"
 
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/uart.h>
@@ -17,17 +21,53 @@ LOG_MODULE_REGISTER(uart_bridge, LOG_LEVEL_INF);
 #define UART_WAIT_FOR_BUF_DELAY K_MSEC(50)
 #define UART_WAIT_FOR_RX_MS     50000
 
+/* RX ring - the driver DMAs straight into it in chunks of UART_RX_DMA_CHUNK */
+#define UART_RX_RING_SIZE       2048
+#define UART_RX_DMA_CHUNK       256
+
+/* How long the RX thread holds back an unterminated line for its end */
+#define UART_RX_LINE_HOLD       K_MSEC(50)
+
+/* TX buffer pool reservation */
+#define UART_TX_BUF_COUNT       4
+
+struct uart_buf_pool;
+
 struct uart_data_t {
 	void *fifo_reserved;
+	struct uart_buf_pool *pool;
 	uint8_t data[UART_BUF_SIZE];
 	uint16_t len;
 };
 
+struct uart_buf_pool {
+	struct k_mem_slab *slab;
+	atomic_t in_use;
+	atomic_t high_water;
+	atomic_t exhausted;
+};
+
+K_MEM_SLAB_DEFINE_STATIC(uart_tx_slab, sizeof(struct uart_data_t), UART_TX_BUF_COUNT, 4);
+
+static struct uart_buf_pool tx_pool = { .slab = &uart_tx_slab };
+
+/* RX path: the UART ISR is the only writer and uart_rx_thread the only
+ * reader of rx_ring. Buffers handed to the driver are consecutive ring
+ * regions starting at rx_dma_pos, so each RX_RDY only has to advance the
+ * write index.
+ */
+static uint8_t rx_ring_buf[UART_RX_RING_SIZE];
+static struct rx_ring rx_ring;
+static uint32_t rx_dma_pos;
+static atomic_t rx_stalled;
+static atomic_t rx_high_water;
+static atomic_t rx_ring_full;
+static K_SEM_DEFINE(rx_sem, 0, 1);
+
 /* State */
 static const struct device *uart;
 static struct k_work_delayable uart_work;
 static K_FIFO_DEFINE(fifo_uart_tx_data);
-static K_FIFO_DEFINE(fifo_uart_rx_data);
 static uart_data_received_cb_t data_received_callback;
 static bool uart_initialized = false;
 
@@ -43,6 +83,89 @@ static const struct device *get_uart_device(void)
 #endif
 }
 
+/* Buffer pool - O(1) and ISR-safe (K_NO_WAIT slab allocation) */
+static struct uart_data_t *uart_buf_alloc(struct uart_buf_pool *pool)
+{
+	struct uart_data_t *buf;
+	atomic_val_t in_use;
+	atomic_val_t high_water;
+
+	if (k_mem_slab_alloc(pool->slab, (void **)&buf, K_NO_WAIT)) {
+		atomic_inc(&pool->exhausted);
+		metrics_inc(METRICS_UART_TX_POOL_EMPTY);
+		return NULL;
+	}
+
+	buf->pool = pool;
+	buf->len = 0;
+
+	in_use = atomic_inc(&pool->in_use) + 1;
+	do {
+		high_water = atomic_get(&pool->high_water);
+		if (in_use <= high_water) {
+			break;
+		}
+	} while (!atomic_cas(&pool->high_water, high_water, in_use));
+
+	return buf;
+}
+
+static void uart_buf_free(struct uart_data_t *buf)
+{
+	struct uart_buf_pool *pool = buf->pool;
+
+	atomic_dec(&pool->in_use);
+	k_mem_slab_free(pool->slab, buf);
+}
+
+/* Claim the next ring region for the driver, NULL if the ring is full */
+static uint8_t *rx_dma_claim(size_t *len)
+{
+	uint32_t n;
+	uint8_t *buf = rx_ring_reserve(&rx_ring, rx_dma_pos, UART_RX_DMA_CHUNK, &n);
+
+	if (buf) {
+		rx_dma_pos += n;
+		*len = n;
+	}
+	return buf;
+}
+
+/* Arm RX right after the last received byte */
+static int uart_rx_start(void)
+{
+	uint8_t *buf;
+	size_t len;
+
+	rx_dma_pos = rx_ring_head(&rx_ring);
+	buf = rx_dma_claim(&len);
+	if (!buf) {
+		return -ENOMEM;
+	}
+
+	return uart_rx_enable(uart, buf, len, UART_WAIT_FOR_RX_MS);
+}
+
+static void uart_rx_rearm(void)
+{
+	int err = uart_rx_start();
+
+	if (err == -ENOMEM) {
+		/* Ring full - the RX thread re-arms once it has drained */
+		atomic_set(&rx_stalled, 1);
+		k_sem_give(&rx_sem);
+	} else if (err) {
+		LOG_WRN("Failed to re-enable RX: %d", err);
+		metrics_inc(METRICS_UART_ERRORS);
+		k_work_reschedule(&uart_work, UART_WAIT_FOR_BUF_DELAY);
+	}
+}
+
+static inline bool is_line_end(uint8_t c)
+{
+	return (c == '\n') || (c == '\r');
+}
+
 /* nRF54L15 has native async UART support - no adapter needed */
 
 /* UART callback */
@@ -53,11 +176,16 @@ static void uart_cb(const struct device *dev, struct uart_event *evt, void *user
 	static size_t aborted_len;
 	struct uart_data_t *buf;
 	static uint8_t *aborted_buf;
+#if !defined(CONFIG_RADPRO_UART_RX_CONTINUOUS)
 	static bool disable_req;
+#endif
+	uint8_t *rx;
+	size_t rx_len;
+	uint32_t used;
 
 	switch (evt->type) {
 	case UART_TX_DONE:
-		LOG_DBG("TX done");
+		trace_event(TRACE_UART_TX_DONE, NULL, evt->data.tx.len);
 		if ((evt->data.tx.len == 0) || (!evt->data.tx.buf)) {
 			return;
 		}
@@ -70,7 +198,7 @@ static void uart_cb(const struct device *dev, struct uart_event *evt, void *user
 			buf = CONTAINER_OF(evt->data.tx.buf, struct uart_data_t, data[0]);
 		}
 
-		k_free(buf);
+		uart_buf_free(buf);
 
 		buf = k_fifo_get(&fifo_uart_tx_data, K_NO_WAIT);
 		if (!buf) {
@@ -79,62 +207,66 @@ static void uart_cb(const struct device *dev, struct uart_event *evt, void *user
 
 		if (uart_tx(uart, buf->data, buf->len, SYS_FOREVER_MS)) {
 			LOG_WRN("Failed to send data");
+			metrics_inc(METRICS_UART_ERRORS);
 		}
 		break;
 
 	case UART_RX_RDY:
-		buf = CONTAINER_OF(evt->data.rx.buf, struct uart_data_t, data[0]);
-		buf->len += evt->data.rx.len;
-		LOG_INF("RDY offset=%u len=%u total=%u", evt->data.rx.offset, evt->data.rx.len, buf->len);
+		trace_event(TRACE_UART_RX_RDY, &evt->data.rx.buf[evt->data.rx.offset],
+			    evt->data.rx.len);
+		rx_ring_commit(&rx_ring, evt->data.rx.len);
+
+		used = rx_ring_used(&rx_ring);
+		if (used > (uint32_t)atomic_get(&rx_high_water)) {
+			atomic_set(&rx_high_water, used);
+		}
 
+		k_sem_give(&rx_sem);
+
+#if !defined(CONFIG_RADPRO_UART_RX_CONTINUOUS)
 		if (disable_req) {
 			return;
 		}
 
-		if ((evt->data.rx.buf[buf->len - 1] == '\n') ||
-		    (evt->data.rx.buf[buf->len - 1] == '\r')) {
+		/* Legacy mode: stop at a line end, RX_DISABLED re-arms */
+		if (is_line_end(evt->data.rx.buf[evt->data.rx.offset + evt->data.rx.len - 1])) {
 			disable_req = true;
 			uart_rx_disable(uart);
 		}
+#endif
 		break;
 
 	case UART_RX_DISABLED:
 		LOG_DBG("RX disabled");
+#if !defined(CONFIG_RADPRO_UART_RX_CONTINUOUS)
 		disable_req = false;
-
-		buf = k_malloc(sizeof(*buf));
-		if (buf) {
-			buf->len = 0;
-		} else {
-			LOG_WRN("Failed to allocate RX buffer");
-			k_work_reschedule(&uart_work, UART_WAIT_FOR_BUF_DELAY);
-			return;
-		}
-
-		uart_rx_enable(uart, buf->data, sizeof(buf->data), UART_WAIT_FOR_RX_MS);
+#endif
+		uart_rx_rearm();
 		break;
 
 	case UART_RX_BUF_REQUEST:
 		LOG_DBG("RX buffer request");
-		buf = k_malloc(sizeof(*buf));
-		if (buf) {
-			buf->len = 0;
-			uart_rx_buf_rsp(uart, buf->data, sizeof(buf->data));
+		rx = rx_dma_claim(&rx_len);
+		if (rx) {
+			uart_rx_buf_rsp(uart, rx, rx_len);
 		} else {
-			LOG_WRN("Failed to allocate RX buffer");
+			/* Driver stops once the current buffer fills */
+			atomic_inc(&rx_ring_full);
+			metrics_inc(METRICS_UART_RX_RING_FULL);
+			trace_event(TRACE_UART_RX_FULL, NULL, 0);
+			LOG_WRN("RX ring full");
 		}
 		break;
 
 	case UART_RX_BUF_RELEASED:
 		LOG_DBG("RX buffer released");
-		buf = CONTAINER_OF(evt->data.rx_buf.buf, struct uart_data_t, data[0]);
+		break;
 
-		if (buf->len > 0) {
-			LOG_HEXDUMP_INF(buf->data, buf->len, "RX-rel:");
-			k_fifo_put(&fifo_uart_rx_data, buf);
-		} else {
-			k_free(buf);
-		}
+	case UART_RX_STOPPED:
+		/* Line error - the driver follows up with RX_DISABLED */
+		LOG_WRN("RX stopped, reason %d", evt->data.rx_stop.reason);
+		trace_event(TRACE_UART_RX_STOPPED, NULL, evt->data.rx_stop.reason);
+		metrics_inc(METRICS_UART_ERRORS);
 		break;
 
 	case UART_TX_ABORTED:
@@ -157,18 +289,56 @@ static void uart_cb(const struct device *dev, struct uart_event *evt, void *user
 /* Work handler */
 static void uart_work_handler(struct k_work *item)
 {
-	struct uart_data_t *buf;
+	uart_rx_rearm();
+}
 
-	buf = k_malloc(sizeof(*buf));
-	if (buf) {
-		buf->len = 0;
-	} else {
-		LOG_WRN("Failed to allocate UART receive buffer");
-		k_work_reschedule(&uart_work, UART_WAIT_FOR_BUF_DELAY);
-		return;
+/**
+ * @brief Bytes of a ring span to hand over
+ *
+ * Up to the last line end in the span. A span without one is handed over
+ * whole once it no longer fits a UART buffer, when it continues past the
+ * end of the ring or when flush is set; otherwise it is held back.
+ */
+static uint32_t rx_line_span(const uint8_t *data, uint32_t len, bool flush)
+{
+	uint32_t n = len;
+
+	while ((n > 0) && !is_line_end(data[n - 1])) {
+		n--;
+	}
+
+	if ((n == 0) &&
+	    (flush || (len >= UART_BUF_SIZE) || (len < rx_ring_used(&rx_ring)))) {
+		n = len;
 	}
 
-	uart_rx_enable(uart, buf->data, sizeof(buf->data), UART_WAIT_FOR_RX_MS);
+	return n;
+}
+
+/* Hand the RX ring to the application, split at line boundaries */
+static void uart_rx_drain(bool flush)
+{
+	const uint8_t *data;
+	uint32_t len;
+
+	while ((len = rx_ring_peek(&rx_ring, &data)) > 0) {
+		len = rx_line_span(data, len, flush);
+		if (len == 0) {
+			/* Partial line - wait for the rest */
+			break;
+		}
+
+		metrics_add(METRICS_UART_RX_BYTES, len);
+		if (data_received_callback) {
+			data_received_callback(data, len);
+		}
+		rx_ring_consume(&rx_ring, len);
+	}
+
+	/* RX stopped for lack of space - re-arm now that the ring is empty */
+	if (atomic_cas(&rx_stalled, 1, 0)) {
+		k_work_reschedule(&uart_work, K_NO_WAIT);
+	}
 }
 
 /* RX processing thread */
@@ -177,19 +347,10 @@ static void uart_rx_thread(void)
 	LOG_INF("UART RX thread started");
 
 	for (;;) {
-		struct uart_data_t *buf = k_fifo_get(&fifo_uart_rx_data, K_FOREVER);
-
-		if (!buf) {
-			LOG_ERR("Received NULL buffer");
-			continue;
-		}
-
-		/* Forward to application callback */
-		if (data_received_callback && buf->len > 0) {
-			data_received_callback(buf->data, buf->len);
-		}
+		/* A partial line left in the ring is flushed once it goes idle */
+		k_timeout_t wait = rx_ring_used(&rx_ring) ? UART_RX_LINE_HOLD : K_FOREVER;
 
-		k_free(buf);
+		uart_rx_drain(k_sem_take(&rx_sem, wait) == -EAGAIN);
 	}
 }
 
@@ -199,10 +360,10 @@ K_THREAD_DEFINE(uart_rx_thread_id, 2048, uart_rx_thread, NULL, NULL, NULL, 7, 0,
 int uart_bridge_init(uart_data_received_cb_t data_cb)
 {
 	int err;
-	struct uart_data_t *rx;
 	struct uart_data_t *tx;
 
 	data_received_callback = data_cb;
+	rx_ring_init(&rx_ring, rx_ring_buf, sizeof(rx_ring_buf));
 
 	/* Get UART device */
 	uart = get_uart_device();
@@ -213,14 +374,6 @@ int uart_bridge_init(uart_data_received_cb_t data_cb)
 
 	LOG_INF("UART device ready");
 
-	/* Allocate initial RX buffer */
-	rx = k_malloc(sizeof(*rx));
-	if (!rx) {
-		LOG_ERR("Failed to allocate RX buffer");
-		return -ENOMEM;
-	}
-	rx->len = 0;
-
 	/* Initialize work queue */
 	k_work_init_delayable(&uart_work, uart_work_handler);
 
@@ -230,34 +383,33 @@ int uart_bridge_init(uart_data_received_cb_t data_cb)
 	err = uart_callback_set(uart, uart_cb, NULL);
 	if (err) {
 		LOG_ERR("Failed to set UART callback: %d", err);
-		k_free(rx);
 		return err;
 	}
 
 	/* Send welcome message */
-	tx = k_malloc(sizeof(*tx));
+	tx = uart_buf_alloc(&tx_pool);
 	if (tx) {
 		tx->len = snprintf(tx->data, sizeof(tx->data), "BLE Bridge Ready\r\n");
 		if (tx->len > 0 && tx->len < sizeof(tx->data)) {
 			err = uart_tx(uart, tx->data, tx->len, SYS_FOREVER_MS);
 			if (err) {
 				LOG_WRN("Failed to send welcome message: %d", err);
-				k_free(tx);
+				uart_buf_free(tx);
 			}
 		} else {
-			k_free(tx);
+			uart_buf_free(tx);
 		}
 	}
 
 	/* Enable RX */
-	err = uart_rx_enable(uart, rx->data, sizeof(rx->data), UART_WAIT_FOR_RX_MS);
+	err = uart_rx_start();
 	if (err) {
 		LOG_ERR("Failed to enable RX: %d", err);
-		k_free(rx);
 		return err;
 	}
 
 	uart_initialized = true;
+	app_status_set(APP_STATUS_UART_READY, true);
 	LOG_INF("UART bridge initialized");
 	return 0;
 }
@@ -273,10 +425,11 @@ int uart_bridge_send(const uint8_t *data, uint16_t len)
 	}
 
 	for (uint16_t pos = 0; pos < len;) {
-		struct uart_data_t *tx = k_malloc(sizeof(*tx));
+		struct uart_data_t *tx = uart_buf_alloc(&tx_pool);
 
 		if (!tx) {
 			LOG_ERR("Failed to allocate TX buffer at offset %u/%u", pos, len);
+			metrics_add(METRICS_DROP_UART_TX_BYTES, len - pos);
 			k_sleep(K_MSEC(10));
 			return -ENOMEM;
 		}
@@ -299,6 +452,7 @@ int uart_bridge_send(const uint8_t *data, uint16_t len)
 			tx->len++;
 		}
 
+		trace_event(TRACE_UART_TX, tx->data, tx->len);
 		err = uart_tx(uart, tx->data, tx->len, SYS_FOREVER_MS);
 		if (err) {
 			LOG_DBG("TX busy, queuing %u bytes", tx->len);
@@ -306,5 +460,16 @@ int uart_bridge_send(const uint8_t *data, uint16_t len)
 		}
 	}
 
+	metrics_add(METRICS_UART_TX_BYTES, len);
 	return 0;
-}
\ No newline at end of file
+}
+
+void uart_bridge_get_pool_stats(struct uart_bridge_pool_stats *stats)
+{
+	stats->rx_in_use = rx_ring_used(&rx_ring);
+	stats->rx_high_water = atomic_get(&rx_high_water);
+	stats->rx_exhausted = atomic_get(&rx_ring_full);
+	stats->tx_in_use = atomic_get(&tx_pool.in_use);
+	stats->tx_high_water = atomic_get(&tx_pool.high_water);
+	stats->tx_exhausted = atomic_get(&tx_pool.exhausted);
+}
@@ -15,6 +15,21 @@
  */
 typedef void (*uart_data_received_cb_t)(const uint8_t *data, uint16_t len);
 
+/**
+ * @brief UART buffer counters
+ *
+ * RX counts bytes in the RX ring (exhausted = times the ring was full when
+ * the driver asked for a buffer); TX counts blocks in the TX pool.
+ */
+struct uart_bridge_pool_stats {
+	uint32_t rx_in_use;
+	uint32_t rx_high_water;
+	uint32_t rx_exhausted;
+	uint32_t tx_in_use;
+	uint32_t tx_high_water;
+	uint32_t tx_exhausted;
+};
+
 /**
  * @brief Initialize UART bridge
  * @param data_cb Callback for received UART data
@@ -30,4 +45,10 @@ int uart_bridge_init(uart_data_received_cb_t data_cb);
  */
 int uart_bridge_send(const uint8_t *data, uint16_t len);
 
-#endif /* UART_BRIDGE_H */
\ No newline at end of file
+/**
+ * @brief Get buffer pool usage counters
+ * @param stats Filled with current, high-water and exhaustion counts
+ */
+void uart_bridge_get_pool_stats(struct uart_bridge_pool_stats *stats);
+
+#endif /* UART_BRIDGE_H */
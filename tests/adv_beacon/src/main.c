@@ -0,0 +1,166 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for adv_beacon module.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/fff.h>
+#include <string.h>
+
+DEFINE_FFF_GLOBALS;
+
+/* Kconfig values */
+#define CONFIG_RADPRO_ADV_BEACON_COMPANY_ID 0xffff
+#define CONFIG_RADPRO_RADIATION_SERVICE 1
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+/* BT type stubs */
+#include "bt_mocks.h"
+
+#include "ble/ble_service.h"
+#include "ble/radiation_service.h"
+#include "radpro/radpro_sampler.h"
+#include "ble/adv_beacon.h"
+
+/* FFF fakes — sampler, radiation service, advertising */
+DECLARE_FAKE_VALUE_FUNC(int, radpro_sampler_add_listener, radpro_sample_cb_t);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_sampler_add_listener, radpro_sample_cb_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, radiation_service_get, enum radiation_value,
+			uint32_t *);
+DEFINE_FAKE_VALUE_FUNC(int, radiation_service_get, enum radiation_value,
+		       uint32_t *);
+
+DECLARE_FAKE_VALUE_FUNC(int, ble_service_set_mfg_data, const uint8_t *,
+			uint8_t);
+DEFINE_FAKE_VALUE_FUNC(int, ble_service_set_mfg_data, const uint8_t *,
+		       uint8_t);
+
+/* Advertised record — the CUT passes a stack buffer */
+static uint8_t adv_record[ADV_BEACON_LEN];
+static int test_set_mfg_data_custom(const uint8_t *data, uint8_t len)
+{
+	memcpy(adv_record, data, MIN(len, sizeof(adv_record)));
+	return 0;
+}
+
+static uint32_t test_battery_mv;
+static int test_radiation_service_get_custom(enum radiation_value id,
+					     uint32_t *value)
+{
+	if (id != RADIATION_BATTERY || !test_battery_mv) {
+		return -ENODATA;
+	}
+
+	*value = test_battery_mv;
+	return 0;
+}
+
+/* Include CUT */
+#include "ble/adv_beacon.c"
+
+static void sample(uint32_t cpm_x100, uint32_t delta)
+{
+	struct radpro_sample s = {
+		.cpm_short_x100 = cpm_x100,
+		.delta = delta,
+	};
+
+	radpro_sampler_add_listener_fake.arg0_val(&s);
+}
+
+/* --- FFF reset rule --- */
+static void fff_reset_rule_before(const struct ztest_unit_test *test,
+				  void *fixture)
+{
+	RESET_FAKE(radpro_sampler_add_listener);
+	RESET_FAKE(radiation_service_get);
+	RESET_FAKE(ble_service_set_mfg_data);
+	FFF_RESET_HISTORY();
+
+	ble_service_set_mfg_data_fake.custom_fake = test_set_mfg_data_custom;
+	radiation_service_get_fake.custom_fake = test_radiation_service_get_custom;
+	memset(adv_record, 0, sizeof(adv_record));
+	test_battery_mv = 0;
+	beacon_seq = 0;
+
+	adv_beacon_init();
+}
+
+ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
+
+/* --- Tests --- */
+
+ZTEST(adv_beacon, test_init_subscribes_to_sampler)
+{
+	zassert_equal(radpro_sampler_add_listener_fake.call_count, 1);
+	zassert_equal(ble_service_set_mfg_data_fake.call_count, 0,
+		      "Nothing advertised before the first sample");
+}
+
+ZTEST(adv_beacon, test_record_layout)
+{
+	test_battery_mv = 3952;
+
+	sample(60000, 10);
+
+	zassert_equal(ble_service_set_mfg_data_fake.call_count, 1);
+	zassert_equal(ble_service_set_mfg_data_fake.arg1_val, ADV_BEACON_LEN);
+	zassert_equal(sys_get_le16(&adv_record[0]), 0xffff);
+	zassert_equal(adv_record[2], ADV_BEACON_VERSION);
+	zassert_equal(adv_record[3], 0);
+	zassert_equal(sys_get_le32(&adv_record[4]), 60000);
+	zassert_equal(sys_get_le16(&adv_record[8]), 10);
+	zassert_equal(sys_get_le16(&adv_record[10]), 3952);
+}
+
+ZTEST(adv_beacon, test_sequence_increments_and_wraps)
+{
+	for (int i = 0; i < 256; i++) {
+		sample(100, 1);
+	}
+	zassert_equal(adv_record[3], 255);
+
+	sample(100, 1);
+	zassert_equal(adv_record[3], 0);
+}
+
+ZTEST(adv_beacon, test_unknown_battery_is_zero)
+{
+	sample(100, 1);
+
+	zassert_equal(sys_get_le16(&adv_record[10]), 0);
+}
+
+ZTEST(adv_beacon, test_delta_saturates)
+{
+	sample(100, 70000);
+
+	zassert_equal(sys_get_le16(&adv_record[8]), UINT16_MAX);
+}
+
+ZTEST_SUITE(adv_beacon, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,137 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for app_status module.
+ */
+
+#include <zephyr/ztest.h>
+#include <string.h>
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+#ifdef LOG_DBG
+#undef LOG_DBG
+#endif
+#define LOG_DBG(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+/* Include CUT */
+#include "status/app_status.c"
+
+/* Subscriber capture */
+struct test_sub {
+	int calls;
+	uint32_t status;
+	uint32_t changed;
+};
+
+static struct test_sub subs[2];
+
+static void test_sub0(uint32_t status, uint32_t changed)
+{
+	subs[0].calls++;
+	subs[0].status = status;
+	subs[0].changed = changed;
+}
+
+static void test_sub1(uint32_t status, uint32_t changed)
+{
+	subs[1].calls++;
+	subs[1].status = status;
+	subs[1].changed = changed;
+}
+
+static void status_before(void *fixture)
+{
+	atomic_clear(&status);
+	atomic_clear(&subscriber_count);
+	memset(subscribers, 0, sizeof(subscribers));
+	memset(subs, 0, sizeof(subs));
+}
+
+/* --- Tests --- */
+
+ZTEST(app_status, test_set_and_get)
+{
+	app_status_set(APP_STATUS_PAIRING_WINDOW, true);
+	app_status_set(APP_STATUS_UART_READY, true);
+	zassert_equal(app_status_get(), APP_STATUS_BIT(APP_STATUS_PAIRING_WINDOW) |
+					APP_STATUS_BIT(APP_STATUS_UART_READY));
+
+	app_status_set(APP_STATUS_PAIRING_WINDOW, false);
+	zassert_equal(app_status_get(), APP_STATUS_BIT(APP_STATUS_UART_READY));
+}
+
+ZTEST(app_status, test_subscribe_replays_current_status)
+{
+	app_status_set(APP_STATUS_CONNECTED, true);
+
+	zassert_ok(app_status_subscribe(test_sub0));
+
+	zassert_equal(subs[0].calls, 1);
+	zassert_equal(subs[0].status, APP_STATUS_BIT(APP_STATUS_CONNECTED));
+	zassert_equal(subs[0].changed, APP_STATUS_ALL);
+}
+
+ZTEST(app_status, test_changes_reach_every_subscriber)
+{
+	app_status_subscribe(test_sub0);
+	app_status_subscribe(test_sub1);
+
+	app_status_set(APP_STATUS_AUTHENTICATED, true);
+
+	for (int i = 0; i < 2; i++) {
+		zassert_equal(subs[i].calls, 2);
+		zassert_equal(subs[i].status, APP_STATUS_BIT(APP_STATUS_AUTHENTICATED));
+		zassert_equal(subs[i].changed, APP_STATUS_BIT(APP_STATUS_AUTHENTICATED));
+	}
+}
+
+ZTEST(app_status, test_unchanged_flag_not_published)
+{
+	app_status_subscribe(test_sub0);
+
+	app_status_set(APP_STATUS_ERROR, false);
+	zassert_equal(subs[0].calls, 1);
+
+	app_status_set(APP_STATUS_ERROR, true);
+	app_status_set(APP_STATUS_ERROR, true);
+	zassert_equal(subs[0].calls, 2);
+}
+
+ZTEST(app_status, test_subscriber_slots_limited)
+{
+	for (int i = 0; i < APP_STATUS_MAX_SUBSCRIBERS; i++) {
+		zassert_ok(app_status_subscribe(test_sub0));
+	}
+
+	zassert_equal(app_status_subscribe(test_sub1), -ENOMEM);
+	zassert_equal(subs[1].calls, 0);
+
+	app_status_set(APP_STATUS_CONNECTED, true);
+	zassert_equal(subs[0].calls, 2 * APP_STATUS_MAX_SUBSCRIBERS);
+	zassert_equal(subs[1].calls, 0);
+}
+
+ZTEST_SUITE(app_status, NULL, NULL, status_before, NULL, NULL);
@@ -46,6 +46,29 @@ DEFINE_FFF_GLOBALS;
 
 /* ble_service.c uses CONFIG_BT_USER_DATA_LEN_UPDATE — leave undefined */
 
+#define CONFIG_BT_MAX_CONN 2
+#define CONFIG_RADPRO_NUS_TX_WINDOW 4
+#define CONFIG_RADPRO_ADV_BONDED_ONLY 1
+#define CONFIG_RADPRO_ADV_FAST_S 30
+#define CONFIG_RADPRO_ADV_MEDIUM_S 300
+#define CONFIG_RADPRO_L2CAP_COC 1
+#define CONFIG_RADPRO_METRICS 1
+
+#include "metrics/metrics.h"
+
+/* FFF fakes — metrics */
+DECLARE_FAKE_VOID_FUNC(metrics_add, enum metrics_id, uint32_t);
+DEFINE_FAKE_VOID_FUNC(metrics_add, enum metrics_id, uint32_t);
+
+DECLARE_FAKE_VOID_FUNC(metrics_set, enum metrics_id, uint32_t);
+DEFINE_FAKE_VOID_FUNC(metrics_set, enum metrics_id, uint32_t);
+
+/* FFF fakes — status channel */
+#include "status/app_status.h"
+
+DECLARE_FAKE_VOID_FUNC(app_status_set, enum app_status_flag, bool);
+DEFINE_FAKE_VOID_FUNC(app_status_set, enum app_status_flag, bool);
+
 /* FFF fakes — BT connection functions — DECLARE then DEFINE */
 DECLARE_FAKE_VALUE_FUNC(struct bt_conn *, bt_conn_ref, struct bt_conn *);
 DEFINE_FAKE_VALUE_FUNC(struct bt_conn *, bt_conn_ref, struct bt_conn *);
@@ -53,6 +76,9 @@ DEFINE_FAKE_VALUE_FUNC(struct bt_conn *, bt_conn_ref, struct bt_conn *);
 DECLARE_FAKE_VOID_FUNC(bt_conn_unref, struct bt_conn *);
 DEFINE_FAKE_VOID_FUNC(bt_conn_unref, struct bt_conn *);
 
+DECLARE_FAKE_VALUE_FUNC(uint8_t, bt_conn_index, const struct bt_conn *);
+DEFINE_FAKE_VALUE_FUNC(uint8_t, bt_conn_index, const struct bt_conn *);
+
 DECLARE_FAKE_VALUE_FUNC(bt_security_t, bt_conn_get_security,
 			struct bt_conn *);
 DEFINE_FAKE_VALUE_FUNC(bt_security_t, bt_conn_get_security,
@@ -85,10 +111,23 @@ DECLARE_FAKE_VALUE_FUNC(int, bt_nus_cb_register, struct bt_nus_cb *,
 DEFINE_FAKE_VALUE_FUNC(int, bt_nus_cb_register, struct bt_nus_cb *,
 		       void *);
 
-DECLARE_FAKE_VALUE_FUNC(int, bt_nus_send, struct bt_conn *,
-			const uint8_t *, uint16_t);
-DEFINE_FAKE_VALUE_FUNC(int, bt_nus_send, struct bt_conn *,
-		       const uint8_t *, uint16_t);
+/* FFF fakes — L2CAP CoC transport (callback type from ble_service.h) */
+#include "ble/ble_service.h"
+
+DECLARE_FAKE_VALUE_FUNC(int, l2cap_coc_init, ble_data_received_cb_t);
+DEFINE_FAKE_VALUE_FUNC(int, l2cap_coc_init, ble_data_received_cb_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, bt_gatt_notify_cb, struct bt_conn *,
+			struct bt_gatt_notify_params *);
+DEFINE_FAKE_VALUE_FUNC(int, bt_gatt_notify_cb, struct bt_conn *,
+		       struct bt_gatt_notify_params *);
+
+DECLARE_FAKE_VALUE_FUNC(const struct bt_gatt_attr *, bt_gatt_find_by_uuid,
+			const struct bt_gatt_attr *, uint16_t,
+			const struct bt_uuid *);
+DEFINE_FAKE_VALUE_FUNC(const struct bt_gatt_attr *, bt_gatt_find_by_uuid,
+		       const struct bt_gatt_attr *, uint16_t,
+		       const struct bt_uuid *);
 
 /* FFF fakes — advertising */
 DECLARE_FAKE_VALUE_FUNC(int, bt_le_adv_start, const struct bt_le_adv_param *,
@@ -98,6 +137,65 @@ DEFINE_FAKE_VALUE_FUNC(int, bt_le_adv_start, const struct bt_le_adv_param *,
 		       const struct bt_data *, size_t,
 		       const struct bt_data *, size_t);
 
+DECLARE_FAKE_VALUE_FUNC(int, bt_le_adv_update_data, const struct bt_data *,
+			size_t, const struct bt_data *, size_t);
+DEFINE_FAKE_VALUE_FUNC(int, bt_le_adv_update_data, const struct bt_data *,
+		       size_t, const struct bt_data *, size_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, bt_le_filter_accept_list_add, const bt_addr_le_t *);
+DEFINE_FAKE_VALUE_FUNC(int, bt_le_filter_accept_list_add, const bt_addr_le_t *);
+
+DECLARE_FAKE_VALUE_FUNC(bool, bt_le_bond_exists, uint8_t, const bt_addr_le_t *);
+DEFINE_FAKE_VALUE_FUNC(bool, bt_le_bond_exists, uint8_t, const bt_addr_le_t *);
+
+typedef void (*bt_foreach_bond_cb_t)(const struct bt_bond_info *, void *);
+DECLARE_FAKE_VOID_FUNC(bt_foreach_bond, uint8_t, bt_foreach_bond_cb_t, void *);
+DEFINE_FAKE_VOID_FUNC(bt_foreach_bond, uint8_t, bt_foreach_bond_cb_t, void *);
+
+/* Advertising parameters — the CUT passes a stack copy */
+static struct bt_le_adv_param last_adv_param;
+static bt_addr_le_t last_adv_peer;
+static int bt_le_adv_start_capture(const struct bt_le_adv_param *param,
+				   const struct bt_data *ad, size_t ad_len,
+				   const struct bt_data *sd, size_t sd_len)
+{
+	last_adv_param = *param;
+	if (param->peer) {
+		last_adv_peer = *param->peer;
+	}
+	return 0;
+}
+
+/* Notification parameters — the CUT passes a stack copy */
+static void *last_notify_user_data;
+static int bt_gatt_notify_cb_capture(struct bt_conn *conn,
+				     struct bt_gatt_notify_params *params)
+{
+	last_notify_user_data = params->user_data;
+	return 0;
+}
+
+/* Zero-arg functions — manual stubs */
+static int bt_le_adv_stop_call_count;
+int bt_le_adv_stop(void)
+{
+	bt_le_adv_stop_call_count++;
+	return 0;
+}
+
+static int bt_le_filter_accept_list_clear_call_count;
+int bt_le_filter_accept_list_clear(void)
+{
+	bt_le_filter_accept_list_clear_call_count++;
+	return 0;
+}
+
+static bool test_pairing_allowed;
+bool security_manager_is_pairing_allowed(void)
+{
+	return test_pairing_allowed;
+}
+
 /* FFF fakes — kernel work */
 DECLARE_FAKE_VOID_FUNC(k_work_init, struct k_work *, k_work_handler_t);
 DEFINE_FAKE_VOID_FUNC(k_work_init, struct k_work *, k_work_handler_t);
@@ -105,8 +203,89 @@ DEFINE_FAKE_VOID_FUNC(k_work_init, struct k_work *, k_work_handler_t);
 DECLARE_FAKE_VALUE_FUNC(int, k_work_submit, struct k_work *);
 DEFINE_FAKE_VALUE_FUNC(int, k_work_submit, struct k_work *);
 
+DECLARE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+			k_work_handler_t);
+DEFINE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+		      k_work_handler_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+			k_timeout_t);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+		       k_timeout_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_cancel_delayable, struct k_work_delayable *);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_cancel_delayable, struct k_work_delayable *);
+
+/* k_sem_* are syscalls in kernel.h — use macro redirect */
+static int k_sem_give_fake_call_count;
+static struct k_sem *k_sem_give_fake_last_sem;
+static void test_k_sem_give(struct k_sem *sem)
+{
+	k_sem_give_fake_call_count++;
+	k_sem_give_fake_last_sem = sem;
+}
+#define k_sem_give(sem) test_k_sem_give(sem)
+
+static int k_sem_take_fake_return_val;
+static k_timeout_t k_sem_take_fake_timeout;
+static int test_k_sem_take(struct k_sem *sem, k_timeout_t timeout)
+{
+	k_sem_take_fake_timeout = timeout;
+	return k_sem_take_fake_return_val;
+}
+#define k_sem_take(sem, timeout) test_k_sem_take(sem, timeout)
+
+static int k_sem_init_fake_call_count;
+static int test_k_sem_init(struct k_sem *sem, unsigned int initial, unsigned int limit)
+{
+	k_sem_init_fake_call_count++;
+	return 0;
+}
+#define k_sem_init(sem, initial, limit) test_k_sem_init(sem, initial, limit)
+
+static int k_sem_reset_fake_call_count;
+static void test_k_sem_reset(struct k_sem *sem)
+{
+	k_sem_reset_fake_call_count++;
+}
+#define k_sem_reset(sem) test_k_sem_reset(sem)
+
+/* k_mutex_lock/k_mutex_unlock are syscalls in kernel.h — use macro redirect */
+static int test_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+	return 0;
+}
+#define k_mutex_lock(mutex, timeout) test_k_mutex_lock(mutex, timeout)
+
+static int test_k_mutex_unlock(struct k_mutex *mutex)
+{
+	return 0;
+}
+#define k_mutex_unlock(mutex) test_k_mutex_unlock(mutex)
+
+/* Stub K_MUTEX_DEFINE — just declare the struct */
+#ifdef K_MUTEX_DEFINE
+#undef K_MUTEX_DEFINE
+#endif
+#define K_MUTEX_DEFINE(name) struct k_mutex name
+
+/* Stub K_SEM_DEFINE — just declare the struct */
+#ifdef K_SEM_DEFINE
+#undef K_SEM_DEFINE
+#endif
+#define K_SEM_DEFINE(name, initial, limit) struct k_sem name
+
+/* Thread identity — decides whether a sender may block */
+static struct k_thread test_app_thread;
+static struct k_thread test_sys_wq_thread;
+static k_tid_t test_current_thread;
+#define k_current_get() (test_current_thread)
+#define k_work_queue_thread_get(q) (&test_sys_wq_thread)
+
 /* Test state */
 static struct bt_conn test_conn;
+static struct bt_conn test_conn2;
+static struct bt_gatt_attr test_tx_attr;
 static bt_addr_le_t test_addr;
 static bool test_data_received;
 static const uint8_t *test_data_ptr;
@@ -120,21 +299,52 @@ static void test_data_cb(struct bt_conn *conn, const uint8_t *data,
 	test_data_len = len;
 }
 
+static inline bool bt_addr_le_eq(const bt_addr_le_t *a, const bt_addr_le_t *b)
+{
+	return memcmp(a, b, sizeof(*a)) == 0;
+}
+
 /* bt_conn_ref returns the conn passed in */
 static struct bt_conn *bt_conn_ref_passthrough(struct bt_conn *conn)
 {
 	return conn;
 }
 
+/* test_conn sits in slot 0, test_conn2 in slot 1 */
+static uint8_t bt_conn_index_custom(const struct bt_conn *conn)
+{
+	return conn == &test_conn2 ? 1 : 0;
+}
+
+/* Total added to a counter */
+static uint32_t metrics_added(enum metrics_id id)
+{
+	uint32_t sum = 0;
+
+	for (unsigned int i = 0; i < metrics_add_fake.call_count; i++) {
+		if (metrics_add_fake.arg0_history[i] == id) {
+			sum += metrics_add_fake.arg1_history[i];
+		}
+	}
+	return sum;
+}
+
 /* Include CUT */
 #include "ble/ble_service.c"
 
+/* Fake a connection in its slot, as connected() would */
+static void set_peer(struct bt_conn *conn)
+{
+	peers[bt_conn_index_custom(conn)].conn = conn;
+}
+
 /* --- FFF reset rule --- */
 static void fff_reset_rule_before(const struct ztest_unit_test *test,
 				  void *fixture)
 {
 	RESET_FAKE(bt_conn_ref);
 	RESET_FAKE(bt_conn_unref);
+	RESET_FAKE(bt_conn_index);
 	RESET_FAKE(bt_conn_get_security);
 	RESET_FAKE(bt_conn_get_dst);
 	RESET_FAKE(bt_addr_le_to_str);
@@ -142,21 +352,57 @@ static void fff_reset_rule_before(const struct ztest_unit_test *test,
 	RESET_FAKE(bt_gatt_get_mtu);
 	RESET_FAKE(bt_gatt_cb_register);
 	RESET_FAKE(bt_nus_cb_register);
-	RESET_FAKE(bt_nus_send);
+	RESET_FAKE(l2cap_coc_init);
+	RESET_FAKE(bt_gatt_notify_cb);
+	RESET_FAKE(bt_gatt_find_by_uuid);
 	RESET_FAKE(bt_le_adv_start);
+	RESET_FAKE(bt_le_adv_update_data);
+	RESET_FAKE(bt_le_filter_accept_list_add);
+	RESET_FAKE(bt_le_bond_exists);
+	RESET_FAKE(bt_foreach_bond);
+	bt_le_adv_stop_call_count = 0;
+	bt_le_filter_accept_list_clear_call_count = 0;
+	test_pairing_allowed = true;
 	RESET_FAKE(k_work_init);
 	RESET_FAKE(k_work_submit);
+	RESET_FAKE(k_work_init_delayable);
+	RESET_FAKE(k_work_reschedule);
+	RESET_FAKE(k_work_cancel_delayable);
+	RESET_FAKE(metrics_add);
+	RESET_FAKE(metrics_set);
+	RESET_FAKE(app_status_set);
 	FFF_RESET_HISTORY();
 
 	/* Reset module state */
-	current_conn = NULL;
-	current_mtu = 23;
+	for (int i = 0; i < BLE_SERVICE_MAX_CONN; i++) {
+		peers[i].conn = NULL;
+		peers[i].mtu = ATT_DEFAULT_MTU;
+	}
 	data_received_callback = NULL;
+	disconnected_callback = NULL;
+	nus_tx_attr = &test_tx_attr;
+	mfg_pending_len = 0;
+	ad[ARRAY_SIZE(ad) - 1].data_len = 0;
+	have_last_peer = false;
+	directed_pending = false;
+	atomic_set(&adv_stage, 0);
+	bt_le_adv_start_fake.custom_fake = bt_le_adv_start_capture;
+	memset(&last_adv_param, 0, sizeof(last_adv_param));
+	memset(&last_adv_peer, 0, sizeof(last_adv_peer));
+	k_sem_give_fake_call_count = 0;
+	k_sem_give_fake_last_sem = NULL;
+	k_sem_init_fake_call_count = 0;
+	k_sem_take_fake_return_val = 0;
+	k_sem_take_fake_timeout = K_NO_WAIT;
+	k_sem_reset_fake_call_count = 0;
+	test_current_thread = &test_app_thread;
 
 	/* Defaults */
 	bt_conn_ref_fake.custom_fake = bt_conn_ref_passthrough;
+	bt_conn_index_fake.custom_fake = bt_conn_index_custom;
 	bt_conn_get_dst_fake.return_val = &test_addr;
 	bt_conn_get_security_fake.return_val = BT_SECURITY_L2;
+	bt_gatt_find_by_uuid_fake.return_val = &test_tx_attr;
 
 	test_data_received = false;
 	test_data_ptr = NULL;
@@ -174,74 +420,219 @@ ZTEST(ble_service, test_init_registers_nus)
 	zassert_equal(err, 0);
 	zassert_equal(bt_nus_cb_register_fake.call_count, 1);
 	zassert_equal(bt_gatt_cb_register_fake.call_count, 1);
-	zassert_equal(k_work_init_fake.call_count, 1);
+	zassert_equal(k_work_init_fake.call_count, 3);
+	zassert_equal(k_sem_init_fake_call_count, CONFIG_BT_MAX_CONN,
+		      "One TX window per connection slot");
+	zassert_equal(nus_tx_attr, &test_tx_attr);
 }
 
-ZTEST(ble_service, test_send_no_connection_fails)
+ZTEST(ble_service, test_init_registers_l2cap_server)
 {
-	current_conn = NULL;
+	int err = ble_service_init(test_data_cb);
+
+	zassert_equal(err, 0);
+	zassert_equal(l2cap_coc_init_fake.call_count, 1);
+	zassert_equal(l2cap_coc_init_fake.arg0_val, test_data_cb,
+		      "Commands from both transports take the same path");
+}
+
+ZTEST(ble_service, test_init_fails_when_l2cap_server_fails)
+{
+	l2cap_coc_init_fake.return_val = -EINVAL;
+
+	int err = ble_service_init(test_data_cb);
+
+	zassert_equal(err, -EINVAL);
+}
+
+ZTEST(ble_service, test_init_fails_without_nus_tx_attr)
+{
+	bt_gatt_find_by_uuid_fake.return_val = NULL;
+
+	int err = ble_service_init(test_data_cb);
+
+	zassert_equal(err, -ENOENT);
+}
 
-	int err = ble_service_send((const uint8_t *)"hi", 2);
+ZTEST(ble_service, test_send_no_connection_fails)
+{
+	int err = ble_service_send(&test_conn, (const uint8_t *)"hi", 2, K_SECONDS(1));
 
 	zassert_equal(err, -ENOTCONN);
-	zassert_equal(bt_nus_send_fake.call_count, 0);
+	zassert_equal(bt_gatt_notify_cb_fake.call_count, 0);
 }
 
 ZTEST(ble_service, test_send_not_authenticated_fails)
 {
-	current_conn = &test_conn;
+	set_peer(&test_conn);
 	bt_conn_get_security_fake.return_val = BT_SECURITY_L1;
 
-	int err = ble_service_send((const uint8_t *)"hi", 2);
+	int err = ble_service_send(&test_conn, (const uint8_t *)"hi", 2, K_SECONDS(1));
 
 	zassert_equal(err, -ENOTCONN);
-	zassert_equal(bt_nus_send_fake.call_count, 0);
+	zassert_equal(bt_gatt_notify_cb_fake.call_count, 0);
 }
 
 ZTEST(ble_service, test_send_authenticated_succeeds)
 {
-	current_conn = &test_conn;
+	set_peer(&test_conn);
 	bt_conn_get_security_fake.return_val = BT_SECURITY_L2;
-	bt_nus_send_fake.return_val = 0;
+	bt_gatt_notify_cb_fake.return_val = 0;
 
-	int err = ble_service_send((const uint8_t *)"data", 4);
+	int err = ble_service_send(&test_conn, (const uint8_t *)"data", 4, K_SECONDS(1));
 
 	zassert_equal(err, 0);
-	zassert_equal(bt_nus_send_fake.call_count, 1);
+	zassert_equal(bt_gatt_notify_cb_fake.call_count, 1);
+	zassert_equal(bt_gatt_notify_cb_fake.arg0_val, &test_conn);
+	/* Credit taken and not returned until the completion fires */
+	zassert_equal(k_sem_give_fake_call_count, 0);
+	zassert_true(K_TIMEOUT_EQ(k_sem_take_fake_timeout, K_SECONDS(1)));
+}
+
+ZTEST(ble_service, test_send_routes_to_own_window)
+{
+	set_peer(&test_conn);
+	set_peer(&test_conn2);
+
+	bt_gatt_notify_cb_fake.custom_fake = bt_gatt_notify_cb_capture;
+
+	ble_service_send(&test_conn2, (const uint8_t *)"data", 4, K_NO_WAIT);
+
+	zassert_equal(bt_gatt_notify_cb_fake.arg0_val, &test_conn2);
+
+	/* The completion returns the credit to that connection only */
+	nus_tx_complete(&test_conn2, last_notify_user_data);
+	zassert_equal(k_sem_give_fake_last_sem, &peers[1].tx_credits);
+}
+
+ZTEST(ble_service, test_send_window_full_returns_eagain)
+{
+	set_peer(&test_conn);
+	k_sem_take_fake_return_val = -EAGAIN;
+
+	int err = ble_service_send(&test_conn, (const uint8_t *)"data", 4, K_SECONDS(1));
+
+	zassert_equal(err, -EAGAIN);
+	zassert_equal(bt_gatt_notify_cb_fake.call_count, 0);
+}
+
+ZTEST(ble_service, test_send_from_sys_workqueue_does_not_block)
+{
+	set_peer(&test_conn);
+	test_current_thread = &test_sys_wq_thread;
+
+	ble_service_send(&test_conn, (const uint8_t *)"data", 4, K_SECONDS(1));
+
+	zassert_true(K_TIMEOUT_EQ(k_sem_take_fake_timeout, K_NO_WAIT));
+}
+
+ZTEST(ble_service, test_send_no_buffers_returns_credit)
+{
+	set_peer(&test_conn);
+	bt_gatt_notify_cb_fake.return_val = -ENOMEM;
+
+	int err = ble_service_send(&test_conn, (const uint8_t *)"data", 4, K_SECONDS(1));
+
+	zassert_equal(err, -EAGAIN, "ENOMEM should be reported as retryable");
+	zassert_equal(k_sem_give_fake_call_count, 1);
+}
+
+ZTEST(ble_service, test_tx_complete_returns_credit)
+{
+	nus_tx_complete(&test_conn, &peers[0]);
+
+	zassert_equal(k_sem_give_fake_call_count, 1);
+	zassert_equal(k_sem_give_fake_last_sem, &peers[0].tx_credits);
+}
+
+ZTEST(ble_service, test_connected_opens_tx_window)
+{
+	connected(&test_conn, 0);
+
+	zassert_equal(k_sem_give_fake_call_count, CONFIG_RADPRO_NUS_TX_WINDOW);
+	zassert_equal(k_sem_give_fake_last_sem, &peers[0].tx_credits);
+}
+
+ZTEST(ble_service, test_disconnected_releases_blocked_senders)
+{
+	set_peer(&test_conn);
+
+	disconnected(&test_conn, 0);
+
+	zassert_equal(k_sem_reset_fake_call_count, 1);
 }
 
 ZTEST(ble_service, test_mtu_default_23)
 {
-	zassert_equal(ble_service_get_mtu(), 23);
+	set_peer(&test_conn);
+
+	zassert_equal(ble_service_get_mtu(&test_conn), 23);
+	zassert_equal(ble_service_get_mtu(NULL), 23);
 }
 
 ZTEST(ble_service, test_mtu_updates_on_callback)
 {
-	gatt_mtu_updated_cb(NULL, 247, 251);
+	set_peer(&test_conn);
+	set_peer(&test_conn2);
 
-	/* MIN(tx, rx) = 247 */
-	zassert_equal(ble_service_get_mtu(), 247);
+	gatt_mtu_updated_cb(&test_conn2, 247, 251);
+
+	/* MIN(tx, rx) = 247, other connection unchanged */
+	zassert_equal(ble_service_get_mtu(&test_conn2), 247);
+	zassert_equal(ble_service_get_mtu(&test_conn), 23);
 }
 
 ZTEST(ble_service, test_connected_stores_handle)
 {
 	connected(&test_conn, 0);
 
-	zassert_not_null(current_conn);
+	zassert_equal(ble_service_get_connection(0), &test_conn);
+	zassert_equal(ble_service_connection_count(), 1);
 	zassert_equal(bt_conn_ref_fake.call_count, 1);
 }
 
+ZTEST(ble_service, test_second_central_gets_own_slot)
+{
+	connected(&test_conn, 0);
+	connected(&test_conn2, 0);
+
+	zassert_equal(ble_service_get_connection(0), &test_conn);
+	zassert_equal(ble_service_get_connection(1), &test_conn2);
+	zassert_equal(ble_service_connection_count(), 2);
+	zassert_is_null(ble_service_get_connection(BLE_SERVICE_MAX_CONN));
+}
+
 ZTEST(ble_service, test_disconnected_clears_state)
 {
 	/* Setup connected state */
-	current_conn = &test_conn;
-	current_mtu = 247;
+	set_peer(&test_conn);
+	set_peer(&test_conn2);
+	peers[0].mtu = 247;
 
 	disconnected(&test_conn, 0);
 
-	zassert_is_null(current_conn);
-	zassert_equal(current_mtu, 23, "MTU should reset to 23");
+	zassert_is_null(ble_service_get_connection(0));
+	zassert_equal(peers[0].mtu, 23, "MTU should reset to 23");
 	zassert_equal(bt_conn_unref_fake.call_count, 1);
+	zassert_equal(ble_service_get_connection(1), &test_conn2,
+		      "Other central stays connected");
+}
+
+static struct bt_conn *disconnected_cb_conn;
+static void test_disconnected_cb(struct bt_conn *conn)
+{
+	disconnected_cb_conn = conn;
+}
+
+ZTEST(ble_service, test_disconnected_notifies_callback)
+{
+	disconnected_cb_conn = NULL;
+	ble_service_set_disconnected_cb(test_disconnected_cb);
+	set_peer(&test_conn2);
+
+	disconnected(&test_conn2, 0x13);
+
+	zassert_equal(disconnected_cb_conn, &test_conn2);
 }
 
 ZTEST(ble_service, test_disconnected_restarts_adv)
@@ -249,27 +640,346 @@ ZTEST(ble_service, test_disconnected_restarts_adv)
 	/* recycled_cb is what restarts advertising after disconnect */
 	ble_service_init(test_data_cb);
 	RESET_FAKE(k_work_submit);
+	atomic_set(&adv_stage, 2);
 
 	recycled_cb();
 
-	/* ble_service_start_advertising → k_work_submit */
+	/* Restarted at the fast stage, advertising may still be running */
+	zassert_equal(k_work_submit_fake.call_count, 1);
+	zassert_equal(k_work_submit_fake.arg0_val, &adv_restart_work);
+	zassert_equal(atomic_get(&adv_stage), 0);
+}
+
+ZTEST(ble_service, test_adv_without_mfg_data)
+{
+	adv_work_handler(&adv_work);
+
+	zassert_equal(bt_le_adv_start_fake.call_count, 1);
+	zassert_equal(bt_le_adv_start_fake.arg2_val, 2,
+		      "Empty manufacturer data is not advertised");
+}
+
+ZTEST(ble_service, test_set_mfg_data_updates_adv)
+{
+	const uint8_t data[] = { 0xff, 0xff, 0x01, 0x02 };
+
+	zassert_equal(ble_service_set_mfg_data(data, sizeof(data)), 0);
+	zassert_equal(k_work_submit_fake.call_count, 1);
+
+	adv_update_work_handler(&adv_update_work);
+
+	zassert_equal(bt_le_adv_update_data_fake.call_count, 1);
+	zassert_equal(bt_le_adv_update_data_fake.arg1_val, 3);
+	zassert_equal(bt_le_adv_update_data_fake.arg0_val[2].type,
+		      BT_DATA_MANUFACTURER_DATA);
+	zassert_equal(bt_le_adv_update_data_fake.arg0_val[2].data_len, sizeof(data));
+	zassert_mem_equal(bt_le_adv_update_data_fake.arg0_val[2].data, data,
+			  sizeof(data));
+
+	/* Advertising restarts with the latest data */
+	adv_work_handler(&adv_work);
+	zassert_equal(bt_le_adv_start_fake.arg2_val, 3);
+}
+
+ZTEST(ble_service, test_set_mfg_data_too_long)
+{
+	uint8_t data[BLE_SERVICE_MFG_DATA_MAX + 1] = { 0 };
+
+	zassert_equal(ble_service_set_mfg_data(data, sizeof(data)), -EINVAL);
+	zassert_equal(k_work_submit_fake.call_count, 0);
+}
+
+/* Two bonds in the accept list */
+static void foreach_two_bonds(uint8_t id, bt_foreach_bond_cb_t func,
+			      void *user_data)
+{
+	struct bt_bond_info info = { 0 };
+
+	func(&info, user_data);
+	func(&info, user_data);
+}
+
+ZTEST(ble_service, test_adv_open_during_pairing_window)
+{
+	adv_work_handler(&adv_work);
+
+	zassert_equal(bt_le_adv_start_fake.call_count, 1);
+	zassert_equal(last_adv_param.options, BT_LE_ADV_OPT_CONN);
+	zassert_equal(bt_le_filter_accept_list_clear_call_count, 0);
+}
+
+ZTEST(ble_service, test_adv_filtered_after_pairing_window)
+{
+	test_pairing_allowed = false;
+	bt_foreach_bond_fake.custom_fake = foreach_two_bonds;
+
+	adv_work_handler(&adv_work);
+
+	zassert_equal(bt_le_filter_accept_list_clear_call_count, 1);
+	zassert_equal(bt_le_filter_accept_list_add_fake.call_count, 2);
+	zassert_equal(bt_le_adv_start_fake.call_count, 1);
+	zassert_true(last_adv_param.options & BT_LE_ADV_OPT_FILTER_CONN);
+}
+
+ZTEST(ble_service, test_directed_adv_to_last_bonded_peer)
+{
+	test_pairing_allowed = false;
+	bt_le_bond_exists_fake.return_val = true;
+	test_addr.a.val[0] = 0x42;
+
+	/* Bonded peer authenticates, then disconnects */
+	connected(&test_conn, 0);
+	security_changed(&test_conn, BT_SECURITY_L2, BT_SECURITY_ERR_SUCCESS);
+	disconnected(&test_conn, 0x13);
+
+	adv_work_handler(&adv_work);
+
+	zassert_equal(bt_le_adv_start_fake.call_count, 1);
+	zassert_equal(last_adv_peer.a.val[0], 0x42);
+	zassert_equal(bt_le_filter_accept_list_clear_call_count, 0);
+
+	/* Directed advertising timed out: fall back to the accept list,
+	 * restarted once, by recycled_cb */
+	RESET_FAKE(k_work_submit);
+	connected(NULL, BT_HCI_ERR_ADV_TIMEOUT);
+	zassert_equal(k_work_submit_fake.call_count, 0);
+
+	recycled_cb();
+	zassert_equal(k_work_submit_fake.call_count, 1);
+	zassert_equal(k_work_submit_fake.arg0_val, &adv_restart_work);
+
+	adv_work_handler(&adv_work);
+
+	zassert_equal(bt_le_adv_start_fake.call_count, 2);
+	zassert_is_null(last_adv_param.peer);
+	zassert_equal(bt_le_filter_accept_list_clear_call_count, 1);
+}
+
+ZTEST(ble_service, test_no_directed_adv_after_other_peer_leaves)
+{
+	static bt_addr_le_t other_addr = { .a.val = { 0x17 } };
+
+	test_pairing_allowed = false;
+	bt_le_bond_exists_fake.return_val = true;
+	test_addr.a.val[0] = 0x42;
+
+	connected(&test_conn, 0);
+	security_changed(&test_conn, BT_SECURITY_L2, BT_SECURITY_ERR_SUCCESS);
+
+	/* Another central disconnects: no invite for the bonded one */
+	connected(&test_conn2, 0);
+	bt_conn_get_dst_fake.return_val = &other_addr;
+	disconnected(&test_conn2, 0x13);
+
+	adv_work_handler(&adv_work);
+
+	zassert_is_null(last_adv_param.peer);
+	zassert_equal(bt_le_filter_accept_list_clear_call_count, 1);
+}
+
+ZTEST(ble_service, test_no_directed_adv_for_unbonded_peer)
+{
+	test_pairing_allowed = false;
+	bt_le_bond_exists_fake.return_val = false;
+
+	connected(&test_conn, 0);
+	security_changed(&test_conn, BT_SECURITY_L2, BT_SECURITY_ERR_SUCCESS);
+	disconnected(&test_conn, 0x13);
+
+	adv_work_handler(&adv_work);
+
+	zassert_equal(bt_le_adv_start_fake.call_count, 1);
+	zassert_equal(bt_le_filter_accept_list_clear_call_count, 1);
+}
+
+ZTEST(ble_service, test_restart_advertising)
+{
+	adv_restart_work_handler(&adv_restart_work);
+
+	zassert_equal(bt_le_adv_stop_call_count, 1);
+	zassert_equal(bt_le_adv_start_fake.call_count, 1);
+
+	/* One slot still free: keep advertising */
+	set_peer(&test_conn);
+	adv_restart_work_handler(&adv_restart_work);
+
+	zassert_equal(bt_le_adv_stop_call_count, 2);
+
+	/* All slots in use: nothing to restart */
+	set_peer(&test_conn2);
+	adv_restart_work_handler(&adv_restart_work);
+
+	zassert_equal(bt_le_adv_stop_call_count, 2);
+}
+
+ZTEST(ble_service, test_adv_steps_down_over_time)
+{
+	ble_service_start_advertising();
+	adv_work_handler(&adv_work);
+
+	zassert_equal(last_adv_param.interval_min, BT_GAP_ADV_FAST_INT_MIN_1);
+	zassert_true(K_TIMEOUT_EQ(k_work_reschedule_fake.arg1_val,
+				  K_SECONDS(CONFIG_RADPRO_ADV_FAST_S)));
+
+	adv_stage_work_handler(&adv_stage_work.work);
+	zassert_equal(bt_le_adv_stop_call_count, 1);
+	zassert_equal(last_adv_param.interval_min, BT_GAP_ADV_FAST_INT_MIN_2);
+	zassert_true(K_TIMEOUT_EQ(k_work_reschedule_fake.arg1_val,
+				  K_SECONDS(CONFIG_RADPRO_ADV_MEDIUM_S)));
+
+	adv_stage_work_handler(&adv_stage_work.work);
+	zassert_equal(last_adv_param.interval_min, BT_GAP_ADV_SLOW_INT_MIN);
+	zassert_equal(k_work_reschedule_fake.call_count, 2,
+		      "Slowest stage lasts until a connection");
+
+	adv_stage_work_handler(&adv_stage_work.work);
+	zassert_equal(last_adv_param.interval_min, BT_GAP_ADV_SLOW_INT_MIN);
+}
+
+ZTEST(ble_service, test_boost_returns_to_fast)
+{
+	atomic_set(&adv_stage, 2);
+
+	ble_service_boost_advertising();
+	zassert_equal(k_work_submit_fake.call_count, 1);
+	zassert_equal(atomic_get(&adv_stage), 0);
+
+	/* Already fast: no restart */
+	ble_service_boost_advertising();
+	zassert_equal(k_work_submit_fake.call_count, 1);
+}
+
+ZTEST(ble_service, test_connected_keeps_advertising_while_slot_free)
+{
+	connected(&test_conn, 0);
+
+	zassert_equal(k_work_submit_fake.call_count, 1);
+	zassert_equal(k_work_submit_fake.arg0_val, &adv_work);
+	zassert_equal(k_work_cancel_delayable_fake.call_count, 0);
+}
+
+ZTEST(ble_service, test_connected_stops_stage_timer_when_full)
+{
+	connected(&test_conn, 0);
+	connected(&test_conn2, 0);
+
 	zassert_equal(k_work_submit_fake.call_count, 1);
+	zassert_equal(k_work_cancel_delayable_fake.call_count, 1);
 }
 
 ZTEST(ble_service, test_is_authenticated_checks_l2)
 {
 	/* No connection → false */
-	current_conn = NULL;
 	zassert_false(ble_service_is_authenticated());
+	zassert_false(ble_service_is_conn_authenticated(NULL));
 
 	/* Connected but L1 → false */
-	current_conn = &test_conn;
+	set_peer(&test_conn);
 	bt_conn_get_security_fake.return_val = BT_SECURITY_L1;
 	zassert_false(ble_service_is_authenticated());
 
 	/* Connected and L2 → true */
 	bt_conn_get_security_fake.return_val = BT_SECURITY_L2;
 	zassert_true(ble_service_is_authenticated());
+	zassert_true(ble_service_is_conn_authenticated(&test_conn));
+	zassert_false(ble_service_is_conn_authenticated(&test_conn2),
+		      "Not one of our connections");
+}
+
+ZTEST(ble_service, test_rx_counts_accepted_frames)
+{
+	data_received_callback = test_data_cb;
+	set_peer(&test_conn);
+
+	bt_receive_cb(&test_conn, "GET x\n", 6, NULL);
+
+	zassert_true(test_data_received);
+	zassert_equal(metrics_added(METRICS_BLE_RX_FRAMES), 1);
+	zassert_equal(metrics_added(METRICS_BLE_RX_BYTES), 6);
+	zassert_equal(metrics_added(METRICS_DROP_UNAUTH_BYTES), 0);
+}
+
+ZTEST(ble_service, test_rx_unauthenticated_counts_drop)
+{
+	data_received_callback = test_data_cb;
+	set_peer(&test_conn);
+	bt_conn_get_security_fake.return_val = BT_SECURITY_L1;
+
+	bt_receive_cb(&test_conn, "GET x\n", 6, NULL);
+
+	zassert_false(test_data_received);
+	zassert_equal(metrics_added(METRICS_DROP_UNAUTH_BYTES), 6);
+	zassert_equal(metrics_added(METRICS_BLE_RX_BYTES), 0);
+}
+
+ZTEST(ble_service, test_send_counts_only_queued_frames)
+{
+	set_peer(&test_conn);
+
+	ble_service_send(&test_conn, (const uint8_t *)"data", 4, K_NO_WAIT);
+	bt_gatt_notify_cb_fake.return_val = -ENOMEM;
+	ble_service_send(&test_conn, (const uint8_t *)"more", 4, K_NO_WAIT);
+
+	zassert_equal(metrics_added(METRICS_BLE_TX_FRAMES), 1);
+	zassert_equal(metrics_added(METRICS_BLE_TX_BYTES), 4);
+}
+
+ZTEST(ble_service, test_connection_metrics)
+{
+	bt_gatt_get_mtu_fake.return_val = ATT_DEFAULT_MTU;
+
+	connected(&test_conn, 0);
+	connected(&test_conn2, 0);
+	zassert_equal(metrics_added(METRICS_CONNECTS), 2);
+	zassert_equal(metrics_set_fake.arg0_val, METRICS_CONNECTIONS);
+	zassert_equal(metrics_set_fake.arg1_val, 2);
+
+	disconnected(&test_conn, 0);
+	zassert_equal(metrics_added(METRICS_DISCONNECTS), 1);
+	zassert_equal(metrics_set_fake.arg0_val, METRICS_CONNECTIONS);
+	zassert_equal(metrics_set_fake.arg1_val, 1);
+}
+
+ZTEST(ble_service, test_mtu_gauge_follows_negotiation)
+{
+	set_peer(&test_conn);
+
+	gatt_mtu_updated_cb(&test_conn, 247, 251);
+
+	zassert_equal(metrics_set_fake.call_count, 1);
+	zassert_equal(metrics_set_fake.arg0_val, METRICS_MTU);
+	zassert_equal(metrics_set_fake.arg1_val, 247);
+}
+
+/* Last value published for a flag, -1 if never */
+static int status_published(enum app_status_flag flag)
+{
+	int value = -1;
+
+	for (unsigned int i = 0; i < app_status_set_fake.call_count; i++) {
+		if (app_status_set_fake.arg0_history[i] == flag) {
+			value = app_status_set_fake.arg1_history[i];
+		}
+	}
+	return value;
+}
+
+ZTEST(ble_service, test_link_status_published)
+{
+	bt_gatt_get_mtu_fake.return_val = ATT_DEFAULT_MTU;
+	bt_conn_get_security_fake.return_val = BT_SECURITY_L1;
+
+	connected(&test_conn, 0);
+	zassert_equal(status_published(APP_STATUS_CONNECTED), 1);
+	zassert_equal(status_published(APP_STATUS_AUTHENTICATED), 0);
+
+	bt_conn_get_security_fake.return_val = BT_SECURITY_L2;
+	security_changed(&test_conn, BT_SECURITY_L2, BT_SECURITY_ERR_SUCCESS);
+	zassert_equal(status_published(APP_STATUS_AUTHENTICATED), 1);
+
+	disconnected(&test_conn, 0);
+	zassert_equal(status_published(APP_STATUS_CONNECTED), 0);
+	zassert_equal(status_published(APP_STATUS_AUTHENTICATED), 0);
 }
 
 ZTEST_SUITE(ble_service, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,650 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for l2cap_coc module.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/fff.h>
+#include <stdio.h>
+#include <string.h>
+
+DEFINE_FFF_GLOBALS;
+
+/* Kconfig values */
+#define CONFIG_BT_MAX_CONN 2
+#define CONFIG_BT_CONN_TX_USER_DATA_SIZE 16
+#define CONFIG_RADPRO_L2CAP_PSM 0x0080
+#define CONFIG_RADPRO_L2CAP_MTU 512
+#define CONFIG_RADPRO_L2CAP_TX_WINDOW 4
+#define CONFIG_RADPRO_NUS_COALESCE_MS 20
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+/* BT and net_buf type stubs */
+#include "bt_mocks.h"
+
+#include "ble/ble_service.h"
+
+/* FFF fakes — Bluetooth */
+DECLARE_FAKE_VALUE_FUNC(uint8_t, bt_conn_index, const struct bt_conn *);
+DEFINE_FAKE_VALUE_FUNC(uint8_t, bt_conn_index, const struct bt_conn *);
+
+DECLARE_FAKE_VALUE_FUNC(int, bt_l2cap_server_register, struct bt_l2cap_server *);
+DEFINE_FAKE_VALUE_FUNC(int, bt_l2cap_server_register, struct bt_l2cap_server *);
+
+DECLARE_FAKE_VALUE_FUNC(int, bt_l2cap_chan_send, struct bt_l2cap_chan *, struct net_buf *);
+DEFINE_FAKE_VALUE_FUNC(int, bt_l2cap_chan_send, struct bt_l2cap_chan *, struct net_buf *);
+
+/* FFF fakes — kernel work */
+DECLARE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+			k_work_handler_t);
+DEFINE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+		      k_work_handler_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+			k_timeout_t);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+		       k_timeout_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_cancel_delayable, struct k_work_delayable *);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_cancel_delayable, struct k_work_delayable *);
+
+/* net_buf — a small fixed pool shared by both CUT pools */
+#define TEST_BUF_COUNT 12
+#define TEST_BUF_SIZE BT_L2CAP_SDU_BUF_SIZE(CONFIG_RADPRO_L2CAP_MTU)
+
+static struct net_buf test_bufs[TEST_BUF_COUNT];
+static uint8_t test_buf_data[TEST_BUF_COUNT][TEST_BUF_SIZE];
+static bool test_buf_used[TEST_BUF_COUNT];
+static int test_bufs_in_use;
+
+struct net_buf *net_buf_alloc(struct net_buf_pool *pool, k_timeout_t timeout)
+{
+	ARG_UNUSED(pool);
+	ARG_UNUSED(timeout);
+
+	for (int i = 0; i < TEST_BUF_COUNT; i++) {
+		if (!test_buf_used[i]) {
+			test_buf_used[i] = true;
+			test_bufs_in_use++;
+			test_bufs[i].__buf = test_buf_data[i];
+			test_bufs[i].data = test_buf_data[i];
+			test_bufs[i].len = 0;
+			test_bufs[i].size = TEST_BUF_SIZE;
+			return &test_bufs[i];
+		}
+	}
+	return NULL;
+}
+
+void net_buf_unref(struct net_buf *buf)
+{
+	int i = buf - test_bufs;
+
+	zassert_true(test_buf_used[i], "Double free of a net_buf");
+	test_buf_used[i] = false;
+	test_bufs_in_use--;
+}
+
+void net_buf_reserve(struct net_buf *buf, size_t reserve)
+{
+	buf->data = buf->__buf + reserve;
+}
+
+void *net_buf_add_mem(struct net_buf *buf, const void *mem, size_t len)
+{
+	uint8_t *tail = buf->data + buf->len;
+
+	zassert_true(tail + len <= buf->__buf + buf->size, "net_buf overflow");
+	memcpy(tail, mem, len);
+	buf->len += len;
+	return tail;
+}
+
+/* k_sem_* are syscalls in kernel.h — redirect to a counting model */
+static k_timeout_t k_sem_take_last_timeout;
+
+static int test_k_sem_init(struct k_sem *sem, unsigned int initial, unsigned int limit)
+{
+	sem->count = initial;
+	sem->limit = limit;
+	return 0;
+}
+#define k_sem_init(sem, initial, limit) test_k_sem_init(sem, initial, limit)
+
+static void test_k_sem_give(struct k_sem *sem)
+{
+	if (sem->count < sem->limit) {
+		sem->count++;
+	}
+}
+#define k_sem_give(sem) test_k_sem_give(sem)
+
+static int test_k_sem_take(struct k_sem *sem, k_timeout_t timeout)
+{
+	k_sem_take_last_timeout = timeout;
+	if (sem->count == 0) {
+		return -EAGAIN;
+	}
+	sem->count--;
+	return 0;
+}
+#define k_sem_take(sem, timeout) test_k_sem_take(sem, timeout)
+
+static void test_k_sem_reset(struct k_sem *sem)
+{
+	sem->count = 0;
+}
+#define k_sem_reset(sem) test_k_sem_reset(sem)
+
+/* k_mutex_* are syscalls in kernel.h — use macro redirect */
+static int test_k_mutex_init(struct k_mutex *mutex)
+{
+	return 0;
+}
+#define k_mutex_init(mutex) test_k_mutex_init(mutex)
+
+/* Set while another thread holds the lock */
+static bool test_mutex_busy;
+
+static int test_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+	if (test_mutex_busy) {
+		zassert_true(K_TIMEOUT_EQ(timeout, K_NO_WAIT), "Would wait for the lock holder");
+		return -EBUSY;
+	}
+	return 0;
+}
+#define k_mutex_lock(mutex, timeout) test_k_mutex_lock(mutex, timeout)
+
+static int test_k_mutex_unlock(struct k_mutex *mutex)
+{
+	return 0;
+}
+#define k_mutex_unlock(mutex) test_k_mutex_unlock(mutex)
+
+/* Stub ARG_UNUSED if not available */
+#ifndef ARG_UNUSED
+#define ARG_UNUSED(x) (void)(x)
+#endif
+
+/* Two centrals: test_conn in slot 0, test_conn2 in slot 1 */
+static struct bt_conn test_conn;
+static struct bt_conn test_conn2;
+
+static uint8_t bt_conn_index_custom(const struct bt_conn *conn)
+{
+	return conn == &test_conn2 ? 1 : 0;
+}
+
+/* Capture of every SDU handed to the stack, buffers are freed right away */
+#define MAX_SDUS 32
+static uint8_t sent_data[8192];
+static size_t sent_total;
+static uint16_t sdu_lens[MAX_SDUS];
+static struct bt_l2cap_chan *sdu_chans[MAX_SDUS];
+
+static int bt_l2cap_chan_send_capture(struct bt_l2cap_chan *chan, struct net_buf *buf)
+{
+	unsigned int idx = bt_l2cap_chan_send_fake.call_count - 1;
+
+	if (idx < MAX_SDUS) {
+		sdu_lens[idx] = buf->len;
+		sdu_chans[idx] = chan;
+	}
+	zassert_true(buf->data - buf->__buf >= BT_L2CAP_SDU_CHAN_SEND_RESERVE,
+		     "No headroom for the SDU and PDU headers");
+	memcpy(&sent_data[sent_total], buf->data, buf->len);
+	sent_total += buf->len;
+	net_buf_unref(buf);
+	return 0;
+}
+
+/* The central keeps granting credits: every SDU goes out at once */
+static int bt_l2cap_chan_send_and_complete(struct bt_l2cap_chan *chan, struct net_buf *buf)
+{
+	int err = bt_l2cap_chan_send_capture(chan, buf);
+
+	chan->ops->sent(chan);
+	return err;
+}
+
+/* Received data */
+static struct bt_conn *rx_conn;
+static uint8_t rx_data[64];
+static uint16_t rx_len;
+
+static void test_data_cb(struct bt_conn *conn, const uint8_t *data, uint16_t len)
+{
+	rx_conn = conn;
+	memcpy(rx_data, data, len);
+	rx_len = len;
+}
+
+/* Include CUT */
+#include "ble/l2cap_coc.c"
+
+/* Central opens the channel, as the stack would drive it */
+static struct bt_l2cap_chan *open_channel(struct bt_conn *conn, uint16_t tx_mtu,
+					  uint16_t tx_mps)
+{
+	struct bt_l2cap_chan *chan = NULL;
+
+	zassert_equal(server.accept(conn, &server, &chan), 0);
+	zassert_not_null(chan);
+
+	chan->conn = conn;
+	CONTAINER_OF(chan, struct bt_l2cap_le_chan, chan)->tx.mtu = tx_mtu;
+	CONTAINER_OF(chan, struct bt_l2cap_le_chan, chan)->tx.mps = tx_mps;
+	chan->ops->connected(chan);
+	return chan;
+}
+
+static void close_channel(struct bt_l2cap_chan *chan)
+{
+	chan->ops->disconnected(chan);
+	chan->conn = NULL;
+}
+
+/* --- FFF reset rule --- */
+static void fff_reset_rule_before(const struct ztest_unit_test *test,
+				  void *fixture)
+{
+	RESET_FAKE(bt_conn_index);
+	RESET_FAKE(bt_l2cap_server_register);
+	RESET_FAKE(bt_l2cap_chan_send);
+	RESET_FAKE(k_work_init_delayable);
+	RESET_FAKE(k_work_reschedule);
+	RESET_FAKE(k_work_cancel_delayable);
+	FFF_RESET_HISTORY();
+
+	bt_conn_index_fake.custom_fake = bt_conn_index_custom;
+	bt_l2cap_chan_send_fake.custom_fake = bt_l2cap_chan_send_capture;
+
+	memset(test_buf_used, 0, sizeof(test_buf_used));
+	test_bufs_in_use = 0;
+	memset(chans, 0, sizeof(chans));
+	memset(sent_data, 0, sizeof(sent_data));
+	memset(sdu_lens, 0, sizeof(sdu_lens));
+	memset(sdu_chans, 0, sizeof(sdu_chans));
+	sent_total = 0;
+	rx_conn = NULL;
+	rx_len = 0;
+	k_sem_take_last_timeout = K_NO_WAIT;
+	test_mutex_busy = false;
+
+	l2cap_coc_init(test_data_cb);
+}
+
+ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
+
+/* --- Tests --- */
+
+ZTEST(l2cap_coc, test_init_registers_server)
+{
+	zassert_equal(bt_l2cap_server_register_fake.call_count, 1);
+	zassert_equal(bt_l2cap_server_register_fake.arg0_val, &server);
+	zassert_equal(server.psm, CONFIG_RADPRO_L2CAP_PSM);
+	zassert_equal(server.sec_level, BT_SECURITY_L2, "Channel requires encryption");
+	zassert_equal(k_work_init_delayable_fake.call_count, CONFIG_BT_MAX_CONN);
+}
+
+ZTEST(l2cap_coc, test_init_propagates_register_error)
+{
+	bt_l2cap_server_register_fake.return_val = -EADDRINUSE;
+
+	zassert_equal(l2cap_coc_init(test_data_cb), -EADDRINUSE);
+}
+
+ZTEST(l2cap_coc, test_accept_sets_rx_mtu)
+{
+	struct bt_l2cap_chan *chan = open_channel(&test_conn, 512, 247);
+
+	zassert_equal(chan, &chans[0].le.chan);
+	zassert_equal(chans[0].le.rx.mtu, CONFIG_RADPRO_L2CAP_MTU);
+	zassert_true(l2cap_coc_is_open(&test_conn));
+	zassert_false(l2cap_coc_is_open(&test_conn2));
+	zassert_false(l2cap_coc_is_open(NULL));
+}
+
+ZTEST(l2cap_coc, test_second_channel_on_same_connection_rejected)
+{
+	struct bt_l2cap_chan *chan = NULL;
+
+	open_channel(&test_conn, 512, 247);
+
+	zassert_equal(server.accept(&test_conn, &server, &chan), -ENOMEM);
+}
+
+ZTEST(l2cap_coc, test_send_without_channel_fails)
+{
+	int err = l2cap_coc_send(&test_conn, (const uint8_t *)"OK\n", 3);
+
+	zassert_equal(err, -ENOTCONN);
+	zassert_equal(bt_l2cap_chan_send_fake.call_count, 0);
+}
+
+ZTEST(l2cap_coc, test_recv_forwards_to_data_cb)
+{
+	struct bt_l2cap_chan *chan = open_channel(&test_conn2, 512, 247);
+	uint8_t cmd[] = "GET deviceId\n";
+	struct net_buf buf = { .data = cmd, .len = sizeof(cmd) - 1 };
+
+	zassert_equal(chan->ops->recv(chan, &buf), 0, "Credit returned on return");
+
+	zassert_equal(rx_conn, &test_conn2);
+	zassert_equal(rx_len, sizeof(cmd) - 1);
+	zassert_mem_equal(rx_data, cmd, sizeof(cmd) - 1);
+}
+
+ZTEST(l2cap_coc, test_line_end_flushes_immediately)
+{
+	open_channel(&test_conn, 512, 247);
+
+	int err = l2cap_coc_send(&test_conn, (const uint8_t *)"OK 1.0\n", 7);
+
+	zassert_equal(err, 0);
+	zassert_equal(bt_l2cap_chan_send_fake.call_count, 1);
+	zassert_equal(sdu_lens[0], 7);
+	zassert_equal(sdu_chans[0], &chans[0].le.chan);
+	zassert_mem_equal(sent_data, "OK 1.0\n", 7);
+}
+
+ZTEST(l2cap_coc, test_partial_line_waits_for_deadline)
+{
+	open_channel(&test_conn, 512, 247);
+
+	int err = l2cap_coc_send(&test_conn, (const uint8_t *)"OK 12", 5);
+
+	zassert_equal(err, 0);
+	zassert_equal(bt_l2cap_chan_send_fake.call_count, 0);
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+	zassert_equal(k_work_reschedule_fake.arg0_val, &chans[0].flush_work);
+
+	/* Deadline expires */
+	flush_work_handler(&chans[0].flush_work.work);
+
+	zassert_equal(bt_l2cap_chan_send_fake.call_count, 1);
+	zassert_equal(sdu_lens[0], 5);
+}
+
+ZTEST(l2cap_coc, test_flush_work_does_not_wait_for_writer)
+{
+	open_channel(&test_conn, 512, 247);
+	l2cap_coc_send(&test_conn, (const uint8_t *)"OK 12", 5);
+	RESET_FAKE(k_work_reschedule);
+
+	/* A writer holds the lock while it waits for a credit */
+	test_mutex_busy = true;
+	flush_work_handler(&chans[0].flush_work.work);
+
+	zassert_equal(bt_l2cap_chan_send_fake.call_count, 0);
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+	zassert_true(K_TIMEOUT_EQ(k_work_reschedule_fake.arg1_val, L2CAP_FLUSH_RETRY_DELAY));
+
+	test_mutex_busy = false;
+	flush_work_handler(&chans[0].flush_work.work);
+	zassert_equal(bt_l2cap_chan_send_fake.call_count, 1);
+	zassert_equal(sdu_lens[0], 5);
+}
+
+ZTEST(l2cap_coc, test_sdu_limited_by_peer_mtu)
+{
+	uint8_t data[300];
+
+	memset(data, 'x', sizeof(data));
+	open_channel(&test_conn, 128, 128);
+
+	int err = l2cap_coc_send(&test_conn, data, sizeof(data));
+
+	zassert_equal(err, 0);
+	zassert_equal(bt_l2cap_chan_send_fake.call_count, 2);
+	zassert_equal(sdu_lens[0], 128);
+	zassert_equal(sdu_lens[1], 128);
+	zassert_equal(chans[0].pending->len, 300 - 256, "Remainder waits for more data");
+}
+
+ZTEST(l2cap_coc, test_full_window_stalls_then_drops)
+{
+	uint8_t data[CONFIG_RADPRO_L2CAP_MTU * (CONFIG_RADPRO_L2CAP_TX_WINDOW + 2)];
+
+	memset(data, 'x', sizeof(data));
+	open_channel(&test_conn, 512, 247);
+
+	/* Central grants no credits: the window fills, nothing completes */
+	int err = l2cap_coc_send(&test_conn, data, sizeof(data));
+
+	zassert_equal(err, -EAGAIN);
+	zassert_equal(bt_l2cap_chan_send_fake.call_count, CONFIG_RADPRO_L2CAP_TX_WINDOW);
+	zassert_true(K_TIMEOUT_EQ(k_sem_take_last_timeout, L2CAP_TX_TIMEOUT),
+		     "First full window blocks the writer");
+	zassert_true(chans[0].stalled);
+	zassert_not_null(chans[0].pending, "Full SDU kept for the retry");
+
+	/* Further writes no longer wait */
+	err = l2cap_coc_send(&test_conn, (const uint8_t *)"more", 4);
+	zassert_true(K_TIMEOUT_EQ(k_sem_take_last_timeout, K_NO_WAIT));
+
+	/* A credit comes back and the retry drains the SDU */
+	chans[0].le.chan.ops->sent(&chans[0].le.chan);
+	flush_work_handler(&chans[0].flush_work.work);
+
+	zassert_equal(bt_l2cap_chan_send_fake.call_count, CONFIG_RADPRO_L2CAP_TX_WINDOW + 1);
+	zassert_false(chans[0].stalled);
+
+	/* The window is full again when the next partial SDU's retry runs:
+	 * that is streaming, not a stall */
+	l2cap_coc_send(&test_conn, (const uint8_t *)"tail", 4);
+	flush_work_handler(&chans[0].flush_work.work);
+	zassert_true(K_TIMEOUT_EQ(k_sem_take_last_timeout, K_NO_WAIT));
+	zassert_false(chans[0].stalled);
+
+	/* So the next bulk write still waits for credits */
+	l2cap_coc_send(&test_conn, data, sizeof(data));
+	zassert_true(K_TIMEOUT_EQ(k_sem_take_last_timeout, L2CAP_TX_TIMEOUT));
+}
+
+ZTEST(l2cap_coc, test_send_error_returns_credit_and_buffer)
+{
+	open_channel(&test_conn, 512, 247);
+	bt_l2cap_chan_send_fake.custom_fake = NULL;
+	bt_l2cap_chan_send_fake.return_val = -ENOTCONN;
+
+	int err = l2cap_coc_send(&test_conn, (const uint8_t *)"OK\n", 3);
+
+	zassert_equal(err, -ENOTCONN);
+	zassert_equal(test_bufs_in_use, 0);
+	zassert_equal(chans[0].tx_credits.count, CONFIG_RADPRO_L2CAP_TX_WINDOW);
+}
+
+ZTEST(l2cap_coc, test_disconnect_drops_pending)
+{
+	struct bt_l2cap_chan *chan = open_channel(&test_conn, 512, 247);
+
+	l2cap_coc_send(&test_conn, (const uint8_t *)"OK 12", 5);
+	zassert_equal(test_bufs_in_use, 1);
+
+	close_channel(chan);
+
+	zassert_false(l2cap_coc_is_open(&test_conn));
+	zassert_equal(test_bufs_in_use, 0);
+	zassert_equal(k_work_cancel_delayable_fake.call_count, 1);
+	zassert_equal(chans[0].tx_credits.count, 0);
+
+	/* The slot takes a new channel */
+	open_channel(&test_conn, 512, 247);
+	zassert_true(l2cap_coc_is_open(&test_conn));
+	zassert_equal(chans[0].tx_credits.count, CONFIG_RADPRO_L2CAP_TX_WINDOW);
+}
+
+ZTEST(l2cap_coc, test_channels_independent)
+{
+	open_channel(&test_conn, 512, 247);
+	open_channel(&test_conn2, 512, 247);
+
+	l2cap_coc_send(&test_conn2, (const uint8_t *)"B\n", 2);
+	l2cap_coc_send(&test_conn, (const uint8_t *)"A\n", 2);
+
+	zassert_equal(bt_l2cap_chan_send_fake.call_count, 2);
+	zassert_equal(sdu_chans[0], &chans[1].le.chan);
+	zassert_equal(sdu_chans[1], &chans[0].le.chan);
+}
+
+/*
+ * Host-side throughput comparison against NUS.
+ *
+ * A datalog reply goes through the real send path; the SDUs it produces
+ * are then segmented the way the stack does (2-byte SDU header in the
+ * first K-frame, 4-byte basic L2CAP header per PDU of at most MPS bytes).
+ * NUS is modelled on the packetizer: (ATT MTU - 3) byte notifications,
+ * each with a 3-byte ATT and a 4-byte L2CAP header. Both run on the same
+ * 251-byte LL payload, so the difference is protocol overhead and the
+ * number of TX completions the bridge has to handle.
+ */
+#define LL_PAYLOAD_MAX 251
+#define L2CAP_HDR 4
+#define ATT_NOTIFY_HDR 3
+
+struct link_cost {
+	unsigned int pdus;       /* LL data PDUs */
+	unsigned int on_air;     /* LL payload bytes */
+	unsigned int tx_events;  /* SDUs / notifications the bridge tracks */
+};
+
+static struct link_cost coc_cost(const uint16_t *sdus, unsigned int count, uint16_t mps)
+{
+	struct link_cost cost = { 0 };
+
+	for (unsigned int i = 0; i < count; i++) {
+		unsigned int remaining = sdus[i] + BT_L2CAP_SDU_HDR_SIZE;
+
+		while (remaining > 0) {
+			unsigned int seg = MIN(remaining, mps);
+
+			cost.pdus++;
+			cost.on_air += seg + L2CAP_HDR;
+			remaining -= seg;
+		}
+		cost.tx_events++;
+	}
+	return cost;
+}
+
+static struct link_cost nus_cost(unsigned int len, uint16_t att_mtu)
+{
+	struct link_cost cost = { 0 };
+	unsigned int chunk = att_mtu - ATT_NOTIFY_HDR;
+
+	while (len > 0) {
+		unsigned int n = MIN(len, chunk);
+
+		cost.pdus++;
+		cost.on_air += n + ATT_NOTIFY_HDR + L2CAP_HDR;
+		cost.tx_events++;
+		len -= n;
+	}
+	return cost;
+}
+
+static size_t build_datalog(char *buf, size_t size)
+{
+	size_t len = snprintf(buf, size, "OK ");
+
+	/* "time,pulses" records, as returned by GET datalog */
+	for (uint32_t i = 0; len < size - 32; i++) {
+		len += snprintf(buf + len, size - len, "%u,%u;", 1700000000 + 60 * i,
+				12345 + 17 * i);
+	}
+	buf[len - 1] = '\n';
+	return len;
+}
+
+ZTEST(l2cap_coc, test_throughput_vs_nus)
+{
+	static char datalog[4096];
+	const uint16_t mps = LL_PAYLOAD_MAX - L2CAP_HDR;
+	const uint16_t att_mtu = 247;   /* CONFIG_BT_L2CAP_TX_MTU */
+	size_t len = build_datalog(datalog, sizeof(datalog));
+	struct link_cost coc, nus;
+
+	bt_l2cap_chan_send_fake.custom_fake = bt_l2cap_chan_send_and_complete;
+	open_channel(&test_conn, CONFIG_RADPRO_L2CAP_MTU, mps);
+
+	/* UART hands the reply over in DMA-sized pieces */
+	for (size_t off = 0; off < len; off += 64) {
+		zassert_equal(l2cap_coc_send(&test_conn, (const uint8_t *)datalog + off,
+					     MIN(64, len - off)), 0);
+	}
+
+	zassert_equal(sent_total, len, "Every byte delivered");
+	zassert_mem_equal(sent_data, datalog, len);
+	zassert_equal(test_bufs_in_use, 0);
+
+	coc = coc_cost(sdu_lens, bt_l2cap_chan_send_fake.call_count, mps);
+	nus = nus_cost(len, att_mtu);
+
+	TC_PRINT("%zu byte datalog over NUS:  %u PDUs, %u bytes on air, %u notifications\n",
+		 len, nus.pdus, nus.on_air, nus.tx_events);
+	TC_PRINT("%zu byte datalog over CoC:  %u PDUs, %u bytes on air, %u SDUs\n",
+		 len, coc.pdus, coc.on_air, coc.tx_events);
+
+	/* Every PDU fits the LL payload */
+	zassert_true(coc.on_air <= coc.pdus * LL_PAYLOAD_MAX);
+	zassert_true(nus.on_air <= nus.pdus * LL_PAYLOAD_MAX);
+
+	/* Less header overhead and about half the TX completions */
+	zassert_true(coc.on_air < nus.on_air, "CoC %u vs NUS %u bytes", coc.on_air,
+		     nus.on_air);
+	zassert_true(coc.tx_events * 2 <= nus.tx_events + 1, "CoC %u vs NUS %u events",
+		     coc.tx_events, nus.tx_events);
+}
+
+ZTEST(l2cap_coc, test_throughput_vs_nus_default_att_mtu)
+{
+	static char datalog[4096];
+	const uint16_t mps = LL_PAYLOAD_MAX - L2CAP_HDR;
+	size_t len = build_datalog(datalog, sizeof(datalog));
+	struct link_cost coc, nus;
+
+	/* Central never exchanged MTU: NUS is stuck at 20-byte notifications */
+	bt_l2cap_chan_send_fake.custom_fake = bt_l2cap_chan_send_and_complete;
+	open_channel(&test_conn, CONFIG_RADPRO_L2CAP_MTU, mps);
+
+	zassert_equal(l2cap_coc_send(&test_conn, (const uint8_t *)datalog, len), 0);
+	zassert_equal(sent_total, len);
+
+	coc = coc_cost(sdu_lens, bt_l2cap_chan_send_fake.call_count, mps);
+	nus = nus_cost(len, 23);
+
+	TC_PRINT("ATT MTU 23: NUS %u PDUs / %u bytes, CoC %u PDUs / %u bytes\n",
+		 nus.pdus, nus.on_air, coc.pdus, coc.on_air);
+
+	/* The CoC MPS is negotiated independently of the ATT MTU */
+	zassert_true(coc.pdus * 5 < nus.pdus);
+	zassert_true(coc.on_air * 100 < nus.on_air * 80, "Over 20% fewer bytes on air");
+}
+
+ZTEST_SUITE(l2cap_coc, NULL, NULL, NULL, NULL, NULL);
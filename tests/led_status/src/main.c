@@ -5,10 +5,12 @@
 
 #include <zephyr/ztest.h>
 #include <zephyr/fff.h>
-#include <setjmp.h>
 
 DEFINE_FFF_GLOBALS;
 
+/* Kconfig values */
+#define CONFIG_RADPRO_LED_ACTIVITY 1
+
 /* Stub logging before including CUT */
 #ifdef LOG_MODULE_REGISTER
 #undef LOG_MODULE_REGISTER
@@ -51,40 +53,68 @@ DECLARE_FAKE_VALUE_FUNC(int, gpio_pin_set_dt,
 DEFINE_FAKE_VALUE_FUNC(int, gpio_pin_set_dt,
 		       const struct gpio_dt_spec *, int);
 
-/* k_msleep is static inline in kernel.h — override via macro redirect.
- * Same pattern as k_uptime_get in security_manager tests.
- * Supports custom_fake for the longjmp thread escape. */
-static int32_t k_msleep_fake_return_val;
-static int k_msleep_fake_call_count;
-static int32_t (*k_msleep_custom_fake)(int32_t);
-static int32_t test_k_msleep(int32_t ms)
-{
-	k_msleep_fake_call_count++;
-	if (k_msleep_custom_fake) {
-		return k_msleep_custom_fake(ms);
-	}
-	return k_msleep_fake_return_val;
-}
-#define k_msleep(ms) test_k_msleep(ms)
-
-/* Stub K_THREAD_DEFINE — don't actually create threads in test */
-#ifdef K_THREAD_DEFINE
-#undef K_THREAD_DEFINE
-#endif
-#define K_THREAD_DEFINE(name, stack, entry, p1, p2, p3, prio, opts, delay)
+/* FFF fakes — status channel */
+#include "status/app_status.h"
+
+DECLARE_FAKE_VALUE_FUNC(int, app_status_subscribe, app_status_cb_t);
+DEFINE_FAKE_VALUE_FUNC(int, app_status_subscribe, app_status_cb_t);
+
+/* FFF fakes — kernel work */
+DECLARE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+		       k_work_handler_t);
+DEFINE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+		      k_work_handler_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+			k_timeout_t);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+		       k_timeout_t);
+
+DECLARE_FAKE_VOID_FUNC(k_work_init, struct k_work *, k_work_handler_t);
+DEFINE_FAKE_VOID_FUNC(k_work_init, struct k_work *, k_work_handler_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_submit, struct k_work *);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_submit, struct k_work *);
 
 /* Include CUT */
 #include "led/led_status.c"
 
-/* --- Thread escape mechanism --- */
-static jmp_buf test_jmp;
-static int32_t captured_sleep_ms;
+/* Run the LED work item, as the system workqueue would when it is due */
+static void run_led_work(void)
+{
+	led_work_handler(NULL);
+}
+
+/* Apply the link state, as the system workqueue would after a change */
+static void run_link_work(void)
+{
+	zassert_equal(k_work_submit_fake.arg0_val, &link_work);
+	link_work_handler(&link_work);
+}
+
+static void set_connected(bool connected)
+{
+	led_status_set_connected(connected);
+	run_link_work();
+}
 
-static int32_t k_msleep_longjmp(int32_t ms)
+static void set_pairing_window(bool pairing_active)
 {
-	captured_sleep_ms = ms;
-	longjmp(test_jmp, 1);
-	return 0; /* unreachable */
+	led_status_set_pairing_window(pairing_active);
+	run_link_work();
+}
+
+/* The work item is due now, or after the given time */
+static void assert_next_step(bool on, int32_t ms)
+{
+	zassert_equal(gpio_pin_set_dt_fake.arg1_val, on ? 1 : 0);
+	zassert_true(K_TIMEOUT_EQ(k_work_reschedule_fake.arg1_val, K_MSEC(ms)),
+		     "next step not scheduled after %d ms", ms);
+}
+
+static void assert_wake_pending(void)
+{
+	zassert_true(K_TIMEOUT_EQ(k_work_reschedule_fake.arg1_val, K_NO_WAIT));
 }
 
 /* --- FFF reset rule --- */
@@ -94,16 +124,19 @@ static void fff_reset_rule_before(const struct ztest_unit_test *test,
 	RESET_FAKE(gpio_is_ready_dt);
 	RESET_FAKE(gpio_pin_configure_dt);
 	RESET_FAKE(gpio_pin_set_dt);
-	k_msleep_fake_return_val = 0;
-	k_msleep_fake_call_count = 0;
-	k_msleep_custom_fake = NULL;
+	RESET_FAKE(app_status_subscribe);
+	RESET_FAKE(k_work_init_delayable);
+	RESET_FAKE(k_work_reschedule);
+	RESET_FAKE(k_work_init);
+	RESET_FAKE(k_work_submit);
 	FFF_RESET_HISTORY();
 
 	/* Reset module state */
-	is_connected = false;
-	pairing_window_active = true;
-	error_mode = false;
-	captured_sleep_ms = 0;
+	atomic_set(&link_state, BIT(LINK_PAIRING));
+	led_ready = false;
+	atomic_clear(&requested);
+	atomic_set(&playing, LED_PATTERN_NONE);
+	step = 0;
 
 	/* Defaults */
 	gpio_is_ready_dt_fake.return_val = true;
@@ -113,6 +146,13 @@ static void fff_reset_rule_before(const struct ztest_unit_test *test,
 
 ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
 
+/* LED initialized with the pairing window open and the first step played */
+static void init_and_start(void)
+{
+	zassert_ok(led_status_init());
+	run_led_work();
+}
+
 /* --- Tests --- */
 
 ZTEST(led_status, test_init_configures_gpio)
@@ -123,6 +163,17 @@ ZTEST(led_status, test_init_configures_gpio)
 	zassert_equal(gpio_pin_configure_dt_fake.call_count, 1);
 	zassert_equal(gpio_pin_configure_dt_fake.arg1_val,
 		      GPIO_OUTPUT_INACTIVE);
+	zassert_equal(k_work_init_delayable_fake.arg1_val, led_work_handler);
+}
+
+ZTEST(led_status, test_init_subscribes_to_status)
+{
+	zassert_ok(led_status_init());
+	zassert_equal(app_status_subscribe_fake.call_count, 1);
+	zassert_equal(app_status_subscribe_fake.arg0_val, status_changed);
+
+	app_status_subscribe_fake.return_val = -ENOMEM;
+	zassert_equal(led_status_init(), -ENOMEM);
 }
 
 ZTEST(led_status, test_init_fails_no_device)
@@ -132,61 +183,161 @@ ZTEST(led_status, test_init_fails_no_device)
 	int err = led_status_init();
 
 	zassert_equal(err, -ENODEV);
+
+	/* Nothing is played on an LED that is not there */
+	led_status_error();
+	zassert_equal(k_work_reschedule_fake.call_count, 0);
 }
 
-ZTEST(led_status, test_set_connected_flag)
+ZTEST(led_status, test_status_changes_drive_led_state)
 {
-	led_status_set_connected(true);
+	uint32_t pairing = APP_STATUS_BIT(APP_STATUS_PAIRING_WINDOW);
+	uint32_t auth = APP_STATUS_BIT(APP_STATUS_AUTHENTICATED);
+	uint32_t error = APP_STATUS_BIT(APP_STATUS_ERROR);
+
+	status_changed(pairing | auth, auth);
+	zassert_true(atomic_test_bit(&link_state, LINK_CONNECTED));
+	zassert_true(atomic_test_bit(&link_state, LINK_PAIRING));
+
+	status_changed(auth, pairing);
+	zassert_false(atomic_test_bit(&link_state, LINK_PAIRING));
+	zassert_true(atomic_test_bit(&link_state, LINK_CONNECTED));
 
-	zassert_true(is_connected);
+	/* A central without encryption does not count as connected */
+	status_changed(APP_STATUS_BIT(APP_STATUS_CONNECTED), auth);
+	zassert_false(atomic_test_bit(&link_state, LINK_CONNECTED));
+	zassert_false(atomic_test_bit(&requested, LED_PATTERN_ERROR));
+
+	status_changed(error, error);
+	zassert_true(atomic_test_bit(&requested, LED_PATTERN_ERROR));
 }
 
-ZTEST(led_status, test_set_pairing_window_flag)
+ZTEST(led_status, test_link_updates_apply_latest_state)
 {
+	init_and_start();
+
+	/* Two updates before link_work runs: it sees both */
+	led_status_set_connected(true);
 	led_status_set_pairing_window(false);
+	run_link_work();
 
-	zassert_false(pairing_window_active);
+	zassert_false(atomic_test_bit(&requested, LED_PATTERN_PAIRING));
+	zassert_false(atomic_test_bit(&requested, LED_PATTERN_CONNECTED));
 }
 
-ZTEST(led_status, test_error_sets_error_mode)
+ZTEST(led_status, test_link_state_before_init_applied)
 {
+	led_status_set_connected(true);
+	zassert_equal(k_work_submit_fake.call_count, 0, "Work not initialized yet");
+
+	init_and_start();
+	zassert_equal(atomic_get(&playing), LED_PATTERN_CONNECTED);
+}
+
+ZTEST(led_status, test_pairing_blinks_250ms)
+{
+	init_and_start();
+	zassert_equal(atomic_get(&playing), LED_PATTERN_PAIRING);
+	assert_next_step(true, 250);
+
+	run_led_work();
+	assert_next_step(false, 250);
+
+	/* Repeats */
+	run_led_work();
+	assert_next_step(true, 250);
+}
+
+ZTEST(led_status, test_connected_blinks_500ms)
+{
+	init_and_start();
+
+	led_status_set_connected(true);
+	zassert_equal(atomic_get(&playing), LED_PATTERN_PAIRING, "Applied on the workqueue");
+	run_link_work();
+	assert_wake_pending();
+
+	run_led_work();
+	zassert_equal(atomic_get(&playing), LED_PATTERN_CONNECTED);
+	assert_next_step(true, 500);
+
+	run_led_work();
+	assert_next_step(false, 500);
+}
+
+ZTEST(led_status, test_error_overrides_and_blinks_100ms)
+{
+	init_and_start();
+	set_connected(true);
+	run_led_work();
+
 	led_status_error();
+	assert_wake_pending();
+
+	run_led_work();
+	zassert_equal(atomic_get(&playing), LED_PATTERN_ERROR);
+	assert_next_step(true, 100);
 
-	zassert_true(error_mode);
+	/* Lower patterns changing underneath do not interrupt it */
+	k_work_reschedule_fake.call_count = 0;
+	set_pairing_window(false);
+	zassert_equal(k_work_reschedule_fake.call_count, 0);
+
+	run_led_work();
+	assert_next_step(false, 100);
 }
 
-ZTEST(led_status, test_led_off_when_pairing_closed)
+ZTEST(led_status, test_window_closed_stops_engine)
 {
-	pairing_window_active = false;
-	error_mode = false;
+	init_and_start();
 
-	k_msleep_custom_fake = k_msleep_longjmp;
+	set_pairing_window(false);
+	assert_wake_pending();
 
-	if (setjmp(test_jmp) == 0) {
-		led_status_thread();
-	}
+	k_work_reschedule_fake.call_count = 0;
+	run_led_work();
 
-	/* LED should be turned off */
-	zassert_equal(gpio_pin_set_dt_fake.arg1_val, 0,
-		      "LED should be off when pairing closed");
-	zassert_equal(captured_sleep_ms, 1000,
-		      "Should use SLOW_BLINK_INTERVAL_MS");
+	/* LED off and nothing scheduled until a pattern is requested */
+	zassert_equal(gpio_pin_set_dt_fake.arg1_val, 0);
+	zassert_equal(atomic_get(&playing), LED_PATTERN_NONE);
+	zassert_equal(k_work_reschedule_fake.call_count, 0);
 }
 
-ZTEST(led_status, test_blink_interval_pairing_connected)
+ZTEST(led_status, test_activity_flash_once_when_dark)
 {
-	pairing_window_active = true;
-	is_connected = true;
-	error_mode = false;
+	init_and_start();
+	set_pairing_window(false);
+	run_led_work();
+
+	led_status_activity();
+	assert_wake_pending();
+
+	run_led_work();
+	zassert_equal(atomic_get(&playing), LED_PATTERN_ACTIVITY);
+	assert_next_step(true, 20);
+
+	/* Traffic during the flash does not extend it */
+	led_status_activity();
+	run_led_work();
+	assert_next_step(false, 80);
+
+	/* One-shot: falls back to off and stops */
+	run_led_work();
+	assert_wake_pending();
+	k_work_reschedule_fake.call_count = 0;
+	run_led_work();
+	zassert_equal(atomic_get(&playing), LED_PATTERN_NONE);
+	zassert_equal(gpio_pin_set_dt_fake.arg1_val, 0);
+	zassert_equal(k_work_reschedule_fake.call_count, 0);
+}
 
-	k_msleep_custom_fake = k_msleep_longjmp;
+ZTEST(led_status, test_activity_ignored_behind_blink)
+{
+	init_and_start();
 
-	if (setjmp(test_jmp) == 0) {
-		led_status_thread();
-	}
+	led_status_activity();
 
-	zassert_equal(captured_sleep_ms, 500,
-		      "Should use MEDIUM_BLINK_INTERVAL_MS (500ms)");
+	zassert_false(atomic_test_bit(&requested, LED_PATTERN_ACTIVITY));
 }
 
 ZTEST_SUITE(led_status, NULL, NULL, NULL, NULL, NULL);
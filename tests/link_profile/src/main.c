@@ -0,0 +1,381 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for link_profile module.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/fff.h>
+
+DEFINE_FFF_GLOBALS;
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+#ifdef LOG_DBG
+#undef LOG_DBG
+#endif
+#define LOG_DBG(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+/* BT type stubs */
+#include "bt_mocks.h"
+
+#define CONFIG_BT_MAX_CONN 2
+#define CONFIG_RADPRO_LINK_AUTO_PROFILE 1
+#define CONFIG_BT_USER_PHY_UPDATE 1
+#define CONFIG_BT_USER_DATA_LEN_UPDATE 1
+
+#include "ble/ble_service.h"
+
+/* Connection slots: test_conn always in slot 0 when connected */
+static struct bt_conn test_conn;
+static struct bt_conn test_conn2;
+static struct bt_conn *test_slots[CONFIG_BT_MAX_CONN];
+
+struct bt_conn *ble_service_get_connection(uint8_t index)
+{
+	return index < CONFIG_BT_MAX_CONN ? test_slots[index] : NULL;
+}
+
+DECLARE_FAKE_VALUE_FUNC(uint8_t, bt_conn_index, const struct bt_conn *);
+DEFINE_FAKE_VALUE_FUNC(uint8_t, bt_conn_index, const struct bt_conn *);
+
+/* test_conn sits in slot 0, test_conn2 in slot 1 */
+static uint8_t bt_conn_index_custom(const struct bt_conn *conn)
+{
+	return conn == &test_conn2 ? 1 : 0;
+}
+
+/* Zero-arg function — manual stub */
+int ble_service_connection_count(void)
+{
+	int count = 0;
+
+	for (int i = 0; i < CONFIG_BT_MAX_CONN; i++) {
+		count += test_slots[i] ? 1 : 0;
+	}
+	return count;
+}
+
+/* FFF fakes — BT connection updates */
+DECLARE_FAKE_VALUE_FUNC(int, bt_conn_le_param_update, struct bt_conn *,
+			const struct bt_le_conn_param *);
+DEFINE_FAKE_VALUE_FUNC(int, bt_conn_le_param_update, struct bt_conn *,
+		       const struct bt_le_conn_param *);
+
+DECLARE_FAKE_VALUE_FUNC(int, bt_conn_le_phy_update, struct bt_conn *,
+			const struct bt_conn_le_phy_param *);
+DEFINE_FAKE_VALUE_FUNC(int, bt_conn_le_phy_update, struct bt_conn *,
+		       const struct bt_conn_le_phy_param *);
+
+DECLARE_FAKE_VALUE_FUNC(int, bt_conn_le_data_len_update, struct bt_conn *,
+			const struct bt_conn_le_data_len_param *);
+DEFINE_FAKE_VALUE_FUNC(int, bt_conn_le_data_len_update, struct bt_conn *,
+		       const struct bt_conn_le_data_len_param *);
+
+/* FFF fakes — kernel work */
+DECLARE_FAKE_VOID_FUNC(k_work_init, struct k_work *, k_work_handler_t);
+DEFINE_FAKE_VOID_FUNC(k_work_init, struct k_work *, k_work_handler_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_submit, struct k_work *);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_submit, struct k_work *);
+
+DECLARE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+			k_work_handler_t);
+DEFINE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+		      k_work_handler_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+			k_timeout_t);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+		       k_timeout_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_cancel_delayable,
+			struct k_work_delayable *);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_cancel_delayable,
+		       struct k_work_delayable *);
+
+/* k_uptime_get is static inline in kernel.h — override via macro redirect */
+static int64_t k_uptime_get_fake_return_val;
+static int64_t test_k_uptime_get(void)
+{
+	return k_uptime_get_fake_return_val;
+}
+#define k_uptime_get() test_k_uptime_get()
+
+/* Stub ARG_UNUSED if not available */
+#ifndef ARG_UNUSED
+#define ARG_UNUSED(x) (void)(x)
+#endif
+
+/* Include CUT */
+#include "ble/link_profile.c"
+
+/* --- FFF reset rule --- */
+static void fff_reset_rule_before(const struct ztest_unit_test *test,
+				  void *fixture)
+{
+	RESET_FAKE(bt_conn_le_param_update);
+	RESET_FAKE(bt_conn_le_phy_update);
+	RESET_FAKE(bt_conn_le_data_len_update);
+	RESET_FAKE(k_work_init);
+	RESET_FAKE(k_work_submit);
+	RESET_FAKE(k_work_init_delayable);
+	RESET_FAKE(k_work_reschedule);
+	RESET_FAKE(k_work_cancel_delayable);
+	RESET_FAKE(bt_conn_index);
+	FFF_RESET_HISTORY();
+
+	bt_conn_index_fake.custom_fake = bt_conn_index_custom;
+
+	test_slots[0] = &test_conn;
+	test_slots[1] = NULL;
+	k_uptime_get_fake_return_val = 10000;
+
+	/* Reset module state */
+	atomic_set(&active_profile, LINK_PROFILE_NONE);
+	atomic_set(&requested_profile, LINK_PROFILE_NONE);
+	atomic_clear(&applied);
+	atomic_clear(&link_count);
+	traffic_window_start = 0;
+	traffic_window_bytes = 0;
+}
+
+ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
+
+/* --- Tests --- */
+
+ZTEST(link_profile, test_init_sets_up_work)
+{
+	int err = link_profile_init();
+
+	zassert_equal(err, 0);
+	zassert_equal(k_work_init_fake.call_count, 1);
+	zassert_equal(k_work_init_delayable_fake.call_count, 1);
+}
+
+ZTEST(link_profile, test_set_bulk_requests_2m_short_interval_max_dle)
+{
+	int err = link_profile_set(LINK_PROFILE_BULK);
+
+	zassert_equal(err, 0);
+	zassert_equal(k_work_submit_fake.call_count, 1);
+
+	apply_work_handler(&apply_work);
+
+	zassert_equal(link_profile_get(), LINK_PROFILE_BULK);
+	zassert_equal(bt_conn_le_phy_update_fake.call_count, 1);
+	zassert_equal(bt_conn_le_phy_update_fake.arg1_val->pref_tx_phy,
+		      BT_GAP_LE_PHY_2M);
+	zassert_equal(bt_conn_le_data_len_update_fake.call_count, 1);
+	zassert_equal(bt_conn_le_data_len_update_fake.arg1_val->tx_max_len,
+		      BT_GAP_DATA_LEN_MAX);
+	zassert_equal(bt_conn_le_param_update_fake.call_count, 1);
+	/* 7.5-15 ms in 1.25 ms units */
+	zassert_equal(bt_conn_le_param_update_fake.arg1_val->interval_min, 6);
+	zassert_equal(bt_conn_le_param_update_fake.arg1_val->interval_max, 12);
+	zassert_equal(bt_conn_le_param_update_fake.arg1_val->latency, 0);
+}
+
+ZTEST(link_profile, test_profile_applied_to_every_connection)
+{
+	test_slots[1] = &test_conn2;
+
+	link_profile_set(LINK_PROFILE_BULK);
+	apply_work_handler(&apply_work);
+
+	zassert_equal(bt_conn_le_param_update_fake.call_count, 2);
+	zassert_equal(bt_conn_le_param_update_fake.arg0_history[0], &test_conn);
+	zassert_equal(bt_conn_le_param_update_fake.arg0_history[1], &test_conn2);
+}
+
+ZTEST(link_profile, test_set_idle_requests_long_interval_with_latency)
+{
+	link_profile_set(LINK_PROFILE_IDLE);
+	apply_work_handler(&apply_work);
+
+	zassert_equal(link_profile_get(), LINK_PROFILE_IDLE);
+	zassert_equal(bt_conn_le_phy_update_fake.call_count, 0);
+	zassert_equal(bt_conn_le_data_len_update_fake.call_count, 0);
+	zassert_equal(bt_conn_le_param_update_fake.call_count, 1);
+	zassert_true(bt_conn_le_param_update_fake.arg1_val->interval_min >= 80);
+	zassert_true(bt_conn_le_param_update_fake.arg1_val->latency > 0);
+}
+
+ZTEST(link_profile, test_set_same_profile_is_noop)
+{
+	link_profile_set(LINK_PROFILE_BULK);
+	apply_work_handler(&apply_work);
+	RESET_FAKE(bt_conn_le_param_update);
+
+	link_profile_set(LINK_PROFILE_BULK);
+	apply_work_handler(&apply_work);
+
+	zassert_equal(bt_conn_le_param_update_fake.call_count, 0);
+}
+
+ZTEST(link_profile, test_set_without_connection_fails)
+{
+	test_slots[0] = NULL;
+
+	int err = link_profile_set(LINK_PROFILE_BULK);
+
+	zassert_equal(err, -ENOTCONN);
+	zassert_equal(k_work_submit_fake.call_count, 0);
+}
+
+ZTEST(link_profile, test_set_invalid_profile_fails)
+{
+	zassert_equal(link_profile_set(LINK_PROFILE_NONE), -EINVAL);
+	zassert_equal(link_profile_set((enum link_profile)7), -EINVAL);
+}
+
+ZTEST(link_profile, test_sustained_traffic_switches_to_bulk)
+{
+	/* A short command response stays below the threshold */
+	link_profile_note_traffic(40);
+	zassert_equal(k_work_submit_fake.call_count, 0);
+
+	/* Datalog download: 512+ bytes within the traffic window */
+	k_uptime_get_fake_return_val += 100;
+	link_profile_note_traffic(244);
+	k_uptime_get_fake_return_val += 100;
+	link_profile_note_traffic(244);
+
+	zassert_equal(k_work_submit_fake.call_count, 1);
+	zassert_equal(atomic_get(&requested_profile), LINK_PROFILE_BULK);
+}
+
+ZTEST(link_profile, test_sparse_traffic_stays_out_of_bulk)
+{
+	for (int i = 0; i < 10; i++) {
+		k_uptime_get_fake_return_val += 1000;
+		link_profile_note_traffic(100);
+	}
+
+	zassert_equal(k_work_submit_fake.call_count, 0);
+}
+
+ZTEST(link_profile, test_traffic_postpones_idle)
+{
+	link_profile_note_traffic(10);
+
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+	zassert_equal(k_work_reschedule_fake.arg0_val, &idle_work);
+	zassert_true(K_TIMEOUT_EQ(k_work_reschedule_fake.arg1_val,
+				  LINK_IDLE_TIMEOUT));
+}
+
+ZTEST(link_profile, test_quiet_link_falls_back_to_idle)
+{
+	atomic_set(&active_profile, LINK_PROFILE_BULK);
+	atomic_set(&requested_profile, LINK_PROFILE_BULK);
+
+	idle_work_handler(&idle_work.work);
+	apply_work_handler(&apply_work);
+
+	zassert_equal(link_profile_get(), LINK_PROFILE_IDLE);
+	zassert_equal(bt_conn_le_param_update_fake.call_count, 1);
+}
+
+ZTEST(link_profile, test_connect_resets_profile_and_arms_idle)
+{
+	atomic_set(&active_profile, LINK_PROFILE_BULK);
+
+	connected(&test_conn, 0);
+
+	zassert_equal(link_profile_get(), LINK_PROFILE_NONE);
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+}
+
+ZTEST(link_profile, test_disconnect_cancels_idle)
+{
+	connected(&test_conn, 0);
+	atomic_set(&active_profile, LINK_PROFILE_IDLE);
+
+	disconnected(&test_conn, 0x13);
+
+	zassert_equal(k_work_cancel_delayable_fake.call_count, 1);
+	zassert_equal(link_profile_get(), LINK_PROFILE_NONE);
+}
+
+ZTEST(link_profile, test_second_link_joins_active_profile)
+{
+	connected(&test_conn, 0);
+	link_profile_set(LINK_PROFILE_BULK);
+	apply_work_handler(&apply_work);
+	RESET_FAKE(bt_conn_le_param_update);
+	RESET_FAKE(k_work_submit);
+
+	/* A second central connects while the first is in bulk */
+	test_slots[1] = &test_conn2;
+	connected(&test_conn2, 0);
+
+	zassert_equal(link_profile_get(), LINK_PROFILE_BULK, "First link's state kept");
+	zassert_equal(k_work_submit_fake.call_count, 1);
+
+	apply_work_handler(&apply_work);
+	zassert_equal(bt_conn_le_param_update_fake.call_count, 1, "Only the new link");
+	zassert_equal(bt_conn_le_param_update_fake.arg0_val, &test_conn2);
+	zassert_equal(bt_conn_le_param_update_fake.arg1_val->interval_min, 6);
+}
+
+ZTEST(link_profile, test_remaining_link_keeps_idle_fallback)
+{
+	test_slots[1] = &test_conn2;
+	connected(&test_conn, 0);
+	connected(&test_conn2, 0);
+	link_profile_set(LINK_PROFILE_BULK);
+	apply_work_handler(&apply_work);
+
+	/* One central leaves: the other stays on bulk until it goes quiet */
+	test_slots[1] = NULL;
+	disconnected(&test_conn2, 0x13);
+
+	zassert_equal(k_work_cancel_delayable_fake.call_count, 0);
+	zassert_equal(link_profile_get(), LINK_PROFILE_BULK);
+
+	RESET_FAKE(bt_conn_le_param_update);
+	idle_work_handler(&idle_work.work);
+	apply_work_handler(&apply_work);
+
+	zassert_equal(link_profile_get(), LINK_PROFILE_IDLE);
+	zassert_equal(bt_conn_le_param_update_fake.call_count, 1);
+	zassert_equal(bt_conn_le_param_update_fake.arg0_val, &test_conn);
+
+	/* The last one leaving resets everything */
+	test_slots[0] = NULL;
+	disconnected(&test_conn, 0x13);
+	zassert_equal(k_work_cancel_delayable_fake.call_count, 1);
+	zassert_equal(link_profile_get(), LINK_PROFILE_NONE);
+}
+
+ZTEST(link_profile, test_profile_names)
+{
+	zassert_str_equal(link_profile_name(LINK_PROFILE_BULK), "bulk");
+	zassert_str_equal(link_profile_name(LINK_PROFILE_IDLE), "idle");
+	zassert_str_equal(link_profile_name(LINK_PROFILE_NONE), "default");
+}
+
+ZTEST_SUITE(link_profile, NULL, NULL, NULL, NULL, NULL);
@@ -29,6 +29,11 @@ DEFINE_FFF_GLOBALS;
 #endif
 #define LOG_ERR(...)
 
+#ifdef LOG_HEXDUMP_INF
+#undef LOG_HEXDUMP_INF
+#endif
+#define LOG_HEXDUMP_INF(...)
+
 /* Block Zephyr logging — prevent CUT from pulling in real logging */
 #define ZEPHYR_INCLUDE_LOGGING_LOG_H_
 #define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
@@ -41,6 +46,19 @@ DEFINE_FFF_GLOBALS;
 
 /* Kconfig defines needed by main.c */
 #define CONFIG_BT_DEVICE_NAME "TestDevice"
+#define CONFIG_BT_MAX_CONN 2
+#define CONFIG_RADPRO_PROTOCOL_ENGINE 1
+#define CONFIG_RADPRO_RESPONSE_CACHE 1
+#define CONFIG_RADPRO_SAMPLER 1
+#define CONFIG_RADPRO_RADIATION_SERVICE 1
+#define CONFIG_RADPRO_ADV_BEACON 1
+#define CONFIG_RADPRO_PER_ADV_TELEMETRY 1
+#define CONFIG_RADPRO_ADV_BONDED_ONLY 1
+#define CONFIG_RADPRO_L2CAP_COC 1
+#define CONFIG_RADPRO_DATALOG_SYNC 1
+#define CONFIG_RADPRO_DATALOG_MIRROR 1
+#define CONFIG_RADPRO_HISTORY 1
+#define CONFIG_RADPRO_METRICS 1
 /* CONFIG_SETTINGS intentionally left undefined -> IS_ENABLED returns 0 */
 
 #ifndef IS_ENABLED
@@ -52,10 +70,24 @@ DEFINE_FFF_GLOBALS;
  * Settings/USB headers are blocked by kernel_mocks.h. */
 #include "board/board_config.h"
 #include "ble/ble_service.h"
+#include "ble/nus_packetizer.h"
+#include "ble/l2cap_coc.h"
+#include "ble/link_profile.h"
+#include "ble/radiation_service.h"
+#include "ble/adv_beacon.h"
+#include "ble/telemetry_adv.h"
 #include "uart/uart_bridge.h"
 #include "security/security_manager.h"
 #include "led/led_status.h"
 #include "dfu/dfu_service.h"
+#include "metrics/metrics.h"
+#include "status/app_status.h"
+#include "radpro/radpro_engine.h"
+#include "radpro/radpro_client.h"
+#include "radpro/radpro_cache.h"
+#include "radpro/radpro_sampler.h"
+#include "radpro/radpro_mirror.h"
+#include "radpro/radpro_history.h"
 
 /* Stub K_THREAD_DEFINE — don't create threads */
 #ifdef K_THREAD_DEFINE
@@ -79,16 +111,35 @@ DEFINE_FFF_GLOBALS;
 MANUAL_FAKE_VALUE_FUNC0(int, board_init)
 MANUAL_FAKE_VALUE_FUNC0(int, led_status_init)
 MANUAL_FAKE_VALUE_FUNC0(int, ble_service_start_advertising)
+MANUAL_FAKE_VALUE_FUNC0(int, nus_packetizer_init)
+MANUAL_FAKE_VALUE_FUNC0(int, link_profile_init)
+MANUAL_FAKE_VALUE_FUNC0(int, radpro_cache_init)
+MANUAL_FAKE_VALUE_FUNC0(int, radpro_cache_prefetch)
+MANUAL_FAKE_VALUE_FUNC0(int, radpro_sampler_init)
+MANUAL_FAKE_VALUE_FUNC0(int, radpro_sampler_start)
+MANUAL_FAKE_VALUE_FUNC0(int, radpro_mirror_init)
+MANUAL_FAKE_VALUE_FUNC0(int, radpro_mirror_start)
+MANUAL_FAKE_VALUE_FUNC0(int, radpro_history_init)
+MANUAL_FAKE_VALUE_FUNC0(int, radiation_service_init)
+MANUAL_FAKE_VALUE_FUNC0(int, radiation_service_start)
+MANUAL_FAKE_VALUE_FUNC0(int, adv_beacon_init)
+MANUAL_FAKE_VALUE_FUNC0(int, telemetry_adv_init)
 MANUAL_FAKE_VALUE_FUNC0(int, dfu_service_init)
+MANUAL_FAKE_VALUE_FUNC0(int, metrics_init)
 MANUAL_FAKE_VALUE_FUNC0(int, settings_load)
 MANUAL_FAKE_VALUE_FUNC0(bool, ble_service_is_authenticated)
-MANUAL_FAKE_VALUE_FUNC0(bool, security_manager_is_pairing_allowed)
-MANUAL_FAKE_VOID_FUNC0(led_status_error)
+MANUAL_FAKE_VOID_FUNC0(ble_service_restart_advertising)
+MANUAL_FAKE_VOID_FUNC0(ble_service_boost_advertising)
 
 /* --- FFF fakes for functions with args (DECLARE+DEFINE) --- */
 DECLARE_FAKE_VALUE_FUNC(int, security_manager_init, uint32_t);
 DEFINE_FAKE_VALUE_FUNC(int, security_manager_init, uint32_t);
 
+DECLARE_FAKE_VOID_FUNC(security_manager_set_window_closed_cb,
+		       security_window_closed_cb_t);
+DEFINE_FAKE_VOID_FUNC(security_manager_set_window_closed_cb,
+		      security_window_closed_cb_t);
+
 DECLARE_FAKE_VALUE_FUNC(int, uart_bridge_init, uart_data_received_cb_t);
 DEFINE_FAKE_VALUE_FUNC(int, uart_bridge_init, uart_data_received_cb_t);
 
@@ -101,17 +152,64 @@ DEFINE_FAKE_VALUE_FUNC(int, ble_service_init, ble_data_received_cb_t);
 DECLARE_FAKE_VOID_FUNC(bt_id_get, bt_addr_le_t *, size_t *);
 DEFINE_FAKE_VOID_FUNC(bt_id_get, bt_addr_le_t *, size_t *);
 
-DECLARE_FAKE_VALUE_FUNC(int, ble_service_send, const uint8_t *, uint16_t);
-DEFINE_FAKE_VALUE_FUNC(int, ble_service_send, const uint8_t *, uint16_t);
+DECLARE_FAKE_VOID_FUNC(ble_service_set_disconnected_cb, ble_disconnected_cb_t);
+DEFINE_FAKE_VOID_FUNC(ble_service_set_disconnected_cb, ble_disconnected_cb_t);
+
+DECLARE_FAKE_VALUE_FUNC(struct bt_conn *, ble_service_get_connection, uint8_t);
+DEFINE_FAKE_VALUE_FUNC(struct bt_conn *, ble_service_get_connection, uint8_t);
+
+DECLARE_FAKE_VALUE_FUNC(bool, ble_service_is_conn_authenticated, struct bt_conn *);
+DEFINE_FAKE_VALUE_FUNC(bool, ble_service_is_conn_authenticated, struct bt_conn *);
+
+DECLARE_FAKE_VALUE_FUNC(uint8_t, bt_conn_index, const struct bt_conn *);
+DEFINE_FAKE_VALUE_FUNC(uint8_t, bt_conn_index, const struct bt_conn *);
+
+DECLARE_FAKE_VALUE_FUNC(int, nus_packetizer_write, struct bt_conn *, const uint8_t *,
+			uint16_t);
+DEFINE_FAKE_VALUE_FUNC(int, nus_packetizer_write, struct bt_conn *, const uint8_t *,
+		       uint16_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, nus_packetizer_broadcast, const uint8_t *, uint16_t);
+DEFINE_FAKE_VALUE_FUNC(int, nus_packetizer_broadcast, const uint8_t *, uint16_t);
+
+DECLARE_FAKE_VALUE_FUNC(bool, l2cap_coc_is_open, struct bt_conn *);
+DEFINE_FAKE_VALUE_FUNC(bool, l2cap_coc_is_open, struct bt_conn *);
+
+DECLARE_FAKE_VALUE_FUNC(int, l2cap_coc_send, struct bt_conn *, const uint8_t *, uint16_t);
+DEFINE_FAKE_VALUE_FUNC(int, l2cap_coc_send, struct bt_conn *, const uint8_t *, uint16_t);
+
+DECLARE_FAKE_VOID_FUNC(link_profile_note_traffic, size_t);
+DEFINE_FAKE_VOID_FUNC(link_profile_note_traffic, size_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, radpro_engine_init, radpro_data_cb_t);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_engine_init, radpro_data_cb_t);
+
+DECLARE_FAKE_VOID_FUNC(radpro_engine_uart_rx, const uint8_t *, size_t);
+DEFINE_FAKE_VOID_FUNC(radpro_engine_uart_rx, const uint8_t *, size_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, radpro_client_init, radpro_client_output_t);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_client_init, radpro_client_output_t);
+
+DECLARE_FAKE_VOID_FUNC(radpro_client_rx, uint8_t, const uint8_t *, uint16_t);
+DEFINE_FAKE_VOID_FUNC(radpro_client_rx, uint8_t, const uint8_t *, uint16_t);
+
+DECLARE_FAKE_VOID_FUNC(radpro_client_reset, uint8_t);
+DEFINE_FAKE_VOID_FUNC(radpro_client_reset, uint8_t);
+
+DECLARE_FAKE_VOID_FUNC(radpro_client_set_peer_cb, radpro_client_peer_t);
+DEFINE_FAKE_VOID_FUNC(radpro_client_set_peer_cb, radpro_client_peer_t);
+
+DECLARE_FAKE_VALUE_FUNC(const bt_addr_le_t *, bt_conn_get_dst, const struct bt_conn *);
+DEFINE_FAKE_VALUE_FUNC(const bt_addr_le_t *, bt_conn_get_dst, const struct bt_conn *);
+
+DECLARE_FAKE_VALUE_FUNC(bool, bt_le_bond_exists, uint8_t, const bt_addr_le_t *);
+DEFINE_FAKE_VALUE_FUNC(bool, bt_le_bond_exists, uint8_t, const bt_addr_le_t *);
 
 DECLARE_FAKE_VALUE_FUNC(int, uart_bridge_send, const uint8_t *, uint16_t);
 DEFINE_FAKE_VALUE_FUNC(int, uart_bridge_send, const uint8_t *, uint16_t);
 
-DECLARE_FAKE_VOID_FUNC(led_status_set_connected, bool);
-DEFINE_FAKE_VOID_FUNC(led_status_set_connected, bool);
-
-DECLARE_FAKE_VOID_FUNC(led_status_set_pairing_window, bool);
-DEFINE_FAKE_VOID_FUNC(led_status_set_pairing_window, bool);
+DECLARE_FAKE_VOID_FUNC(app_status_set, enum app_status_flag, bool);
+DEFINE_FAKE_VOID_FUNC(app_status_set, enum app_status_flag, bool);
 
 /* k_sleep is static inline in kernel.h — use macro redirect */
 static int32_t k_sleep_fake_return_val;
@@ -139,22 +237,52 @@ static void fff_reset_rule_before(const struct ztest_unit_test *test,
 	RESET_MANUAL_FAKE(board_init);
 	RESET_MANUAL_FAKE(led_status_init);
 	RESET_MANUAL_FAKE(ble_service_start_advertising);
+	RESET_MANUAL_FAKE(nus_packetizer_init);
+	RESET_MANUAL_FAKE(link_profile_init);
+	RESET_MANUAL_FAKE(radpro_cache_init);
+	RESET_MANUAL_FAKE(radpro_cache_prefetch);
+	RESET_MANUAL_FAKE(radpro_sampler_init);
+	RESET_MANUAL_FAKE(radpro_sampler_start);
+	RESET_MANUAL_FAKE(radpro_mirror_init);
+	RESET_MANUAL_FAKE(radpro_mirror_start);
+	RESET_MANUAL_FAKE(radpro_history_init);
+	RESET_MANUAL_FAKE(radiation_service_init);
+	RESET_MANUAL_FAKE(radiation_service_start);
+	RESET_MANUAL_FAKE(adv_beacon_init);
+	RESET_MANUAL_FAKE(telemetry_adv_init);
 	RESET_MANUAL_FAKE(dfu_service_init);
+	RESET_MANUAL_FAKE(metrics_init);
 	RESET_MANUAL_FAKE(settings_load);
 	RESET_MANUAL_FAKE(ble_service_is_authenticated);
-	RESET_MANUAL_FAKE(security_manager_is_pairing_allowed);
-	RESET_MANUAL_FAKE(led_status_error);
+	RESET_MANUAL_FAKE(ble_service_restart_advertising);
+	RESET_MANUAL_FAKE(ble_service_boost_advertising);
 
 	/* Reset FFF fakes (functions with args) */
 	RESET_FAKE(security_manager_init);
+	RESET_FAKE(security_manager_set_window_closed_cb);
 	RESET_FAKE(uart_bridge_init);
 	RESET_FAKE(bt_enable);
 	RESET_FAKE(ble_service_init);
 	RESET_FAKE(bt_id_get);
-	RESET_FAKE(ble_service_send);
+	RESET_FAKE(ble_service_set_disconnected_cb);
+	RESET_FAKE(ble_service_get_connection);
+	RESET_FAKE(ble_service_is_conn_authenticated);
+	RESET_FAKE(bt_conn_index);
+	RESET_FAKE(nus_packetizer_write);
+	RESET_FAKE(nus_packetizer_broadcast);
+	RESET_FAKE(l2cap_coc_is_open);
+	RESET_FAKE(l2cap_coc_send);
+	RESET_FAKE(link_profile_note_traffic);
+	RESET_FAKE(radpro_engine_init);
+	RESET_FAKE(radpro_engine_uart_rx);
+	RESET_FAKE(radpro_client_init);
+	RESET_FAKE(radpro_client_rx);
+	RESET_FAKE(radpro_client_reset);
+	RESET_FAKE(radpro_client_set_peer_cb);
+	RESET_FAKE(bt_conn_get_dst);
+	RESET_FAKE(bt_le_bond_exists);
 	RESET_FAKE(uart_bridge_send);
-	RESET_FAKE(led_status_set_connected);
-	RESET_FAKE(led_status_set_pairing_window);
+	RESET_FAKE(app_status_set);
 	k_sleep_fake_return_val = 0;
 	k_sleep_fake_call_count = 0;
 	FFF_RESET_HISTORY();
@@ -167,6 +295,8 @@ static void fff_reset_rule_before(const struct ztest_unit_test *test,
 	bt_enable_fake.return_val = 0;
 	ble_service_init_fake.return_val = 0;
 	ble_service_start_advertising_fake.return_val = 0;
+	nus_packetizer_init_fake.return_val = 0;
+	link_profile_init_fake.return_val = 0;
 	dfu_service_init_fake.return_val = 0;
 }
 
@@ -177,12 +307,97 @@ ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
 ZTEST(main_flow, test_uart_to_ble_authenticated)
 {
 	ble_service_is_authenticated_fake.return_val = true;
-	ble_service_send_fake.return_val = 0;
+	nus_packetizer_broadcast_fake.return_val = 0;
 
 	uint8_t data[] = "sensor_data";
-	uart_data_handler(data, sizeof(data));
+	forward_to_ble(data, sizeof(data));
+
+	/* Unsolicited data is fanned out to every central */
+	zassert_equal(nus_packetizer_broadcast_fake.call_count, 1);
+	zassert_equal(nus_packetizer_broadcast_fake.arg1_val, sizeof(data));
+	zassert_equal(nus_packetizer_write_fake.call_count, 0);
+	zassert_equal(link_profile_note_traffic_fake.arg0_val, sizeof(data));
+}
+
+ZTEST(main_flow, test_reply_routed_to_issuing_central)
+{
+	struct bt_conn second_conn;
+	uint8_t data[] = "OK 1.0\r\n";
+
+	ble_service_get_connection_fake.return_val = &second_conn;
+	ble_service_is_conn_authenticated_fake.return_val = true;
+
+	reply_to_client(1, data, sizeof(data) - 1);
+
+	zassert_equal(ble_service_get_connection_fake.arg0_val, 1);
+	zassert_equal(nus_packetizer_write_fake.call_count, 1);
+	zassert_equal(nus_packetizer_write_fake.arg0_val, &second_conn);
+	zassert_equal(nus_packetizer_broadcast_fake.call_count, 0);
+}
+
+ZTEST(main_flow, test_reply_uses_open_l2cap_channel)
+{
+	struct bt_conn conn;
+	uint8_t data[] = "OK 1.0\r\n";
+
+	ble_service_get_connection_fake.return_val = &conn;
+	ble_service_is_conn_authenticated_fake.return_val = true;
+	l2cap_coc_is_open_fake.return_val = true;
+
+	reply_to_client(0, data, sizeof(data) - 1);
+
+	zassert_equal(l2cap_coc_is_open_fake.arg0_val, &conn);
+	zassert_equal(l2cap_coc_send_fake.call_count, 1);
+	zassert_equal(l2cap_coc_send_fake.arg0_val, &conn);
+	zassert_equal(l2cap_coc_send_fake.arg2_val, sizeof(data) - 1);
+	zassert_equal(nus_packetizer_write_fake.call_count, 0);
+	zassert_equal(link_profile_note_traffic_fake.arg0_val, sizeof(data) - 1);
+}
+
+ZTEST(main_flow, test_reply_to_gone_central_dropped)
+{
+	uint8_t data[] = "OK 1.0\r\n";
+
+	ble_service_is_conn_authenticated_fake.return_val = false;
+
+	reply_to_client(0, data, sizeof(data) - 1);
+
+	zassert_equal(nus_packetizer_write_fake.call_count, 0);
+	zassert_equal(link_profile_note_traffic_fake.call_count, 0);
+}
+
+ZTEST(main_flow, test_client_peer_is_bonded_identity)
+{
+	struct bt_conn conn;
+	bt_addr_le_t addr = { 0 };
+
+	ble_service_get_connection_fake.return_val = &conn;
+	ble_service_is_conn_authenticated_fake.return_val = true;
+	bt_conn_get_dst_fake.return_val = &addr;
+	bt_le_bond_exists_fake.return_val = true;
+
+	zassert_equal(client_peer(1), &addr);
+	zassert_equal(ble_service_get_connection_fake.arg0_val, 1);
+
+	/* Encrypted but not bonded: nowhere to keep a cursor */
+	bt_le_bond_exists_fake.return_val = false;
+	zassert_is_null(client_peer(1));
+
+	ble_service_is_conn_authenticated_fake.return_val = false;
+	bt_le_bond_exists_fake.return_val = true;
+	zassert_is_null(client_peer(1));
+}
+
+ZTEST(main_flow, test_disconnect_resets_client)
+{
+	struct bt_conn dummy_conn;
+
+	bt_conn_index_fake.return_val = 1;
+
+	ble_disconnected_handler(&dummy_conn);
 
-	zassert_equal(ble_service_send_fake.call_count, 1);
+	zassert_equal(radpro_client_reset_fake.call_count, 1);
+	zassert_equal(radpro_client_reset_fake.arg0_val, 1);
 }
 
 ZTEST(main_flow, test_uart_to_ble_not_authenticated)
@@ -190,21 +405,127 @@ ZTEST(main_flow, test_uart_to_ble_not_authenticated)
 	ble_service_is_authenticated_fake.return_val = false;
 
 	uint8_t data[] = "sensor_data";
-	uart_data_handler(data, sizeof(data));
+	forward_to_ble(data, sizeof(data));
 
-	zassert_equal(ble_service_send_fake.call_count, 0,
+	zassert_equal(nus_packetizer_broadcast_fake.call_count, 0,
 		      "Data should be dropped when not authenticated");
+	zassert_equal(link_profile_note_traffic_fake.call_count, 0);
 }
 
-ZTEST(main_flow, test_ble_to_uart)
+ZTEST(main_flow, test_uart_data_goes_to_engine)
 {
-	uart_bridge_send_fake.return_val = 0;
+	uint8_t data[] = "OK 1.0\r\n";
+	uart_data_handler(data, sizeof(data) - 1);
+
+	zassert_equal(radpro_engine_uart_rx_fake.call_count, 1);
+	zassert_equal(radpro_engine_uart_rx_fake.arg1_val, sizeof(data) - 1);
+	zassert_equal(nus_packetizer_write_fake.call_count, 0,
+		      "Responses are routed by the engine, not sent directly");
+}
 
-	uint8_t data[] = "ble_command";
+ZTEST(main_flow, test_unsolicited_output_boosts_advertising)
+{
+	uint8_t data[] = "event\r\n";
+
+	unsolicited_handler(data, sizeof(data) - 1, NULL);
+
+	zassert_equal(ble_service_boost_advertising_fake.call_count, 1);
+	zassert_equal(radpro_engine_uart_rx_fake.call_count, 0);
+}
+
+ZTEST(main_flow, test_ble_to_uart)
+{
+	uint8_t data[] = "GET deviceId\r\n";
 	struct bt_conn dummy_conn;
-	ble_data_handler(&dummy_conn, data, sizeof(data));
 
-	zassert_equal(uart_bridge_send_fake.call_count, 1);
+	bt_conn_index_fake.return_val = 1;
+	ble_data_handler(&dummy_conn, data, sizeof(data) - 1);
+
+	/* Commands go through the engine queue, not straight to the UART */
+	zassert_equal(radpro_client_rx_fake.call_count, 1);
+	zassert_equal(radpro_client_rx_fake.arg0_val, 1, "Client is the connection slot");
+	zassert_equal(uart_bridge_send_fake.call_count, 0);
+}
+
+ZTEST(main_flow, test_init_wires_protocol_engine)
+{
+	int err = app_init();
+
+	zassert_equal(err, 0);
+	zassert_equal(radpro_engine_init_fake.call_count, 1);
+	zassert_equal(radpro_engine_init_fake.arg0_val, unsolicited_handler);
+	zassert_equal(radpro_client_init_fake.arg0_val, reply_to_client);
+	zassert_equal(ble_service_set_disconnected_cb_fake.arg0_val,
+		      ble_disconnected_handler);
+	zassert_equal(radpro_client_set_peer_cb_fake.arg0_val, client_peer);
+	zassert_equal(radpro_cache_init_fake.call_count, 1);
+	zassert_equal(radpro_cache_prefetch_fake.call_count, 1,
+		      "Static values are prefetched once the UART is up");
+	zassert_equal(radpro_sampler_init_fake.call_count, 1);
+	zassert_equal(radpro_sampler_start_fake.call_count, 1);
+	zassert_equal(radpro_mirror_init_fake.call_count, 1);
+	zassert_equal(radpro_mirror_start_fake.call_count, 1);
+	zassert_equal(radpro_history_init_fake.call_count, 1);
+	zassert_equal(radiation_service_init_fake.call_count, 1);
+	zassert_equal(radiation_service_start_fake.call_count, 1);
+	zassert_equal(adv_beacon_init_fake.call_count, 1);
+	zassert_equal(telemetry_adv_init_fake.call_count, 1);
+	zassert_equal(security_manager_set_window_closed_cb_fake.arg0_val,
+		      ble_service_restart_advertising,
+		      "Advertising restarts bonded-only when pairing ends");
+}
+
+ZTEST(main_flow, test_init_telemetry_failure_non_fatal)
+{
+	telemetry_adv_init_fake.return_val = -ENOMEM;
+
+	int err = app_init();
+
+	zassert_equal(err, 0);
+	zassert_equal(ble_service_start_advertising_fake.call_count, 1,
+		      "Connectable advertising still starts");
+}
+
+ZTEST(main_flow, test_init_mirror_failure_non_fatal)
+{
+	radpro_mirror_init_fake.return_val = -ENOENT;
+
+	int err = app_init();
+
+	zassert_equal(err, 0);
+	zassert_equal(ble_service_start_advertising_fake.call_count, 1);
+}
+
+ZTEST(main_flow, test_init_history_failure_non_fatal)
+{
+	radpro_history_init_fake.return_val = -ENOMEM;
+
+	int err = app_init();
+
+	zassert_equal(err, 0);
+	zassert_equal(radiation_service_init_fake.call_count, 1);
+}
+
+ZTEST(main_flow, test_init_metrics_failure_non_fatal)
+{
+	metrics_init_fake.return_val = -EINVAL;
+
+	int err = app_init();
+
+	zassert_equal(err, 0);
+	zassert_equal(metrics_init_fake.call_count, 1);
+	zassert_equal(ble_service_start_advertising_fake.call_count, 1);
+}
+
+ZTEST(main_flow, test_init_metrics_first)
+{
+	/* Registration zeroes the counters: nothing may count before it */
+	board_init_fake.return_val = -EIO;
+
+	int err = app_init();
+
+	zassert_equal(err, -EIO);
+	zassert_equal(metrics_init_fake.call_count, 1);
 }
 
 ZTEST(main_flow, test_init_fails_on_ble_error)
@@ -216,6 +537,16 @@ ZTEST(main_flow, test_init_fails_on_ble_error)
 	zassert_not_equal(err, 0, "app_init should fail when bt_enable fails");
 }
 
+ZTEST(main_flow, test_init_failure_publishes_error)
+{
+	bt_enable_fake.return_val = -EIO;
+
+	zassert_not_equal(radpro_main(), 0);
+	zassert_equal(app_status_set_fake.call_count, 1);
+	zassert_equal(app_status_set_fake.arg0_val, APP_STATUS_ERROR);
+	zassert_true(app_status_set_fake.arg1_val);
+}
+
 ZTEST(main_flow, test_init_uart_failure_non_fatal)
 {
 	uart_bridge_init_fake.return_val = -ENODEV;
@@ -226,6 +557,12 @@ ZTEST(main_flow, test_init_uart_failure_non_fatal)
 		      "app_init should succeed even if UART init fails");
 	/* bt_enable should still be called after UART failure */
 	zassert_equal(bt_enable_fake.call_count, 1);
+	zassert_equal(radpro_cache_prefetch_fake.call_count, 0);
+	zassert_equal(radpro_sampler_start_fake.call_count, 0);
+	zassert_equal(radpro_mirror_start_fake.call_count, 0);
+	zassert_equal(radiation_service_init_fake.call_count, 1);
+	zassert_equal(radiation_service_start_fake.call_count, 0,
+		      "No device polling without a UART");
 }
 
 ZTEST_SUITE(main_flow, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,205 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for metrics module.
+ */
+
+#include <zephyr/ztest.h>
+#include <string.h>
+
+/* Kconfig values — CONFIG_STATS left undefined */
+#define CONFIG_RADPRO_METRICS 1
+#define CONFIG_RADPRO_LATENCY 1
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+#ifdef LOG_DBG
+#undef LOG_DBG
+#endif
+#define LOG_DBG(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+/* BT type stubs */
+#include "bt_mocks.h"
+
+/* bt_gatt_attr_read copies the value as Zephyr does */
+static ssize_t bt_gatt_attr_read(struct bt_conn *conn,
+				 const struct bt_gatt_attr *attr, void *buf,
+				 uint16_t buf_len, uint16_t offset,
+				 const void *value, uint16_t value_len)
+{
+	uint16_t len;
+
+	if (offset > value_len) {
+		return -EINVAL;
+	}
+
+	len = MIN(buf_len, value_len - offset);
+	memcpy(buf, (const uint8_t *)value + offset, len);
+	return len;
+}
+
+/* Latency stubs: stage s reports max 1000 + s and bucket b = 100 * s + b */
+#include "radpro/radpro_latency.h"
+
+static int latency_resets;
+
+void radpro_latency_get(enum radpro_latency_stage stage, struct radpro_latency_hist *hist)
+{
+	hist->max_us = 1000 + stage;
+	for (int b = 0; b < RADPRO_LATENCY_BUCKETS; b++) {
+		hist->buckets[b] = 100 * stage + b;
+	}
+}
+
+void radpro_latency_reset(void)
+{
+	latency_resets++;
+}
+
+/* Include CUT */
+#include "metrics/metrics.c"
+
+/* Attribute index of the metrics value: primary service, declaration */
+#define METRICS_VALUE_ATTR 2
+/* Followed by the latency declaration and value */
+#define METRICS_LATENCY_ATTR 4
+
+static void metrics_before(void *fixture)
+{
+	for (int i = 0; i < METRICS_COUNT; i++) {
+		atomic_clear(&values[i]);
+	}
+	latency_resets = 0;
+}
+
+/* --- Tests --- */
+
+ZTEST(metrics, test_init_succeeds)
+{
+	zassert_ok(metrics_init());
+}
+
+ZTEST(metrics, test_counters_accumulate)
+{
+	uint32_t snapshot[METRICS_COUNT];
+
+	metrics_inc(METRICS_BLE_RX_FRAMES);
+	metrics_inc(METRICS_BLE_RX_FRAMES);
+	metrics_add(METRICS_BLE_RX_BYTES, 20);
+	metrics_add(METRICS_BLE_RX_BYTES, 22);
+
+	metrics_snapshot(snapshot);
+	zassert_equal(snapshot[METRICS_BLE_RX_FRAMES], 2);
+	zassert_equal(snapshot[METRICS_BLE_RX_BYTES], 42);
+	zassert_equal(snapshot[METRICS_BLE_TX_BYTES], 0);
+}
+
+ZTEST(metrics, test_counters_wrap)
+{
+	uint32_t snapshot[METRICS_COUNT];
+
+	metrics_set(METRICS_UART_RX_BYTES, UINT32_MAX);
+	metrics_add(METRICS_UART_RX_BYTES, 2);
+
+	metrics_snapshot(snapshot);
+	zassert_equal(snapshot[METRICS_UART_RX_BYTES], 1);
+}
+
+ZTEST(metrics, test_gauge_keeps_last_value)
+{
+	uint32_t snapshot[METRICS_COUNT];
+
+	metrics_set(METRICS_MTU, 247);
+	metrics_set(METRICS_MTU, 185);
+
+	metrics_snapshot(snapshot);
+	zassert_equal(snapshot[METRICS_MTU], 185);
+}
+
+ZTEST(metrics, test_gatt_read_encodes_le_in_enum_order)
+{
+	const struct bt_gatt_attr *attr = &metrics_svc.attrs[METRICS_VALUE_ATTR];
+	uint8_t buf[METRICS_COUNT * sizeof(uint32_t)];
+	ssize_t len;
+
+	metrics_add(METRICS_BLE_RX_BYTES, 0x01020304);
+	metrics_set(METRICS_MTU, 247);
+
+	len = attr->read(NULL, attr, buf, sizeof(buf), 0);
+
+	zassert_equal(len, sizeof(buf));
+	zassert_equal(sys_get_le32(&buf[METRICS_BLE_RX_BYTES * 4]), 0x01020304);
+	zassert_equal(sys_get_le32(&buf[METRICS_MTU * 4]), 247);
+	zassert_equal(sys_get_le32(&buf[METRICS_CONNECTS * 4]), 0);
+}
+
+ZTEST(metrics, test_gatt_read_continues_at_offset)
+{
+	const struct bt_gatt_attr *attr = &metrics_svc.attrs[METRICS_VALUE_ATTR];
+	uint8_t buf[22];
+	ssize_t len;
+
+	metrics_set(METRICS_MTU, 0xaabbccdd);
+
+	/* Read Blob past a default-MTU read */
+	len = attr->read(NULL, attr, buf, sizeof(buf), METRICS_MTU * 4);
+
+	zassert_equal(len, 4);
+	zassert_equal(sys_get_le32(buf), 0xaabbccdd);
+}
+
+ZTEST(metrics, test_gatt_read_needs_encryption)
+{
+	zassert_equal(metrics_svc.attrs[METRICS_VALUE_ATTR].perm, BT_GATT_PERM_READ_ENCRYPT);
+}
+
+ZTEST(metrics, test_latency_read_stage_by_stage)
+{
+	const struct bt_gatt_attr *attr = &metrics_svc.attrs[METRICS_LATENCY_ATTR];
+	uint8_t buf[RADPRO_LATENCY_STAGES * LATENCY_HIST_WORDS * sizeof(uint32_t)];
+	const uint8_t *total = &buf[RADPRO_LATENCY_TOTAL * LATENCY_HIST_WORDS * 4];
+	ssize_t len;
+
+	len = attr->read(NULL, attr, buf, sizeof(buf), 0);
+
+	zassert_equal(len, sizeof(buf));
+	zassert_equal(sys_get_le32(&buf[0]), 1000);
+	zassert_equal(sys_get_le32(&buf[4]), 0);
+	zassert_equal(sys_get_le32(&buf[4 * RADPRO_LATENCY_BUCKETS]), RADPRO_LATENCY_BUCKETS - 1);
+	zassert_equal(sys_get_le32(&total[0]), 1000 + RADPRO_LATENCY_TOTAL);
+	zassert_equal(sys_get_le32(&total[4 * 5]), 100 * RADPRO_LATENCY_TOTAL + 4);
+}
+
+ZTEST(metrics, test_latency_write_resets)
+{
+	const struct bt_gatt_attr *attr = &metrics_svc.attrs[METRICS_LATENCY_ATTR];
+	uint8_t zero = 0;
+
+	zassert_equal(attr->write(NULL, attr, &zero, 1, 0, 0), 1);
+	zassert_equal(latency_resets, 1);
+	zassert_equal(attr->perm, BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT);
+}
+
+ZTEST_SUITE(metrics, NULL, NULL, metrics_before, NULL, NULL);
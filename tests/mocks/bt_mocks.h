@@ -16,16 +16,21 @@
 #define ZEPHYR_INCLUDE_BLUETOOTH_HCI_H_
 #define ZEPHYR_INCLUDE_BLUETOOTH_HCI_TYPES_H_
 #define ZEPHYR_INCLUDE_BLUETOOTH_SERVICES_NUS_H_
+#define ZEPHYR_INCLUDE_BLUETOOTH_L2CAP_H_
+#define ZEPHYR_INCLUDE_NET_BUF_H_
 
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <sys/types.h>
 
 /* --- Address types --- */
 typedef struct { uint8_t val[6]; } bt_addr_t;
 typedef struct { uint8_t type; bt_addr_t a; } bt_addr_le_t;
 #define BT_ADDR_LE_STR_LEN 30
 
+#define BT_ID_DEFAULT 0
+
 /* --- Connection types --- */
 struct bt_conn { int _dummy; };
 
@@ -69,6 +74,35 @@ struct bt_le_conn_param {
 	uint16_t timeout;
 };
 
+#define BT_LE_CONN_PARAM_INIT(int_min, int_max, lat, to) \
+	{ .interval_min = (int_min), .interval_max = (int_max), \
+	  .latency = (lat), .timeout = (to) }
+
+/* --- PHY / data length types --- */
+#define BT_GAP_LE_PHY_NONE   0
+#define BT_GAP_LE_PHY_1M     (1 << 0)
+#define BT_GAP_LE_PHY_2M     (1 << 1)
+#define BT_GAP_LE_PHY_CODED  (1 << 2)
+#define BT_CONN_LE_PHY_OPT_NONE 0
+#define BT_GAP_DATA_LEN_MAX  0xfb
+#define BT_GAP_DATA_TIME_MAX 0x4290
+
+struct bt_conn_le_phy_param {
+	uint16_t options;
+	uint8_t pref_tx_phy;
+	uint8_t pref_rx_phy;
+};
+
+struct bt_conn_le_phy_info {
+	uint8_t tx_phy;
+	uint8_t rx_phy;
+};
+
+struct bt_conn_le_data_len_param {
+	uint16_t tx_max_len;
+	uint16_t tx_max_time;
+};
+
 struct bt_conn_le_data_len_info {
 	uint16_t tx_max_len;
 	uint16_t rx_max_len;
@@ -86,6 +120,8 @@ struct bt_conn_cb {
 			     struct bt_le_conn_param *param);
 	void (*le_param_updated)(struct bt_conn *conn, uint16_t interval,
 				 uint16_t latency, uint16_t timeout);
+	void (*le_phy_updated)(struct bt_conn *conn,
+			       struct bt_conn_le_phy_info *info);
 	void (*le_data_len_updated)(struct bt_conn *conn,
 				    struct bt_conn_le_data_len_info *info);
 };
@@ -99,6 +135,97 @@ struct bt_gatt_cb {
 			       uint16_t rx);
 };
 
+/* --- UUID / attribute types --- */
+struct bt_uuid { uint8_t type; };
+struct bt_uuid_128 { struct bt_uuid uuid; uint8_t val[16]; };
+#define BT_UUID_TYPE_128 2
+#define BT_UUID_INIT_128(value...) \
+	{ .uuid = { BT_UUID_TYPE_128 }, .val = { value } }
+
+#define BT_UUID_128_ENCODE(w32, w1, w2, w3, w48) \
+	(((w48) >>  0) & 0xFF), (((w48) >>  8) & 0xFF), \
+	(((w48) >> 16) & 0xFF), (((w48) >> 24) & 0xFF), \
+	(((w48) >> 32) & 0xFF), (((w48) >> 40) & 0xFF), \
+	(((w3)  >>  0) & 0xFF), (((w3)  >>  8) & 0xFF), \
+	(((w2)  >>  0) & 0xFF), (((w2)  >>  8) & 0xFF), \
+	(((w1)  >>  0) & 0xFF), (((w1)  >>  8) & 0xFF), \
+	(((w32) >>  0) & 0xFF), (((w32) >>  8) & 0xFF), \
+	(((w32) >> 16) & 0xFF), (((w32) >> 24) & 0xFF)
+#define BT_UUID_DECLARE_128(value...) \
+	((const struct bt_uuid *)((const struct bt_uuid_128[]) { \
+		BT_UUID_INIT_128(value) }))
+
+struct bt_gatt_attr {
+	const struct bt_uuid *uuid;
+	ssize_t (*read)(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			void *buf, uint16_t len, uint16_t offset);
+	ssize_t (*write)(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			 const void *buf, uint16_t len, uint16_t offset,
+			 uint8_t flags);
+	void *user_data;
+	uint16_t handle;
+	uint16_t perm;
+};
+
+/* --- GATT service definition --- */
+#define BT_GATT_CHRC_READ          0x02
+#define BT_GATT_CHRC_NOTIFY        0x10
+#define BT_GATT_PERM_NONE          0x00
+#define BT_GATT_PERM_READ          0x01
+#define BT_GATT_PERM_WRITE         0x02
+#define BT_GATT_PERM_READ_ENCRYPT  0x04
+#define BT_GATT_PERM_WRITE_ENCRYPT 0x08
+#define BT_GATT_CCC_NOTIFY         0x0001
+
+struct bt_gatt_service_static {
+	const struct bt_gatt_attr *attrs;
+	size_t attr_count;
+};
+
+/* Same attribute layout as Zephyr: service, declaration + value per
+ * characteristic, one attribute per CCC */
+#define BT_GATT_SERVICE_DEFINE(_name, ...) \
+	static struct bt_gatt_attr attr_##_name[] = { __VA_ARGS__ }; \
+	static const struct bt_gatt_service_static _name = { \
+		.attrs = attr_##_name, \
+		.attr_count = sizeof(attr_##_name) / sizeof(attr_##_name[0]), \
+	}
+
+#define BT_GATT_PRIMARY_SERVICE(_service) \
+	{ .uuid = NULL, .user_data = (void *)(_service) }
+
+#define BT_GATT_CHARACTERISTIC(_uuid, _props, _perm, _read, _write, _user_data) \
+	{ .uuid = NULL }, \
+	{ .uuid = (_uuid), .read = (_read), .write = (_write), \
+	  .user_data = (_user_data), .perm = (_perm) }
+
+#define BT_GATT_CCC(_changed, _perm) \
+	{ .uuid = NULL, .user_data = (void *)(_changed), .perm = (_perm) }
+
+/* CCC with a per-connection write callback: user_data points to both */
+struct bt_gatt_ccc_cbs {
+	void (*changed)(const struct bt_gatt_attr *attr, uint16_t value);
+	ssize_t (*cfg_write)(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			     uint16_t value);
+};
+
+#define BT_GATT_CCC_WITH_WRITE_CB(_changed, _write, _perm) \
+	{ .uuid = NULL, \
+	  .user_data = (void *)&(const struct bt_gatt_ccc_cbs){ (_changed), (_write) }, \
+	  .perm = (_perm) }
+
+typedef void (*bt_gatt_complete_func_t)(struct bt_conn *conn,
+					void *user_data);
+
+struct bt_gatt_notify_params {
+	const struct bt_uuid *uuid;
+	const struct bt_gatt_attr *attr;
+	const void *data;
+	uint16_t len;
+	bt_gatt_complete_func_t func;
+	void *user_data;
+};
+
 /* --- NUS types --- */
 struct bt_nus_cb {
 	void (*received)(struct bt_conn *conn, const void *data,
@@ -114,14 +241,39 @@ struct bt_data {
 
 struct bt_le_adv_param {
 	uint8_t id;
-	uint8_t options;
+	uint32_t options;
 	uint16_t interval_min;
 	uint16_t interval_max;
+	const bt_addr_le_t *peer;
+};
+
+#define BT_LE_ADV_OPT_CONN             (1 << 0)
+#define BT_LE_ADV_OPT_FILTER_SCAN_REQ  (1 << 3)
+#define BT_LE_ADV_OPT_FILTER_CONN      (1 << 4)
+#define BT_GAP_ADV_FAST_INT_MIN_1      0x0030
+#define BT_GAP_ADV_FAST_INT_MAX_1      0x0060
+#define BT_GAP_ADV_FAST_INT_MIN_2      0x00a0
+#define BT_GAP_ADV_FAST_INT_MAX_2      0x00f0
+#define BT_GAP_ADV_SLOW_INT_MIN        0x0640
+#define BT_GAP_ADV_SLOW_INT_MAX        0x0780
+
+#define BT_LE_ADV_PARAM_INIT(_options, _int_min, _int_max, _peer) \
+	{ .id = BT_ID_DEFAULT, .options = (_options), \
+	  .interval_min = (_int_min), .interval_max = (_int_max), \
+	  .peer = (_peer) }
+
+#define BT_HCI_ERR_ADV_TIMEOUT 0x3c
+
+/* --- Bond types --- */
+struct bt_bond_info {
+	bt_addr_le_t addr;
 };
 
 #define BT_DATA_FLAGS        0x01
 #define BT_DATA_NAME_COMPLETE 0x09
 #define BT_DATA_UUID128_ALL  0x07
+#define BT_DATA_MANUFACTURER_DATA 0xff
+#define BT_DATA_SVC_DATA128  0x21
 
 #define BT_LE_AD_GENERAL     0x02
 #define BT_LE_AD_NO_BREDR    0x04
@@ -139,11 +291,95 @@ struct bt_le_adv_param {
 #define BT_LE_ADV_CONN_FAST_2 \
 	((struct bt_le_adv_param[]){ { 0 } })
 
+#define BT_LE_ADV_CONN_DIR(_peer) \
+	((struct bt_le_adv_param[]){ \
+		BT_LE_ADV_PARAM_INIT(BT_LE_ADV_OPT_CONN, 0, 0, _peer) })
+
+/* --- Extended / periodic advertising types --- */
+struct bt_le_ext_adv { int _dummy; };
+
+struct bt_le_ext_adv_cb { int _dummy; };
+
+struct bt_le_ext_adv_start_param {
+	uint16_t timeout;
+	uint8_t num_events;
+};
+
+struct bt_le_per_adv_param {
+	uint16_t interval_min;
+	uint16_t interval_max;
+	uint32_t options;
+};
+
+#define BT_LE_PER_ADV_OPT_NONE 0
+
+#define BT_LE_EXT_ADV_NCONN \
+	((struct bt_le_adv_param[]){ { 0 } })
+#define BT_LE_EXT_ADV_START_DEFAULT \
+	((struct bt_le_ext_adv_start_param[]){ { 0 } })
+
 /* NUS service UUID (16 bytes) */
 #define BT_UUID_NUS_SRV_VAL \
 	0x9E, 0xCA, 0xDC, 0x24, 0x0E, 0xE5, 0xA9, 0xE0, \
 	0x93, 0xF3, 0xA3, 0xB5, 0x01, 0x00, 0x40, 0x6E
 
+/* NUS TX characteristic UUID (16 bytes) */
+#define BT_UUID_NUS_TX_CHAR_VAL \
+	0x9E, 0xCA, 0xDC, 0x24, 0x0E, 0xE5, 0xA9, 0xE0, \
+	0x93, 0xF3, 0xA3, 0xB5, 0x03, 0x00, 0x40, 0x6E
+
 typedef void (*bt_ready_cb_t)(int err);
 
+/* --- Network buffers --- */
+struct net_buf {
+	uint8_t *data;
+	uint16_t len;
+	uint16_t size;
+	uint8_t *__buf;
+};
+
+struct net_buf_pool { int _dummy; };
+
+#define NET_BUF_POOL_FIXED_DEFINE(_name, _count, _data_size, _ud_size, _destroy) \
+	static struct net_buf_pool _name
+
+/* --- L2CAP connection-oriented channels --- */
+struct bt_l2cap_chan_ops;
+
+struct bt_l2cap_chan {
+	struct bt_conn *conn;
+	const struct bt_l2cap_chan_ops *ops;
+};
+
+struct bt_l2cap_le_endpoint {
+	uint16_t cid;
+	uint16_t mtu;
+	uint16_t mps;
+};
+
+struct bt_l2cap_le_chan {
+	struct bt_l2cap_chan chan;
+	struct bt_l2cap_le_endpoint rx;
+	struct bt_l2cap_le_endpoint tx;
+};
+
+struct bt_l2cap_chan_ops {
+	void (*connected)(struct bt_l2cap_chan *chan);
+	void (*disconnected)(struct bt_l2cap_chan *chan);
+	struct net_buf *(*alloc_buf)(struct bt_l2cap_chan *chan);
+	int (*recv)(struct bt_l2cap_chan *chan, struct net_buf *buf);
+	void (*sent)(struct bt_l2cap_chan *chan);
+};
+
+struct bt_l2cap_server {
+	uint16_t psm;
+	bt_security_t sec_level;
+	int (*accept)(struct bt_conn *conn, struct bt_l2cap_server *server,
+		      struct bt_l2cap_chan **chan);
+};
+
+#define BT_L2CAP_SDU_HDR_SIZE 2
+#define BT_L2CAP_SDU_CHAN_SEND_RESERVE 8
+#define BT_L2CAP_SDU_BUF_SIZE(mtu) (BT_L2CAP_SDU_CHAN_SEND_RESERVE + (mtu))
+
 #endif /* BT_MOCKS_H */
@@ -46,12 +46,25 @@ struct uart_event_rx_buf {
 	uint8_t *buf;
 };
 
+enum uart_rx_stop_reason {
+	UART_ERROR_OVERRUN = (1 << 0),
+	UART_ERROR_PARITY = (1 << 1),
+	UART_ERROR_FRAMING = (1 << 2),
+	UART_BREAK = (1 << 3),
+};
+
+struct uart_event_rx_stop {
+	enum uart_rx_stop_reason reason;
+	struct uart_event_rx data;
+};
+
 struct uart_event {
 	enum uart_event_type type;
 	union {
 		struct uart_event_tx tx;
 		struct uart_event_rx rx;
 		struct uart_event_rx_buf rx_buf;
+		struct uart_event_rx_stop rx_stop;
 	} data;
 };
 
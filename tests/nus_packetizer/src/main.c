@@ -0,0 +1,551 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for nus_packetizer module.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/fff.h>
+#include <string.h>
+
+DEFINE_FFF_GLOBALS;
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+#ifdef LOG_DBG
+#undef LOG_DBG
+#endif
+#define LOG_DBG(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+/* BT type stubs (ble_service.h pulls in BT headers) */
+#include "bt_mocks.h"
+
+#define CONFIG_BT_MAX_CONN 2
+#define CONFIG_RADPRO_NUS_COALESCE_MS 20
+
+#include "ble/ble_service.h"
+
+/* FFF fakes — BLE service */
+DECLARE_FAKE_VALUE_FUNC(uint16_t, ble_service_get_mtu, struct bt_conn *);
+DEFINE_FAKE_VALUE_FUNC(uint16_t, ble_service_get_mtu, struct bt_conn *);
+
+DECLARE_FAKE_VALUE_FUNC(int, ble_service_send, struct bt_conn *, const uint8_t *,
+			uint16_t, k_timeout_t);
+DEFINE_FAKE_VALUE_FUNC(int, ble_service_send, struct bt_conn *, const uint8_t *,
+		       uint16_t, k_timeout_t);
+
+DECLARE_FAKE_VALUE_FUNC(struct bt_conn *, ble_service_get_connection, uint8_t);
+DEFINE_FAKE_VALUE_FUNC(struct bt_conn *, ble_service_get_connection, uint8_t);
+
+DECLARE_FAKE_VALUE_FUNC(bool, ble_service_is_conn_authenticated, struct bt_conn *);
+DEFINE_FAKE_VALUE_FUNC(bool, ble_service_is_conn_authenticated, struct bt_conn *);
+
+DECLARE_FAKE_VALUE_FUNC(uint8_t, bt_conn_index, const struct bt_conn *);
+DEFINE_FAKE_VALUE_FUNC(uint8_t, bt_conn_index, const struct bt_conn *);
+
+/* FFF fakes — kernel work */
+DECLARE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+			k_work_handler_t);
+DEFINE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+		      k_work_handler_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+			k_timeout_t);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+		       k_timeout_t);
+
+/* k_mutex_* are syscalls in kernel.h — use macro redirect */
+static int test_k_mutex_init(struct k_mutex *mutex)
+{
+	return 0;
+}
+#define k_mutex_init(mutex) test_k_mutex_init(mutex)
+
+/* Set while another thread holds the lock */
+static bool test_mutex_busy;
+
+static int test_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+	if (test_mutex_busy) {
+		zassert_true(K_TIMEOUT_EQ(timeout, K_NO_WAIT), "Would wait for the lock holder");
+		return -EBUSY;
+	}
+	return 0;
+}
+#define k_mutex_lock(mutex, timeout) test_k_mutex_lock(mutex, timeout)
+
+static int test_k_mutex_unlock(struct k_mutex *mutex)
+{
+	return 0;
+}
+#define k_mutex_unlock(mutex) test_k_mutex_unlock(mutex)
+
+/* Stub K_MUTEX_DEFINE — just declare the struct */
+#ifdef K_MUTEX_DEFINE
+#undef K_MUTEX_DEFINE
+#endif
+#define K_MUTEX_DEFINE(name) struct k_mutex name
+
+/* Stub ARG_UNUSED if not available */
+#ifndef ARG_UNUSED
+#define ARG_UNUSED(x) (void)(x)
+#endif
+
+/* Two centrals: test_conn in slot 0, test_conn2 in slot 1 */
+static struct bt_conn test_conn;
+static struct bt_conn test_conn2;
+static bool test_conn2_connected;
+
+static uint8_t bt_conn_index_custom(const struct bt_conn *conn)
+{
+	return conn == &test_conn2 ? 1 : 0;
+}
+
+static struct bt_conn *ble_service_get_connection_custom(uint8_t index)
+{
+	if (index == 0) {
+		return &test_conn;
+	}
+	return (index == 1 && test_conn2_connected) ? &test_conn2 : NULL;
+}
+
+static bool ble_service_is_conn_authenticated_custom(struct bt_conn *conn)
+{
+	return conn == &test_conn || (conn == &test_conn2 && test_conn2_connected);
+}
+
+/* Capture of everything handed to ble_service_send */
+#define MAX_SENDS 16
+static uint8_t sent_data[1024];
+static size_t sent_total;
+static uint16_t sent_lens[MAX_SENDS];
+static struct bt_conn *sent_conns[MAX_SENDS];
+
+static int ble_service_send_capture(struct bt_conn *conn, const uint8_t *data,
+				    uint16_t len, k_timeout_t timeout)
+{
+	unsigned int idx = ble_service_send_fake.call_count - 1;
+
+	if (idx < MAX_SENDS) {
+		sent_lens[idx] = len;
+		sent_conns[idx] = conn;
+	}
+	memcpy(&sent_data[sent_total], data, len);
+	sent_total += len;
+	return 0;
+}
+
+/* test_conn2 stopped reading: its TX window stays full */
+static int ble_service_send_conn2_stalled(struct bt_conn *conn, const uint8_t *data,
+					  uint16_t len, k_timeout_t timeout)
+{
+	if (conn == &test_conn2) {
+		return -EAGAIN;
+	}
+	return ble_service_send_capture(conn, data, len, timeout);
+}
+
+/* Include CUT */
+#include "ble/nus_packetizer.c"
+
+/* --- FFF reset rule --- */
+static void fff_reset_rule_before(const struct ztest_unit_test *test,
+				  void *fixture)
+{
+	RESET_FAKE(ble_service_get_mtu);
+	RESET_FAKE(ble_service_send);
+	RESET_FAKE(ble_service_get_connection);
+	RESET_FAKE(ble_service_is_conn_authenticated);
+	RESET_FAKE(bt_conn_index);
+	RESET_FAKE(k_work_init_delayable);
+	RESET_FAKE(k_work_reschedule);
+	FFF_RESET_HISTORY();
+
+	ble_service_get_mtu_fake.return_val = 23;
+	ble_service_send_fake.custom_fake = ble_service_send_capture;
+	ble_service_get_connection_fake.custom_fake = ble_service_get_connection_custom;
+	ble_service_is_conn_authenticated_fake.custom_fake =
+		ble_service_is_conn_authenticated_custom;
+	bt_conn_index_fake.custom_fake = bt_conn_index_custom;
+	test_conn2_connected = false;
+	test_mutex_busy = false;
+
+	memset(sent_data, 0, sizeof(sent_data));
+	memset(sent_lens, 0, sizeof(sent_lens));
+	memset(sent_conns, 0, sizeof(sent_conns));
+	sent_total = 0;
+
+	nus_packetizer_init();
+}
+
+ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
+
+/* --- Tests --- */
+
+ZTEST(nus_packetizer, test_init_sets_up_flush_work)
+{
+	zassert_equal(k_work_init_delayable_fake.call_count, CONFIG_BT_MAX_CONN);
+	zassert_equal(k_work_init_delayable_fake.arg0_history[0], &ctxs[0].flush_work);
+	zassert_equal(k_work_init_delayable_fake.arg0_history[1], &ctxs[1].flush_work);
+	zassert_equal(ctxs[0].len, 0);
+}
+
+ZTEST(nus_packetizer, test_small_write_is_buffered)
+{
+	int err = nus_packetizer_write(&test_conn, (const uint8_t *)"OK 12", 5);
+
+	zassert_equal(err, 0);
+	zassert_equal(ble_service_send_fake.call_count, 0);
+	zassert_equal(ctxs[0].len, 5);
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+	zassert_true(K_TIMEOUT_EQ(k_work_reschedule_fake.arg1_val, K_MSEC(20)));
+}
+
+ZTEST(nus_packetizer, test_fragments_coalesce_until_deadline)
+{
+	nus_packetizer_write(&test_conn, (const uint8_t *)"OK ", 3);
+	nus_packetizer_write(&test_conn, (const uint8_t *)"time,", 5);
+	nus_packetizer_write(&test_conn, (const uint8_t *)"tube", 4);
+
+	/* Deadline runs from the first buffered byte, not the last */
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+	zassert_equal(ble_service_send_fake.call_count, 0);
+
+	/* Deadline expires */
+	flush_work_handler(&ctxs[0].flush_work.work);
+
+	zassert_equal(ble_service_send_fake.call_count, 1);
+	zassert_equal(sent_lens[0], 12);
+	zassert_mem_equal(sent_data, "OK time,tube", 12);
+	zassert_equal(ctxs[0].len, 0);
+}
+
+ZTEST(nus_packetizer, test_line_end_flushes_immediately)
+{
+	nus_packetizer_write(&test_conn, (const uint8_t *)"OK 3.", 5);
+	nus_packetizer_write(&test_conn, (const uint8_t *)"95\r\n", 4);
+
+	zassert_equal(ble_service_send_fake.call_count, 1);
+	zassert_equal(sent_lens[0], 9);
+	zassert_mem_equal(sent_data, "OK 3.95\r\n", 9);
+	zassert_equal(ctxs[0].len, 0);
+}
+
+ZTEST(nus_packetizer, test_large_write_split_to_mtu)
+{
+	uint8_t data[50];
+
+	for (int i = 0; i < sizeof(data); i++) {
+		data[i] = 'a' + (i % 26);
+	}
+
+	/* Default MTU 23 → 20-byte payloads */
+	int err = nus_packetizer_write(&test_conn, data, sizeof(data));
+
+	zassert_equal(err, 0);
+	zassert_equal(ble_service_send_fake.call_count, 2);
+	zassert_equal(sent_lens[0], 20);
+	zassert_equal(sent_lens[1], 20);
+	zassert_equal(ctxs[0].len, 10);
+
+	nus_packetizer_flush(&test_conn);
+
+	zassert_equal(ble_service_send_fake.call_count, 3);
+	zassert_equal(sent_lens[2], 10);
+	zassert_mem_equal(sent_data, data, sizeof(data));
+}
+
+ZTEST(nus_packetizer, test_fragments_fill_full_notification)
+{
+	uint8_t data[300];
+
+	memset(data, '7', sizeof(data));
+	ble_service_get_mtu_fake.return_val = 247;
+
+	nus_packetizer_write(&test_conn, data, 200);
+	zassert_equal(ble_service_send_fake.call_count, 0);
+
+	nus_packetizer_write(&test_conn, data, 100);
+
+	/* 244-byte payload sent as soon as it fills, rest restarts deadline */
+	zassert_equal(ble_service_send_fake.call_count, 1);
+	zassert_equal(sent_lens[0], 244);
+	zassert_equal(ctxs[0].len, 56);
+	zassert_equal(k_work_reschedule_fake.call_count, 2);
+}
+
+ZTEST(nus_packetizer, test_payload_clamped_to_buffer)
+{
+	uint8_t data[300];
+
+	memset(data, '1', sizeof(data));
+	ble_service_get_mtu_fake.return_val = 498;
+
+	nus_packetizer_write(&test_conn, data, sizeof(data));
+
+	zassert_equal(ble_service_send_fake.call_count, 1);
+	zassert_equal(sent_lens[0], NUS_PKT_MAX_PAYLOAD);
+	zassert_equal(ctxs[0].len, sizeof(data) - NUS_PKT_MAX_PAYLOAD);
+}
+
+ZTEST(nus_packetizer, test_mtu_shrink_flushes_buffered_data)
+{
+	uint8_t data[100];
+
+	memset(data, 'x', sizeof(data));
+	ble_service_get_mtu_fake.return_val = 247;
+	nus_packetizer_write(&test_conn, data, 30);
+
+	/* Reconnected with the default MTU: 30 buffered bytes no longer fit */
+	ble_service_get_mtu_fake.return_val = 23;
+	nus_packetizer_write(&test_conn, data, 5);
+
+	zassert_equal(ble_service_send_fake.call_count, 1);
+	zassert_equal(sent_lens[0], 30);
+	zassert_equal(ctxs[0].len, 5);
+}
+
+ZTEST(nus_packetizer, test_send_error_drops_buffer)
+{
+	ble_service_send_fake.custom_fake = NULL;
+	ble_service_send_fake.return_val = -ENOTCONN;
+
+	int err = nus_packetizer_write(&test_conn, (const uint8_t *)"OK\r\n", 4);
+
+	zassert_equal(err, -ENOTCONN);
+	zassert_equal(ctxs[0].len, 0);
+}
+
+ZTEST(nus_packetizer, test_tx_window_full_keeps_data)
+{
+	ble_service_send_fake.custom_fake = NULL;
+	ble_service_send_fake.return_val = -EAGAIN;
+
+	int err = nus_packetizer_write(&test_conn, (const uint8_t *)"OK 42\r\n", 7);
+
+	/* Line is retained and a retry is scheduled */
+	zassert_equal(err, 0);
+	zassert_equal(ctxs[0].len, 7);
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+	zassert_true(K_TIMEOUT_EQ(k_work_reschedule_fake.arg1_val,
+				  NUS_FLUSH_RETRY_DELAY));
+
+	/* Window reopens; retry sends it */
+	ble_service_send_fake.custom_fake = ble_service_send_capture;
+	flush_work_handler(&ctxs[0].flush_work.work);
+
+	zassert_equal(ctxs[0].len, 0);
+	zassert_mem_equal(sent_data, "OK 42\r\n", 7);
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+}
+
+ZTEST(nus_packetizer, test_retry_reschedules_while_window_full)
+{
+	nus_packetizer_write(&test_conn, (const uint8_t *)"OK", 2);
+	ble_service_send_fake.custom_fake = NULL;
+	ble_service_send_fake.return_val = -EAGAIN;
+	RESET_FAKE(k_work_reschedule);
+
+	flush_work_handler(&ctxs[0].flush_work.work);
+
+	zassert_equal(ctxs[0].len, 2);
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+}
+
+ZTEST(nus_packetizer, test_flush_work_does_not_wait_for_writer)
+{
+	nus_packetizer_write(&test_conn, (const uint8_t *)"OK", 2);
+	RESET_FAKE(k_work_reschedule);
+
+	/* A writer holds the lock while it waits for TX credits */
+	test_mutex_busy = true;
+	flush_work_handler(&ctxs[0].flush_work.work);
+
+	zassert_equal(ble_service_send_fake.call_count, 0);
+	zassert_equal(ctxs[0].len, 2);
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+	zassert_true(K_TIMEOUT_EQ(k_work_reschedule_fake.arg1_val, NUS_FLUSH_RETRY_DELAY));
+
+	test_mutex_busy = false;
+	flush_work_handler(&ctxs[0].flush_work.work);
+	zassert_equal(ble_service_send_fake.call_count, 1);
+}
+
+ZTEST(nus_packetizer, test_stalled_link_reports_dropped_data)
+{
+	uint8_t data[50];
+
+	memset(data, 'z', sizeof(data));
+	ble_service_send_fake.custom_fake = NULL;
+	ble_service_send_fake.return_val = -EAGAIN;
+
+	/* First 20-byte chunk can't be sent; the rest has nowhere to go */
+	int err = nus_packetizer_write(&test_conn, data, sizeof(data));
+
+	zassert_equal(err, -EAGAIN);
+	zassert_equal(ctxs[0].len, 20);
+}
+
+ZTEST(nus_packetizer, test_flush_empty_is_noop)
+{
+	int err = nus_packetizer_flush(&test_conn);
+
+	zassert_equal(err, 0);
+	zassert_equal(ble_service_send_fake.call_count, 0);
+}
+
+ZTEST(nus_packetizer, test_write_waits_for_tx_window)
+{
+	nus_packetizer_write(&test_conn, (const uint8_t *)"OK\r\n", 4);
+
+	zassert_equal(ble_service_send_fake.arg0_val, &test_conn);
+	zassert_true(K_TIMEOUT_EQ(ble_service_send_fake.arg3_val, NUS_TX_TIMEOUT));
+}
+
+ZTEST(nus_packetizer, test_stalled_central_waits_only_once)
+{
+	uint8_t data[50];
+
+	memset(data, 'z', sizeof(data));
+	ble_service_send_fake.custom_fake = NULL;
+	ble_service_send_fake.return_val = -EAGAIN;
+
+	nus_packetizer_write(&test_conn, data, sizeof(data));
+	zassert_true(K_TIMEOUT_EQ(ble_service_send_fake.arg3_val, NUS_TX_TIMEOUT));
+
+	/* Still stalled: the next write doesn't wait again */
+	nus_packetizer_write(&test_conn, data, sizeof(data));
+	zassert_true(K_TIMEOUT_EQ(ble_service_send_fake.arg3_val, K_NO_WAIT));
+
+	/* Drained by the retry: waiting is allowed again */
+	ble_service_send_fake.custom_fake = ble_service_send_capture;
+	flush_work_handler(&ctxs[0].flush_work.work);
+	nus_packetizer_write(&test_conn, (const uint8_t *)"OK\r\n", 4);
+	zassert_true(K_TIMEOUT_EQ(ble_service_send_fake.arg3_val, NUS_TX_TIMEOUT));
+}
+
+ZTEST(nus_packetizer, test_full_window_on_flush_work_is_not_a_stall)
+{
+	uint8_t data[50];
+
+	memset(data, 'z', sizeof(data));
+	nus_packetizer_write(&test_conn, (const uint8_t *)"OK", 2);
+
+	/* Coalesce deadline while notifications are still in flight */
+	ble_service_send_fake.custom_fake = NULL;
+	ble_service_send_fake.return_val = -EAGAIN;
+	flush_work_handler(&ctxs[0].flush_work.work);
+	zassert_false(ctxs[0].stalled);
+
+	/* The next write still waits for the window and loses nothing */
+	ble_service_send_fake.custom_fake = ble_service_send_capture;
+	int err = nus_packetizer_write(&test_conn, data, sizeof(data));
+
+	zassert_equal(err, 0);
+	zassert_true(K_TIMEOUT_EQ(ble_service_send_fake.arg3_val, NUS_TX_TIMEOUT));
+	zassert_equal(sent_total + ctxs[0].len, 2 + sizeof(data));
+}
+
+ZTEST(nus_packetizer, test_full_window_on_broadcast_is_not_a_stall)
+{
+	test_conn2_connected = true;
+	ble_service_send_fake.custom_fake = ble_service_send_conn2_stalled;
+
+	nus_packetizer_broadcast((const uint8_t *)"DATA\r\n", 6);
+	zassert_false(ctxs[1].stalled);
+
+	/* A routed write to that central keeps its backpressure */
+	nus_packetizer_write(&test_conn2, (const uint8_t *)"OK\r\n", 4);
+	zassert_true(K_TIMEOUT_EQ(ble_service_send_fake.arg3_val, NUS_TX_TIMEOUT));
+}
+
+ZTEST(nus_packetizer, test_write_unauthenticated_fails)
+{
+	int err = nus_packetizer_write(&test_conn2, (const uint8_t *)"OK\r\n", 4);
+
+	zassert_equal(err, -ENOTCONN);
+	zassert_equal(ble_service_send_fake.call_count, 0);
+}
+
+ZTEST(nus_packetizer, test_connections_buffer_separately)
+{
+	test_conn2_connected = true;
+
+	nus_packetizer_write(&test_conn, (const uint8_t *)"OK 1", 4);
+	nus_packetizer_write(&test_conn2, (const uint8_t *)"OK 2", 4);
+
+	zassert_equal(ctxs[0].len, 4);
+	zassert_equal(ctxs[1].len, 4);
+
+	flush_work_handler(&ctxs[1].flush_work.work);
+
+	zassert_equal(ble_service_send_fake.call_count, 1);
+	zassert_equal(sent_conns[0], &test_conn2);
+	zassert_mem_equal(sent_data, "OK 2", 4);
+	zassert_equal(ctxs[0].len, 4);
+}
+
+ZTEST(nus_packetizer, test_broadcast_reaches_every_central)
+{
+	test_conn2_connected = true;
+
+	int err = nus_packetizer_broadcast((const uint8_t *)"DATA\r\n", 6);
+
+	zassert_equal(err, 0);
+	zassert_equal(ble_service_send_fake.call_count, 2);
+	zassert_equal(sent_conns[0], &test_conn);
+	zassert_equal(sent_conns[1], &test_conn2);
+	/* Nobody waits for anybody with two subscribers */
+	zassert_true(K_TIMEOUT_EQ(ble_service_send_fake.arg3_history[0], K_NO_WAIT));
+	zassert_true(K_TIMEOUT_EQ(ble_service_send_fake.arg3_history[1], K_NO_WAIT));
+}
+
+ZTEST(nus_packetizer, test_broadcast_single_central_keeps_backpressure)
+{
+	nus_packetizer_broadcast((const uint8_t *)"DATA\r\n", 6);
+
+	zassert_equal(ble_service_send_fake.call_count, 1);
+	zassert_true(K_TIMEOUT_EQ(ble_service_send_fake.arg3_val, NUS_TX_TIMEOUT));
+}
+
+ZTEST(nus_packetizer, test_broadcast_slow_central_does_not_stall_others)
+{
+	uint8_t data[50];
+
+	memset(data, 'b', sizeof(data));
+	test_conn2_connected = true;
+	ble_service_send_fake.custom_fake = ble_service_send_conn2_stalled;
+
+	int err = nus_packetizer_broadcast(data, sizeof(data));
+
+	/* test_conn got everything, test_conn2 keeps one chunk for retry */
+	zassert_equal(err, -EAGAIN);
+	zassert_equal(sent_total, 40);
+	zassert_equal(ctxs[0].len, 10);
+	zassert_equal(ctxs[1].len, 20);
+	zassert_equal(k_work_reschedule_fake.arg0_history[1], &ctxs[1].flush_work);
+}
+
+ZTEST_SUITE(nus_packetizer, NULL, NULL, NULL, NULL, NULL);
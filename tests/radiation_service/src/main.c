@@ -0,0 +1,585 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for radiation_service module.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/fff.h>
+#include <string.h>
+
+DEFINE_FFF_GLOBALS;
+
+/* Kconfig values */
+#define CONFIG_RADPRO_RAD_POLL_PERIOD_S 30
+#define CONFIG_RADPRO_RAD_CPM_THRESHOLD 100
+#define CONFIG_RADPRO_RAD_PULSES_THRESHOLD 1
+#define CONFIG_RADPRO_RAD_BATTERY_THRESHOLD_MV 20
+#define CONFIG_RADPRO_RAD_TIME_THRESHOLD_S 60
+#define CONFIG_RADPRO_HISTORY 1
+#define CONFIG_BT_MAX_CONN 2
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+#ifdef LOG_DBG
+#undef LOG_DBG
+#endif
+#define LOG_DBG(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+/* BT type stubs */
+#include "bt_mocks.h"
+
+#include "radpro/radpro_engine.h"
+#include "radpro/radpro_sampler.h"
+#include "radpro/radpro_history.h"
+
+/* FFF fakes — protocol engine and sampler */
+DECLARE_FAKE_VALUE_FUNC(int, radpro_engine_submit, const char *, size_t,
+			uint32_t, radpro_data_cb_t, radpro_done_cb_t, void *);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_engine_submit, const char *, size_t,
+		       uint32_t, radpro_data_cb_t, radpro_done_cb_t, void *);
+
+DECLARE_FAKE_VALUE_FUNC(int, radpro_sampler_add_listener, radpro_sample_cb_t);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_sampler_add_listener, radpro_sample_cb_t);
+
+/* FFF fakes — sample history */
+DECLARE_FAKE_VALUE_FUNC(uint32_t, radpro_history_period_s, uint8_t);
+DEFINE_FAKE_VALUE_FUNC(uint32_t, radpro_history_period_s, uint8_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, radpro_history_read, uint8_t, uint32_t *,
+			struct radpro_history_point *);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_history_read, uint8_t, uint32_t *,
+		       struct radpro_history_point *);
+
+/* FFF fakes — connections */
+DECLARE_FAKE_VALUE_FUNC(struct bt_conn *, bt_conn_ref, struct bt_conn *);
+DEFINE_FAKE_VALUE_FUNC(struct bt_conn *, bt_conn_ref, struct bt_conn *);
+
+DECLARE_FAKE_VOID_FUNC(bt_conn_unref, struct bt_conn *);
+DEFINE_FAKE_VOID_FUNC(bt_conn_unref, struct bt_conn *);
+
+DECLARE_FAKE_VALUE_FUNC(uint8_t, bt_conn_index, const struct bt_conn *);
+DEFINE_FAKE_VALUE_FUNC(uint8_t, bt_conn_index, const struct bt_conn *);
+
+DECLARE_FAKE_VALUE_FUNC(uint16_t, bt_gatt_get_mtu, struct bt_conn *);
+DEFINE_FAKE_VALUE_FUNC(uint16_t, bt_gatt_get_mtu, struct bt_conn *);
+
+/* FFF fakes — GATT */
+DECLARE_FAKE_VALUE_FUNC(int, bt_gatt_notify, struct bt_conn *,
+			const struct bt_gatt_attr *, const void *, uint16_t);
+DEFINE_FAKE_VALUE_FUNC(int, bt_gatt_notify, struct bt_conn *,
+		       const struct bt_gatt_attr *, const void *, uint16_t);
+
+DECLARE_FAKE_VALUE_FUNC(bool, bt_gatt_is_subscribed, struct bt_conn *,
+			const struct bt_gatt_attr *, uint16_t);
+DEFINE_FAKE_VALUE_FUNC(bool, bt_gatt_is_subscribed, struct bt_conn *,
+		       const struct bt_gatt_attr *, uint16_t);
+
+/* Notified payloads — the CUT passes a stack buffer */
+static uint8_t notify_data[4];
+static uint8_t notify_log[1024];
+static size_t notify_log_len;
+static int notify_budget;  /* Notifications before -ENOMEM, < 0 unlimited */
+
+static int test_bt_gatt_notify_custom(struct bt_conn *conn,
+				      const struct bt_gatt_attr *attr,
+				      const void *data, uint16_t len)
+{
+	if (notify_budget == 0) {
+		return -ENOMEM;
+	}
+	if (notify_budget > 0) {
+		notify_budget--;
+	}
+
+	memcpy(notify_data, data, MIN(len, sizeof(notify_data)));
+	zassert_true(notify_log_len + len <= sizeof(notify_log));
+	memcpy(&notify_log[notify_log_len], data, len);
+	notify_log_len += len;
+	return 0;
+}
+
+/* bt_gatt_attr_read copies the value as Zephyr does */
+static ssize_t bt_gatt_attr_read(struct bt_conn *conn,
+				 const struct bt_gatt_attr *attr, void *buf,
+				 uint16_t buf_len, uint16_t offset,
+				 const void *value, uint16_t value_len)
+{
+	uint16_t len;
+
+	if (offset > value_len) {
+		return -EINVAL;
+	}
+
+	len = MIN(buf_len, value_len - offset);
+	memcpy(buf, (const uint8_t *)value + offset, len);
+	return len;
+}
+
+/* FFF fakes — kernel work */
+DECLARE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+			k_work_handler_t);
+DEFINE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+		      k_work_handler_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+			k_timeout_t);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+		       k_timeout_t);
+
+/* k_uptime_get is static inline in kernel.h — override via macro redirect */
+static int64_t k_uptime_get_fake_return_val;
+static int64_t test_k_uptime_get(void)
+{
+	return k_uptime_get_fake_return_val;
+}
+#define k_uptime_get() test_k_uptime_get()
+
+/* k_mutex_lock/k_mutex_unlock are syscalls in kernel.h — use macro redirect */
+static int test_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+	return 0;
+}
+#define k_mutex_lock(mutex, timeout) test_k_mutex_lock(mutex, timeout)
+
+static int test_k_mutex_unlock(struct k_mutex *mutex)
+{
+	return 0;
+}
+#define k_mutex_unlock(mutex) test_k_mutex_unlock(mutex)
+
+/* Stub K_MUTEX_DEFINE — just declare the struct */
+#ifdef K_MUTEX_DEFINE
+#undef K_MUTEX_DEFINE
+#endif
+#define K_MUTEX_DEFINE(name) struct k_mutex name
+
+/* Stub ARG_UNUSED if not available */
+#ifndef ARG_UNUSED
+#define ARG_UNUSED(x) (void)(x)
+#endif
+
+/* Include CUT */
+#include "ble/radiation_service.c"
+
+static const struct bt_gatt_attr *value_attr(enum radiation_value id)
+{
+	return &rad_svc.attrs[RAD_VALUE_ATTR(id)];
+}
+
+typedef void (*ccc_changed_t)(const struct bt_gatt_attr *attr, uint16_t value);
+
+static void subscribe(enum radiation_value id)
+{
+	const struct bt_gatt_attr *ccc = &rad_svc.attrs[RAD_VALUE_ATTR(id) + 1];
+
+	((ccc_changed_t)ccc->user_data)(ccc, BT_GATT_CCC_NOTIFY);
+}
+
+/* Answer the poll request submitted for a value */
+static void answer(int call, const char *line)
+{
+	radpro_engine_submit_fake.arg3_history[call]((const uint8_t *)line,
+						     strlen(line), NULL);
+	radpro_engine_submit_fake.arg4_history[call](
+		0, radpro_engine_submit_fake.arg5_history[call]);
+}
+
+/* History stand-in: per tier, count intervals 10 periods apart */
+static int history_count[RADPRO_HISTORY_TIERS];
+static const uint32_t history_period[RADPRO_HISTORY_TIERS] = { 1, 60, 600 };
+
+static uint32_t radpro_history_period_s_custom(uint8_t tier)
+{
+	return history_period[tier];
+}
+
+static int radpro_history_read_custom(uint8_t tier, uint32_t *seq,
+				      struct radpro_history_point *point)
+{
+	if (*seq >= history_count[tier]) {
+		return -ENODATA;
+	}
+
+	point->start_s = 1000 * 60 - (history_count[tier] - *seq) * history_period[tier];
+	point->raw_count = 100 * tier + *seq;
+	point->cpm_min_x100 = 1000;
+	point->cpm_avg_x100 = 2000;
+	point->cpm_max_x100 = 3000;
+	(*seq)++;
+	return 0;
+}
+
+static struct bt_conn test_conn;
+
+static ssize_t subscribe_history(uint16_t value)
+{
+	const struct bt_gatt_attr *ccc = &rad_svc.attrs[RAD_HISTORY_ATTR + 1];
+	const struct bt_gatt_ccc_cbs *cbs = ccc->user_data;
+
+	return cbs->cfg_write(&test_conn, ccc, value);
+}
+
+/* --- FFF reset rule --- */
+static void fff_reset_rule_before(const struct ztest_unit_test *test,
+				  void *fixture)
+{
+	RESET_FAKE(radpro_engine_submit);
+	RESET_FAKE(radpro_sampler_add_listener);
+	RESET_FAKE(bt_gatt_notify);
+	RESET_FAKE(k_work_init_delayable);
+	RESET_FAKE(k_work_reschedule);
+	RESET_FAKE(radpro_history_period_s);
+	RESET_FAKE(radpro_history_read);
+	RESET_FAKE(bt_conn_ref);
+	RESET_FAKE(bt_conn_unref);
+	RESET_FAKE(bt_conn_index);
+	RESET_FAKE(bt_gatt_get_mtu);
+	RESET_FAKE(bt_gatt_is_subscribed);
+	FFF_RESET_HISTORY();
+
+	bt_gatt_notify_fake.custom_fake = test_bt_gatt_notify_custom;
+	memset(notify_data, 0, sizeof(notify_data));
+	notify_log_len = 0;
+	notify_budget = -1;
+
+	radpro_history_period_s_fake.custom_fake = radpro_history_period_s_custom;
+	radpro_history_read_fake.custom_fake = radpro_history_read_custom;
+	memset(history_count, 0, sizeof(history_count));
+	bt_conn_ref_fake.return_val = &test_conn;
+	bt_gatt_get_mtu_fake.return_val = 23;
+	k_uptime_get_fake_return_val = 1000 * 60 * 1000;
+	memset(bursts, 0, sizeof(bursts));
+
+	for (int id = 0; id < RADIATION_VALUE_COUNT; id++) {
+		values[id].valid = false;
+		values[id].notified_valid = false;
+		values[id].subscribed = false;
+	}
+	atomic_set(&poll_pending, 0);
+	resp_len = 0;
+
+	radiation_service_init();
+}
+
+ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
+
+/* --- Tests --- */
+
+ZTEST(radiation_service, test_init_subscribes_to_sampler)
+{
+	zassert_equal(radpro_sampler_add_listener_fake.call_count, 1);
+	zassert_equal(radpro_sampler_add_listener_fake.arg0_val, on_sample);
+}
+
+ZTEST(radiation_service, test_attribute_layout)
+{
+	zassert_equal(rad_svc.attr_count, 1 + 3 * RADIATION_VALUE_COUNT + 3,
+		      "Values, then history");
+
+	for (int id = 0; id < RADIATION_VALUE_COUNT; id++) {
+		zassert_equal(value_attr(id)->read, read_value);
+		zassert_equal(POINTER_TO_INT(value_attr(id)->user_data), id);
+	}
+}
+
+ZTEST(radiation_service, test_read_before_data_is_empty)
+{
+	uint8_t buf[4];
+	uint32_t value;
+
+	zassert_equal(read_value(NULL, value_attr(RADIATION_CPM), buf,
+				 sizeof(buf), 0), 0);
+	zassert_equal(radiation_service_get(RADIATION_CPM, &value), -ENODATA);
+}
+
+ZTEST(radiation_service, test_read_encodes_little_endian)
+{
+	uint8_t buf[4];
+
+	radiation_service_update(RADIATION_CPM, 0x01020304);
+	radiation_service_update(RADIATION_BATTERY, 3952);
+
+	zassert_equal(read_value(NULL, value_attr(RADIATION_CPM), buf,
+				 sizeof(buf), 0), 4);
+	zassert_equal(sys_get_le32(buf), 0x01020304);
+
+	zassert_equal(read_value(NULL, value_attr(RADIATION_BATTERY), buf,
+				 sizeof(buf), 0), 2, "Battery is a uint16");
+	zassert_equal(sys_get_le16(buf), 3952);
+}
+
+ZTEST(radiation_service, test_no_notify_without_subscriber)
+{
+	radiation_service_update(RADIATION_CPM, 5000);
+
+	zassert_equal(bt_gatt_notify_fake.call_count, 0);
+}
+
+ZTEST(radiation_service, test_notify_respects_threshold)
+{
+	subscribe(RADIATION_CPM);
+
+	radiation_service_update(RADIATION_CPM, 5000);
+	zassert_equal(bt_gatt_notify_fake.call_count, 1, "First value always sent");
+	zassert_equal(bt_gatt_notify_fake.arg1_val, value_attr(RADIATION_CPM));
+	zassert_equal(bt_gatt_notify_fake.arg3_val, 4);
+	zassert_equal(sys_get_le32(notify_data), 5000);
+
+	radiation_service_update(RADIATION_CPM, 5050);
+	radiation_service_update(RADIATION_CPM, 4950);
+	zassert_equal(bt_gatt_notify_fake.call_count, 1,
+		      "Change below threshold is not sent");
+
+	radiation_service_update(RADIATION_CPM, 4900);
+	zassert_equal(bt_gatt_notify_fake.call_count, 2);
+	zassert_equal(sys_get_le32(notify_data), 4900);
+}
+
+ZTEST(radiation_service, test_unchanged_value_not_notified)
+{
+	subscribe(RADIATION_PULSES);
+
+	radiation_service_update(RADIATION_PULSES, 42);
+	radiation_service_update(RADIATION_PULSES, 42);
+
+	zassert_equal(bt_gatt_notify_fake.call_count, 1);
+}
+
+ZTEST(radiation_service, test_sample_updates_cpm_and_pulses)
+{
+	struct radpro_sample sample = {
+		.raw_count = 1010,
+		.cpm_short_x100 = 60000,
+	};
+	uint32_t value;
+
+	on_sample(&sample);
+
+	zassert_equal(radiation_service_get(RADIATION_CPM, &value), 0);
+	zassert_equal(value, 60000);
+	zassert_equal(radiation_service_get(RADIATION_PULSES, &value), 0);
+	zassert_equal(value, 1010);
+}
+
+ZTEST(radiation_service, test_poll_parses_battery_and_time)
+{
+	uint32_t value;
+
+	radiation_service_start();
+	poll_work_handler(&poll_work.work);
+
+	zassert_equal(radpro_engine_submit_fake.call_count, 2);
+	zassert_mem_equal(radpro_engine_submit_fake.arg0_history[0],
+			  "GET deviceBatteryVoltage", 24);
+	zassert_mem_equal(radpro_engine_submit_fake.arg0_history[1],
+			  "GET deviceTime", 14);
+	zassert_true(K_TIMEOUT_EQ(k_work_reschedule_fake.arg1_val,
+				  K_SECONDS(CONFIG_RADPRO_RAD_POLL_PERIOD_S)));
+
+	answer(0, "OK 3.952\r\n");
+	answer(1, "OK 1700000000\r\n");
+
+	zassert_equal(radiation_service_get(RADIATION_BATTERY, &value), 0);
+	zassert_equal(value, 3952);
+	zassert_equal(radiation_service_get(RADIATION_TIME, &value), 0);
+	zassert_equal(value, 1700000000);
+}
+
+ZTEST(radiation_service, test_poll_skips_pending_request)
+{
+	poll_work_handler(&poll_work.work);
+	poll_work_handler(&poll_work.work);
+
+	zassert_equal(radpro_engine_submit_fake.call_count, 2,
+		      "Requests still pending");
+
+	answer(0, "OK 4.1\r\n");
+	poll_work_handler(&poll_work.work);
+
+	zassert_equal(radpro_engine_submit_fake.call_count, 3);
+	zassert_mem_equal(radpro_engine_submit_fake.arg0_history[2],
+			  "GET deviceBatteryVoltage", 24);
+}
+
+ZTEST(radiation_service, test_poll_error_leaves_value_unknown)
+{
+	uint32_t value;
+
+	poll_work_handler(&poll_work.work);
+	radpro_engine_submit_fake.arg3_history[0]((const uint8_t *)"ERROR\r\n",
+						  7, NULL);
+	radpro_engine_submit_fake.arg4_history[0](
+		-EIO, radpro_engine_submit_fake.arg5_history[0]);
+
+	zassert_equal(radiation_service_get(RADIATION_BATTERY, &value), -ENODATA);
+
+	/* Pending bit cleared: the next poll retries */
+	poll_work_handler(&poll_work.work);
+	zassert_equal(radpro_engine_submit_fake.call_count, 3);
+}
+
+ZTEST(radiation_service, test_history_sent_on_subscribe)
+{
+	history_count[RADPRO_HISTORY_SECOND] = 2;
+	history_count[RADPRO_HISTORY_10MIN] = 1;
+
+	zassert_equal(subscribe_history(BT_GATT_CCC_NOTIFY), sizeof(uint16_t));
+	zassert_equal(bt_conn_ref_fake.call_count, 1);
+	zassert_equal(k_work_reschedule_fake.arg0_val, &history_work);
+	zassert_equal(bt_gatt_notify_fake.call_count, 0, "Not from the BT RX thread");
+
+	history_work_handler(&history_work.work);
+
+	/* MTU 23: one point per notification, then the end marker */
+	zassert_equal(bt_gatt_notify_fake.call_count, 4);
+	zassert_equal(bt_gatt_notify_fake.arg0_val, &test_conn, "Only to the new subscriber");
+	zassert_equal(bt_gatt_notify_fake.arg1_val, &rad_svc.attrs[RAD_HISTORY_ATTR]);
+	zassert_equal(notify_log_len, 3 * RADIATION_HISTORY_POINT_SIZE + 1);
+
+	/* Oldest first, finest tier first */
+	zassert_equal(notify_log[0], RADPRO_HISTORY_SECOND);
+	zassert_equal(sys_get_le16(&notify_log[1]), 2);
+	zassert_equal(sys_get_le32(&notify_log[3]), 0);
+	zassert_equal(sys_get_le32(&notify_log[7]), 1000);
+	zassert_equal(sys_get_le32(&notify_log[11]), 2000);
+	zassert_equal(sys_get_le32(&notify_log[15]), 3000);
+	zassert_equal(sys_get_le16(&notify_log[19 + 1]), 1);
+	zassert_equal(notify_log[38], RADPRO_HISTORY_10MIN);
+	zassert_equal(sys_get_le16(&notify_log[38 + 1]), 1);
+	zassert_equal(sys_get_le32(&notify_log[38 + 3]), 200);
+	zassert_equal(notify_log[57], RADIATION_HISTORY_END);
+
+	zassert_is_null(bursts[0].conn);
+	zassert_equal(bt_conn_unref_fake.call_count, 2, "Work and burst references");
+}
+
+ZTEST(radiation_service, test_history_packs_points_into_mtu)
+{
+	history_count[RADPRO_HISTORY_MINUTE] = 20;
+	bt_gatt_get_mtu_fake.return_val = 247;
+
+	subscribe_history(BT_GATT_CCC_NOTIFY);
+	history_work_handler(&history_work.work);
+
+	/* 12 points fit 244 bytes */
+	zassert_equal(bt_gatt_notify_fake.call_count, 3);
+	zassert_equal(bt_gatt_notify_fake.arg3_history[0], 12 * RADIATION_HISTORY_POINT_SIZE);
+	zassert_equal(bt_gatt_notify_fake.arg3_history[1], 8 * RADIATION_HISTORY_POINT_SIZE);
+	zassert_equal(bt_gatt_notify_fake.arg3_history[2], 1);
+}
+
+ZTEST(radiation_service, test_history_resumes_when_out_of_buffers)
+{
+	history_count[RADPRO_HISTORY_SECOND] = 3;
+	notify_budget = 2;
+
+	subscribe_history(BT_GATT_CCC_NOTIFY);
+	history_work_handler(&history_work.work);
+
+	zassert_equal(notify_log_len, 2 * RADIATION_HISTORY_POINT_SIZE);
+	zassert_true(K_TIMEOUT_EQ(k_work_reschedule_fake.arg1_val, RAD_HISTORY_RETRY_DELAY));
+	zassert_not_null(bursts[0].conn);
+
+	notify_budget = -1;
+	history_work_handler(&history_work.work);
+
+	zassert_equal(notify_log_len, 3 * RADIATION_HISTORY_POINT_SIZE + 1);
+	zassert_equal(sys_get_le32(&notify_log[2 * RADIATION_HISTORY_POINT_SIZE + 3]), 2,
+		      "Continues after the last point sent");
+	zassert_is_null(bursts[0].conn);
+}
+
+ZTEST(radiation_service, test_history_empty_sends_end_only)
+{
+	subscribe_history(BT_GATT_CCC_NOTIFY);
+	history_work_handler(&history_work.work);
+
+	zassert_equal(bt_gatt_notify_fake.call_count, 1);
+	zassert_equal(notify_log_len, 1);
+	zassert_equal(notify_log[0], RADIATION_HISTORY_END);
+}
+
+ZTEST(radiation_service, test_history_unsubscribe_cancels_burst)
+{
+	history_count[RADPRO_HISTORY_SECOND] = 3;
+
+	subscribe_history(BT_GATT_CCC_NOTIFY);
+	subscribe_history(0);
+	history_work_handler(&history_work.work);
+
+	zassert_equal(bt_gatt_notify_fake.call_count, 0);
+	zassert_equal(bt_conn_unref_fake.call_count, 1);
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+}
+
+ZTEST(radiation_service, test_history_dropped_on_disconnect)
+{
+	history_count[RADPRO_HISTORY_SECOND] = 3;
+	bt_gatt_notify_fake.custom_fake = NULL;
+	bt_gatt_notify_fake.return_val = -ENOTCONN;
+
+	subscribe_history(BT_GATT_CCC_NOTIFY);
+	history_work_handler(&history_work.work);
+
+	zassert_equal(bt_gatt_notify_fake.call_count, 1);
+	zassert_is_null(bursts[0].conn);
+	zassert_equal(k_work_reschedule_fake.call_count, 1, "No retry");
+}
+
+ZTEST(radiation_service, test_history_sent_on_bonded_reconnect)
+{
+	history_count[RADPRO_HISTORY_SECOND] = 1;
+
+	/* Subscription restored from the bond, no CCC write */
+	bt_gatt_is_subscribed_fake.return_val = true;
+	security_changed(&test_conn, BT_SECURITY_L2, BT_SECURITY_ERR_SUCCESS);
+
+	zassert_equal(bt_gatt_is_subscribed_fake.arg1_val, &rad_svc.attrs[RAD_HISTORY_ATTR]);
+	zassert_equal(bt_conn_ref_fake.call_count, 1);
+	zassert_equal(k_work_reschedule_fake.arg0_val, &history_work);
+
+	/* A level change while the burst is queued does not restart it */
+	security_changed(&test_conn, BT_SECURITY_L4, BT_SECURITY_ERR_SUCCESS);
+	zassert_equal(bt_conn_ref_fake.call_count, 1);
+
+	history_work_handler(&history_work.work);
+	zassert_equal(notify_log_len, RADIATION_HISTORY_POINT_SIZE + 1);
+}
+
+ZTEST(radiation_service, test_history_not_sent_on_reconnect_without_subscription)
+{
+	history_count[RADPRO_HISTORY_SECOND] = 1;
+
+	security_changed(&test_conn, BT_SECURITY_L2, BT_SECURITY_ERR_SUCCESS);
+
+	bt_gatt_is_subscribed_fake.return_val = true;
+	security_changed(&test_conn, BT_SECURITY_L2, BT_SECURITY_ERR_AUTH_FAIL);
+
+	zassert_equal(bt_conn_ref_fake.call_count, 0);
+	zassert_equal(k_work_reschedule_fake.call_count, 0);
+}
+
+ZTEST_SUITE(radiation_service, NULL, NULL, NULL, NULL, NULL);
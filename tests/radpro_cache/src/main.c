@@ -0,0 +1,287 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for radpro_cache module.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/fff.h>
+#include <string.h>
+
+DEFINE_FFF_GLOBALS;
+
+/* Kconfig values */
+#define CONFIG_RADPRO_RESPONSE_CACHE_TTL_S 600
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+#ifdef LOG_DBG
+#undef LOG_DBG
+#endif
+#define LOG_DBG(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+#include "radpro/radpro_engine.h"
+
+/* FFF fakes — protocol engine */
+DECLARE_FAKE_VALUE_FUNC(int, radpro_engine_submit, const char *, size_t,
+			uint32_t, radpro_data_cb_t, radpro_done_cb_t, void *);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_engine_submit, const char *, size_t,
+		       uint32_t, radpro_data_cb_t, radpro_done_cb_t, void *);
+
+/* k_uptime_get is static inline in kernel.h — override via macro redirect */
+static int64_t k_uptime_get_fake_return_val;
+static int64_t test_k_uptime_get(void)
+{
+	return k_uptime_get_fake_return_val;
+}
+#define k_uptime_get() test_k_uptime_get()
+
+/* k_mutex_lock/k_mutex_unlock are syscalls in kernel.h — use macro redirect */
+static int test_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+	return 0;
+}
+#define k_mutex_lock(mutex, timeout) test_k_mutex_lock(mutex, timeout)
+
+static int test_k_mutex_unlock(struct k_mutex *mutex)
+{
+	return 0;
+}
+#define k_mutex_unlock(mutex) test_k_mutex_unlock(mutex)
+
+/* Stub K_MUTEX_DEFINE — just declare the struct */
+#ifdef K_MUTEX_DEFINE
+#undef K_MUTEX_DEFINE
+#endif
+#define K_MUTEX_DEFINE(name) struct k_mutex name
+
+/* Include CUT */
+#include "radpro/radpro_cache.c"
+
+/* Submitted prefetch commands, NUL-terminated */
+#define MAX_SUBMITS 8
+static char submitted[MAX_SUBMITS][RADPRO_CMD_MAX_LEN + 1];
+static radpro_data_cb_t submitted_data_cb[MAX_SUBMITS];
+static radpro_done_cb_t submitted_done_cb[MAX_SUBMITS];
+static void *submitted_user_data[MAX_SUBMITS];
+static int submit_count;
+
+static int radpro_engine_submit_capture(const char *cmd, size_t len,
+					uint32_t timeout_ms,
+					radpro_data_cb_t data_cb,
+					radpro_done_cb_t done_cb, void *user_data)
+{
+	if (submit_count < MAX_SUBMITS) {
+		memcpy(submitted[submit_count], cmd, len);
+		submitted[submit_count][len] = '\0';
+		submitted_data_cb[submit_count] = data_cb;
+		submitted_done_cb[submit_count] = done_cb;
+		submitted_user_data[submit_count] = user_data;
+	}
+	submit_count++;
+	return 0;
+}
+
+static uint8_t buf[RADPRO_CACHE_RESP_MAX];
+
+/* Run a command through track/fill/complete as a client would */
+static void pass_through(const char *cmd, const char *response, int status)
+{
+	int ticket = radpro_cache_track(cmd, strlen(cmd));
+
+	radpro_cache_fill(ticket, (const uint8_t *)response, strlen(response));
+	radpro_cache_complete(ticket, status);
+}
+
+static int lookup(const char *cmd)
+{
+	return radpro_cache_lookup(cmd, strlen(cmd), buf, sizeof(buf));
+}
+
+/* --- FFF reset rule --- */
+static void fff_reset_rule_before(const struct ztest_unit_test *test,
+				  void *fixture)
+{
+	RESET_FAKE(radpro_engine_submit);
+	FFF_RESET_HISTORY();
+
+	radpro_engine_submit_fake.custom_fake = radpro_engine_submit_capture;
+	memset(submitted, 0, sizeof(submitted));
+	submit_count = 0;
+	memset(buf, 0, sizeof(buf));
+	k_uptime_get_fake_return_val = 1000;
+
+	radpro_cache_init();
+}
+
+ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
+
+/* --- Tests --- */
+
+ZTEST(radpro_cache, test_empty_cache_misses)
+{
+	zassert_equal(lookup("GET deviceId"), -ENOENT);
+}
+
+ZTEST(radpro_cache, test_response_cached_after_first_query)
+{
+	pass_through("GET deviceId", "OK Bosean FS-600;Rad Pro 2.0/en;1234\r\n", 0);
+
+	zassert_equal(lookup("GET deviceId"), 38);
+	zassert_mem_equal(buf, "OK Bosean FS-600;Rad Pro 2.0/en;1234\r\n", 38);
+
+	/* Terminator on the command does not matter */
+	zassert_equal(lookup("GET deviceId\r\n"), 38);
+}
+
+ZTEST(radpro_cache, test_split_response_cached)
+{
+	int ticket = radpro_cache_track("GET tubeSensitivity", 19);
+
+	radpro_cache_fill(ticket, (const uint8_t *)"OK 153", 6);
+	radpro_cache_fill(ticket, (const uint8_t *)".800\r\n", 6);
+	radpro_cache_complete(ticket, 0);
+
+	zassert_equal(lookup("GET tubeSensitivity"), 12);
+	zassert_mem_equal(buf, "OK 153.800\r\n", 12);
+}
+
+ZTEST(radpro_cache, test_error_response_not_cached)
+{
+	pass_through("GET tubeType", "ERROR\r\n", -EIO);
+
+	zassert_equal(lookup("GET tubeType"), -ENOENT);
+}
+
+ZTEST(radpro_cache, test_uncacheable_commands)
+{
+	zassert_equal(radpro_cache_track("GET tubeRate", 12), -ENOENT);
+	zassert_equal(radpro_cache_track("GET deviceIdX", 13), -ENOENT);
+	zassert_equal(radpro_cache_track("RESET datalog", 13), -ENOENT);
+
+	pass_through("GET tubeRate", "OK 10.0\r\n", 0);
+	zassert_equal(lookup("GET tubeRate"), -ENOENT);
+}
+
+ZTEST(radpro_cache, test_keys_sharing_a_prefix_are_distinct)
+{
+	pass_through("GET tubeDeadTime", "OK 0.0000325\r\n", 0);
+
+	zassert_equal(lookup("GET tubeDeadTimeCompensation"), -ENOENT);
+	zassert_equal(lookup("GET tubeDeadTime"), 14);
+}
+
+ZTEST(radpro_cache, test_set_invalidates_entry)
+{
+	pass_through("GET tubeDeadTimeCompensation", "OK 0.0000000\r\n", 0);
+	zassert_true(lookup("GET tubeDeadTimeCompensation") > 0);
+
+	zassert_equal(radpro_cache_track("SET tubeDeadTimeCompensation 0.00002\r\n", 38),
+		      -ENOENT);
+
+	zassert_equal(lookup("GET tubeDeadTimeCompensation"), -ENOENT);
+}
+
+ZTEST(radpro_cache, test_unrelated_set_keeps_entries)
+{
+	pass_through("GET tubeType", "OK M4011\r\n", 0);
+
+	radpro_cache_track("SET deviceTime 1690000300", 25);
+	radpro_cache_track("SET tubeTypeX 1", 15);
+
+	zassert_equal(lookup("GET tubeType"), 10);
+}
+
+ZTEST(radpro_cache, test_reply_overtaken_by_set_not_cached)
+{
+	int ticket = radpro_cache_track("GET tubeSensitivity", 19);
+
+	/* SET queued behind the GET; the GET's reply is already stale */
+	radpro_cache_track("SET tubeSensitivity 200", 23);
+
+	radpro_cache_fill(ticket, (const uint8_t *)"OK 153.800\r\n", 12);
+	radpro_cache_complete(ticket, 0);
+
+	zassert_equal(lookup("GET tubeSensitivity"), -ENOENT);
+}
+
+ZTEST(radpro_cache, test_oversized_response_not_cached)
+{
+	char response[RADPRO_CACHE_RESP_MAX + 8];
+
+	memset(response, 'x', sizeof(response) - 1);
+	memcpy(response, "OK ", 3);
+	response[sizeof(response) - 1] = '\0';
+
+	pass_through("GET deviceId", response, 0);
+
+	zassert_equal(lookup("GET deviceId"), -ENOENT);
+}
+
+ZTEST(radpro_cache, test_entry_expires)
+{
+	pass_through("GET tubeDeadTime", "OK 0.0000325\r\n", 0);
+
+	k_uptime_get_fake_return_val += CONFIG_RADPRO_RESPONSE_CACHE_TTL_S * 1000 - 1;
+	zassert_equal(lookup("GET tubeDeadTime"), 14);
+
+	k_uptime_get_fake_return_val += 1;
+	zassert_equal(lookup("GET tubeDeadTime"), -ENOENT);
+}
+
+ZTEST(radpro_cache, test_prefetch_queues_empty_entries)
+{
+	pass_through("GET tubeType", "OK M4011\r\n", 0);
+
+	zassert_equal(radpro_cache_prefetch(), 0);
+
+	zassert_equal(submit_count, 4);
+	zassert_str_equal(submitted[0], "GET deviceId");
+	zassert_str_equal(submitted[1], "GET tubeSensitivity");
+	zassert_str_equal(submitted[2], "GET tubeDeadTime");
+	zassert_str_equal(submitted[3], "GET tubeDeadTimeCompensation");
+}
+
+ZTEST(radpro_cache, test_prefetch_response_fills_entry)
+{
+	radpro_cache_prefetch();
+
+	submitted_data_cb[0]((const uint8_t *)"OK 1\r\n", 6, submitted_user_data[0]);
+	submitted_done_cb[0](0, submitted_user_data[0]);
+
+	zassert_equal(lookup("GET deviceId"), 6);
+	zassert_mem_equal(buf, "OK 1\r\n", 6);
+}
+
+ZTEST(radpro_cache, test_prefetch_submit_failure)
+{
+	radpro_engine_submit_fake.custom_fake = NULL;
+	radpro_engine_submit_fake.return_val = -ENOSPC;
+
+	zassert_equal(radpro_cache_prefetch(), -ENOSPC);
+	zassert_equal(radpro_engine_submit_fake.call_count, 1);
+}
+
+ZTEST_SUITE(radpro_cache, NULL, NULL, NULL, NULL, NULL);
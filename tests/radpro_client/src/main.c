@@ -0,0 +1,879 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for radpro_client module.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/fff.h>
+#include <string.h>
+
+DEFINE_FFF_GLOBALS;
+
+/* Kconfig values */
+#define CONFIG_RADPRO_RESPONSE_CACHE 1
+#define CONFIG_RADPRO_DATALOG_BINARY 1
+#define CONFIG_RADPRO_DATALOG_SYNC 1
+#define CONFIG_RADPRO_DATALOG_MIRROR 1
+#define CONFIG_BT_MAX_CONN 2
+#define CONFIG_BT_MAX_PAIRED 2
+
+/* BT type stubs — block real BT headers */
+#include "bt_mocks.h"
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+#ifdef LOG_DBG
+#undef LOG_DBG
+#endif
+#define LOG_DBG(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+#include "radpro/radpro_engine.h"
+#include "radpro/radpro_cache.h"
+#include "radpro/radpro_datalog.h"
+#include "radpro/radpro_sync.h"
+#include "radpro/radpro_mirror.h"
+
+/* FFF fakes — protocol engine */
+DECLARE_FAKE_VALUE_FUNC(int, radpro_engine_submit_timed, const char *, size_t,
+			uint32_t, radpro_data_cb_t, radpro_done_cb_t, void *);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_engine_submit_timed, const char *, size_t,
+		       uint32_t, radpro_data_cb_t, radpro_done_cb_t, void *);
+
+/* FFF fakes — response cache */
+DECLARE_FAKE_VALUE_FUNC(int, radpro_cache_lookup, const char *, size_t,
+			uint8_t *, size_t);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_cache_lookup, const char *, size_t,
+		       uint8_t *, size_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, radpro_cache_track, const char *, size_t);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_cache_track, const char *, size_t);
+
+DECLARE_FAKE_VOID_FUNC(radpro_cache_fill, int, const uint8_t *, size_t);
+DEFINE_FAKE_VOID_FUNC(radpro_cache_fill, int, const uint8_t *, size_t);
+
+DECLARE_FAKE_VOID_FUNC(radpro_cache_complete, int, int);
+DEFINE_FAKE_VOID_FUNC(radpro_cache_complete, int, int);
+
+/* FFF fakes — datalog encoder */
+DECLARE_FAKE_VOID_FUNC(radpro_datalog_enc_init, struct radpro_datalog_enc *);
+DEFINE_FAKE_VOID_FUNC(radpro_datalog_enc_init, struct radpro_datalog_enc *);
+
+DECLARE_FAKE_VOID_FUNC(radpro_datalog_enc_feed, struct radpro_datalog_enc *,
+		       const uint8_t *, size_t, radpro_data_cb_t, void *);
+DEFINE_FAKE_VOID_FUNC(radpro_datalog_enc_feed, struct radpro_datalog_enc *,
+		      const uint8_t *, size_t, radpro_data_cb_t, void *);
+
+DECLARE_FAKE_VALUE_FUNC(bool, radpro_datalog_enc_finish, struct radpro_datalog_enc *,
+			int, radpro_data_cb_t, void *);
+DEFINE_FAKE_VALUE_FUNC(bool, radpro_datalog_enc_finish, struct radpro_datalog_enc *,
+		       int, radpro_data_cb_t, void *);
+
+DECLARE_FAKE_VALUE_FUNC(uint32_t, radpro_datalog_enc_last_time,
+			const struct radpro_datalog_enc *);
+DEFINE_FAKE_VALUE_FUNC(uint32_t, radpro_datalog_enc_last_time,
+		       const struct radpro_datalog_enc *);
+
+/* FFF fakes — sync cursors */
+DECLARE_FAKE_VALUE_FUNC(uint32_t, radpro_sync_get, const bt_addr_le_t *);
+DEFINE_FAKE_VALUE_FUNC(uint32_t, radpro_sync_get, const bt_addr_le_t *);
+
+DECLARE_FAKE_VALUE_FUNC(int, radpro_sync_set, const bt_addr_le_t *, uint32_t);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_sync_set, const bt_addr_le_t *, uint32_t);
+
+/* FFF fakes — datalog mirror */
+DECLARE_FAKE_VALUE_FUNC(bool, radpro_mirror_covers, const char *, size_t);
+DEFINE_FAKE_VALUE_FUNC(bool, radpro_mirror_covers, const char *, size_t);
+
+DECLARE_FAKE_VOID_FUNC(radpro_mirror_refresh);
+DEFINE_FAKE_VOID_FUNC(radpro_mirror_refresh);
+
+DECLARE_FAKE_VALUE_FUNC(int, radpro_mirror_serve, const char *, size_t,
+			radpro_data_cb_t, void *);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_mirror_serve, const char *, size_t,
+		       radpro_data_cb_t, void *);
+
+DECLARE_FAKE_VALUE_FUNC(int, radpro_mirror_clear);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_mirror_clear);
+
+DECLARE_FAKE_VALUE_FUNC(int, radpro_engine_submit_local, const char *, size_t,
+			radpro_local_cb_t, radpro_data_cb_t, radpro_done_cb_t, void *);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_engine_submit_local, const char *, size_t,
+		       radpro_local_cb_t, radpro_data_cb_t, radpro_done_cb_t, void *);
+
+/* Stub ARG_UNUSED if not available */
+#ifndef ARG_UNUSED
+#define ARG_UNUSED(x) (void)(x)
+#endif
+
+/* Include CUT */
+#include "radpro/radpro_client.c"
+
+/* Submitted command lines, NUL-terminated */
+#define MAX_SUBMITS 4
+static char submitted[MAX_SUBMITS][RADPRO_CMD_MAX_LEN + 1];
+static int submit_count;
+
+/* Bytes sent back to the client */
+static char output[128];
+static size_t output_len;
+static uint8_t output_client;
+static int output_other_count;
+
+static int radpro_engine_submit_timed_capture(const char *cmd, size_t len,
+					      uint32_t timeout_ms,
+					      radpro_data_cb_t data_cb,
+					      radpro_done_cb_t done_cb, void *user_data)
+{
+	if (submit_count < MAX_SUBMITS) {
+		memcpy(submitted[submit_count], cmd, len);
+		submitted[submit_count][len] = '\0';
+	}
+	submit_count++;
+	return 0;
+}
+
+/* Client 0 is the one under test, output to others is only counted */
+static void test_output(uint8_t client, const uint8_t *data, uint16_t len)
+{
+	if (client != output_client) {
+		output_other_count++;
+		return;
+	}
+
+	memcpy(&output[output_len], data, len);
+	output_len += len;
+}
+
+static void client_write(const char *text)
+{
+	radpro_client_rx(output_client, (const uint8_t *)text, strlen(text));
+}
+
+static void engine_reply(const char *text)
+{
+	radpro_engine_submit_timed_fake.arg3_val((const uint8_t *)text, strlen(text),
+						 radpro_engine_submit_timed_fake.arg5_val);
+}
+
+static void engine_done(int status)
+{
+	radpro_engine_submit_timed_fake.arg4_val(status,
+						 radpro_engine_submit_timed_fake.arg5_val);
+}
+
+/* Answer the last locally submitted command, as the engine's work queue would */
+static void engine_run_local(void)
+{
+	void *tag = radpro_engine_submit_local_fake.arg5_val;
+	int status = radpro_engine_submit_local_fake.arg2_val(
+		radpro_engine_submit_local_fake.arg0_val, radpro_engine_submit_local_fake.arg1_val,
+		radpro_engine_submit_local_fake.arg3_val, tag);
+
+	radpro_engine_submit_local_fake.arg4_val(status, tag);
+}
+
+/* Encoder stand-in: every response byte becomes "#" */
+static void radpro_datalog_enc_feed_hash(struct radpro_datalog_enc *enc,
+					 const uint8_t *data, size_t len,
+					 radpro_data_cb_t out, void *user_data)
+{
+	for (size_t i = 0; i < len; i++) {
+		out((const uint8_t *)"#", 1, user_data);
+	}
+}
+
+static bool radpro_datalog_enc_finish_end(struct radpro_datalog_enc *enc, int status,
+					  radpro_data_cb_t out, void *user_data)
+{
+	out((const uint8_t *)"$\r\n", 3, user_data);
+	return true;
+}
+
+/* Client 0 is bonded, others are not */
+static const bt_addr_le_t bonded_peer = { .type = 1, .a.val = { 1, 2, 3, 4, 5, 6 } };
+
+static const bt_addr_le_t *test_peer(uint8_t client)
+{
+	return client == 0 ? &bonded_peer : NULL;
+}
+
+/* --- FFF reset rule --- */
+static void fff_reset_rule_before(const struct ztest_unit_test *test,
+				  void *fixture)
+{
+	RESET_FAKE(radpro_engine_submit_timed);
+	RESET_FAKE(radpro_cache_lookup);
+	RESET_FAKE(radpro_cache_track);
+	RESET_FAKE(radpro_cache_fill);
+	RESET_FAKE(radpro_cache_complete);
+	RESET_FAKE(radpro_datalog_enc_init);
+	RESET_FAKE(radpro_datalog_enc_feed);
+	RESET_FAKE(radpro_datalog_enc_finish);
+	RESET_FAKE(radpro_datalog_enc_last_time);
+	RESET_FAKE(radpro_sync_get);
+	RESET_FAKE(radpro_sync_set);
+	RESET_FAKE(radpro_mirror_covers);
+	RESET_FAKE(radpro_mirror_refresh);
+	RESET_FAKE(radpro_mirror_serve);
+	RESET_FAKE(radpro_mirror_clear);
+	RESET_FAKE(radpro_engine_submit_local);
+	FFF_RESET_HISTORY();
+
+	radpro_engine_submit_timed_fake.custom_fake = radpro_engine_submit_timed_capture;
+	radpro_cache_lookup_fake.return_val = -ENOENT;
+	radpro_cache_track_fake.return_val = -ENOENT;
+	memset(submitted, 0, sizeof(submitted));
+	submit_count = 0;
+	memset(output, 0, sizeof(output));
+	output_len = 0;
+	output_client = 0;
+	output_other_count = 0;
+
+	radpro_client_init(test_output);
+	radpro_client_set_peer_cb(test_peer);
+}
+
+ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
+
+/* --- Tests --- */
+
+ZTEST(radpro_client, test_crlf_line_submitted_once)
+{
+	client_write("GET deviceId\r\n");
+
+	zassert_equal(submit_count, 1);
+	zassert_str_equal(submitted[0], "GET deviceId");
+	zassert_equal(radpro_engine_submit_timed_fake.arg2_val, RADPRO_CLIENT_TIMEOUT_MS);
+}
+
+ZTEST(radpro_client, test_bare_terminators)
+{
+	client_write("GET tubeRate\rGET tubePulseCount\n");
+
+	zassert_equal(submit_count, 2);
+	zassert_str_equal(submitted[0], "GET tubeRate");
+	zassert_str_equal(submitted[1], "GET tubePulseCount");
+}
+
+ZTEST(radpro_client, test_line_split_across_writes)
+{
+	client_write("GET dev");
+	zassert_equal(submit_count, 0);
+
+	client_write("iceTime\r");
+	client_write("\n");
+
+	zassert_equal(submit_count, 1);
+	zassert_str_equal(submitted[0], "GET deviceTime");
+}
+
+ZTEST(radpro_client, test_oversized_line_replies_error)
+{
+	char line[RADPRO_CMD_MAX_LEN + 8];
+
+	memset(line, 'A', sizeof(line) - 2);
+	line[sizeof(line) - 2] = '\n';
+	line[sizeof(line) - 1] = '\0';
+
+	client_write(line);
+
+	zassert_equal(submit_count, 0);
+	zassert_equal(output_len, 7);
+	zassert_mem_equal(output, "ERROR\r\n", 7);
+
+	/* Next line is unaffected */
+	client_write("GET tubeRate\n");
+	zassert_equal(submit_count, 1);
+	zassert_str_equal(submitted[0], "GET tubeRate");
+}
+
+ZTEST(radpro_client, test_submit_failure_replies_error)
+{
+	radpro_engine_submit_timed_fake.custom_fake = NULL;
+	radpro_engine_submit_timed_fake.return_val = -ENOSPC;
+
+	client_write("GET tubeRate\r\n");
+
+	zassert_equal(output_len, 7);
+	zassert_mem_equal(output, "ERROR\r\n", 7);
+}
+
+ZTEST(radpro_client, test_response_forwarded_verbatim)
+{
+	client_write("GET tubeRate\r\n");
+
+	engine_reply("OK 14");
+	engine_reply("2.857\r\n");
+	engine_done(0);
+
+	zassert_equal(output_len, 12);
+	zassert_mem_equal(output, "OK 142.857\r\n", 12);
+}
+
+ZTEST(radpro_client, test_error_response_not_duplicated)
+{
+	client_write("SET deviceTime x\r\n");
+
+	engine_reply("ERROR\r\n");
+	engine_done(-EIO);
+
+	zassert_equal(output_len, 7);
+	zassert_mem_equal(output, "ERROR\r\n", 7);
+}
+
+ZTEST(radpro_client, test_timeout_without_reply_sends_error)
+{
+	client_write("GET tubeRate\r\n");
+
+	engine_done(-ETIMEDOUT);
+
+	zassert_equal(output_len, 7);
+	zassert_mem_equal(output, "ERROR\r\n", 7);
+}
+
+ZTEST(radpro_client, test_timeout_mid_reply_terminates_line)
+{
+	client_write("GET datalog\r\n");
+
+	engine_reply("OK time,tubePulseCount;1690000000,");
+	engine_done(-ETIMEDOUT);
+
+	zassert_equal(output_len, 36);
+	zassert_mem_equal(&output[output_len - 2], "\r\n", 2);
+
+	/* Next timeout starts a fresh reply */
+	output_len = 0;
+	client_write("GET tubeRate\r\n");
+	engine_done(-ETIMEDOUT);
+	zassert_mem_equal(output, "ERROR\r\n", 7);
+}
+
+static int radpro_cache_lookup_hit(const char *cmd, size_t len, uint8_t *buf,
+				   size_t size)
+{
+	memcpy(buf, "OK M4011\r\n", 10);
+	return 10;
+}
+
+ZTEST(radpro_client, test_cache_hit_answered_locally)
+{
+	radpro_cache_lookup_fake.custom_fake = radpro_cache_lookup_hit;
+
+	client_write("GET tubeType\r\n");
+
+	zassert_equal(submit_count, 0, "Cache hit must not reach the UART");
+	zassert_equal(radpro_engine_submit_local_fake.call_count, 1);
+	zassert_equal(radpro_engine_submit_local_fake.arg2_val, cache_serve);
+	zassert_equal(output_len, 0, "Not sent from the BLE RX thread");
+
+	engine_run_local();
+
+	zassert_equal(output_len, 10);
+	zassert_mem_equal(output, "OK M4011\r\n", 10);
+	zassert_equal(atomic_get(&clients[0].outstanding), 0);
+}
+
+ZTEST(radpro_client, test_cache_hit_does_not_overtake_pending_reply)
+{
+	client_write("GET tubeRate\r\n");
+
+	radpro_cache_lookup_fake.custom_fake = radpro_cache_lookup_hit;
+	client_write("GET tubeType\r\n");
+
+	/* Still queued behind the outstanding command */
+	zassert_equal(submit_count, 2);
+	zassert_equal(output_len, 0);
+
+	engine_reply("OK 10.0\r\n");
+	engine_done(0);
+	engine_reply("OK M4011\r\n");
+	engine_done(0);
+
+	/* Both answered, so the next hit is served locally again */
+	output_len = 0;
+	client_write("GET tubeType\r\n");
+	engine_run_local();
+	zassert_equal(submit_count, 2);
+	zassert_equal(output_len, 10);
+}
+
+ZTEST(radpro_client, test_cache_hit_queue_full_replies_error)
+{
+	radpro_cache_lookup_fake.custom_fake = radpro_cache_lookup_hit;
+	radpro_engine_submit_local_fake.return_val = -ENOSPC;
+
+	client_write("GET tubeType\r\n");
+
+	zassert_mem_equal(output, "ERROR\r\n", 7);
+	zassert_equal(atomic_get(&clients[0].outstanding), 0);
+}
+
+ZTEST(radpro_client, test_cache_filled_from_reply)
+{
+	radpro_cache_track_fake.return_val = 3;
+
+	client_write("GET tubeSensitivity\r\n");
+
+	zassert_equal(TAG_TICKET(radpro_engine_submit_timed_fake.arg5_val), 3);
+
+	engine_reply("OK 153.800\r\n");
+	engine_done(0);
+
+	zassert_equal(radpro_cache_fill_fake.call_count, 1);
+	zassert_equal(radpro_cache_fill_fake.arg0_val, 3);
+	zassert_equal(radpro_cache_fill_fake.arg2_val, 12);
+	zassert_equal(radpro_cache_complete_fake.call_count, 1);
+	zassert_equal(radpro_cache_complete_fake.arg0_val, 3);
+	zassert_equal(radpro_cache_complete_fake.arg1_val, 0);
+}
+
+ZTEST(radpro_client, test_rejected_submit_not_outstanding)
+{
+	radpro_engine_submit_timed_fake.custom_fake = NULL;
+	radpro_engine_submit_timed_fake.return_val = -ENOSPC;
+	client_write("GET tubeRate\r\n");
+
+	radpro_cache_lookup_fake.custom_fake = radpro_cache_lookup_hit;
+	output_len = 0;
+	client_write("GET tubeType\r\n");
+	engine_run_local();
+
+	zassert_equal(output_len, 10);
+	zassert_mem_equal(output, "OK M4011\r\n", 10);
+}
+
+ZTEST(radpro_client, test_tag_round_trips)
+{
+	void *tag = CLIENT_TAG(1, 0xfe, -ENOENT);
+
+	zassert_equal(TAG_CLIENT(tag), 1);
+	zassert_equal(TAG_GEN(tag), 0xfe);
+	zassert_equal(TAG_TICKET(tag), -ENOENT);
+
+	tag = CLIENT_TAG(0, 3, 7);
+	zassert_equal(TAG_CLIENT(tag), 0);
+	zassert_equal(TAG_GEN(tag), 3);
+	zassert_equal(TAG_TICKET(tag), 7);
+}
+
+ZTEST(radpro_client, test_cache_ticket_at_high_generation)
+{
+	/* Entry 4 after 255 invalidations: generation 0xff */
+	radpro_cache_track_fake.return_val = 0xff04;
+
+	client_write("GET tubeDeadTimeCompensation\r\n");
+
+	zassert_equal(TAG_CLIENT(radpro_engine_submit_timed_fake.arg5_val), 0);
+	zassert_equal(TAG_TICKET(radpro_engine_submit_timed_fake.arg5_val), 0xff04);
+
+	engine_reply("OK 0.000000\r\n");
+	engine_done(0);
+
+	zassert_equal(radpro_cache_fill_fake.arg0_val, 0xff04);
+	zassert_equal(radpro_cache_complete_fake.arg0_val, 0xff04);
+	zassert_equal(atomic_get(&clients[0].outstanding), 0);
+
+	radpro_cache_track_fake.return_val = 0x8000;
+	client_write("GET tubeType\r\n");
+	zassert_equal(TAG_TICKET(radpro_engine_submit_timed_fake.arg5_val), 0x8000,
+		      "Generation 128 stays positive");
+}
+
+ZTEST(radpro_client, test_reply_routed_to_sender)
+{
+	output_client = 1;
+	client_write("GET tubeRate\r\n");
+
+	engine_reply("OK 10.0\r\n");
+	engine_done(0);
+
+	zassert_equal(output_len, 9);
+	zassert_mem_equal(output, "OK 10.0\r\n", 9);
+	zassert_equal(output_other_count, 0, "Nothing for the other client");
+}
+
+ZTEST(radpro_client, test_clients_have_separate_lines)
+{
+	radpro_client_rx(0, (const uint8_t *)"GET dev", 7);
+	radpro_client_rx(1, (const uint8_t *)"GET tube", 8);
+	radpro_client_rx(1, (const uint8_t *)"Rate\n", 5);
+	radpro_client_rx(0, (const uint8_t *)"iceId\n", 6);
+
+	zassert_equal(submit_count, 2);
+	zassert_str_equal(submitted[0], "GET tubeRate");
+	zassert_str_equal(submitted[1], "GET deviceId");
+}
+
+ZTEST(radpro_client, test_outstanding_is_per_client)
+{
+	/* Client 1 waits for the UART... */
+	radpro_client_rx(1, (const uint8_t *)"GET tubeRate\n", 13);
+
+	/* ...which doesn't hold back a cache hit for client 0 */
+	radpro_cache_lookup_fake.custom_fake = radpro_cache_lookup_hit;
+	client_write("GET tubeType\r\n");
+	engine_run_local();
+
+	zassert_equal(submit_count, 1);
+	zassert_equal(output_len, 10);
+	zassert_mem_equal(output, "OK M4011\r\n", 10);
+}
+
+ZTEST(radpro_client, test_reset_drops_replies_to_gone_client)
+{
+	radpro_cache_track_fake.return_val = 2;
+	client_write("GET tubeSensitivity\r\n");
+
+	/* Disconnected; a new central takes the slot */
+	radpro_client_reset(0);
+
+	engine_reply("OK 153.800\r\n");
+	engine_done(0);
+
+	zassert_equal(output_len, 0);
+	/* The cache still learns the value */
+	zassert_equal(radpro_cache_fill_fake.call_count, 1);
+	zassert_equal(radpro_cache_complete_fake.call_count, 1);
+
+	/* The new client starts from a clean slate */
+	radpro_cache_lookup_fake.custom_fake = radpro_cache_lookup_hit;
+	client_write("GET tubeType\r\n");
+	engine_run_local();
+	zassert_equal(output_len, 10);
+}
+
+ZTEST(radpro_client, test_reset_drops_partial_line)
+{
+	client_write("GET dev");
+	radpro_client_reset(0);
+	client_write("GET tubeRate\n");
+
+	zassert_equal(submit_count, 1);
+	zassert_str_equal(submitted[0], "GET tubeRate");
+}
+
+ZTEST(radpro_client, test_datalog_bin_sent_as_datalog)
+{
+	client_write("GET datalogBin 1690000000\r\n");
+	client_write("GET datalogBin\r\n");
+
+	zassert_equal(submit_count, 2);
+	zassert_str_equal(submitted[0], "GET datalog 1690000000");
+	zassert_str_equal(submitted[1], "GET datalog");
+	zassert_equal(radpro_cache_track_fake.call_count, 0, "Never cached");
+}
+
+ZTEST(radpro_client, test_datalog_bin_prefix_only_matches_whole_word)
+{
+	client_write("GET datalogBinary\r\n");
+
+	zassert_str_equal(submitted[0], "GET datalogBinary");
+	zassert_equal(radpro_engine_submit_timed_fake.arg3_val, client_data);
+}
+
+ZTEST(radpro_client, test_datalog_bin_reply_encoded)
+{
+	radpro_datalog_enc_feed_fake.custom_fake = radpro_datalog_enc_feed_hash;
+	radpro_datalog_enc_finish_fake.custom_fake = radpro_datalog_enc_finish_end;
+	client_write("GET datalogBin\r\n");
+
+	engine_reply("OK t,p;1,2\r\n");
+	engine_done(0);
+
+	zassert_equal(output_len, 15);
+	zassert_mem_equal(output, "############$\r\n", 15);
+	zassert_equal(radpro_cache_fill_fake.call_count, 0);
+	zassert_equal(atomic_get(&clients[0].outstanding), 0);
+	zassert_true(radpro_datalog_enc_init_fake.call_count >= 2,
+		     "Encoder reset for the next download");
+}
+
+ZTEST(radpro_client, test_datalog_bin_timeout_without_reply_sends_error)
+{
+	radpro_datalog_enc_finish_fake.return_val = false;
+	client_write("GET datalogBin\r\n");
+
+	engine_done(-ETIMEDOUT);
+
+	zassert_equal(output_len, 7);
+	zassert_mem_equal(output, "ERROR\r\n", 7);
+	zassert_equal(atomic_get(&clients[0].outstanding), 0);
+}
+
+ZTEST(radpro_client, test_datalog_bin_dropped_for_gone_client)
+{
+	radpro_datalog_enc_feed_fake.custom_fake = radpro_datalog_enc_feed_hash;
+	radpro_datalog_enc_finish_fake.custom_fake = radpro_datalog_enc_finish_end;
+	client_write("GET datalogBin\r\n");
+	radpro_client_reset(0);
+
+	engine_reply("OK t,p;1,2\r\n");
+	engine_done(0);
+
+	zassert_equal(output_len, 0);
+	zassert_equal(radpro_datalog_enc_feed_fake.call_count, 1, "Encoder state still tracked");
+}
+
+ZTEST(radpro_client, test_sync_requests_records_after_cursor)
+{
+	radpro_sync_get_fake.return_val = 1690000060;
+
+	client_write("SYNC datalog\r\n");
+
+	zassert_equal(submit_count, 1);
+	zassert_str_equal(submitted[0], "GET datalog 1690000061");
+	zassert_equal(radpro_sync_get_fake.arg0_val, &bonded_peer);
+	zassert_equal(radpro_engine_submit_timed_fake.arg3_val, datalog_data, "Binary reply");
+	zassert_equal(radpro_cache_track_fake.call_count, 0, "Never cached");
+}
+
+ZTEST(radpro_client, test_sync_first_time_from_start)
+{
+	client_write("SYNC datalog\r\n");
+
+	zassert_str_equal(submitted[0], "GET datalog 1");
+}
+
+ZTEST(radpro_client, test_sync_ack_commits_last_record)
+{
+	radpro_datalog_enc_finish_fake.custom_fake = radpro_datalog_enc_finish_end;
+	radpro_datalog_enc_last_time_fake.return_val = 1690000120;
+	client_write("SYNC datalog\r\n");
+	engine_reply("OK t,p;1690000120,2\r\n");
+	engine_done(0);
+
+	/* Not stored until the client confirms */
+	zassert_equal(radpro_sync_set_fake.call_count, 0);
+
+	output_len = 0;
+	radpro_sync_get_fake.return_val = 1690000120;
+	client_write("SYNC ack\r\n");
+
+	/* Settings are written on the engine's work queue */
+	zassert_equal(radpro_sync_set_fake.call_count, 0);
+	zassert_equal(radpro_engine_submit_local_fake.arg2_val, sync_ack);
+	engine_run_local();
+
+	zassert_equal(radpro_sync_set_fake.call_count, 1);
+	zassert_equal(radpro_sync_set_fake.arg0_val, &bonded_peer);
+	zassert_equal(radpro_sync_set_fake.arg1_val, 1690000120);
+	zassert_equal(output_len, 15);
+	zassert_mem_equal(output, "OK 1690000120\r\n", 15);
+	zassert_equal(submit_count, 1, "Answered locally");
+
+	/* A second ack has nothing new to store */
+	client_write("SYNC ack\r\n");
+	engine_run_local();
+	zassert_equal(radpro_sync_set_fake.call_count, 1);
+}
+
+ZTEST(radpro_client, test_sync_ack_ignores_aborted_download)
+{
+	radpro_datalog_enc_finish_fake.custom_fake = radpro_datalog_enc_finish_end;
+	radpro_datalog_enc_last_time_fake.return_val = 1690000120;
+	client_write("SYNC datalog\r\n");
+	engine_reply("OK t,p;1690000120,2;169");
+	engine_done(-ETIMEDOUT);
+
+	client_write("SYNC ack\r\n");
+	engine_run_local();
+
+	zassert_equal(radpro_sync_set_fake.call_count, 0, "Cursor must not advance");
+}
+
+ZTEST(radpro_client, test_sync_ack_queued_behind_download)
+{
+	radpro_datalog_enc_finish_fake.custom_fake = radpro_datalog_enc_finish_end;
+	radpro_datalog_enc_last_time_fake.return_val = 1690000120;
+
+	/* Pipelined: the ack waits for the download it confirms */
+	client_write("SYNC datalog\r\n");
+	client_write("SYNC ack\r\n");
+	zassert_equal(radpro_engine_submit_local_fake.call_count, 1);
+
+	engine_reply("OK t,p;1690000120,2\r\n");
+	engine_done(0);
+	engine_run_local();
+
+	zassert_equal(radpro_sync_set_fake.arg1_val, 1690000120);
+}
+
+ZTEST(radpro_client, test_sync_ack_store_failure_replies_error)
+{
+	radpro_datalog_enc_last_time_fake.return_val = 1690000120;
+	client_write("SYNC datalog\r\n");
+	engine_reply("OK t,p;1690000120,2\r\n");
+	engine_done(0);
+
+	output_len = 0;
+	radpro_sync_set_fake.return_val = -EIO;
+	client_write("SYNC ack\r\n");
+	engine_run_local();
+
+	zassert_equal(output_len, 7);
+	zassert_mem_equal(output, "ERROR\r\n", 7);
+	zassert_equal(atomic_get(&clients[0].outstanding), 0);
+}
+
+ZTEST(radpro_client, test_sync_unbonded_client_replies_error)
+{
+	output_client = 1;
+	client_write("SYNC datalog\r\n");
+
+	zassert_equal(submit_count, 0);
+	zassert_equal(radpro_sync_get_fake.call_count, 0);
+	zassert_equal(output_len, 7);
+	zassert_mem_equal(output, "ERROR\r\n", 7);
+}
+
+ZTEST(radpro_client, test_sync_unknown_subcommand_replies_error)
+{
+	client_write("SYNC datalogs\r\n");
+	client_write("SYNCack\r\n");
+
+	zassert_equal(submit_count, 1, "SYNCack is passed to the device");
+	zassert_str_equal(submitted[0], "SYNCack");
+	zassert_equal(output_len, 7);
+	zassert_mem_equal(output, "ERROR\r\n", 7);
+}
+
+ZTEST(radpro_client, test_sync_reset_clears_cursor)
+{
+	client_write("SYNC reset\r\n");
+	zassert_equal(radpro_engine_submit_local_fake.arg2_val, sync_reset);
+	engine_run_local();
+
+	zassert_equal(radpro_sync_set_fake.call_count, 1);
+	zassert_equal(radpro_sync_set_fake.arg1_val, 0);
+	zassert_equal(output_len, 4);
+	zassert_mem_equal(output, "OK\r\n", 4);
+}
+
+ZTEST(radpro_client, test_sync_pending_ack_dropped_on_reset)
+{
+	radpro_datalog_enc_finish_fake.custom_fake = radpro_datalog_enc_finish_end;
+	radpro_datalog_enc_last_time_fake.return_val = 1690000120;
+	client_write("SYNC datalog\r\n");
+	engine_reply("OK t,p;1690000120,2\r\n");
+	engine_done(0);
+
+	/* Disconnected before acking */
+	radpro_client_reset(0);
+	client_write("SYNC ack\r\n");
+	engine_run_local();
+
+	zassert_equal(radpro_sync_set_fake.call_count, 0);
+}
+
+ZTEST(radpro_client, test_covered_datalog_served_from_mirror)
+{
+	radpro_mirror_covers_fake.return_val = true;
+
+	client_write("GET datalog 1690000000\r\n");
+
+	zassert_equal(submit_count, 0, "Device not asked");
+	zassert_equal(radpro_mirror_refresh_fake.call_count, 1, "Catch-up fetch queued");
+	zassert_equal(radpro_engine_submit_local_fake.call_count, 1);
+	zassert_equal(radpro_engine_submit_local_fake.arg2_val, radpro_mirror_serve);
+	zassert_equal(radpro_engine_submit_local_fake.arg3_val, client_data);
+	zassert_equal(radpro_engine_submit_local_fake.arg4_val, client_done);
+	zassert_equal(atomic_get(&clients[0].outstanding), 1);
+}
+
+ZTEST(radpro_client, test_covered_datalog_bin_served_from_mirror)
+{
+	radpro_mirror_covers_fake.return_val = true;
+
+	client_write("GET datalogBin 1690000000\r\n");
+
+	zassert_equal(submit_count, 0);
+	zassert_equal(radpro_engine_submit_local_fake.call_count, 1);
+	zassert_equal(radpro_engine_submit_local_fake.arg3_val, datalog_data, "Still encoded");
+	zassert_equal(radpro_mirror_covers_fake.arg1_val, strlen("GET datalog 1690000000"),
+		      "Checked as GET datalog");
+}
+
+ZTEST(radpro_client, test_covered_sync_served_from_mirror)
+{
+	radpro_mirror_covers_fake.return_val = true;
+	radpro_sync_get_fake.return_val = 1690000060;
+
+	client_write("SYNC datalog\r\n");
+
+	zassert_equal(submit_count, 0);
+	zassert_equal(radpro_engine_submit_local_fake.call_count, 1);
+	zassert_equal(radpro_engine_submit_local_fake.arg4_val, sync_done);
+}
+
+ZTEST(radpro_client, test_uncovered_datalog_sent_to_device)
+{
+	client_write("GET datalog 1690000000 1690000600 10\r\n");
+
+	zassert_equal(radpro_mirror_covers_fake.call_count, 1);
+	zassert_equal(submit_count, 1);
+	zassert_str_equal(submitted[0], "GET datalog 1690000000 1690000600 10");
+	zassert_equal(radpro_mirror_refresh_fake.call_count, 0);
+	zassert_equal(radpro_engine_submit_local_fake.call_count, 0);
+}
+
+ZTEST(radpro_client, test_mirror_submit_failure_replies_error)
+{
+	radpro_mirror_covers_fake.return_val = true;
+	radpro_engine_submit_local_fake.return_val = -ENOMEM;
+
+	client_write("GET datalog\r\n");
+
+	zassert_equal(output_len, 7);
+	zassert_mem_equal(output, "ERROR\r\n", 7);
+	zassert_equal(atomic_get(&clients[0].outstanding), 0);
+}
+
+ZTEST(radpro_client, test_reset_datalog_clears_mirror)
+{
+	client_write("RESET datalog\r\n");
+
+	zassert_str_equal(submitted[0], "RESET datalog");
+	zassert_equal(radpro_mirror_clear_fake.call_count, 0, "Not before the device's OK");
+
+	/* Cleared even if the client is gone by then */
+	radpro_client_reset(0);
+	engine_reply("OK\r\n");
+	engine_done(0);
+
+	zassert_equal(radpro_mirror_clear_fake.call_count, 1);
+}
+
+ZTEST(radpro_client, test_failed_reset_datalog_keeps_mirror)
+{
+	client_write("RESET datalog\r\n");
+	engine_reply("ERROR\r\n");
+	engine_done(-EIO);
+
+	zassert_equal(radpro_mirror_clear_fake.call_count, 0);
+	zassert_equal(atomic_get(&clients[0].outstanding), 0);
+}
+
+ZTEST_SUITE(radpro_client, NULL, NULL, NULL, NULL, NULL);
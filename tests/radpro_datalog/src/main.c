@@ -0,0 +1,320 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for radpro_datalog module.
+ */
+
+#include <zephyr/ztest.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Include CUT */
+#include "radpro/radpro_datalog.c"
+
+/* Encoded output */
+static uint8_t output[4096];
+static size_t output_len;
+static int output_calls;
+
+static void test_out(const uint8_t *data, size_t len, void *user_data)
+{
+	zassert_equal(user_data, &output_calls, "user_data passed through");
+	zassert_true(output_len + len <= sizeof(output));
+	memcpy(&output[output_len], data, len);
+	output_len += len;
+	output_calls++;
+}
+
+static struct radpro_datalog_enc enc;
+
+static void feed(const char *text)
+{
+	radpro_datalog_enc_feed(&enc, (const uint8_t *)text, strlen(text), test_out,
+				&output_calls);
+}
+
+static bool finish(int status)
+{
+	return radpro_datalog_enc_finish(&enc, status, test_out, &output_calls);
+}
+
+/* Reference decoder, as a client would implement it */
+struct decoded {
+	uint32_t time[1100];
+	uint32_t pulses[1100];
+	int sessions[1100];   /* Session number of each record */
+	int records;
+	int session_count;
+	int end;              /* Terminating head */
+};
+
+static bool get_varint(const uint8_t **p, const uint8_t *end, uint64_t *value)
+{
+	int shift = 0;
+
+	*value = 0;
+	while (*p < end && shift < 64) {
+		uint8_t b = *(*p)++;
+
+		*value |= (uint64_t)(b & 0x7f) << shift;
+		if (!(b & 0x80)) {
+			return true;
+		}
+		shift += 7;
+	}
+	return false;
+}
+
+static int64_t unzigzag(uint64_t value)
+{
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static void decode(struct decoded *d)
+{
+	const uint8_t *p = output;
+	const uint8_t *end = output + output_len;
+	uint32_t time = 0;
+	uint32_t pulses = 0;
+	uint64_t head, dp;
+
+	memset(d, 0, sizeof(*d));
+	d->end = -1;
+
+	zassert_true(output_len >= 3 && memcmp(output, "OK ", 3) == 0, "Reply starts with OK");
+	p += 3;
+
+	while (get_varint(&p, end, &head)) {
+		if (head == RADPRO_DATALOG_END || head == RADPRO_DATALOG_ABORT) {
+			d->end = head;
+			break;
+		}
+		if (head == RADPRO_DATALOG_SESSION) {
+			d->session_count++;
+			continue;
+		}
+
+		zassert_true(get_varint(&p, end, &dp), "Record has a pulse delta");
+		time += unzigzag(head - RADPRO_DATALOG_RECORD);
+		pulses += unzigzag(dp);
+		d->time[d->records] = time;
+		d->pulses[d->records] = pulses;
+		d->sessions[d->records] = d->session_count;
+		d->records++;
+	}
+
+	zassert_equal(end - p, 2, "Line end follows the end marker");
+	zassert_mem_equal(p, "\r\n", 2);
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	memset(output, 0, sizeof(output));
+	output_len = 0;
+	output_calls = 0;
+	radpro_datalog_enc_init(&enc);
+}
+
+/* --- Tests --- */
+
+ZTEST(radpro_datalog, test_documented_example)
+{
+	static struct decoded d;
+
+	feed("OK time,tubePulseCount;;1690000000,1542;1690000060,1618;1690000120,1693\r\n");
+	zassert_true(finish(0));
+
+	decode(&d);
+	zassert_equal(d.end, RADPRO_DATALOG_END);
+	zassert_equal(d.session_count, 1);
+	zassert_equal(d.records, 3);
+	zassert_equal(d.time[0], 1690000000);
+	zassert_equal(d.pulses[0], 1542);
+	zassert_equal(d.time[2], 1690000120);
+	zassert_equal(d.pulses[2], 1693);
+	zassert_equal(d.sessions[0], 1, "Session marker precedes the first record");
+}
+
+ZTEST(radpro_datalog, test_record_after_first_is_two_bytes)
+{
+	feed("OK time,tubePulseCount;1690000000,1542;");
+	size_t before_second = output_len;
+
+	feed("1690000060,1560;");
+
+	/* dt 60 -> head 123, dp 18 -> 36: one byte each */
+	zassert_equal(output_len - before_second, 2);
+	zassert_equal(output[before_second], RADPRO_DATALOG_RECORD + 120);
+	zassert_equal(output[before_second + 1], 36);
+}
+
+ZTEST(radpro_datalog, test_split_feeds_match_single_feed)
+{
+	const char *log = "OK time,tubePulseCount;;1690000000,1542;1690000060,1618;;"
+			  "1690003600,12;1690003660,50\r\n";
+	static uint8_t whole[256];
+	size_t whole_len;
+
+	feed(log);
+	finish(0);
+	memcpy(whole, output, output_len);
+	whole_len = output_len;
+
+	before(NULL);
+	for (size_t i = 0; i < strlen(log); i++) {
+		radpro_datalog_enc_feed(&enc, (const uint8_t *)&log[i], 1, test_out,
+					&output_calls);
+	}
+	finish(0);
+
+	zassert_equal(output_len, whole_len);
+	zassert_mem_equal(output, whole, whole_len);
+}
+
+ZTEST(radpro_datalog, test_session_with_counter_reset)
+{
+	static struct decoded d;
+
+	/* Pulse counter restarts and time goes backwards after a clock fix */
+	feed("OK time,tubePulseCount;1690000000,9000;;1680000000,5\r\n");
+	finish(0);
+
+	decode(&d);
+	zassert_equal(d.records, 2);
+	zassert_equal(d.time[1], 1680000000);
+	zassert_equal(d.pulses[1], 5);
+	zassert_equal(d.sessions[1], 1);
+}
+
+ZTEST(radpro_datalog, test_error_passed_through)
+{
+	feed("ERR");
+	feed("OR\r\n");
+
+	zassert_false(finish(-EIO), "Caller completes non-binary replies");
+	zassert_equal(output_len, 7);
+	zassert_mem_equal(output, "ERROR\r\n", 7);
+}
+
+ZTEST(radpro_datalog, test_empty_log)
+{
+	static struct decoded d;
+
+	feed("OK\r\n");
+	zassert_true(finish(0));
+
+	decode(&d);
+	zassert_equal(d.records, 0);
+	zassert_equal(d.end, RADPRO_DATALOG_END);
+}
+
+ZTEST(radpro_datalog, test_timeout_mid_record_aborts)
+{
+	static struct decoded d;
+
+	feed("OK time,tubePulseCount;1690000000,1542;1690000060,16");
+	zassert_true(finish(-ETIMEDOUT));
+
+	decode(&d);
+	zassert_equal(d.end, RADPRO_DATALOG_ABORT);
+	zassert_equal(d.records, 1, "Cut-off record dropped");
+}
+
+ZTEST(radpro_datalog, test_timeout_before_reply)
+{
+	zassert_false(finish(-ETIMEDOUT));
+	zassert_equal(output_len, 0);
+}
+
+ZTEST(radpro_datalog, test_malformed_records_skipped)
+{
+	static struct decoded d;
+
+	feed("OK time,tubePulseCount;1690000000,1542,7;99999999999,1;1690000060,1600\r\n");
+	finish(0);
+
+	decode(&d);
+	zassert_equal(d.records, 1);
+	zassert_equal(d.time[0], 1690000060);
+}
+
+ZTEST(radpro_datalog, test_full_log_an_order_of_magnitude_smaller)
+{
+	static char ascii[20000];
+	static struct decoded d;
+	size_t len = snprintf(ascii, sizeof(ascii), "OK time,tubePulseCount;;");
+	uint32_t pulses = 123456;
+
+	/* 1000 records at the 60 s logging period, ~30 cpm background */
+	for (int i = 0; i < 1000; i++) {
+		pulses += 20 + (i * 7) % 23;
+		len += snprintf(&ascii[len], sizeof(ascii) - len, "%u,%u;",
+				1690000000 + 60 * i, pulses);
+	}
+	ascii[len - 1] = '\r';
+	ascii[len++] = '\n';
+
+	/* UART DMA-sized pieces */
+	for (size_t off = 0; off < len; off += 256) {
+		radpro_datalog_enc_feed(&enc, (const uint8_t *)&ascii[off], MIN(256, len - off),
+					test_out, &output_calls);
+	}
+	finish(0);
+
+	TC_PRINT("1000 records: %zu bytes ASCII, %zu bytes encoded (%.1fx)\n", len,
+		 output_len, (double)len / output_len);
+
+	decode(&d);
+	zassert_equal(d.records, 1000);
+	zassert_equal(d.time[999], 1690000000 + 60 * 999);
+	zassert_equal(d.pulses[999], pulses);
+	zassert_true(output_len * 8 <= len, "%zu -> %zu bytes", len, output_len);
+}
+
+/* Items reported to the record callback */
+static uint8_t item_heads[8];
+static uint32_t item_times[8];
+static uint32_t item_pulses[8];
+static int item_count;
+
+static void test_record_cb(uint8_t head, uint32_t time, uint32_t pulses, void *user_data)
+{
+	zassert_equal(user_data, &item_count, "user_data passed through");
+	zassert_true(item_count < ARRAY_SIZE(item_heads));
+	item_heads[item_count] = head;
+	item_times[item_count] = time;
+	item_pulses[item_count] = pulses;
+	item_count++;
+}
+
+ZTEST(radpro_datalog, test_record_cb_sees_parsed_items)
+{
+	item_count = 0;
+	radpro_datalog_enc_set_record_cb(&enc, test_record_cb, &item_count);
+
+	feed("OK time,tubePulseCount;;1690000000,1542;x,1;1690000060,1618\r\n");
+	finish(0);
+
+	zassert_equal(item_count, 3, "Field names and malformed records not reported");
+	zassert_equal(item_heads[0], RADPRO_DATALOG_SESSION);
+	zassert_equal(item_heads[1], RADPRO_DATALOG_RECORD);
+	zassert_equal(item_times[1], 1690000000);
+	zassert_equal(item_pulses[1], 1542);
+	zassert_equal(item_times[2], 1690000060);
+	zassert_equal(item_pulses[2], 1618);
+}
+
+ZTEST(radpro_datalog, test_records_without_output)
+{
+	item_count = 0;
+	radpro_datalog_enc_set_record_cb(&enc, test_record_cb, &item_count);
+
+	radpro_datalog_enc_feed(&enc, (const uint8_t *)"OK t,p;1,2;3,4\r\n", 17, NULL, NULL);
+	zassert_true(radpro_datalog_enc_finish(&enc, 0, NULL, NULL));
+
+	zassert_equal(item_count, 2);
+	zassert_equal(output_len, 0);
+}
+
+ZTEST_SUITE(radpro_datalog, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,631 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for radpro_engine module.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/fff.h>
+#include <string.h>
+
+DEFINE_FFF_GLOBALS;
+
+/* Kconfig values */
+#define CONFIG_RADPRO_LATENCY 1
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+#ifdef LOG_DBG
+#undef LOG_DBG
+#endif
+#define LOG_DBG(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+/* UART type stubs (uart_bridge.h pulls in the UART driver header) */
+#include "uart_mocks.h"
+
+#include "uart/uart_bridge.h"
+
+/* FFF fakes — UART bridge */
+DECLARE_FAKE_VALUE_FUNC(int, uart_bridge_send, const uint8_t *, uint16_t);
+DEFINE_FAKE_VALUE_FUNC(int, uart_bridge_send, const uint8_t *, uint16_t);
+
+/* FFF fakes — kernel work */
+DECLARE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+			k_work_handler_t);
+DEFINE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+		      k_work_handler_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+			k_timeout_t);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+		       k_timeout_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_cancel_delayable,
+			struct k_work_delayable *);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_cancel_delayable,
+		       struct k_work_delayable *);
+
+DECLARE_FAKE_VOID_FUNC(k_work_init, struct k_work *, k_work_handler_t);
+DEFINE_FAKE_VOID_FUNC(k_work_init, struct k_work *, k_work_handler_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_submit_to_queue, struct k_work_q *,
+			struct k_work *);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_submit_to_queue, struct k_work_q *,
+		       struct k_work *);
+
+DECLARE_FAKE_VOID_FUNC(k_work_queue_start, struct k_work_q *, k_thread_stack_t *,
+		       size_t, int, const struct k_work_queue_config *);
+DEFINE_FAKE_VOID_FUNC(k_work_queue_start, struct k_work_q *, k_thread_stack_t *,
+		      size_t, int, const struct k_work_queue_config *);
+
+/* FFF fakes — latency histograms */
+/* k_cycle_get_32 is inline in kernel.h — use macro redirect */
+static uint32_t test_cycles;
+#define k_cycle_get_32() (test_cycles)
+
+#include "radpro/radpro_latency.h"
+
+DECLARE_FAKE_VOID_FUNC(radpro_latency_record, enum radpro_latency_stage, uint32_t,
+		       uint32_t);
+DEFINE_FAKE_VOID_FUNC(radpro_latency_record, enum radpro_latency_stage, uint32_t,
+		      uint32_t);
+
+/* k_uptime_get is static inline in kernel.h — override via macro redirect */
+static int64_t test_uptime;
+#define k_uptime_get() (test_uptime)
+
+/* Stub the local work queue stack — no thread is started */
+#ifdef K_THREAD_STACK_DEFINE
+#undef K_THREAD_STACK_DEFINE
+#endif
+#define K_THREAD_STACK_DEFINE(sym, size) k_thread_stack_t sym[size]
+
+#ifdef K_THREAD_STACK_SIZEOF
+#undef K_THREAD_STACK_SIZEOF
+#endif
+#define K_THREAD_STACK_SIZEOF(sym) sizeof(sym)
+
+/* k_mutex_lock/k_mutex_unlock are syscalls in kernel.h — use macro redirect */
+static int test_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+	return 0;
+}
+#define k_mutex_lock(mutex, timeout) test_k_mutex_lock(mutex, timeout)
+
+static int test_k_mutex_unlock(struct k_mutex *mutex)
+{
+	return 0;
+}
+#define k_mutex_unlock(mutex) test_k_mutex_unlock(mutex)
+
+/* Stub K_MUTEX_DEFINE — just declare the struct */
+#ifdef K_MUTEX_DEFINE
+#undef K_MUTEX_DEFINE
+#endif
+#define K_MUTEX_DEFINE(name) struct k_mutex name
+
+/* Stub ARG_UNUSED if not available */
+#ifndef ARG_UNUSED
+#define ARG_UNUSED(x) (void)(x)
+#endif
+
+/* Include CUT */
+#include "radpro/radpro_engine.c"
+
+/* Last line handed to the UART */
+static char uart_line[RADPRO_CMD_MAX_LEN + 2];
+static uint16_t uart_line_len;
+
+static int uart_bridge_send_capture(const uint8_t *data, uint16_t len)
+{
+	memcpy(uart_line, data, len);
+	uart_line_len = len;
+	return 0;
+}
+
+/* Per-command response capture, indexed by user_data */
+struct test_reply {
+	char data[64];
+	size_t len;
+	int data_calls;
+	int done_calls;
+	int status;
+};
+
+static struct test_reply replies[RADPRO_CMD_QUEUE_DEPTH + 1];
+static char unsolicited[64];
+static size_t unsolicited_len;
+
+static void test_data_cb(const uint8_t *data, size_t len, void *user_data)
+{
+	struct test_reply *r = user_data;
+
+	memcpy(&r->data[r->len], data, len);
+	r->len += len;
+	r->data_calls++;
+}
+
+static void test_done_cb(int status, void *user_data)
+{
+	struct test_reply *r = user_data;
+
+	r->status = status;
+	r->done_calls++;
+}
+
+static void test_unsolicited_cb(const uint8_t *data, size_t len, void *user_data)
+{
+	memcpy(&unsolicited[unsolicited_len], data, len);
+	unsolicited_len += len;
+}
+
+/* Local command handler: answers with its own command line */
+static int local_status;
+static int local_calls;
+
+static int test_local_cb(const char *cmd, size_t len, radpro_data_cb_t data_cb,
+			 void *user_data)
+{
+	local_calls++;
+	data_cb((const uint8_t *)"OK ", 3, user_data);
+	data_cb((const uint8_t *)cmd, len, user_data);
+	data_cb((const uint8_t *)"\r\n", 2, user_data);
+	return local_status;
+}
+
+static int submit_local(const char *cmd, struct test_reply *r)
+{
+	return radpro_engine_submit_local(cmd, strlen(cmd), test_local_cb, test_data_cb,
+					  test_done_cb, r);
+}
+
+/* Run the local work item, as the engine's work queue would */
+static void run_local_work(void)
+{
+	zassert_equal(k_work_submit_to_queue_fake.arg1_val, &local_work);
+	k_work_init_fake.arg1_val(&local_work);
+}
+
+#define TEST_TIMEOUT_MS 1000
+
+static int submit(const char *cmd, struct test_reply *r)
+{
+	return radpro_engine_submit(cmd, strlen(cmd), TEST_TIMEOUT_MS, test_data_cb,
+				    test_done_cb, r);
+}
+
+static int submit_timed(const char *cmd, struct test_reply *r)
+{
+	return radpro_engine_submit_timed(cmd, strlen(cmd), TEST_TIMEOUT_MS, test_data_cb,
+					  test_done_cb, r);
+}
+
+static void uart_rx(const char *text)
+{
+	radpro_engine_uart_rx((const uint8_t *)text, strlen(text));
+}
+
+/* --- FFF reset rule --- */
+static void fff_reset_rule_before(const struct ztest_unit_test *test,
+				  void *fixture)
+{
+	RESET_FAKE(uart_bridge_send);
+	RESET_FAKE(k_work_init_delayable);
+	RESET_FAKE(k_work_reschedule);
+	RESET_FAKE(k_work_cancel_delayable);
+	RESET_FAKE(k_work_init);
+	RESET_FAKE(k_work_submit_to_queue);
+	RESET_FAKE(k_work_queue_start);
+	RESET_FAKE(radpro_latency_record);
+	FFF_RESET_HISTORY();
+
+	uart_bridge_send_fake.custom_fake = uart_bridge_send_capture;
+	memset(uart_line, 0, sizeof(uart_line));
+	uart_line_len = 0;
+	memset(replies, 0, sizeof(replies));
+	memset(unsolicited, 0, sizeof(unsolicited));
+	unsolicited_len = 0;
+	local_status = 0;
+	local_calls = 0;
+	test_cycles = 0;
+	test_uptime = 0;
+
+	radpro_engine_init(test_unsolicited_cb);
+}
+
+ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
+
+/* --- Tests --- */
+
+ZTEST(radpro_engine, test_submit_sends_line_with_crlf)
+{
+	int err = submit("GET deviceId", &replies[0]);
+
+	zassert_equal(err, 0);
+	zassert_equal(uart_bridge_send_fake.call_count, 1);
+	zassert_equal(uart_line_len, 14);
+	zassert_mem_equal(uart_line, "GET deviceId\r\n", 14);
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+	zassert_true(K_TIMEOUT_EQ(k_work_reschedule_fake.arg1_val, K_MSEC(1000)));
+	zassert_equal(radpro_engine_pending(), 1);
+}
+
+ZTEST(radpro_engine, test_submit_normalizes_terminator)
+{
+	submit("GET tubeRate\r", &replies[0]);
+
+	zassert_equal(uart_line_len, 14);
+	zassert_mem_equal(uart_line, "GET tubeRate\r\n", 14);
+}
+
+ZTEST(radpro_engine, test_invalid_commands_rejected)
+{
+	char too_long[RADPRO_CMD_MAX_LEN + 2];
+
+	memset(too_long, 'A', sizeof(too_long) - 1);
+	too_long[sizeof(too_long) - 1] = '\0';
+
+	zassert_equal(submit("", &replies[0]), -EINVAL);
+	zassert_equal(submit("\r\n", &replies[0]), -EINVAL);
+	zassert_equal(submit(too_long, &replies[0]), -EINVAL);
+	zassert_equal(uart_bridge_send_fake.call_count, 0);
+}
+
+ZTEST(radpro_engine, test_only_one_command_outstanding)
+{
+	submit("GET deviceId", &replies[0]);
+	submit("GET tubeRate", &replies[1]);
+	submit("GET deviceBatteryVoltage", &replies[2]);
+
+	zassert_equal(uart_bridge_send_fake.call_count, 1);
+	zassert_equal(radpro_engine_pending(), 3);
+
+	uart_rx("OK Bosean FS-600;Rad Pro 2.0/en;1234\r\n");
+
+	/* Next command goes out only once the first is answered */
+	zassert_equal(uart_bridge_send_fake.call_count, 2);
+	zassert_mem_equal(uart_line, "GET tubeRate\r\n", 14);
+	zassert_equal(radpro_engine_pending(), 2);
+}
+
+ZTEST(radpro_engine, test_responses_routed_to_their_commands)
+{
+	submit("GET tubeRate", &replies[0]);
+	submit("GET deviceBatteryVoltage", &replies[1]);
+
+	uart_rx("OK 142.857\r\n");
+	uart_rx("OK 3.95\r\n");
+
+	zassert_equal(replies[0].done_calls, 1);
+	zassert_equal(replies[0].status, 0);
+	zassert_equal(replies[0].len, 12);
+	zassert_mem_equal(replies[0].data, "OK 142.857\r\n", 12);
+
+	zassert_equal(replies[1].done_calls, 1);
+	zassert_equal(replies[1].len, 9);
+	zassert_mem_equal(replies[1].data, "OK 3.95\r\n", 9);
+	zassert_equal(radpro_engine_pending(), 0);
+}
+
+ZTEST(radpro_engine, test_error_response_status)
+{
+	submit("SET tubeHVFrequency 99", &replies[0]);
+
+	uart_rx("ERROR\r\n");
+
+	zassert_equal(replies[0].done_calls, 1);
+	zassert_equal(replies[0].status, -EIO);
+	zassert_mem_equal(replies[0].data, "ERROR\r\n", 7);
+}
+
+ZTEST(radpro_engine, test_unexpected_line_status)
+{
+	submit("GET tubeRate", &replies[0]);
+
+	uart_rx("garbage\r\n");
+
+	zassert_equal(replies[0].status, -EBADMSG);
+}
+
+ZTEST(radpro_engine, test_split_response_streams_and_extends_timeout)
+{
+	submit("GET datalog", &replies[0]);
+	RESET_FAKE(k_work_reschedule);
+
+	uart_rx("OK time,tubePulseCount;;1690000000,");
+
+	zassert_equal(replies[0].data_calls, 1);
+	zassert_equal(replies[0].done_calls, 0);
+	zassert_equal(k_work_reschedule_fake.call_count, 1,
+		      "Partial data restarts the silence timeout");
+
+	uart_rx("1542\r\n");
+
+	zassert_equal(replies[0].data_calls, 2);
+	zassert_equal(replies[0].done_calls, 1);
+	zassert_equal(replies[0].status, 0);
+	zassert_equal(k_work_cancel_delayable_fake.call_count, 1);
+}
+
+ZTEST(radpro_engine, test_split_status_prefix)
+{
+	submit("RESET datalog", &replies[0]);
+
+	uart_rx("ER");
+	uart_rx("ROR\r\n");
+
+	zassert_equal(replies[0].status, -EIO);
+}
+
+ZTEST(radpro_engine, test_several_lines_in_one_chunk)
+{
+	submit("GET tubeRate", &replies[0]);
+	submit("GET tubePulseCount", &replies[1]);
+
+	uart_rx("OK 10.0\r\nOK 4242\r\n");
+
+	zassert_equal(replies[0].done_calls, 1);
+	zassert_mem_equal(replies[0].data, "OK 10.0\r\n", 9);
+	zassert_equal(replies[1].done_calls, 1);
+	zassert_mem_equal(replies[1].data, "OK 4242\r\n", 9);
+}
+
+ZTEST(radpro_engine, test_timeout_fails_command_and_resyncs)
+{
+	submit("GET deviceTime", &replies[0]);
+	submit("GET tubeRate", &replies[1]);
+
+	/* No answer */
+	test_uptime += TEST_TIMEOUT_MS;
+	timeout_work_handler(&timeout_work.work);
+
+	zassert_equal(replies[0].done_calls, 1);
+	zassert_equal(replies[0].status, -ETIMEDOUT);
+	zassert_equal(uart_bridge_send_fake.call_count, 1,
+		      "Next command waits for the resync period");
+
+	/* Late reply to the timed-out command is swallowed */
+	uart_rx("OK 1690000000\r\n");
+	zassert_equal(replies[1].data_calls, 0);
+	zassert_equal(unsolicited_len, 0);
+
+	/* Resync period ends */
+	test_uptime += RADPRO_RESYNC_MS;
+	timeout_work_handler(&timeout_work.work);
+
+	zassert_equal(uart_bridge_send_fake.call_count, 2);
+	zassert_mem_equal(uart_line, "GET tubeRate\r\n", 14);
+
+	uart_rx("OK 12.5\r\n");
+	zassert_equal(replies[1].status, 0);
+	zassert_mem_equal(replies[1].data, "OK 12.5\r\n", 9);
+}
+
+ZTEST(radpro_engine, test_late_timeout_run_spares_next_command)
+{
+	submit("GET deviceTime", &replies[0]);
+	submit("GET tubeRate", &replies[1]);
+
+	/* The timeout fires, but its run is held up on the engine lock while
+	 * the reply arrives and the next command is sent */
+	test_uptime += TEST_TIMEOUT_MS;
+	uart_rx("OK 1690000000\r\n");
+	zassert_equal(uart_bridge_send_fake.call_count, 2);
+
+	timeout_work_handler(&timeout_work.work);
+
+	zassert_equal(replies[0].status, 0);
+	zassert_equal(replies[1].done_calls, 0, "Next command must not time out");
+	zassert_equal(state, ENGINE_BUSY);
+
+	/* Its own timeout still applies */
+	test_uptime += TEST_TIMEOUT_MS;
+	timeout_work_handler(&timeout_work.work);
+	zassert_equal(replies[1].status, -ETIMEDOUT);
+}
+
+ZTEST(radpro_engine, test_late_timeout_run_spares_streaming_reply)
+{
+	submit("GET datalog", &replies[0]);
+
+	/* More of the reply re-arms the timeout while a run is under way */
+	test_uptime += TEST_TIMEOUT_MS;
+	uart_rx("OK time,tubePulseCount;;1690000000,");
+	timeout_work_handler(&timeout_work.work);
+
+	zassert_equal(replies[0].done_calls, 0);
+
+	uart_rx("1542\r\n");
+	zassert_equal(replies[0].status, 0);
+}
+
+ZTEST(radpro_engine, test_unsolicited_data_when_idle)
+{
+	uart_rx("hello\r\n");
+
+	zassert_equal(unsolicited_len, 7);
+	zassert_mem_equal(unsolicited, "hello\r\n", 7);
+}
+
+ZTEST(radpro_engine, test_queue_full)
+{
+	for (int i = 0; i < RADPRO_CMD_QUEUE_DEPTH; i++) {
+		zassert_equal(submit("GET tubeRate", &replies[i]), 0);
+	}
+
+	zassert_equal(submit("GET tubeRate", &replies[RADPRO_CMD_QUEUE_DEPTH]),
+		      -ENOSPC);
+}
+
+ZTEST(radpro_engine, test_uart_send_failure_fails_command)
+{
+	uart_bridge_send_fake.custom_fake = NULL;
+	uart_bridge_send_fake.return_val = -ENOMEM;
+
+	submit("GET tubeRate", &replies[0]);
+
+	zassert_equal(replies[0].done_calls, 1);
+	zassert_equal(replies[0].status, -ENOMEM);
+	zassert_equal(radpro_engine_pending(), 0);
+}
+
+ZTEST(radpro_engine, test_local_command_answered_in_turn)
+{
+	submit("GET tubeRate", &replies[0]);
+	submit_local("GET datalog 5", &replies[1]);
+	submit("GET deviceTime", &replies[2]);
+
+	zassert_equal(k_work_submit_to_queue_fake.call_count, 0,
+		      "Waits for the command ahead of it");
+
+	uart_rx("OK 10.0\r\n");
+
+	zassert_equal(k_work_submit_to_queue_fake.call_count, 1);
+	zassert_equal(uart_bridge_send_fake.call_count, 1, "UART idle meanwhile");
+	zassert_equal(local_calls, 0, "Runs on the work queue, not in the caller");
+
+	run_local_work();
+
+	zassert_equal(local_calls, 1);
+	zassert_equal(replies[1].done_calls, 1);
+	zassert_equal(replies[1].status, 0);
+	zassert_equal(replies[1].len, 18);
+	zassert_mem_equal(replies[1].data, "OK GET datalog 5\r\n", 18);
+
+	/* The next command goes out once the local one is done */
+	zassert_equal(uart_bridge_send_fake.call_count, 2);
+	zassert_mem_equal(uart_line, "GET deviceTime\r\n", 16);
+	zassert_equal(radpro_engine_pending(), 1);
+}
+
+ZTEST(radpro_engine, test_local_command_status)
+{
+	local_status = -EIO;
+	submit_local("GET datalog", &replies[0]);
+
+	zassert_equal(k_work_submit_to_queue_fake.call_count, 1, "Starts at once when idle");
+
+	run_local_work();
+
+	zassert_equal(replies[0].status, -EIO);
+	zassert_equal(radpro_engine_pending(), 0);
+}
+
+ZTEST(radpro_engine, test_uart_output_during_local_command_unsolicited)
+{
+	submit_local("GET datalog", &replies[0]);
+
+	uart_rx("hello\r\n");
+
+	zassert_equal(unsolicited_len, 7);
+	zassert_equal(replies[0].data_calls, 0);
+}
+
+ZTEST(radpro_engine, test_local_command_validated)
+{
+	zassert_equal(submit_local("\r\n", &replies[0]), -EINVAL);
+	zassert_equal(k_work_submit_to_queue_fake.call_count, 0);
+}
+
+ZTEST(radpro_engine, test_latency_stages_recorded)
+{
+	test_cycles = 100;
+	submit_timed("GET tubeRate", &replies[0]);
+	test_cycles = 250;
+	submit_timed("GET deviceId", &replies[1]);
+
+	/* Only the command written to the UART has left the queue */
+	zassert_equal(radpro_latency_record_fake.call_count, 1);
+	zassert_equal(radpro_latency_record_fake.arg0_val, RADPRO_LATENCY_QUEUE);
+	zassert_equal(radpro_latency_record_fake.arg1_val, 100);
+	zassert_equal(radpro_latency_record_fake.arg2_val, 100);
+
+	test_cycles = 1000;
+	uart_rx("OK 1");
+	zassert_equal(radpro_latency_record_fake.call_count, 2);
+	zassert_equal(radpro_latency_record_fake.arg0_val, RADPRO_LATENCY_DEVICE);
+	zassert_equal(radpro_latency_record_fake.arg1_val, 100);
+	zassert_equal(radpro_latency_record_fake.arg2_val, 1000);
+
+	/* Later chunks of the same reply are not a new first byte */
+	test_cycles = 1500;
+	uart_rx("2.5");
+	zassert_equal(radpro_latency_record_fake.call_count, 2);
+
+	test_cycles = 2000;
+	uart_rx("\r\n");
+	zassert_equal(replies[0].done_calls, 1);
+
+	/* Reply and total for the first, then the second leaves the queue */
+	zassert_equal(radpro_latency_record_fake.call_count, 5);
+	zassert_equal(radpro_latency_record_fake.arg0_history[2], RADPRO_LATENCY_REPLY);
+	zassert_equal(radpro_latency_record_fake.arg1_history[2], 1000);
+	zassert_equal(radpro_latency_record_fake.arg2_history[2], 2000);
+	zassert_equal(radpro_latency_record_fake.arg0_history[3], RADPRO_LATENCY_TOTAL);
+	zassert_equal(radpro_latency_record_fake.arg1_history[3], 100);
+	zassert_equal(radpro_latency_record_fake.arg2_history[3], 2000);
+	zassert_equal(radpro_latency_record_fake.arg0_history[4], RADPRO_LATENCY_QUEUE);
+	zassert_equal(radpro_latency_record_fake.arg1_history[4], 250);
+	zassert_equal(radpro_latency_record_fake.arg2_history[4], 2000);
+}
+
+ZTEST(radpro_engine, test_latency_not_recorded_for_bridge_polls)
+{
+	/* A sampler poll ahead of a client command */
+	test_cycles = 100;
+	submit("GET tubePulseCount", &replies[0]);
+	test_cycles = 250;
+	submit_timed("GET tubeRate", &replies[1]);
+	zassert_equal(radpro_latency_record_fake.call_count, 0);
+
+	test_cycles = 1000;
+	uart_rx("OK 1234\r\n");
+	zassert_equal(replies[0].done_calls, 1);
+
+	/* Only the client command's queue wait, which includes the poll */
+	zassert_equal(radpro_latency_record_fake.call_count, 1);
+	zassert_equal(radpro_latency_record_fake.arg0_val, RADPRO_LATENCY_QUEUE);
+	zassert_equal(radpro_latency_record_fake.arg1_val, 250);
+	zassert_equal(radpro_latency_record_fake.arg2_val, 1000);
+
+	test_cycles = 3000;
+	uart_rx("OK 2.5\r\n");
+	zassert_equal(replies[1].done_calls, 1);
+	zassert_equal(radpro_latency_record_fake.call_count, 4);
+	zassert_equal(radpro_latency_record_fake.arg0_history[3], RADPRO_LATENCY_TOTAL);
+	zassert_equal(radpro_latency_record_fake.arg1_history[3], 250);
+	zassert_equal(radpro_latency_record_fake.arg2_history[3], 3000);
+}
+
+ZTEST(radpro_engine, test_latency_not_recorded_for_local_commands)
+{
+	submit_local("GET cached", &replies[0]);
+	run_local_work();
+
+	zassert_equal(replies[0].done_calls, 1);
+	zassert_equal(radpro_latency_record_fake.call_count, 0);
+}
+
+ZTEST_SUITE(radpro_engine, NULL, NULL, NULL, NULL, NULL);
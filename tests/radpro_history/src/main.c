@@ -0,0 +1,217 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for radpro_history module.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/fff.h>
+#include <string.h>
+
+DEFINE_FFF_GLOBALS;
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+#include "radpro/radpro_sampler.h"
+
+/* FFF fakes — sampler */
+DECLARE_FAKE_VALUE_FUNC(int, radpro_sampler_add_listener, radpro_sample_cb_t);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_sampler_add_listener, radpro_sample_cb_t);
+
+/* k_mutex_lock/k_mutex_unlock are syscalls in kernel.h — use macro redirect */
+static int test_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+	return 0;
+}
+#define k_mutex_lock(mutex, timeout) test_k_mutex_lock(mutex, timeout)
+
+static int test_k_mutex_unlock(struct k_mutex *mutex)
+{
+	return 0;
+}
+#define k_mutex_unlock(mutex) test_k_mutex_unlock(mutex)
+
+/* Stub K_MUTEX_DEFINE — just declare the struct */
+#ifdef K_MUTEX_DEFINE
+#undef K_MUTEX_DEFINE
+#endif
+#define K_MUTEX_DEFINE(name) struct k_mutex name
+
+/* Include CUT */
+#include "radpro/radpro_history.c"
+
+/* Feed a sample through the registered listener */
+static void sample_at(int64_t uptime_ms, uint32_t raw_count, uint32_t cpm_x100)
+{
+	struct radpro_sample sample = {
+		.uptime_ms = uptime_ms,
+		.raw_count = raw_count,
+		.cpm_short_x100 = cpm_x100,
+	};
+
+	radpro_sampler_add_listener_fake.arg0_val(&sample);
+}
+
+static int count(uint8_t tier)
+{
+	struct radpro_history_point point;
+	uint32_t seq = 0;
+	int n = 0;
+
+	while (radpro_history_read(tier, &seq, &point) == 0) {
+		n++;
+	}
+	return n;
+}
+
+/* --- FFF reset rule --- */
+static void fff_reset_rule_before(const struct ztest_unit_test *test,
+				  void *fixture)
+{
+	RESET_FAKE(radpro_sampler_add_listener);
+	FFF_RESET_HISTORY();
+
+	zassert_ok(radpro_history_init());
+}
+
+ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
+
+/* --- Tests --- */
+
+ZTEST(radpro_history, test_init_subscribes_to_sampler)
+{
+	zassert_equal(radpro_sampler_add_listener_fake.call_count, 1);
+	zassert_equal(radpro_sampler_add_listener_fake.arg0_val, on_sample);
+}
+
+ZTEST(radpro_history, test_listener_slot_full)
+{
+	radpro_sampler_add_listener_fake.return_val = -ENOMEM;
+
+	zassert_equal(radpro_history_init(), -ENOMEM);
+}
+
+ZTEST(radpro_history, test_interval_stored_when_next_begins)
+{
+	struct radpro_history_point point;
+	uint32_t seq = 0;
+
+	sample_at(10000, 100, 1000);
+	sample_at(10500, 101, 3000);
+	zassert_equal(radpro_history_read(RADPRO_HISTORY_SECOND, &seq, &point), -ENODATA,
+		      "Interval still open");
+
+	sample_at(11000, 102, 2000);
+
+	zassert_ok(radpro_history_read(RADPRO_HISTORY_SECOND, &seq, &point));
+	zassert_equal(point.start_s, 10);
+	zassert_equal(point.raw_count, 101);
+	zassert_equal(point.cpm_min_x100, 1000);
+	zassert_equal(point.cpm_avg_x100, 2000);
+	zassert_equal(point.cpm_max_x100, 3000);
+	zassert_equal(seq, 1);
+	zassert_equal(radpro_history_read(RADPRO_HISTORY_SECOND, &seq, &point), -ENODATA);
+}
+
+ZTEST(radpro_history, test_coarse_tiers_downsample)
+{
+	struct radpro_history_point point;
+	uint32_t seq = 0;
+
+	/* One sample a second for two minutes from uptime 600 s */
+	for (int i = 0; i <= 120; i++) {
+		sample_at((600 + i) * 1000LL, i, i < 60 ? 100 * i : 500);
+	}
+
+	zassert_equal(count(RADPRO_HISTORY_SECOND), 120);
+	zassert_equal(count(RADPRO_HISTORY_MINUTE), 2);
+	zassert_equal(count(RADPRO_HISTORY_10MIN), 0);
+
+	zassert_ok(radpro_history_read(RADPRO_HISTORY_MINUTE, &seq, &point));
+	zassert_equal(point.start_s, 600);
+	zassert_equal(point.raw_count, 59);
+	zassert_equal(point.cpm_min_x100, 0);
+	zassert_equal(point.cpm_avg_x100, 2950);
+	zassert_equal(point.cpm_max_x100, 5900);
+
+	zassert_ok(radpro_history_read(RADPRO_HISTORY_MINUTE, &seq, &point));
+	zassert_equal(point.start_s, 660);
+	zassert_equal(point.cpm_min_x100, 500);
+	zassert_equal(point.cpm_max_x100, 500);
+}
+
+ZTEST(radpro_history, test_gap_leaves_no_empty_intervals)
+{
+	sample_at(5000, 1, 100);
+	sample_at(9000, 2, 100);
+	sample_at(10000, 3, 100);
+
+	zassert_equal(count(RADPRO_HISTORY_SECOND), 2);
+}
+
+ZTEST(radpro_history, test_ring_keeps_newest)
+{
+	struct radpro_history_point point;
+	uint32_t seq = 0;
+
+	for (int i = 0; i <= RADPRO_HISTORY_SECOND_LEN + 10; i++) {
+		sample_at(i * 1000LL, i, 100);
+	}
+
+	zassert_equal(count(RADPRO_HISTORY_SECOND), RADPRO_HISTORY_SECOND_LEN);
+	zassert_ok(radpro_history_read(RADPRO_HISTORY_SECOND, &seq, &point));
+	zassert_equal(point.start_s, 10, "Oldest ones overwritten");
+}
+
+ZTEST(radpro_history, test_slow_reader_skips_overwritten)
+{
+	struct radpro_history_point point;
+	uint32_t seq = 0;
+
+	sample_at(0, 0, 100);
+	sample_at(1000, 1, 100);
+	zassert_ok(radpro_history_read(RADPRO_HISTORY_SECOND, &seq, &point));
+	zassert_equal(point.start_s, 0);
+
+	for (int i = 2; i <= RADPRO_HISTORY_SECOND_LEN + 5; i++) {
+		sample_at(i * 1000LL, i, 100);
+	}
+
+	zassert_ok(radpro_history_read(RADPRO_HISTORY_SECOND, &seq, &point));
+	zassert_equal(point.start_s, 5);
+}
+
+ZTEST(radpro_history, test_periods_and_bad_tier)
+{
+	struct radpro_history_point point;
+	uint32_t seq = 0;
+
+	zassert_equal(radpro_history_period_s(RADPRO_HISTORY_SECOND), 1);
+	zassert_equal(radpro_history_period_s(RADPRO_HISTORY_MINUTE), 60);
+	zassert_equal(radpro_history_period_s(RADPRO_HISTORY_10MIN), 600);
+	zassert_equal(radpro_history_read(RADPRO_HISTORY_TIERS, &seq, &point), -EINVAL);
+}
+
+ZTEST_SUITE(radpro_history, NULL, NULL, NULL, NULL, NULL);
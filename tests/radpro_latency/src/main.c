@@ -0,0 +1,173 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for radpro_latency module.
+ */
+
+#include <zephyr/ztest.h>
+#include <string.h>
+
+/* Kconfig values */
+#define CONFIG_RADPRO_LATENCY 1
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+#ifdef LOG_DBG
+#undef LOG_DBG
+#endif
+#define LOG_DBG(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+/* Timestamps in the tests are microseconds — use macro redirect */
+#define k_cyc_to_us_floor32(cycles) (cycles)
+
+/* Include CUT */
+#include "radpro/radpro_latency.c"
+
+static uint32_t hist_count(const struct radpro_latency_hist *hist)
+{
+	uint32_t count = 0;
+
+	for (int b = 0; b < RADPRO_LATENCY_BUCKETS; b++) {
+		count += hist->buckets[b];
+	}
+
+	return count;
+}
+
+static void latency_before(void *fixture)
+{
+	radpro_latency_reset();
+}
+
+/* --- Tests --- */
+
+ZTEST(radpro_latency, test_bucket_boundaries)
+{
+	zassert_equal(bucket_of(0), 0);
+	zassert_equal(bucket_of(1), 0);
+	zassert_equal(bucket_of(2), 1);
+	zassert_equal(bucket_of(3), 1);
+	zassert_equal(bucket_of(4), 2);
+	zassert_equal(bucket_of(1023), 9);
+	zassert_equal(bucket_of(1024), 10);
+	zassert_equal(bucket_of(UINT32_MAX), RADPRO_LATENCY_BUCKETS - 1);
+}
+
+ZTEST(radpro_latency, test_record_fills_stage_only)
+{
+	struct radpro_latency_hist hist;
+
+	radpro_latency_record(RADPRO_LATENCY_DEVICE, 1000, 1300);
+	radpro_latency_record(RADPRO_LATENCY_DEVICE, 1000, 6000);
+
+	radpro_latency_get(RADPRO_LATENCY_DEVICE, &hist);
+	zassert_equal(hist_count(&hist), 2);
+	zassert_equal(hist.buckets[8], 1);
+	zassert_equal(hist.buckets[12], 1);
+	zassert_equal(hist.max_us, 5000);
+
+	radpro_latency_get(RADPRO_LATENCY_QUEUE, &hist);
+	zassert_equal(hist_count(&hist), 0);
+	zassert_equal(hist.max_us, 0);
+}
+
+ZTEST(radpro_latency, test_record_across_counter_wrap)
+{
+	struct radpro_latency_hist hist;
+
+	radpro_latency_record(RADPRO_LATENCY_TOTAL, UINT32_MAX - 99, 100);
+
+	radpro_latency_get(RADPRO_LATENCY_TOTAL, &hist);
+	zassert_equal(hist.max_us, 200);
+	zassert_equal(hist.buckets[7], 1);
+}
+
+ZTEST(radpro_latency, test_max_only_grows)
+{
+	struct radpro_latency_hist hist;
+
+	radpro_latency_record(RADPRO_LATENCY_REPLY, 0, 900);
+	radpro_latency_record(RADPRO_LATENCY_REPLY, 0, 50);
+
+	radpro_latency_get(RADPRO_LATENCY_REPLY, &hist);
+	zassert_equal(hist.max_us, 900);
+}
+
+ZTEST(radpro_latency, test_reset_clears_all_stages)
+{
+	struct radpro_latency_hist hist;
+
+	for (int i = 0; i < RADPRO_LATENCY_STAGES; i++) {
+		radpro_latency_record(i, 0, 10);
+	}
+
+	radpro_latency_reset();
+
+	for (int i = 0; i < RADPRO_LATENCY_STAGES; i++) {
+		radpro_latency_get(i, &hist);
+		zassert_equal(hist_count(&hist), 0);
+		zassert_equal(hist.max_us, 0);
+	}
+}
+
+ZTEST(radpro_latency, test_percentile_is_bucket_top)
+{
+	struct radpro_latency_hist hist;
+
+	/* 90 samples in [8, 16) us, 10 in [1024, 2048) us */
+	for (int i = 0; i < 90; i++) {
+		radpro_latency_record(RADPRO_LATENCY_TOTAL, 0, 10);
+	}
+	for (int i = 0; i < 10; i++) {
+		radpro_latency_record(RADPRO_LATENCY_TOTAL, 0, 1500);
+	}
+
+	radpro_latency_get(RADPRO_LATENCY_TOTAL, &hist);
+	zassert_equal(percentile_us(&hist, 100, 50), 15);
+	zassert_equal(percentile_us(&hist, 100, 90), 15);
+	zassert_equal(percentile_us(&hist, 100, 99), 1500);
+}
+
+ZTEST(radpro_latency, test_percentile_capped_at_max)
+{
+	struct radpro_latency_hist hist;
+
+	radpro_latency_record(RADPRO_LATENCY_QUEUE, 0, 1100);
+
+	radpro_latency_get(RADPRO_LATENCY_QUEUE, &hist);
+	zassert_equal(percentile_us(&hist, 1, 50), 1100);
+}
+
+ZTEST(radpro_latency, test_percentile_in_last_bucket_is_max)
+{
+	struct radpro_latency_hist hist;
+
+	radpro_latency_record(RADPRO_LATENCY_TOTAL, 0, UINT32_MAX);
+
+	radpro_latency_get(RADPRO_LATENCY_TOTAL, &hist);
+	zassert_equal(percentile_us(&hist, 1, 50), UINT32_MAX);
+}
+
+ZTEST_SUITE(radpro_latency, NULL, NULL, latency_before, NULL, NULL);
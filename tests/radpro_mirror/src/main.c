@@ -0,0 +1,624 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for radpro_mirror module.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/fff.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+
+DEFINE_FFF_GLOBALS;
+
+/* Kconfig values */
+#define CONFIG_RADPRO_MIRROR_PERIOD_S 300
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+/* Block FCB and flash map headers — modelled in RAM below */
+#define ZEPHYR_INCLUDE_FS_FCB_H_
+#define ZEPHYR_INCLUDE_STORAGE_FLASH_MAP_H_
+
+struct flash_sector {
+	off_t fs_off;
+	size_t fs_size;
+};
+
+struct flash_area {
+	size_t fa_size;
+};
+
+struct fcb {
+	uint32_t f_magic;
+	uint8_t f_version;
+	uint8_t f_sector_cnt;
+	uint8_t f_scratch_cnt;
+	struct flash_sector *f_sectors;
+	const struct flash_area *fap;
+};
+
+struct fcb_entry {
+	struct flash_sector *fe_sector;
+	uint32_t fe_elem_off;
+	uint32_t fe_data_off;
+	uint16_t fe_data_len;
+};
+
+struct fcb_entry_ctx {
+	struct fcb_entry loc;
+	const struct flash_area *fap;
+};
+
+typedef int (*fcb_walk_cb)(struct fcb_entry_ctx *loc_ctx, void *arg);
+
+#define FCB_ENTRY_FA_DATA_OFF(entry) ((entry).fe_sector->fs_off + (entry).fe_data_off)
+#define FIXED_PARTITION_ID(label) 0
+
+/*
+ * RAM model of the partition: 3 sectors of 4 entry slots each. Sectors
+ * fill up in ring order, fcb_rotate() drops the oldest one.
+ */
+#define TEST_SECTORS 3
+#define TEST_SLOTS 4
+#define TEST_SLOT_SIZE 256
+
+static uint8_t test_flash[TEST_SECTORS * TEST_SLOTS * TEST_SLOT_SIZE];
+static const struct flash_area test_fa = { .fa_size = sizeof(test_flash) };
+static uint16_t slot_len[TEST_SECTORS][TEST_SLOTS];  /* 0 if not written */
+static int first_sector;
+static int used_sectors;
+static int fcb_init_err;
+static int erase_count;
+
+static int flash_area_get_sectors(int fa_id, uint32_t *count, struct flash_sector *sectors)
+{
+	zassert_true(*count >= TEST_SECTORS);
+	for (int i = 0; i < TEST_SECTORS; i++) {
+		sectors[i].fs_off = i * TEST_SLOTS * TEST_SLOT_SIZE;
+		sectors[i].fs_size = TEST_SLOTS * TEST_SLOT_SIZE;
+	}
+	*count = TEST_SECTORS;
+	return 0;
+}
+
+static int flash_area_open(uint8_t id, const struct flash_area **fa)
+{
+	*fa = &test_fa;
+	return 0;
+}
+
+static void flash_area_close(const struct flash_area *fa)
+{
+}
+
+static int flash_area_erase(const struct flash_area *fa, off_t off, size_t len)
+{
+	memset(test_flash, 0xff, sizeof(test_flash));
+	erase_count++;
+	return 0;
+}
+
+static int flash_area_read(const struct flash_area *fa, off_t off, void *dst, size_t len)
+{
+	zassert_true(off + len <= sizeof(test_flash));
+	memcpy(dst, &test_flash[off], len);
+	return 0;
+}
+
+static int flash_area_write(const struct flash_area *fa, off_t off, const void *src,
+			    size_t len)
+{
+	zassert_true(off + len <= sizeof(test_flash));
+	memcpy(&test_flash[off], src, len);
+	return 0;
+}
+
+static int fcb_init(int f_area_id, struct fcb *fcbp)
+{
+	if (fcb_init_err) {
+		int err = fcb_init_err;
+
+		/* Only the first attempt fails */
+		fcb_init_err = 0;
+		return err;
+	}
+
+	zassert_equal(fcbp->f_sector_cnt, TEST_SECTORS);
+	fcbp->fap = &test_fa;
+	return 0;
+}
+
+static int fcb_is_empty(struct fcb *fcbp)
+{
+	return used_sectors == 0;
+}
+
+static int sector_entries(int sector)
+{
+	int n = 0;
+
+	while (n < TEST_SLOTS && slot_len[sector][n] != 0) {
+		n++;
+	}
+	return n;
+}
+
+static int fcb_append(struct fcb *fcbp, uint16_t len, struct fcb_entry *loc)
+{
+	int sector = (first_sector + used_sectors - 1) % TEST_SECTORS;
+	int slot;
+
+	zassert_true(len > 0 && len <= TEST_SLOT_SIZE);
+
+	if (used_sectors == 0 || sector_entries(sector) == TEST_SLOTS) {
+		if (used_sectors == TEST_SECTORS) {
+			return -ENOSPC;
+		}
+		used_sectors++;
+		sector = (first_sector + used_sectors - 1) % TEST_SECTORS;
+	}
+
+	slot = sector_entries(sector);
+	loc->fe_sector = &fcbp->f_sectors[sector];
+	loc->fe_elem_off = slot * TEST_SLOT_SIZE;
+	loc->fe_data_off = slot * TEST_SLOT_SIZE;
+	loc->fe_data_len = len;
+	return 0;
+}
+
+static int fcb_append_finish(struct fcb *fcbp, struct fcb_entry *loc)
+{
+	int sector = loc->fe_sector - fcbp->f_sectors;
+
+	slot_len[sector][loc->fe_data_off / TEST_SLOT_SIZE] = loc->fe_data_len;
+	return 0;
+}
+
+static int fcb_rotate(struct fcb *fcbp)
+{
+	memset(slot_len[first_sector], 0, sizeof(slot_len[first_sector]));
+	first_sector = (first_sector + 1) % TEST_SECTORS;
+	used_sectors--;
+	return 0;
+}
+
+static int fcb_clear(struct fcb *fcbp)
+{
+	memset(slot_len, 0, sizeof(slot_len));
+	first_sector = 0;
+	used_sectors = 0;
+	erase_count++;
+	return 0;
+}
+
+static int fcb_walk(struct fcb *fcbp, struct flash_sector *sector, fcb_walk_cb cb,
+		    void *cb_arg)
+{
+	struct fcb_entry_ctx ctx = { .fap = fcbp->fap };
+
+	for (int i = 0; i < used_sectors; i++) {
+		int s = (first_sector + i) % TEST_SECTORS;
+
+		for (int slot = 0; slot < sector_entries(s); slot++) {
+			ctx.loc.fe_sector = &fcbp->f_sectors[s];
+			ctx.loc.fe_data_off = slot * TEST_SLOT_SIZE;
+			ctx.loc.fe_data_len = slot_len[s][slot];
+			if (cb(&ctx, cb_arg)) {
+				return 0;
+			}
+		}
+	}
+	return 0;
+}
+
+#include "radpro/radpro_engine.h"
+#include "radpro/radpro_datalog.h"
+
+/* FFF fakes — protocol engine */
+DECLARE_FAKE_VALUE_FUNC(int, radpro_engine_submit, const char *, size_t,
+			uint32_t, radpro_data_cb_t, radpro_done_cb_t, void *);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_engine_submit, const char *, size_t,
+		       uint32_t, radpro_data_cb_t, radpro_done_cb_t, void *);
+
+/* FFF fakes — datalog parser, records are fed to the callback directly */
+DECLARE_FAKE_VOID_FUNC(radpro_datalog_enc_init, struct radpro_datalog_enc *);
+DEFINE_FAKE_VOID_FUNC(radpro_datalog_enc_init, struct radpro_datalog_enc *);
+
+DECLARE_FAKE_VOID_FUNC(radpro_datalog_enc_set_record_cb, struct radpro_datalog_enc *,
+		       radpro_datalog_record_cb_t, void *);
+DEFINE_FAKE_VOID_FUNC(radpro_datalog_enc_set_record_cb, struct radpro_datalog_enc *,
+		      radpro_datalog_record_cb_t, void *);
+
+DECLARE_FAKE_VOID_FUNC(radpro_datalog_enc_feed, struct radpro_datalog_enc *,
+		       const uint8_t *, size_t, radpro_data_cb_t, void *);
+DEFINE_FAKE_VOID_FUNC(radpro_datalog_enc_feed, struct radpro_datalog_enc *,
+		      const uint8_t *, size_t, radpro_data_cb_t, void *);
+
+/* FFF fakes — kernel work */
+DECLARE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+		       k_work_handler_t);
+DEFINE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+		      k_work_handler_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+			k_timeout_t);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+		       k_timeout_t);
+
+/* k_mutex_lock/k_mutex_unlock are syscalls in kernel.h — use macro redirect */
+static int test_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+	return 0;
+}
+#define k_mutex_lock(mutex, timeout) test_k_mutex_lock(mutex, timeout)
+
+static int test_k_mutex_unlock(struct k_mutex *mutex)
+{
+	return 0;
+}
+#define k_mutex_unlock(mutex) test_k_mutex_unlock(mutex)
+
+/* Stub K_MUTEX_DEFINE — just declare the struct */
+#ifdef K_MUTEX_DEFINE
+#undef K_MUTEX_DEFINE
+#endif
+#define K_MUTEX_DEFINE(name) struct k_mutex name
+
+/* Stub ARG_UNUSED if not available */
+#ifndef ARG_UNUSED
+#define ARG_UNUSED(x) (void)(x)
+#endif
+
+/* Include CUT */
+#include "radpro/radpro_mirror.c"
+
+/* Last fetch command, NUL-terminated */
+static char fetch_cmd[RADPRO_CMD_MAX_LEN + 1];
+
+static int radpro_engine_submit_capture(const char *cmd, size_t len, uint32_t timeout_ms,
+					radpro_data_cb_t data_cb, radpro_done_cb_t done_cb,
+					void *user_data)
+{
+	memcpy(fetch_cmd, cmd, len);
+	fetch_cmd[len] = '\0';
+	return 0;
+}
+
+/* Reply produced by radpro_mirror_serve() */
+static char served[2048];
+static size_t served_len;
+
+static void serve_out(const uint8_t *data, size_t len, void *user_data)
+{
+	zassert_equal(user_data, served, "user_data passed through");
+	zassert_true(served_len + len < sizeof(served));
+	memcpy(&served[served_len], data, len);
+	served_len += len;
+	served[served_len] = '\0';
+}
+
+static const char *serve(const char *cmd)
+{
+	served_len = 0;
+	served[0] = '\0';
+	zassert_ok(radpro_mirror_serve(cmd, strlen(cmd), serve_out, served));
+	return served;
+}
+
+static bool covers(const char *cmd)
+{
+	return radpro_mirror_covers(cmd, strlen(cmd));
+}
+
+/* Parsed item, as the encoder reports it */
+static void record(uint32_t time, uint32_t pulses)
+{
+	radpro_datalog_enc_set_record_cb_fake.arg1_val(RADPRO_DATALOG_RECORD, time, pulses,
+						       radpro_datalog_enc_set_record_cb_fake.arg2_val);
+}
+
+static void session(void)
+{
+	radpro_datalog_enc_set_record_cb_fake.arg1_val(RADPRO_DATALOG_SESSION, 0, 0,
+						       radpro_datalog_enc_set_record_cb_fake.arg2_val);
+}
+
+static void fetch_end(int status)
+{
+	radpro_engine_submit_fake.arg4_val(status, radpro_engine_submit_fake.arg5_val);
+}
+
+/* Fetch count records, one a minute from time */
+static void fetch(uint32_t time, int count)
+{
+	radpro_mirror_refresh();
+	for (int i = 0; i < count; i++) {
+		record(time + 60 * i, 1000 + i);
+	}
+	fetch_end(0);
+}
+
+/* --- FFF reset rule --- */
+static void fff_reset_rule_before(const struct ztest_unit_test *test,
+				  void *fixture)
+{
+	RESET_FAKE(radpro_engine_submit);
+	RESET_FAKE(radpro_datalog_enc_init);
+	RESET_FAKE(radpro_datalog_enc_set_record_cb);
+	RESET_FAKE(radpro_datalog_enc_feed);
+	RESET_FAKE(k_work_init_delayable);
+	RESET_FAKE(k_work_reschedule);
+	FFF_RESET_HISTORY();
+
+	radpro_engine_submit_fake.custom_fake = radpro_engine_submit_capture;
+	memset(fetch_cmd, 0, sizeof(fetch_cmd));
+	memset(test_flash, 0xff, sizeof(test_flash));
+	memset(slot_len, 0, sizeof(slot_len));
+	first_sector = 0;
+	used_sectors = 0;
+	fcb_init_err = 0;
+	erase_count = 0;
+
+	zassert_ok(radpro_mirror_init());
+}
+
+ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
+
+/* --- Tests --- */
+
+ZTEST(radpro_mirror, test_fresh_mirror_has_origin_marker)
+{
+	zassert_equal(used_sectors, 1);
+	zassert_equal(slot_len[0][0], sizeof(struct mirror_record));
+	zassert_true(is_marker((struct mirror_record *)test_flash, MARK_ORIGIN));
+	zassert_equal(newest_time, 0);
+	zassert_equal(floor_time, 0);
+}
+
+ZTEST(radpro_mirror, test_unreadable_partition_erased)
+{
+	memset(slot_len, 0, sizeof(slot_len));
+	used_sectors = 0;
+	fcb_init_err = -ENOMSG;
+
+	zassert_ok(radpro_mirror_init());
+	zassert_equal(erase_count, 1);
+	zassert_true(ready);
+}
+
+ZTEST(radpro_mirror, test_start_schedules_fetch)
+{
+	zassert_ok(radpro_mirror_start());
+
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+	zassert_equal(k_work_reschedule_fake.arg0_val, &fetch_work);
+	zassert_true(K_TIMEOUT_EQ(k_work_reschedule_fake.arg1_val, K_NO_WAIT));
+}
+
+ZTEST(radpro_mirror, test_first_fetch_gets_whole_log)
+{
+	radpro_mirror_refresh();
+
+	zassert_str_equal(fetch_cmd, "GET datalog");
+	zassert_equal(radpro_engine_submit_fake.arg3_val, fetch_data);
+	zassert_equal(radpro_datalog_enc_set_record_cb_fake.arg1_val, fetch_record);
+}
+
+ZTEST(radpro_mirror, test_next_fetch_continues_after_newest)
+{
+	fetch(1690000000, 3);
+	fetch(1690000180, 1);
+
+	zassert_str_equal(fetch_cmd, "GET datalog 1690000121");
+	zassert_equal(newest_time, 1690000180);
+}
+
+ZTEST(radpro_mirror, test_fetch_not_queued_twice)
+{
+	radpro_mirror_refresh();
+	radpro_mirror_refresh();
+
+	zassert_equal(radpro_engine_submit_fake.call_count, 1);
+
+	fetch_end(0);
+	radpro_mirror_refresh();
+	zassert_equal(radpro_engine_submit_fake.call_count, 2);
+}
+
+ZTEST(radpro_mirror, test_rejected_fetch_retried)
+{
+	radpro_engine_submit_fake.custom_fake = NULL;
+	radpro_engine_submit_fake.return_val = -ENOMEM;
+	radpro_mirror_refresh();
+
+	radpro_engine_submit_fake.custom_fake = radpro_engine_submit_capture;
+	radpro_mirror_refresh();
+
+	zassert_equal(radpro_engine_submit_fake.call_count, 2);
+}
+
+ZTEST(radpro_mirror, test_records_written_in_batches)
+{
+	radpro_mirror_refresh();
+	for (int i = 0; i < MIRROR_BATCH + 1; i++) {
+		record(1690000000 + 60 * i, i);
+	}
+
+	/* Origin marker and one full batch */
+	zassert_equal(slot_len[0][1], MIRROR_BATCH * sizeof(struct mirror_record));
+	zassert_equal(slot_len[0][2], 0, "Partial batch held until done");
+
+	fetch_end(0);
+	zassert_equal(slot_len[0][2], sizeof(struct mirror_record));
+	zassert_equal(newest_time, 1690000000 + 60 * MIRROR_BATCH);
+}
+
+ZTEST(radpro_mirror, test_already_mirrored_records_skipped)
+{
+	fetch(1690000000, 2);
+
+	/* Device answered with an overlapping range */
+	radpro_mirror_refresh();
+	record(1690000000, 1000);
+	record(1690000060, 1001);
+	record(1690000120, 1002);
+	fetch_end(0);
+
+	zassert_str_equal(serve("GET datalog"),
+			  "OK time,tubePulseCount;1690000000,1000;1690000060,1001;"
+			  "1690000120,1002\r\n");
+}
+
+ZTEST(radpro_mirror, test_not_covered_before_first_fetch)
+{
+	zassert_false(covers("GET datalog"));
+
+	radpro_mirror_refresh();
+	zassert_false(covers("GET datalog"), "Fetch still running");
+
+	fetch_end(0);
+	zassert_true(covers("GET datalog"));
+	zassert_true(covers("GET datalog 1690000000"));
+	zassert_true(covers("GET datalog 1690000000 1690000600"));
+}
+
+ZTEST(radpro_mirror, test_failed_fetch_keeps_records_but_not_synced)
+{
+	radpro_mirror_refresh();
+	record(1690000000, 1000);
+	fetch_end(-ETIMEDOUT);
+
+	zassert_false(covers("GET datalog"));
+	zassert_equal(newest_time, 1690000000);
+
+	radpro_mirror_refresh();
+	zassert_str_equal(fetch_cmd, "GET datalog 1690000001");
+}
+
+ZTEST(radpro_mirror, test_other_requests_not_covered)
+{
+	fetch(1690000000, 1);
+
+	zassert_false(covers("GET datalog 1690000000 1690000600 10"), "Record limit");
+	zassert_false(covers("GET datalogBin"));
+	zassert_false(covers("GET datalog x"));
+	zassert_false(covers("GET tubeRate"));
+}
+
+ZTEST(radpro_mirror, test_serve_formats_like_device)
+{
+	radpro_mirror_refresh();
+	session();
+	record(1690000000, 1542);
+	record(1690000060, 1560);
+	session();
+	record(1690000600, 1600);
+	fetch_end(0);
+
+	zassert_str_equal(serve("GET datalog"),
+			  "OK time,tubePulseCount;;1690000000,1542;1690000060,1560;"
+			  ";1690000600,1600\r\n");
+}
+
+ZTEST(radpro_mirror, test_serve_time_range)
+{
+	radpro_mirror_refresh();
+	session();
+	fetch_end(0);
+	fetch(1690000000, 5);
+
+	zassert_str_equal(serve("GET datalog 1690000060 1690000180"),
+			  "OK time,tubePulseCount;1690000060,1001;1690000120,1002;"
+			  "1690000180,1003\r\n");
+	zassert_str_equal(serve("GET datalog 1690000240"),
+			  "OK time,tubePulseCount;1690000240,1004\r\n");
+	zassert_str_equal(serve("GET datalog 1690001000"), "OK time,tubePulseCount\r\n");
+}
+
+ZTEST(radpro_mirror, test_serve_long_reply_in_chunks)
+{
+	fetch(1690000000, 3 * MIRROR_BATCH);
+
+	serve("GET datalog");
+
+	zassert_equal(served_len, strlen("OK time,tubePulseCount") +
+				  3 * MIRROR_BATCH * strlen(";1690000000,1000") + 2);
+	zassert_equal(strncmp(&served[served_len - 18], ";1690005700,1095\r\n", 18), 0);
+}
+
+ZTEST(radpro_mirror, test_rotation_raises_floor)
+{
+	/* 3 sectors of 4 entries: the 12th batch drops the first sector */
+	for (int i = 0; i < 11; i++) {
+		fetch(1690000000 + i * 60 * MIRROR_BATCH, MIRROR_BATCH);
+	}
+	zassert_equal(floor_time, 0);
+	zassert_true(covers("GET datalog 1"));
+
+	fetch(1690000000 + 11 * 60 * MIRROR_BATCH, MIRROR_BATCH);
+
+	/* Batches 0-2 were in the first sector with the origin marker */
+	zassert_equal(floor_time, 1690000000 + 3 * 60 * MIRROR_BATCH - 1);
+	zassert_false(covers("GET datalog 1"));
+	zassert_false(covers("GET datalog"));
+	zassert_true(covers("GET datalog 1690005760"));
+	zassert_equal(newest_time, 1690000000 + (12 * MIRROR_BATCH - 1) * 60);
+}
+
+ZTEST(radpro_mirror, test_extent_restored_on_init)
+{
+	fetch(1690000000, 3);
+
+	zassert_ok(radpro_mirror_init());
+
+	zassert_equal(used_sectors, 1, "Origin marker not appended again");
+	zassert_equal(newest_time, 1690000120);
+	zassert_false(covers("GET datalog"), "Not synced since boot");
+}
+
+ZTEST(radpro_mirror, test_clear_drops_records_and_refetches)
+{
+	for (int i = 0; i < 12; i++) {
+		fetch(1690000000 + i * 60 * MIRROR_BATCH, MIRROR_BATCH);
+	}
+	zassert_true(floor_time > 0);
+
+	zassert_ok(radpro_mirror_clear());
+
+	zassert_equal(erase_count, 1);
+	zassert_equal(newest_time, 0);
+	zassert_equal(floor_time, 0);
+	zassert_false(covers("GET datalog"), "Not synced with the new log");
+	zassert_str_equal(fetch_cmd, "GET datalog", "Whole new log fetched");
+
+	record(1690100000, 5);
+	fetch_end(0);
+
+	zassert_str_equal(serve("GET datalog"), "OK time,tubePulseCount;1690100000,5\r\n");
+}
+
+ZTEST_SUITE(radpro_mirror, NULL, NULL, NULL, NULL, NULL);
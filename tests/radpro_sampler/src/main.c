@@ -0,0 +1,286 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for radpro_sampler module.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/fff.h>
+#include <stdio.h>
+#include <string.h>
+
+DEFINE_FFF_GLOBALS;
+
+/* Kconfig values */
+#define CONFIG_RADPRO_SAMPLER_PERIOD_MS 1000
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+#ifdef LOG_DBG
+#undef LOG_DBG
+#endif
+#define LOG_DBG(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+#include "radpro/radpro_engine.h"
+
+/* FFF fakes — protocol engine */
+DECLARE_FAKE_VALUE_FUNC(int, radpro_engine_submit, const char *, size_t,
+			uint32_t, radpro_data_cb_t, radpro_done_cb_t, void *);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_engine_submit, const char *, size_t,
+		       uint32_t, radpro_data_cb_t, radpro_done_cb_t, void *);
+
+/* FFF fakes — kernel work */
+DECLARE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+			k_work_handler_t);
+DEFINE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
+		      k_work_handler_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+			k_timeout_t);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_reschedule, struct k_work_delayable *,
+		       k_timeout_t);
+
+/* k_uptime_get is static inline in kernel.h — override via macro redirect */
+static int64_t k_uptime_get_fake_return_val;
+static int64_t test_k_uptime_get(void)
+{
+	return k_uptime_get_fake_return_val;
+}
+#define k_uptime_get() test_k_uptime_get()
+
+/* k_mutex_lock/k_mutex_unlock are syscalls in kernel.h — use macro redirect */
+static int test_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+	return 0;
+}
+#define k_mutex_lock(mutex, timeout) test_k_mutex_lock(mutex, timeout)
+
+static int test_k_mutex_unlock(struct k_mutex *mutex)
+{
+	return 0;
+}
+#define k_mutex_unlock(mutex) test_k_mutex_unlock(mutex)
+
+/* Stub K_MUTEX_DEFINE — just declare the struct */
+#ifdef K_MUTEX_DEFINE
+#undef K_MUTEX_DEFINE
+#endif
+#define K_MUTEX_DEFINE(name) struct k_mutex name
+
+/* Stub ARG_UNUSED if not available */
+#ifndef ARG_UNUSED
+#define ARG_UNUSED(x) (void)(x)
+#endif
+
+/* Include CUT */
+#include "radpro/radpro_sampler.c"
+
+/* Listener capture */
+static struct radpro_sample last_sample;
+static int listener_calls;
+
+static void test_listener(const struct radpro_sample *sample)
+{
+	last_sample = *sample;
+	listener_calls++;
+}
+
+/* Advance time by one period and answer the poll with a pulse count */
+static void tick(uint32_t pulse_count)
+{
+	char line[24];
+
+	k_uptime_get_fake_return_val += CONFIG_RADPRO_SAMPLER_PERIOD_MS;
+	sample_work_handler(&sample_work.work);
+
+	snprintf(line, sizeof(line), "OK %u\r\n", pulse_count);
+	radpro_engine_submit_fake.arg3_val((const uint8_t *)line, strlen(line),
+					   NULL);
+	radpro_engine_submit_fake.arg4_val(0, NULL);
+}
+
+/* --- FFF reset rule --- */
+static void fff_reset_rule_before(const struct ztest_unit_test *test,
+				  void *fixture)
+{
+	RESET_FAKE(radpro_engine_submit);
+	RESET_FAKE(k_work_init_delayable);
+	RESET_FAKE(k_work_reschedule);
+	FFF_RESET_HISTORY();
+
+	k_uptime_get_fake_return_val = 100000;
+	memset(&last_sample, 0, sizeof(last_sample));
+	listener_calls = 0;
+
+	radpro_sampler_init();
+	radpro_sampler_add_listener(test_listener);
+}
+
+ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
+
+/* --- Tests --- */
+
+ZTEST(radpro_sampler, test_poll_submits_pulse_count_request)
+{
+	radpro_sampler_start();
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+
+	sample_work_handler(&sample_work.work);
+
+	zassert_equal(radpro_engine_submit_fake.call_count, 1);
+	zassert_equal(radpro_engine_submit_fake.arg1_val, 18);
+	zassert_mem_equal(radpro_engine_submit_fake.arg0_val, "GET tubePulseCount", 18);
+	zassert_true(K_TIMEOUT_EQ(k_work_reschedule_fake.arg1_val,
+				  K_MSEC(CONFIG_RADPRO_SAMPLER_PERIOD_MS)));
+}
+
+ZTEST(radpro_sampler, test_no_overlapping_requests)
+{
+	sample_work_handler(&sample_work.work);
+	sample_work_handler(&sample_work.work);
+
+	zassert_equal(radpro_engine_submit_fake.call_count, 1,
+		      "Previous request still pending");
+
+	radpro_engine_submit_fake.arg4_val(-ETIMEDOUT, NULL);
+	sample_work_handler(&sample_work.work);
+
+	zassert_equal(radpro_engine_submit_fake.call_count, 2);
+}
+
+ZTEST(radpro_sampler, test_first_reading_is_baseline)
+{
+	struct radpro_sample sample;
+
+	tick(1000);
+
+	zassert_equal(listener_calls, 0);
+	zassert_equal(radpro_sampler_get_latest(&sample), -ENODATA);
+}
+
+ZTEST(radpro_sampler, test_cpm_from_deltas)
+{
+	struct radpro_sample sample;
+
+	tick(1000);
+	tick(1010);  /* 10 pulses in 1 s = 600 CPM */
+
+	zassert_equal(listener_calls, 1);
+	zassert_equal(last_sample.delta, 10);
+	zassert_equal(last_sample.pulse_count, 10);
+	zassert_equal(last_sample.raw_count, 1010);
+	zassert_equal(last_sample.cpm_short_x100, 60000);
+	zassert_equal(last_sample.cpm_long_x100, 60000);
+
+	zassert_equal(radpro_sampler_get_latest(&sample), 0);
+	zassert_equal(sample.cpm_short_x100, 60000);
+}
+
+ZTEST(radpro_sampler, test_fractional_cpm)
+{
+	tick(0);
+	for (int i = 1; i <= 3; i++) {
+		tick(i == 3 ? 1 : 0);
+	}
+
+	/* 1 pulse in 3 s = 20 CPM */
+	zassert_equal(last_sample.cpm_short_x100, 2000);
+}
+
+ZTEST(radpro_sampler, test_sliding_windows)
+{
+	uint32_t count = 0;
+
+	tick(count);
+
+	/* 60 s at 60 CPM, then 10 s at 600 CPM */
+	for (int i = 0; i < 60; i++) {
+		count += 1;
+		tick(count);
+	}
+	for (int i = 0; i < 10; i++) {
+		count += 10;
+		tick(count);
+	}
+
+	zassert_equal(last_sample.cpm_short_x100, 60000,
+		      "Short window sees only the recent rate");
+	/* Long window: 50 + 100 pulses over 60 s = 150 CPM */
+	zassert_equal(last_sample.cpm_long_x100, 15000);
+}
+
+ZTEST(radpro_sampler, test_counter_wraparound)
+{
+	tick(UINT32_MAX - 4);
+	tick(5);  /* 10 pulses across the 2^32 boundary */
+
+	zassert_equal(listener_calls, 1);
+	zassert_equal(last_sample.delta, 10);
+	zassert_equal(last_sample.cpm_short_x100, 60000);
+}
+
+ZTEST(radpro_sampler, test_counter_reset_restarts_baseline)
+{
+	tick(500000);
+	tick(500010);
+	zassert_equal(listener_calls, 1);
+
+	/* Device restarted: count goes back to a small value */
+	tick(3);
+	zassert_equal(listener_calls, 1, "Reset is not reported as a sample");
+
+	tick(9);
+	zassert_equal(listener_calls, 2);
+	zassert_equal(last_sample.delta, 6);
+	zassert_equal(last_sample.pulse_count, 6);
+	zassert_equal(last_sample.cpm_short_x100, 36000);
+}
+
+ZTEST(radpro_sampler, test_malformed_response_ignored)
+{
+	tick(1000);
+
+	k_uptime_get_fake_return_val += CONFIG_RADPRO_SAMPLER_PERIOD_MS;
+	sample_work_handler(&sample_work.work);
+	radpro_engine_submit_fake.arg3_val((const uint8_t *)"OK abc\r\n", 8, NULL);
+	radpro_engine_submit_fake.arg4_val(0, NULL);
+
+	zassert_equal(listener_calls, 0);
+
+	tick(1010);
+	zassert_equal(listener_calls, 1);
+}
+
+ZTEST(radpro_sampler, test_listener_slots_limited)
+{
+	/* One slot taken by the fixture */
+	for (int i = 1; i < SAMPLER_MAX_LISTENERS; i++) {
+		zassert_equal(radpro_sampler_add_listener(test_listener), 0);
+	}
+
+	zassert_equal(radpro_sampler_add_listener(test_listener), -ENOMEM);
+}
+
+ZTEST_SUITE(radpro_sampler, NULL, NULL, NULL, NULL, NULL);
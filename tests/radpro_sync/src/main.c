@@ -0,0 +1,260 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for radpro_sync module.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/fff.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+DEFINE_FFF_GLOBALS;
+
+/* Kconfig values */
+#define CONFIG_BT_MAX_PAIRED 2
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+/* BT type stubs — block real BT headers */
+#include "bt_mocks.h"
+
+/* Block settings header */
+#include "kernel_mocks.h"
+
+typedef ssize_t (*settings_read_cb)(void *cb_arg, void *data, size_t len);
+
+/* Handler registered by the CUT, called directly to simulate settings_load() */
+#define SETTINGS_STATIC_HANDLER_DEFINE(_hname, _tree, _get, _set, _commit, _export) \
+	static int (*const registered_set)(const char *, size_t, settings_read_cb, \
+					   void *) = _set;                         \
+	static const char registered_tree[] = _tree
+
+static int settings_name_next(const char *name, const char **next)
+{
+	int len = 0;
+
+	*next = NULL;
+	while (name[len] != '\0' && name[len] != '=') {
+		if (name[len] == '/') {
+			*next = &name[len + 1];
+			break;
+		}
+		len++;
+	}
+	return len;
+}
+
+static inline bool bt_addr_le_eq(const bt_addr_le_t *a, const bt_addr_le_t *b)
+{
+	return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+/* lib/utils/hex.c is not part of the unittest build */
+static size_t test_bin2hex(const uint8_t *buf, size_t buflen, char *hex, size_t hexlen)
+{
+	if (hexlen < buflen * 2 + 1) {
+		return 0;
+	}
+	for (size_t i = 0; i < buflen; i++) {
+		sprintf(&hex[i * 2], "%02x", buf[i]);
+	}
+	return buflen * 2;
+}
+#define bin2hex test_bin2hex
+
+static size_t test_hex2bin(const char *hex, size_t hexlen, uint8_t *buf, size_t buflen)
+{
+	unsigned int byte;
+
+	if (hexlen % 2 || buflen < hexlen / 2) {
+		return 0;
+	}
+	for (size_t i = 0; i < hexlen / 2; i++) {
+		if (!isxdigit((unsigned char)hex[i * 2]) ||
+		    !isxdigit((unsigned char)hex[i * 2 + 1]) ||
+		    sscanf(&hex[i * 2], "%2x", &byte) != 1) {
+			return 0;
+		}
+		buf[i] = byte;
+	}
+	return hexlen / 2;
+}
+#define hex2bin test_hex2bin
+
+/* FFF fakes — settings */
+DECLARE_FAKE_VALUE_FUNC(int, settings_save_one, const char *, const void *, size_t);
+DEFINE_FAKE_VALUE_FUNC(int, settings_save_one, const char *, const void *, size_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, settings_delete, const char *);
+DEFINE_FAKE_VALUE_FUNC(int, settings_delete, const char *);
+
+/* FFF fakes — bonds */
+DECLARE_FAKE_VALUE_FUNC(bool, bt_le_bond_exists, uint8_t, const bt_addr_le_t *);
+DEFINE_FAKE_VALUE_FUNC(bool, bt_le_bond_exists, uint8_t, const bt_addr_le_t *);
+
+/* Include CUT */
+#include "radpro/radpro_sync.c"
+
+/* Last saved and deleted setting */
+static char saved_name[SYNC_NAME_SIZE];
+static uint32_t saved_value;
+static char deleted_name[SYNC_NAME_SIZE];
+
+static int settings_save_one_capture(const char *name, const void *value, size_t len)
+{
+	zassert_equal(len, sizeof(saved_value));
+	strncpy(saved_name, name, sizeof(saved_name) - 1);
+	memcpy(&saved_value, value, len);
+	return 0;
+}
+
+static int settings_delete_capture(const char *name)
+{
+	strncpy(deleted_name, name, sizeof(deleted_name) - 1);
+	return 0;
+}
+
+static ssize_t read_value(void *cb_arg, void *data, size_t len)
+{
+	memcpy(data, cb_arg, len);
+	return len;
+}
+
+/* Feed a stored setting back as settings_load() would */
+static int load(const char *key, uint32_t value)
+{
+	return registered_set(key, sizeof(value), read_value, &value);
+}
+
+static const bt_addr_le_t peer_a = { .type = 1, .a.val = { 0x56, 0x34, 0x12, 0xee, 0xff, 0xc0 } };
+static const bt_addr_le_t peer_b = { .type = 0, .a.val = { 1, 2, 3, 4, 5, 6 } };
+static const bt_addr_le_t peer_c = { .type = 0, .a.val = { 9, 9, 9, 9, 9, 9 } };
+
+/* --- FFF reset rule --- */
+static void fff_reset_rule_before(const struct ztest_unit_test *test,
+				  void *fixture)
+{
+	RESET_FAKE(settings_save_one);
+	RESET_FAKE(settings_delete);
+	RESET_FAKE(bt_le_bond_exists);
+	FFF_RESET_HISTORY();
+
+	settings_save_one_fake.custom_fake = settings_save_one_capture;
+	settings_delete_fake.custom_fake = settings_delete_capture;
+	bt_le_bond_exists_fake.return_val = true;
+	memset(saved_name, 0, sizeof(saved_name));
+	saved_value = 0;
+	memset(deleted_name, 0, sizeof(deleted_name));
+	memset(entries, 0, sizeof(entries));
+}
+
+ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
+
+/* --- Tests --- */
+
+ZTEST(radpro_sync, test_unknown_peer_syncs_from_scratch)
+{
+	zassert_equal(radpro_sync_get(&peer_a), 0);
+}
+
+ZTEST(radpro_sync, test_set_then_get)
+{
+	zassert_ok(radpro_sync_set(&peer_a, 1690000120));
+	zassert_ok(radpro_sync_set(&peer_b, 1690000060));
+
+	zassert_equal(radpro_sync_get(&peer_a), 1690000120);
+	zassert_equal(radpro_sync_get(&peer_b), 1690000060);
+
+	zassert_ok(radpro_sync_set(&peer_a, 1690000180));
+	zassert_equal(radpro_sync_get(&peer_a), 1690000180);
+}
+
+ZTEST(radpro_sync, test_saved_under_identity_address)
+{
+	radpro_sync_set(&peer_a, 1690000120);
+
+	zassert_equal(settings_save_one_fake.call_count, 1);
+	zassert_str_equal(saved_name, "radpro/sync/01563412eeffc0");
+	zassert_equal(saved_value, 1690000120);
+	zassert_str_equal(registered_tree, "radpro/sync");
+}
+
+ZTEST(radpro_sync, test_save_failure_reported)
+{
+	settings_save_one_fake.custom_fake = NULL;
+	settings_save_one_fake.return_val = -EIO;
+
+	zassert_equal(radpro_sync_set(&peer_a, 1690000120), -EIO);
+}
+
+ZTEST(radpro_sync, test_load_restores_cursor)
+{
+	/* Key as passed to the handler, relative to the tree */
+	zassert_ok(load("01563412eeffc0", 1690000120));
+
+	zassert_equal(radpro_sync_get(&peer_a), 1690000120);
+	zassert_equal(settings_save_one_fake.call_count, 0);
+}
+
+ZTEST(radpro_sync, test_load_ignores_malformed_keys)
+{
+	zassert_ok(load("01563412eeff", 1));
+	zassert_ok(load("01563412eeffzz", 2));
+	zassert_ok(load("01563412eeffc0/x", 3));
+
+	zassert_equal(radpro_sync_get(&peer_a), 0);
+	for (int i = 0; i < RADPRO_SYNC_MAX; i++) {
+		zassert_false(entries[i].used);
+	}
+}
+
+ZTEST(radpro_sync, test_deleted_bond_slot_reused)
+{
+	radpro_sync_set(&peer_a, 100);
+	radpro_sync_set(&peer_b, 200);
+
+	/* peer_a was unpaired, peer_c paired in its place */
+	bt_le_bond_exists_fake.return_val = false;
+	zassert_ok(radpro_sync_set(&peer_c, 300));
+
+	zassert_str_equal(deleted_name, "radpro/sync/01563412eeffc0");
+	zassert_equal(radpro_sync_get(&peer_a), 0);
+	zassert_equal(radpro_sync_get(&peer_c), 300);
+}
+
+ZTEST(radpro_sync, test_full_with_live_bonds)
+{
+	radpro_sync_set(&peer_a, 100);
+	radpro_sync_set(&peer_b, 200);
+
+	zassert_equal(radpro_sync_set(&peer_c, 300), -ENOMEM);
+	zassert_equal(settings_delete_fake.call_count, 0);
+	zassert_equal(radpro_sync_get(&peer_a), 100);
+	zassert_equal(radpro_sync_get(&peer_b), 200);
+}
+
+ZTEST_SUITE(radpro_sync, NULL, NULL, NULL, NULL, NULL);
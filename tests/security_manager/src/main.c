@@ -81,6 +81,12 @@ DECLARE_FAKE_VALUE_FUNC(int, k_work_schedule, struct k_work_delayable *,
 			k_timeout_t);
 DEFINE_FAKE_VALUE_FUNC(int, k_work_schedule, struct k_work_delayable *,
 		       k_timeout_t);
+/* FFF fakes — status channel */
+#include "status/app_status.h"
+
+DECLARE_FAKE_VOID_FUNC(app_status_set, enum app_status_flag, bool);
+DEFINE_FAKE_VOID_FUNC(app_status_set, enum app_status_flag, bool);
+
 /* k_uptime_get is static inline in kernel.h — override via macro redirect */
 static int64_t k_uptime_get_fake_return_val;
 static int k_uptime_get_fake_call_count;
@@ -95,6 +101,13 @@ static int64_t test_k_uptime_get(void)
 static bt_addr_le_t test_addr;
 static struct bt_conn test_conn;
 
+static int test_window_closed_calls;
+
+static void test_window_closed(void)
+{
+	test_window_closed_calls++;
+}
+
 /* Include CUT — its Zephyr #includes are blocked/stubbed */
 #include "security/security_manager.c"
 
@@ -112,6 +125,7 @@ static void fff_reset_rule_before(const struct ztest_unit_test *test,
 	RESET_FAKE(bt_security_err_to_str);
 	RESET_FAKE(k_work_init_delayable);
 	RESET_FAKE(k_work_schedule);
+	RESET_FAKE(app_status_set);
 	k_uptime_get_fake_return_val = 0;
 	k_uptime_get_fake_call_count = 0;
 	FFF_RESET_HISTORY();
@@ -120,6 +134,8 @@ static void fff_reset_rule_before(const struct ztest_unit_test *test,
 	pairing_allowed = true;
 	pairing_window_ms = 0;
 	pairing_window_end_time = 0;
+	window_closed_cb = NULL;
+	test_window_closed_calls = 0;
 
 	/* Default: bt_conn_get_dst returns valid address */
 	bt_conn_get_dst_fake.return_val = &test_addr;
@@ -159,6 +175,33 @@ ZTEST(security_manager, test_pairing_denied_after_window)
 	zassert_false(security_manager_is_pairing_allowed());
 }
 
+ZTEST(security_manager, test_pairing_window_published)
+{
+	security_manager_init(60000);
+
+	zassert_equal(app_status_set_fake.call_count, 1);
+	zassert_equal(app_status_set_fake.arg0_val, APP_STATUS_PAIRING_WINDOW);
+	zassert_true(app_status_set_fake.arg1_val);
+
+	pairing_timeout_handler(NULL);
+
+	zassert_equal(app_status_set_fake.call_count, 2);
+	zassert_equal(app_status_set_fake.arg0_val, APP_STATUS_PAIRING_WINDOW);
+	zassert_false(app_status_set_fake.arg1_val);
+}
+
+ZTEST(security_manager, test_window_closed_cb)
+{
+	security_manager_init(60000);
+	security_manager_set_window_closed_cb(test_window_closed);
+
+	zassert_equal(test_window_closed_calls, 0);
+
+	pairing_timeout_handler(NULL);
+
+	zassert_equal(test_window_closed_calls, 1);
+}
+
 ZTEST(security_manager, test_time_remaining_calculation)
 {
 	/* Init at uptime=1000 with 60s window → end_time=61000 */
@@ -0,0 +1,321 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for telemetry_adv module.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/fff.h>
+#include <string.h>
+
+DEFINE_FFF_GLOBALS;
+
+/* Kconfig values */
+#define CONFIG_BT_DEVICE_NAME "TestDevice"
+#define CONFIG_RADPRO_PER_ADV_INTERVAL_MS 1000
+#define CONFIG_RADPRO_RADIATION_SERVICE 1
+
+/* Stub logging before including CUT */
+#ifdef LOG_MODULE_REGISTER
+#undef LOG_MODULE_REGISTER
+#endif
+#define LOG_MODULE_REGISTER(...)
+
+#ifdef LOG_INF
+#undef LOG_INF
+#endif
+#define LOG_INF(...)
+
+#ifdef LOG_WRN
+#undef LOG_WRN
+#endif
+#define LOG_WRN(...)
+
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+#define LOG_ERR(...)
+
+/* Block Zephyr logging — prevent CUT from pulling in real logging */
+#define ZEPHYR_INCLUDE_LOGGING_LOG_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_CORE_H_
+
+/* BT type stubs */
+#include "bt_mocks.h"
+
+#include "ble/ble_service.h"
+#include "ble/radiation_service.h"
+#include "radpro/radpro_sampler.h"
+
+/* FFF fakes — extended / periodic advertising */
+DECLARE_FAKE_VALUE_FUNC(int, bt_le_ext_adv_create,
+			const struct bt_le_adv_param *,
+			const struct bt_le_ext_adv_cb *, struct bt_le_ext_adv **);
+DEFINE_FAKE_VALUE_FUNC(int, bt_le_ext_adv_create,
+		       const struct bt_le_adv_param *,
+		       const struct bt_le_ext_adv_cb *, struct bt_le_ext_adv **);
+
+DECLARE_FAKE_VALUE_FUNC(int, bt_le_ext_adv_set_data, struct bt_le_ext_adv *,
+			const struct bt_data *, size_t,
+			const struct bt_data *, size_t);
+DEFINE_FAKE_VALUE_FUNC(int, bt_le_ext_adv_set_data, struct bt_le_ext_adv *,
+		       const struct bt_data *, size_t,
+		       const struct bt_data *, size_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, bt_le_ext_adv_start, struct bt_le_ext_adv *,
+			const struct bt_le_ext_adv_start_param *);
+DEFINE_FAKE_VALUE_FUNC(int, bt_le_ext_adv_start, struct bt_le_ext_adv *,
+		       const struct bt_le_ext_adv_start_param *);
+
+DECLARE_FAKE_VALUE_FUNC(int, bt_le_per_adv_set_param, struct bt_le_ext_adv *,
+			const struct bt_le_per_adv_param *);
+DEFINE_FAKE_VALUE_FUNC(int, bt_le_per_adv_set_param, struct bt_le_ext_adv *,
+		       const struct bt_le_per_adv_param *);
+
+DECLARE_FAKE_VALUE_FUNC(int, bt_le_per_adv_set_data, const struct bt_le_ext_adv *,
+			const struct bt_data *, size_t);
+DEFINE_FAKE_VALUE_FUNC(int, bt_le_per_adv_set_data, const struct bt_le_ext_adv *,
+		       const struct bt_data *, size_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, bt_le_per_adv_start, struct bt_le_ext_adv *);
+DEFINE_FAKE_VALUE_FUNC(int, bt_le_per_adv_start, struct bt_le_ext_adv *);
+
+/* FFF fakes — sampler, radiation service, BLE service */
+DECLARE_FAKE_VALUE_FUNC(int, radpro_sampler_add_listener, radpro_sample_cb_t);
+DEFINE_FAKE_VALUE_FUNC(int, radpro_sampler_add_listener, radpro_sample_cb_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, radiation_service_get, enum radiation_value,
+			uint32_t *);
+DEFINE_FAKE_VALUE_FUNC(int, radiation_service_get, enum radiation_value,
+		       uint32_t *);
+
+/* Zero-arg function — manual stub */
+static int test_connection_count;
+int ble_service_connection_count(void)
+{
+	return test_connection_count;
+}
+
+/* FFF fakes — kernel work */
+DECLARE_FAKE_VOID_FUNC(k_work_init, struct k_work *, k_work_handler_t);
+DEFINE_FAKE_VOID_FUNC(k_work_init, struct k_work *, k_work_handler_t);
+
+DECLARE_FAKE_VALUE_FUNC(int, k_work_submit, struct k_work *);
+DEFINE_FAKE_VALUE_FUNC(int, k_work_submit, struct k_work *);
+
+/* k_mutex_lock/k_mutex_unlock are syscalls in kernel.h — use macro redirect */
+static int test_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+	return 0;
+}
+#define k_mutex_lock(mutex, timeout) test_k_mutex_lock(mutex, timeout)
+
+static int test_k_mutex_unlock(struct k_mutex *mutex)
+{
+	return 0;
+}
+#define k_mutex_unlock(mutex) test_k_mutex_unlock(mutex)
+
+/* Stub K_MUTEX_DEFINE — just declare the struct */
+#ifdef K_MUTEX_DEFINE
+#undef K_MUTEX_DEFINE
+#endif
+#define K_MUTEX_DEFINE(name) struct k_mutex name
+
+/* Stub ARG_UNUSED if not available */
+#ifndef ARG_UNUSED
+#define ARG_UNUSED(x) (void)(x)
+#endif
+
+/* Test state */
+static struct bt_le_ext_adv test_adv;
+static uint8_t per_data[128];
+static size_t per_data_len;
+static uint32_t test_battery_mv;
+
+static int bt_le_ext_adv_create_custom(const struct bt_le_adv_param *param,
+				       const struct bt_le_ext_adv_cb *cb,
+				       struct bt_le_ext_adv **adv)
+{
+	*adv = &test_adv;
+	return 0;
+}
+
+/* Capture the frame — the CUT passes a stack buffer */
+static int bt_le_per_adv_set_data_custom(const struct bt_le_ext_adv *adv,
+					 const struct bt_data *ad, size_t ad_len)
+{
+	per_data_len = MIN(ad[0].data_len, sizeof(per_data));
+	memcpy(per_data, ad[0].data, per_data_len);
+	return 0;
+}
+
+static int radiation_service_get_custom(enum radiation_value id,
+					uint32_t *value)
+{
+	if (id != RADIATION_BATTERY || !test_battery_mv) {
+		return -ENODATA;
+	}
+
+	*value = test_battery_mv;
+	return 0;
+}
+
+/* Include CUT */
+#include "ble/telemetry_adv.c"
+
+/* Frame field after the UUID */
+#define FIELD(offset) (&per_data[UUID_LEN + (offset)])
+
+static void sample(int64_t uptime_ms, uint64_t pulse_count, uint32_t delta,
+		   uint32_t cpm_x100)
+{
+	struct radpro_sample s = {
+		.uptime_ms = uptime_ms,
+		.pulse_count = pulse_count,
+		.delta = delta,
+		.cpm_short_x100 = cpm_x100,
+		.cpm_long_x100 = cpm_x100 / 2,
+	};
+
+	radpro_sampler_add_listener_fake.arg0_val(&s);
+	update_work_handler(&update_work);
+}
+
+/* --- FFF reset rule --- */
+static void fff_reset_rule_before(const struct ztest_unit_test *test,
+				  void *fixture)
+{
+	RESET_FAKE(bt_le_ext_adv_create);
+	RESET_FAKE(bt_le_ext_adv_set_data);
+	RESET_FAKE(bt_le_ext_adv_start);
+	RESET_FAKE(bt_le_per_adv_set_param);
+	RESET_FAKE(bt_le_per_adv_set_data);
+	RESET_FAKE(bt_le_per_adv_start);
+	RESET_FAKE(radpro_sampler_add_listener);
+	RESET_FAKE(radiation_service_get);
+	RESET_FAKE(k_work_init);
+	RESET_FAKE(k_work_submit);
+	FFF_RESET_HISTORY();
+
+	bt_le_ext_adv_create_fake.custom_fake = bt_le_ext_adv_create_custom;
+	bt_le_per_adv_set_data_fake.custom_fake = bt_le_per_adv_set_data_custom;
+	radiation_service_get_fake.custom_fake = radiation_service_get_custom;
+
+	/* Reset module state */
+	memset(&frame[UUID_LEN + 1], 0, TELEMETRY_FRAME_LEN - 1);
+	frame[UUID_LEN + 3] = TELEMETRY_HISTORY - 1;
+	have_first = false;
+	test_connection_count = 0;
+	test_battery_mv = 0;
+	memset(per_data, 0, sizeof(per_data));
+	per_data_len = 0;
+}
+
+ZTEST_RULE(fff_reset_rule, fff_reset_rule_before, NULL);
+
+/* --- Tests --- */
+
+ZTEST(telemetry_adv, test_init_starts_periodic_train)
+{
+	zassert_equal(telemetry_adv_init(), 0);
+
+	zassert_equal(bt_le_per_adv_set_param_fake.arg0_val, &test_adv);
+	zassert_equal(bt_le_per_adv_set_param_fake.arg1_val->interval_min, 800,
+		      "1000 ms in 1.25 ms units");
+	zassert_equal(bt_le_per_adv_start_fake.call_count, 1);
+	zassert_equal(bt_le_ext_adv_start_fake.call_count, 1);
+	zassert_equal(radpro_sampler_add_listener_fake.call_count, 1);
+
+	/* Initial frame is published before the train starts */
+	zassert_equal(per_data_len, UUID_LEN + TELEMETRY_FRAME_LEN);
+	zassert_equal(*FIELD(0), TELEMETRY_VERSION);
+}
+
+ZTEST(telemetry_adv, test_init_fails_without_adv_set)
+{
+	bt_le_ext_adv_create_fake.custom_fake = NULL;
+	bt_le_ext_adv_create_fake.return_val = -ENOMEM;
+
+	zassert_equal(telemetry_adv_init(), -ENOMEM);
+	zassert_equal(bt_le_per_adv_start_fake.call_count, 0);
+}
+
+ZTEST(telemetry_adv, test_frame_carries_uuid)
+{
+	const uint8_t uuid[] = { RADIATION_SVC_UUID_VAL };
+
+	telemetry_adv_init();
+
+	zassert_mem_equal(per_data, uuid, UUID_LEN);
+}
+
+ZTEST(telemetry_adv, test_sample_updates_frame)
+{
+	telemetry_adv_init();
+	test_battery_mv = 3952;
+	test_connection_count = 1;
+
+	sample(100000, 1010, 10, 60000);
+
+	zassert_equal(k_work_submit_fake.call_count, 1);
+	zassert_equal(*FIELD(1), 1, "Sequence number");
+	zassert_equal(*FIELD(2),
+		      TELEMETRY_STATUS_CONNECTED | TELEMETRY_STATUS_BATTERY);
+	zassert_equal(sys_get_le32(FIELD(4)), 60000);
+	zassert_equal(sys_get_le32(FIELD(8)), 30000);
+	zassert_equal(sys_get_le16(FIELD(20)), 3952);
+	zassert_equal(sys_get_le32(FIELD(22)), 0, "Device time unknown");
+}
+
+ZTEST(telemetry_adv, test_dose_accumulator)
+{
+	telemetry_adv_init();
+
+	sample(100000, 1010, 10, 60000);
+	zassert_equal(sys_get_le32(FIELD(12)), 10);
+	zassert_equal(sys_get_le32(FIELD(16)), 0);
+
+	sample(101000, 1015, 5, 30000);
+	sample(102000, 1025, 10, 45000);
+	zassert_equal(sys_get_le32(FIELD(12)), 25);
+	zassert_equal(sys_get_le32(FIELD(16)), 2);
+}
+
+ZTEST(telemetry_adv, test_dose_survives_counter_reset)
+{
+	telemetry_adv_init();
+
+	sample(100000, 1010, 10, 60000);
+	sample(101000, 1020, 10, 60000);
+
+	/* The sampler restarts pulse_count when the device's counter resets */
+	sample(103000, 4, 4, 24000);
+	zassert_equal(sys_get_le32(FIELD(12)), 24);
+	zassert_equal(sys_get_le32(FIELD(16)), 3);
+}
+
+ZTEST(telemetry_adv, test_history_ring)
+{
+	telemetry_adv_init();
+
+	for (int i = 0; i < TELEMETRY_HISTORY + 2; i++) {
+		sample(100000 + i * 1000, i, 1, (i + 1) * 100);
+	}
+
+	/* Newest at the head, oldest overwritten */
+	zassert_equal(*FIELD(3), 1);
+	zassert_equal(sys_get_le16(FIELD(TELEMETRY_HEADER_LEN + 2)),
+		      TELEMETRY_HISTORY + 2);
+	zassert_equal(sys_get_le16(FIELD(TELEMETRY_HEADER_LEN + 4)), 3);
+}
+
+ZTEST(telemetry_adv, test_history_saturates)
+{
+	telemetry_adv_init();
+
+	sample(100000, 1, 1, 10000000);
+
+	zassert_equal(sys_get_le16(FIELD(TELEMETRY_HEADER_LEN)), UINT16_MAX);
+}
+
+ZTEST_SUITE(telemetry_adv, NULL, NULL, NULL, NULL, NULL);
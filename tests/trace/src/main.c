@@ -0,0 +1,86 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for trace module.
+ */
+
+#include <zephyr/ztest.h>
+#include <string.h>
+
+/* Kconfig values */
+#define CONFIG_RADPRO_TRACE 1
+#define CONFIG_RADPRO_TRACE_RECORDS 4
+#define CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC 32768
+
+/* k_cycle_get_32 is inline in kernel.h — use macro redirect */
+static uint32_t test_cycles;
+#define k_cycle_get_32() (test_cycles)
+
+/* Include CUT */
+#include "trace/trace.c"
+
+static void trace_before(void *fixture)
+{
+	memset(radpro_trace.records, 0, sizeof(radpro_trace.records));
+	atomic_clear(&radpro_trace.head);
+	test_cycles = 0;
+}
+
+/* --- Tests --- */
+
+ZTEST(trace, test_ring_header_for_host)
+{
+	zassert_str_equal(radpro_trace.magic, "RPTRACE");
+	zassert_equal(radpro_trace.record_size, 16);
+	zassert_equal(radpro_trace.record_count, 4);
+	zassert_equal(radpro_trace.cycles_per_sec, 32768);
+}
+
+ZTEST(trace, test_event_recorded)
+{
+	const struct trace_record *rec = &radpro_trace.records[0];
+
+	test_cycles = 1234;
+	trace_event(TRACE_UART_TX, "GET", 3);
+
+	zassert_equal(atomic_get(&radpro_trace.head), 1);
+	zassert_equal(rec->cycles, 1234);
+	zassert_equal(rec->event, TRACE_UART_TX);
+	zassert_equal(rec->len, 3);
+	zassert_mem_equal(rec->data, "GET", 3);
+}
+
+ZTEST(trace, test_long_data_truncated)
+{
+	const struct trace_record *rec = &radpro_trace.records[0];
+
+	trace_event(TRACE_UART_TO_BLE, "OK Bosean FS-600\r\n", 18);
+
+	zassert_equal(rec->len, 18);
+	zassert_mem_equal(rec->data, "OK Bosea", TRACE_DATA_LEN);
+}
+
+ZTEST(trace, test_argument_without_data)
+{
+	const struct trace_record *rec = &radpro_trace.records[0];
+
+	trace_event(TRACE_UART_RX_STOPPED, NULL, 2);
+
+	zassert_equal(rec->event, TRACE_UART_RX_STOPPED);
+	zassert_equal(rec->len, 2);
+}
+
+ZTEST(trace, test_ring_wraps_over_oldest)
+{
+	for (uint32_t i = 0; i < 6; i++) {
+		test_cycles = i;
+		trace_event(TRACE_UART_RX_RDY, NULL, i);
+	}
+
+	/* Head keeps counting, slots 0 and 1 hold events 4 and 5 */
+	zassert_equal(atomic_get(&radpro_trace.head), 6);
+	zassert_equal(radpro_trace.records[0].cycles, 4);
+	zassert_equal(radpro_trace.records[1].cycles, 5);
+	zassert_equal(radpro_trace.records[2].cycles, 2);
+}
+
+ZTEST_SUITE(trace, NULL, NULL, trace_before, NULL, NULL);
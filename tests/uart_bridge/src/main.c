@@ -45,6 +45,45 @@ DEFINE_FFF_GLOBALS;
 /* UART type stubs */
 #include "uart_mocks.h"
 
+/* Test the production RX mode (Kconfig default) */
+#define CONFIG_RADPRO_UART_RX_CONTINUOUS 1
+#define CONFIG_RADPRO_METRICS 1
+#define CONFIG_RADPRO_TRACE 1
+
+#include "metrics/metrics.h"
+
+/* FFF fakes — metrics */
+DECLARE_FAKE_VOID_FUNC(metrics_add, enum metrics_id, uint32_t);
+DEFINE_FAKE_VOID_FUNC(metrics_add, enum metrics_id, uint32_t);
+
+DECLARE_FAKE_VOID_FUNC(metrics_set, enum metrics_id, uint32_t);
+DEFINE_FAKE_VOID_FUNC(metrics_set, enum metrics_id, uint32_t);
+
+#include "trace/trace.h"
+
+/* FFF fakes — trace */
+DECLARE_FAKE_VOID_FUNC(trace_event, enum trace_event_id, const void *, size_t);
+DEFINE_FAKE_VOID_FUNC(trace_event, enum trace_event_id, const void *, size_t);
+
+#include "status/app_status.h"
+
+/* FFF fakes — status channel */
+DECLARE_FAKE_VOID_FUNC(app_status_set, enum app_status_flag, bool);
+DEFINE_FAKE_VOID_FUNC(app_status_set, enum app_status_flag, bool);
+
+/* Total added to a counter */
+static uint32_t metrics_added(enum metrics_id id)
+{
+	uint32_t sum = 0;
+
+	for (unsigned int i = 0; i < metrics_add_fake.call_count; i++) {
+		if (metrics_add_fake.arg0_history[i] == id) {
+			sum += metrics_add_fake.arg1_history[i];
+		}
+	}
+	return sum;
+}
+
 /* Provide the test UART device referenced by DEVICE_DT_GET */
 static struct device test_uart_device = { .name = "test_uart" };
 
@@ -75,30 +114,54 @@ DECLARE_FAKE_VALUE_FUNC(int, uart_rx_buf_rsp, const struct device *,
 DEFINE_FAKE_VALUE_FUNC(int, uart_rx_buf_rsp, const struct device *,
 		       uint8_t *, size_t);
 
-/* k_malloc and k_free are provided by the unit test kernel — use macro redirect */
-static void *k_malloc_fake_return_val;
-static int k_malloc_fake_call_count;
-static void *(*k_malloc_fake_custom_fake)(size_t);
-static void *test_k_malloc(size_t size)
+/* k_mem_slab_alloc/k_mem_slab_free — use macro redirect so the test can
+ * hand out buffers from a local pool and simulate exhaustion per slab */
+static int k_mem_slab_alloc_fake_call_count;
+static int (*k_mem_slab_alloc_fake_custom_fake)(struct k_mem_slab *, void **);
+static int test_k_mem_slab_alloc(struct k_mem_slab *slab, void **mem,
+				 k_timeout_t timeout)
 {
-	k_malloc_fake_call_count++;
-	if (k_malloc_fake_custom_fake) {
-		return k_malloc_fake_custom_fake(size);
+	k_mem_slab_alloc_fake_call_count++;
+	if (k_mem_slab_alloc_fake_custom_fake) {
+		return k_mem_slab_alloc_fake_custom_fake(slab, mem);
 	}
-	return k_malloc_fake_return_val;
+	*mem = NULL;
+	return -ENOMEM;
 }
-#define k_malloc(size) test_k_malloc(size)
+#define k_mem_slab_alloc(slab, mem, timeout) test_k_mem_slab_alloc(slab, mem, timeout)
 
-static int k_free_fake_call_count;
-static void (*k_free_fake_custom_fake)(void *);
-static void test_k_free(void *ptr)
+static int k_mem_slab_free_fake_call_count;
+static void test_k_mem_slab_free(struct k_mem_slab *slab, void *mem)
 {
-	k_free_fake_call_count++;
-	if (k_free_fake_custom_fake) {
-		k_free_fake_custom_fake(ptr);
-	}
+	k_mem_slab_free_fake_call_count++;
 }
-#define k_free(ptr) test_k_free(ptr)
+#define k_mem_slab_free(slab, mem) test_k_mem_slab_free(slab, mem)
+
+/* Stub K_MEM_SLAB_DEFINE_STATIC — just declare the struct */
+#ifdef K_MEM_SLAB_DEFINE_STATIC
+#undef K_MEM_SLAB_DEFINE_STATIC
+#endif
+#define K_MEM_SLAB_DEFINE_STATIC(name, size, num, align) static struct k_mem_slab name
+
+/* k_sem_give/k_sem_take are syscalls in kernel.h — use macro redirect */
+static int k_sem_give_fake_call_count;
+static void test_k_sem_give(struct k_sem *sem)
+{
+	k_sem_give_fake_call_count++;
+}
+#define k_sem_give(sem) test_k_sem_give(sem)
+
+static int test_k_sem_take(struct k_sem *sem, k_timeout_t timeout)
+{
+	return 0;
+}
+#define k_sem_take(sem, timeout) test_k_sem_take(sem, timeout)
+
+/* Stub K_SEM_DEFINE — just declare the struct */
+#ifdef K_SEM_DEFINE
+#undef K_SEM_DEFINE
+#endif
+#define K_SEM_DEFINE(name, initial, limit) struct k_sem name
 
 /* FFF fakes — kernel work */
 DECLARE_FAKE_VOID_FUNC(k_work_init_delayable, struct k_work_delayable *,
@@ -159,22 +222,22 @@ DEFINE_FAKE_VALUE_FUNC(void *, k_fifo_get, struct k_fifo *, k_timeout_t);
 #define ARG_UNUSED(x) (void)(x)
 #endif
 
-/* Memory pool for k_malloc — provides real allocations for send tests */
+/* Backing memory for slab allocations — provides real buffers for send tests */
 #define TEST_BUF_POOL_SIZE 16
-static uint8_t test_buf_pool[TEST_BUF_POOL_SIZE][280]; /* > sizeof uart_data_t */
+static uint8_t test_buf_pool[TEST_BUF_POOL_SIZE][288] __aligned(8); /* > sizeof uart_data_t */
 static int test_buf_idx;
 
-static void *k_malloc_from_pool(size_t size)
-{
-	if (test_buf_idx < TEST_BUF_POOL_SIZE && size <= sizeof(test_buf_pool[0])) {
-		return test_buf_pool[test_buf_idx++];
-	}
-	return NULL;
-}
+/* Slab that reports exhaustion (NULL = none) */
+static struct k_mem_slab *test_exhausted_slab;
 
-static void k_free_noop(void *ptr)
+static int k_mem_slab_alloc_from_pool(struct k_mem_slab *slab, void **mem)
 {
-	(void)ptr;
+	if (slab != test_exhausted_slab && test_buf_idx < TEST_BUF_POOL_SIZE) {
+		*mem = test_buf_pool[test_buf_idx++];
+		return 0;
+	}
+	*mem = NULL;
+	return -ENOMEM;
 }
 
 /* Capture uart_tx calls */
@@ -214,27 +277,38 @@ static void fff_reset_rule_before(const struct ztest_unit_test *test,
 	RESET_FAKE(uart_rx_enable);
 	RESET_FAKE(uart_rx_disable);
 	RESET_FAKE(uart_rx_buf_rsp);
-	k_malloc_fake_return_val = NULL;
-	k_malloc_fake_call_count = 0;
-	k_malloc_fake_custom_fake = k_malloc_from_pool;
-	k_free_fake_call_count = 0;
-	k_free_fake_custom_fake = k_free_noop;
+	k_mem_slab_alloc_fake_call_count = 0;
+	k_mem_slab_alloc_fake_custom_fake = k_mem_slab_alloc_from_pool;
+	k_mem_slab_free_fake_call_count = 0;
 	RESET_FAKE(k_work_init_delayable);
 	RESET_FAKE(k_work_reschedule);
 	RESET_FAKE(k_fifo_put);
 	RESET_FAKE(k_fifo_get);
 	k_sleep_fake_return_val = 0;
 	k_sleep_fake_call_count = 0;
+	RESET_FAKE(metrics_add);
+	RESET_FAKE(metrics_set);
+	RESET_FAKE(trace_event);
+	RESET_FAKE(app_status_set);
 	FFF_RESET_HISTORY();
 
 	/* Reset module state */
 	uart = NULL;
 	uart_initialized = false;
 	data_received_callback = NULL;
-	uart_log_count = 0;
+	atomic_clear(&tx_pool.in_use);
+	atomic_clear(&tx_pool.high_water);
+	atomic_clear(&tx_pool.exhausted);
+	rx_ring_init(&rx_ring, rx_ring_buf, sizeof(rx_ring_buf));
+	rx_dma_pos = 0;
+	atomic_clear(&rx_stalled);
+	atomic_clear(&rx_high_water);
+	atomic_clear(&rx_ring_full);
+	k_sem_give_fake_call_count = 0;
 
 	/* Reset test state */
 	test_buf_idx = 0;
+	test_exhausted_slab = NULL;
 	memset(captured_tx_data, 0, sizeof(captured_tx_data));
 	captured_tx_len = 0;
 	rx_cb_called = false;
@@ -260,6 +334,9 @@ ZTEST(uart_bridge, test_init_enables_rx)
 	zassert_true(uart_rx_enable_fake.call_count >= 1,
 		     "uart_rx_enable should be called during init");
 	zassert_true(uart_initialized);
+	zassert_equal(app_status_set_fake.call_count, 1);
+	zassert_equal(app_status_set_fake.arg0_val, APP_STATUS_UART_READY);
+	zassert_true(app_status_set_fake.arg1_val);
 }
 
 ZTEST(uart_bridge, test_init_no_device_fails)
@@ -270,6 +347,7 @@ ZTEST(uart_bridge, test_init_no_device_fails)
 
 	zassert_equal(err, -ENODEV);
 	zassert_false(uart_initialized);
+	zassert_equal(app_status_set_fake.call_count, 0);
 }
 
 ZTEST(uart_bridge, test_send_small_data)
@@ -279,7 +357,6 @@ ZTEST(uart_bridge, test_send_small_data)
 	RESET_FAKE(uart_tx);
 	uart_tx_fake.return_val = 0;
 	test_buf_idx = 0;
-	k_malloc_fake_custom_fake = k_malloc_from_pool;
 
 	uint8_t data[] = "hello";
 	int err = uart_bridge_send(data, 5);
@@ -294,7 +371,6 @@ ZTEST(uart_bridge, test_send_large_data_chunked)
 	RESET_FAKE(uart_tx);
 	uart_tx_fake.return_val = 0;
 	test_buf_idx = 0;
-	k_malloc_fake_custom_fake = k_malloc_from_pool;
 
 	/* 300 bytes > UART_BUF_SIZE-1 (255), should be split */
 	uint8_t data[300];
@@ -314,7 +390,6 @@ ZTEST(uart_bridge, test_cr_gets_lf_appended)
 	uart_tx_fake.custom_fake = uart_tx_capture;
 	captured_tx_len = 0;
 	test_buf_idx = 0;
-	k_malloc_fake_custom_fake = k_malloc_from_pool;
 
 	uint8_t data[] = "test\r";
 	int err = uart_bridge_send(data, 5);
@@ -349,20 +424,280 @@ ZTEST(uart_bridge, test_rx_callback_invoked)
 	zassert_equal(data_received_callback, test_rx_callback);
 }
 
-ZTEST(uart_bridge, test_buf_alloc_failure_reschedules)
+ZTEST(uart_bridge, test_rx_rearm_failure_reschedules)
 {
 	uart_bridge_init(test_rx_callback);
-	k_malloc_fake_custom_fake = NULL;
-	k_malloc_fake_return_val = NULL;
-	k_malloc_fake_call_count = 0;
+	uart_rx_enable_fake.return_val = -EBUSY;
 	RESET_FAKE(k_work_reschedule);
 
 	/* Simulate UART_RX_DISABLED event — calls uart_cb */
 	struct uart_event evt = { .type = UART_RX_DISABLED };
 	uart_cb(uart, &evt, NULL);
 
-	/* Should reschedule work when malloc fails */
+	/* Should reschedule work when RX cannot be re-armed */
 	zassert_equal(k_work_reschedule_fake.call_count, 1);
 }
 
+/* Deliver an RX_RDY span written by "DMA" at the ring write index */
+static void rx_rdy(const char *text)
+{
+	size_t len = strlen(text);
+	uint32_t offset = rx_ring_head(&rx_ring) & (UART_RX_RING_SIZE - 1);
+	struct uart_event evt = { .type = UART_RX_RDY };
+
+	memcpy(&rx_ring_buf[offset], text, len);
+	evt.data.rx.buf = rx_ring_buf;
+	evt.data.rx.offset = offset;
+	evt.data.rx.len = len;
+	uart_cb(uart, &evt, NULL);
+}
+
+ZTEST(uart_bridge, test_rx_buf_request_claims_next_ring_chunk)
+{
+	uart_bridge_init(test_rx_callback);
+	RESET_FAKE(uart_rx_buf_rsp);
+
+	/* Init armed RX on the first chunk */
+	zassert_equal(uart_rx_enable_fake.arg1_val, rx_ring_buf);
+
+	struct uart_event evt = { .type = UART_RX_BUF_REQUEST };
+
+	uart_cb(uart, &evt, NULL);
+	zassert_equal(uart_rx_buf_rsp_fake.arg1_val, &rx_ring_buf[UART_RX_DMA_CHUNK]);
+
+	uart_cb(uart, &evt, NULL);
+	zassert_equal(uart_rx_buf_rsp_fake.arg1_val, &rx_ring_buf[2 * UART_RX_DMA_CHUNK]);
+	zassert_equal(uart_rx_buf_rsp_fake.arg2_val, UART_RX_DMA_CHUNK);
+}
+
+ZTEST(uart_bridge, test_rx_line_end_keeps_rx_armed)
+{
+	uart_bridge_init(test_rx_callback);
+
+	rx_rdy("OK 1.421\r\n");
+
+	zassert_equal(uart_rx_disable_fake.call_count, 0,
+		      "RX must stay armed across line ends");
+	zassert_equal(rx_ring_used(&rx_ring), 10);
+	zassert_equal(k_sem_give_fake_call_count, 1, "RX thread should be woken");
+}
+
+ZTEST(uart_bridge, test_rx_drain_forwards_ring_contents)
+{
+	uart_bridge_init(test_rx_callback);
+
+	rx_rdy("OK 1500\r\n");
+	rx_rdy("OK 142.857\r\n");
+	uart_rx_drain(false);
+
+	zassert_true(rx_cb_called);
+	zassert_equal(rx_cb_len, 21, "Adjacent spans should drain as one");
+	zassert_equal(rx_ring_used(&rx_ring), 0);
+}
+
+ZTEST(uart_bridge, test_rx_drain_holds_partial_line)
+{
+	uart_bridge_init(test_rx_callback);
+
+	/* DMA chunk ended mid-line */
+	rx_rdy("OK 1500\r\nOK 14");
+	uart_rx_drain(false);
+
+	zassert_equal(rx_cb_len, 9, "Only the complete line is handed over");
+	zassert_equal(rx_ring_used(&rx_ring), 5);
+
+	rx_rdy("2.857\r\n");
+	uart_rx_drain(false);
+
+	zassert_equal(rx_cb_len, 12);
+	zassert_equal(rx_ring_used(&rx_ring), 0);
+}
+
+ZTEST(uart_bridge, test_rx_drain_flushes_idle_partial_line)
+{
+	uart_bridge_init(test_rx_callback);
+
+	rx_rdy("> ");
+	uart_rx_drain(false);
+	zassert_false(rx_cb_called);
+
+	/* RX thread timed out waiting for the line end */
+	uart_rx_drain(true);
+	zassert_true(rx_cb_called);
+	zassert_equal(rx_cb_len, 2);
+	zassert_equal(rx_ring_used(&rx_ring), 0);
+}
+
+ZTEST(uart_bridge, test_rx_drain_passes_long_line)
+{
+	char line[UART_BUF_SIZE + 1];
+
+	uart_bridge_init(test_rx_callback);
+	memset(line, 'x', UART_BUF_SIZE);
+	line[UART_BUF_SIZE] = '\0';
+
+	rx_rdy(line);
+	uart_rx_drain(false);
+
+	zassert_equal(rx_cb_len, UART_BUF_SIZE, "A line longer than a buffer is not held");
+}
+
+ZTEST(uart_bridge, test_rx_drain_splits_line_at_ring_wrap)
+{
+	uart_bridge_init(test_rx_callback);
+
+	/* Move the ring indices to just before the end of the buffer */
+	rx_ring_commit(&rx_ring, UART_RX_RING_SIZE - 4);
+	rx_ring_consume(&rx_ring, UART_RX_RING_SIZE - 4);
+	memcpy(&rx_ring_buf[UART_RX_RING_SIZE - 4], "OK 1", 4);
+	memcpy(rx_ring_buf, ".5\r\n", 4);
+	rx_ring_commit(&rx_ring, 8);
+
+	uart_rx_drain(false);
+
+	zassert_equal(rx_cb_len, 4, "Second half of the wrapped line follows");
+	zassert_equal(rx_ring_used(&rx_ring), 0);
+}
+
+ZTEST(uart_bridge, test_rx_ring_full_stalls_and_rearms)
+{
+	struct uart_bridge_pool_stats stats;
+	struct uart_event req = { .type = UART_RX_BUF_REQUEST };
+	struct uart_event disabled = { .type = UART_RX_DISABLED };
+
+	uart_bridge_init(test_rx_callback);
+
+	/* Driver has been given every chunk of the ring */
+	for (int i = 1; i < UART_RX_RING_SIZE / UART_RX_DMA_CHUNK; i++) {
+		uart_cb(uart, &req, NULL);
+	}
+	uart_cb(uart, &req, NULL);
+	rx_ring_commit(&rx_ring, UART_RX_RING_SIZE);
+
+	uart_bridge_get_pool_stats(&stats);
+	zassert_equal(stats.rx_exhausted, 1);
+
+	/* Driver stops; no space to re-arm yet */
+	RESET_FAKE(uart_rx_enable);
+	uart_cb(uart, &disabled, NULL);
+	zassert_equal(uart_rx_enable_fake.call_count, 0);
+	zassert_equal(atomic_get(&rx_stalled), 1);
+
+	/* Draining the ring schedules the re-arm */
+	RESET_FAKE(k_work_reschedule);
+	uart_rx_drain(false);
+	zassert_equal(k_work_reschedule_fake.call_count, 1);
+	zassert_equal(atomic_get(&rx_stalled), 0);
+}
+
+ZTEST(uart_bridge, test_pool_tracks_high_water)
+{
+	struct uart_bridge_pool_stats stats;
+	struct uart_data_t *a = uart_buf_alloc(&tx_pool);
+	struct uart_data_t *b = uart_buf_alloc(&tx_pool);
+
+	zassert_not_null(a);
+	zassert_not_null(b);
+	uart_buf_free(a);
+	uart_buf_free(b);
+
+	uart_bridge_get_pool_stats(&stats);
+	zassert_equal(stats.tx_in_use, 0);
+	zassert_equal(stats.tx_high_water, 2);
+	zassert_equal(stats.rx_high_water, 0);
+	zassert_equal(k_mem_slab_free_fake_call_count, 2);
+}
+
+ZTEST(uart_bridge, test_tx_exhaustion_does_not_starve_rx)
+{
+	struct uart_bridge_pool_stats stats;
+
+	uart_bridge_init(test_rx_callback);
+	test_exhausted_slab = &uart_tx_slab;
+
+	uint8_t data[] = "GET deviceId\r";
+	int err = uart_bridge_send(data, sizeof(data) - 1);
+
+	zassert_equal(err, -ENOMEM);
+
+	/* RX reservation is unaffected */
+	struct uart_event evt = { .type = UART_RX_BUF_REQUEST };
+
+	uart_cb(uart, &evt, NULL);
+	zassert_equal(uart_rx_buf_rsp_fake.call_count, 1);
+
+	uart_bridge_get_pool_stats(&stats);
+	zassert_equal(stats.tx_exhausted, 1);
+	zassert_equal(stats.rx_exhausted, 0);
+}
+
+ZTEST(uart_bridge, test_metrics_count_bytes_both_ways)
+{
+	uint8_t data[] = "GET deviceId\r";
+
+	uart_bridge_init(test_rx_callback);
+	RESET_FAKE(metrics_add);
+
+	uart_bridge_send(data, sizeof(data) - 1);
+	rx_ring_commit(&rx_ring, 20);
+	uart_rx_drain(true);
+
+	zassert_equal(metrics_added(METRICS_UART_TX_BYTES), sizeof(data) - 1);
+	zassert_equal(metrics_added(METRICS_UART_RX_BYTES), 20);
+}
+
+ZTEST(uart_bridge, test_metrics_count_tx_exhaustion_drops)
+{
+	uint8_t data[300] = { 0 };
+
+	uart_bridge_init(test_rx_callback);
+	RESET_FAKE(metrics_add);
+
+	/* First 255-byte chunk fits, the pool runs dry for the rest */
+	test_buf_idx = TEST_BUF_POOL_SIZE - 1;
+	zassert_equal(uart_bridge_send(data, sizeof(data)), -ENOMEM);
+
+	zassert_equal(metrics_added(METRICS_UART_TX_POOL_EMPTY), 1);
+	zassert_equal(metrics_added(METRICS_DROP_UART_TX_BYTES), sizeof(data) - 255);
+	zassert_equal(metrics_added(METRICS_UART_TX_BYTES), 0);
+}
+
+ZTEST(uart_bridge, test_metrics_count_rx_errors)
+{
+	struct uart_event stopped = {
+		.type = UART_RX_STOPPED,
+		.data.rx_stop.reason = UART_ERROR_FRAMING,
+	};
+	struct uart_event req = { .type = UART_RX_BUF_REQUEST };
+
+	uart_bridge_init(test_rx_callback);
+	uart_cb(uart, &stopped, NULL);
+	zassert_equal(metrics_added(METRICS_UART_ERRORS), 1);
+
+	/* Ring handed out completely, the next request overflows */
+	for (int i = 0; i < UART_RX_RING_SIZE / UART_RX_DMA_CHUNK; i++) {
+		uart_cb(uart, &req, NULL);
+	}
+	zassert_equal(metrics_added(METRICS_UART_RX_RING_FULL), 1);
+}
+
+ZTEST(uart_bridge, test_trace_rx_and_tx)
+{
+	uint8_t data[] = "GET tubeRate\r";
+
+	uart_bridge_init(test_rx_callback);
+	RESET_FAKE(trace_event);
+
+	rx_rdy("OK 12.5\r\n");
+	zassert_equal(trace_event_fake.call_count, 1);
+	zassert_equal(trace_event_fake.arg0_val, TRACE_UART_RX_RDY);
+	zassert_equal(trace_event_fake.arg2_val, 9);
+	zassert_mem_equal(trace_event_fake.arg1_val, "OK 12.5", 7);
+
+	uart_bridge_send(data, sizeof(data) - 1);
+	zassert_equal(trace_event_fake.call_count, 2);
+	zassert_equal(trace_event_fake.arg0_val, TRACE_UART_TX);
+	zassert_equal(trace_event_fake.arg2_val, sizeof(data));
+}
+
 ZTEST_SUITE(uart_bridge, NULL, NULL, NULL, NULL, NULL);
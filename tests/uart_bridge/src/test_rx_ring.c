@@ -0,0 +1,196 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Unit tests for the SPSC RX byte ring.
+ */
+
+#include <zephyr/ztest.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#include "uart/rx_ring.h"
+
+#define RING_SIZE 64
+
+static uint8_t ring_buf[RING_SIZE];
+static struct rx_ring ring;
+
+/* Deterministic byte stream so the consumer can verify every byte */
+static uint8_t pattern(uint32_t i)
+{
+	return (uint8_t)((i * 2654435761u) >> 24);
+}
+
+static uint32_t lcg(uint32_t *seed)
+{
+	*seed = (*seed * 1103515245u) + 12345u;
+	return *seed >> 16;
+}
+
+static void rx_ring_before(void *fixture)
+{
+	rx_ring_init(&ring, ring_buf, sizeof(ring_buf));
+}
+
+ZTEST(rx_ring, test_empty_after_init)
+{
+	const uint8_t *data;
+
+	zassert_equal(rx_ring_used(&ring), 0);
+	zassert_equal(rx_ring_peek(&ring, &data), 0);
+}
+
+ZTEST(rx_ring, test_put_peek_consume)
+{
+	const uint8_t *data;
+
+	zassert_equal(rx_ring_put(&ring, (const uint8_t *)"OK 1.421\r\n", 10), 10);
+	zassert_equal(rx_ring_peek(&ring, &data), 10);
+	zassert_mem_equal(data, "OK 1.421\r\n", 10);
+
+	rx_ring_consume(&ring, 10);
+	zassert_equal(rx_ring_used(&ring), 0);
+}
+
+ZTEST(rx_ring, test_put_stops_when_full)
+{
+	uint8_t data[RING_SIZE + 8];
+
+	memset(data, 'A', sizeof(data));
+
+	zassert_equal(rx_ring_put(&ring, data, sizeof(data)), RING_SIZE);
+	zassert_equal(rx_ring_put(&ring, data, 1), 0);
+	zassert_equal(rx_ring_used(&ring), RING_SIZE);
+}
+
+ZTEST(rx_ring, test_wraparound_splits_span)
+{
+	uint8_t data[48];
+	const uint8_t *span;
+
+	for (uint32_t i = 0; i < sizeof(data); i++) {
+		data[i] = pattern(i);
+	}
+
+	rx_ring_put(&ring, data, sizeof(data));
+	rx_ring_consume(&ring, sizeof(data));
+
+	/* 32 bytes starting at offset 48 wrap after 16 */
+	zassert_equal(rx_ring_put(&ring, data, 32), 32);
+	zassert_equal(rx_ring_peek(&ring, &span), 16);
+	zassert_equal(span, &ring_buf[48]);
+	zassert_mem_equal(span, data, 16);
+	rx_ring_consume(&ring, 16);
+
+	zassert_equal(rx_ring_peek(&ring, &span), 16);
+	zassert_equal(span, &ring_buf[0]);
+	zassert_mem_equal(span, &data[16], 16);
+}
+
+ZTEST(rx_ring, test_reserve_ahead_of_head)
+{
+	uint32_t len;
+	uint8_t *first = rx_ring_reserve(&ring, 0, 24, &len);
+
+	zassert_equal(first, &ring_buf[0]);
+	zassert_equal(len, 24);
+
+	/* Second DMA buffer queued behind the first, clipped at the wrap */
+	uint8_t *second = rx_ring_reserve(&ring, 48, 24, &len);
+
+	zassert_equal(second, &ring_buf[48]);
+	zassert_equal(len, 16);
+
+	/* No room past a full ring */
+	zassert_is_null(rx_ring_reserve(&ring, RING_SIZE, 24, &len));
+}
+
+ZTEST(rx_ring, test_index_overflow)
+{
+	const uint8_t *span;
+	uint8_t data[40];
+
+	for (uint32_t i = 0; i < sizeof(data); i++) {
+		data[i] = pattern(i);
+	}
+
+	/* Free-running indices about to wrap past UINT32_MAX */
+	atomic_set(&ring.head, (atomic_val_t)0xFFFFFFF0u);
+	atomic_set(&ring.tail, (atomic_val_t)0xFFFFFFF0u);
+
+	zassert_equal(rx_ring_put(&ring, data, sizeof(data)), sizeof(data));
+	zassert_equal(rx_ring_used(&ring), sizeof(data));
+
+	zassert_equal(rx_ring_peek(&ring, &span), 16);
+	zassert_mem_equal(span, data, 16);
+	rx_ring_consume(&ring, 16);
+
+	zassert_equal(rx_ring_peek(&ring, &span), 24);
+	zassert_mem_equal(span, &data[16], 24);
+	rx_ring_consume(&ring, 24);
+	zassert_equal(rx_ring_used(&ring), 0);
+}
+
+#define STRESS_BYTES 2000000u
+
+static void *stress_producer(void *arg)
+{
+	uint32_t seed = 1;
+	uint32_t written = 0;
+
+	while (written < STRESS_BYTES) {
+		uint32_t len;
+		uint32_t want = MIN(1 + (lcg(&seed) % 40), STRESS_BYTES - written);
+		uint8_t *dst = rx_ring_reserve(&ring, rx_ring_head(&ring), want, &len);
+
+		if (!dst) {
+			sched_yield();
+			continue;
+		}
+
+		for (uint32_t i = 0; i < len; i++) {
+			dst[i] = pattern(written + i);
+		}
+		rx_ring_commit(&ring, len);
+		written += len;
+	}
+
+	return NULL;
+}
+
+ZTEST(rx_ring, test_concurrent_producer_consumer)
+{
+	pthread_t producer;
+	uint32_t seed = 7;
+	uint32_t read = 0;
+	uint32_t mismatches = 0;
+
+	zassert_equal(pthread_create(&producer, NULL, stress_producer, NULL), 0);
+
+	while (read < STRESS_BYTES) {
+		const uint8_t *span;
+		uint32_t len = rx_ring_peek(&ring, &span);
+
+		if (len == 0) {
+			sched_yield();
+			continue;
+		}
+
+		/* Consume a random part of the span to vary interleavings */
+		len = 1 + (lcg(&seed) % len);
+		for (uint32_t i = 0; i < len; i++) {
+			if (span[i] != pattern(read + i)) {
+				mismatches++;
+			}
+		}
+		rx_ring_consume(&ring, len);
+		read += len;
+	}
+
+	pthread_join(producer, NULL);
+
+	zassert_equal(mismatches, 0, "Consumer saw corrupted or reordered bytes");
+	zassert_equal(rx_ring_used(&ring), 0);
+}
+
+ZTEST_SUITE(rx_ring, NULL, NULL, rx_ring_before, NULL, NULL);